@@ -163,6 +163,14 @@ impl Entry {
   pub(crate) fn into_sqe(self) -> bindings::io_uring_sqe {
     self.0
   }
+
+  /// Target the registered file at `index` instead of the entry's fd, see
+  /// [`LioUring::register_files`].
+  pub fn fixed_file(mut self, index: u32) -> Self {
+    self.0.fd = index as i32;
+    self.0.flags |= SqeFlags::FIXED_FILE.bits();
+    self
+  }
 }
 
 /// Configuration parameters for io_uring initialization
@@ -170,6 +178,9 @@ impl Entry {
 pub struct Params {
   /// Number of entries in the submission queue
   pub sq_entries: u32,
+  /// Number of entries in the completion queue, used with
+  /// [`cq_entries`](Self::cq_entries)
+  pub cq_entries: u32,
   /// Additional flags for io_uring setup
   pub flags: u32,
   /// CPU affinity for SQPOLL thread
@@ -180,7 +191,13 @@ pub struct Params {
 
 impl Default for Params {
   fn default() -> Self {
-    Self { sq_entries: 128, flags: 0, sq_thread_cpu: 0, sq_thread_idle: 0 }
+    Self {
+      sq_entries: 128,
+      cq_entries: 0,
+      flags: 0,
+      sq_thread_cpu: 0,
+      sq_thread_idle: 0,
+    }
   }
 }
 
@@ -197,6 +214,46 @@ impl Params {
     self.flags |= bindings::IORING_SETUP_IOPOLL;
     self
   }
+
+  /// Pin the SQPOLL thread to `cpu`. The kernel rejects this without
+  /// [`sqpoll`](Self::sqpoll).
+  pub fn sq_thread_cpu(mut self, cpu: u32) -> Self {
+    self.flags |= bindings::IORING_SETUP_SQ_AFF;
+    self.sq_thread_cpu = cpu;
+    self
+  }
+
+  /// Size the completion queue to `entries` instead of twice the submission
+  /// queue, so bursts of multishot completions don't overflow it.
+  pub fn cq_entries(mut self, entries: u32) -> Self {
+    self.flags |= bindings::IORING_SETUP_CQSIZE;
+    self.cq_entries = entries;
+    self
+  }
+
+  /// Run completion task work when the task next enters the kernel
+  /// instead of interrupting it (Linux 5.19).
+  pub fn coop_taskrun(mut self) -> Self {
+    // TASKRUN_FLAG lets peeking for completions notice pending work.
+    self.flags |=
+      bindings::IORING_SETUP_COOP_TASKRUN | bindings::IORING_SETUP_TASKRUN_FLAG;
+    self
+  }
+
+  /// Promise that only the creating thread submits to the ring (Linux 6.0).
+  pub fn single_issuer(mut self) -> Self {
+    self.flags |= bindings::IORING_SETUP_SINGLE_ISSUER;
+    self
+  }
+
+  /// Defer completion task work until the application waits for completions
+  /// (Linux 6.1). Implies [`single_issuer`](Self::single_issuer).
+  pub fn defer_taskrun(mut self) -> Self {
+    self.flags |= bindings::IORING_SETUP_DEFER_TASKRUN
+      | bindings::IORING_SETUP_SINGLE_ISSUER
+      | bindings::IORING_SETUP_TASKRUN_FLAG;
+    self
+  }
 }
 
 /// A Linux io_uring instance for high-performance async I/O.
@@ -235,7 +292,7 @@ impl LioUring {
     let mut ring = MaybeUninit::zeroed();
     let mut raw_params = bindings::io_uring_params {
       sq_entries: params.sq_entries,
-      cq_entries: 0,
+      cq_entries: params.cq_entries,
       flags: params.flags,
       sq_thread_cpu: params.sq_thread_cpu,
       sq_thread_idle: params.sq_thread_idle,
@@ -286,6 +343,8 @@ impl LioUring {
 
   /// Push an operation to the submission queue with custom flags.
   ///
+  /// `flags` are added to the ones the operation already carries.
+  ///
   /// # Safety
   /// Same requirements as `push()`.
   ///
@@ -308,7 +367,8 @@ impl LioUring {
     unsafe {
       (*sqe) = entry.into_sqe();
       (*sqe).user_data = user_data;
-      (*sqe).flags = flags.bits()
+      // Keep flags set by the operation builder (e.g BUFFER_SELECT).
+      (*sqe).flags |= flags.bits()
     }
 
     Ok(())
@@ -446,6 +506,46 @@ impl LioUring {
     Ok(Some(completion))
   }
 
+  /// Submit queued operations and wait until `wait_nr` completions are
+  /// ready or `timeout` passes, in one call.
+  ///
+  /// The completions stay queued for [`try_wait`](Self::try_wait). Returns
+  /// `Ok(false)` if the timeout expired first, with fewer ready.
+  ///
+  /// # Errors
+  /// Returns an error if submitting or waiting fails (other than timeout).
+  pub fn submit_and_wait_timeout(
+    &mut self,
+    wait_nr: u32,
+    timeout: Option<Duration>,
+  ) -> io::Result<bool> {
+    let mut cqe_ptr = ptr::null_mut();
+    let mut ts = timeout.map(|timeout| bindings::__kernel_timespec {
+      tv_sec: timeout.as_secs() as i64,
+      tv_nsec: timeout.subsec_nanos() as i64,
+    });
+    let ts_ptr = ts.as_mut().map_or(ptr::null_mut(), |ts| ts as *mut _);
+
+    let ret = unsafe {
+      bindings::io_uring_submit_and_wait_timeout(
+        &raw mut self.ring,
+        &raw mut cqe_ptr,
+        wait_nr,
+        ts_ptr,
+        ptr::null_mut(),
+      )
+    };
+
+    if ret < 0 {
+      let errno = -ret;
+      if errno == libc::ETIME {
+        return Ok(false);
+      }
+      return Err(io::Error::from_raw_os_error(errno));
+    }
+    Ok(true)
+  }
+
   /// Try to retrieve the next completion without blocking.
   ///
   /// Returns `None` if no completions are available.
@@ -621,6 +721,117 @@ impl LioUring {
     }
     Ok(())
   }
+
+  /// Register a provided-buffer ring for buffer group `bgid`.
+  ///
+  /// Operations using buffer selection on group `bgid` (for example
+  /// [`RecvMulti`](operation::RecvMulti)) pick their buffer from the ring, and
+  /// report which one through [`Completion::buffer_id`]. The ring starts
+  /// empty, use [`BufRing::add`] and [`BufRing::advance`] to hand buffers to
+  /// the kernel.
+  ///
+  /// `entries` must be a power of two, at most 32768.
+  ///
+  /// # Errors
+  /// Returns an error if the kernel doesn't support buffer rings (older than
+  /// 5.19) or `bgid` is already in use.
+  pub fn setup_buf_ring(
+    &mut self,
+    entries: u32,
+    bgid: u16,
+  ) -> io::Result<BufRing> {
+    let mut err = 0;
+    let br = unsafe {
+      bindings::io_uring_setup_buf_ring(
+        &raw mut self.ring,
+        entries,
+        bgid as i32,
+        0,
+        &raw mut err,
+      )
+    };
+
+    if br.is_null() {
+      return Err(io::Error::from_raw_os_error(-err));
+    }
+    Ok(BufRing {
+      br,
+      entries,
+      bgid,
+      mask: unsafe { bindings::io_uring_buf_ring_mask(entries) },
+    })
+  }
+
+  /// Unregister and unmap a ring created by [`setup_buf_ring`](Self::setup_buf_ring).
+  ///
+  /// # Safety
+  /// No in-flight operation may still select buffers from the ring.
+  pub unsafe fn free_buf_ring(&mut self, ring: BufRing) -> io::Result<()> {
+    let ret = unsafe {
+      bindings::io_uring_free_buf_ring(
+        &raw mut self.ring,
+        ring.br,
+        ring.entries,
+        ring.bgid as i32,
+      )
+    };
+
+    if ret < 0 {
+      return Err(io::Error::from_raw_os_error(-ret));
+    }
+    Ok(())
+  }
+}
+
+/// A provided-buffer ring shared with the kernel, see
+/// [`LioUring::setup_buf_ring`].
+///
+/// Dropping it without [`LioUring::free_buf_ring`] keeps the ring registered
+/// until the io_uring instance is dropped.
+pub struct BufRing {
+  br: *mut bindings::io_uring_buf_ring,
+  entries: u32,
+  bgid: u16,
+  mask: i32,
+}
+
+impl BufRing {
+  /// The buffer group id operations select from.
+  pub fn bgid(&self) -> u16 {
+    self.bgid
+  }
+
+  /// Number of slots in the ring.
+  pub fn entries(&self) -> u32 {
+    self.entries
+  }
+
+  /// Write buffer `bid` into the ring, `offset` slots past the current tail.
+  ///
+  /// The buffer isn't visible to the kernel until [`advance`](Self::advance)
+  /// is called with a count covering it. When adding a batch, use offsets
+  /// `0..n` and advance once by `n`.
+  ///
+  /// # Safety
+  /// `addr` must be valid for writes of `len` bytes and must not be accessed
+  /// until a completion hands `bid` back.
+  pub unsafe fn add(&mut self, addr: *mut u8, len: u32, bid: u16, offset: i32) {
+    unsafe {
+      bindings::io_uring_buf_ring_add(
+        self.br,
+        addr.cast(),
+        len,
+        bid,
+        self.mask,
+        offset,
+      )
+    }
+  }
+
+  /// Make the next `count` added buffers visible to the kernel.
+  pub fn advance(&mut self, count: i32) {
+    unsafe { bindings::io_uring_buf_ring_advance(self.br, count) }
+  }
 }
 
 #[cfg(test)]
@@ -770,6 +981,7 @@ mod tests {
   fn test_params_default() {
     let params = Params::default();
     assert_eq!(params.sq_entries, 128);
+    assert_eq!(params.cq_entries, 0);
     assert_eq!(params.flags, 0);
     assert_eq!(params.sq_thread_cpu, 0);
     assert_eq!(params.sq_thread_idle, 0);
@@ -795,4 +1007,50 @@ mod tests {
     assert!((params.flags & bindings::IORING_SETUP_IOPOLL) != 0);
     assert_eq!(params.sq_thread_idle, 500);
   }
+
+  #[test]
+  fn test_params_sq_thread_cpu() {
+    let params = Params::default().sqpoll(10).sq_thread_cpu(3);
+    assert!((params.flags & bindings::IORING_SETUP_SQ_AFF) != 0);
+    assert_eq!(params.sq_thread_cpu, 3);
+  }
+
+  #[test]
+  fn test_params_cq_entries() {
+    let params = Params::default().cq_entries(4096);
+    assert!((params.flags & bindings::IORING_SETUP_CQSIZE) != 0);
+    assert_eq!(params.cq_entries, 4096);
+  }
+
+  #[test]
+  fn test_params_defer_taskrun_implies_single_issuer() {
+    let params = Params::default().defer_taskrun();
+    assert!((params.flags & bindings::IORING_SETUP_DEFER_TASKRUN) != 0);
+    assert!((params.flags & bindings::IORING_SETUP_SINGLE_ISSUER) != 0);
+  }
+
+  #[test]
+  fn test_entry_fixed_file() {
+    let entry = operation::Nop::new().build().fixed_file(7);
+    let sqe = entry.into_sqe();
+    assert_eq!(sqe.fd, 7);
+    assert!(SqeFlags(sqe.flags).contains(SqeFlags::FIXED_FILE));
+  }
+
+  #[test]
+  fn test_register_files_sparse() {
+    let mut ring = LioUring::new(8).unwrap();
+    ring.register_files(&[-1; 4]).unwrap();
+    ring.register_files_update(2, &[libc::STDOUT_FILENO]).unwrap();
+    ring.register_files_update(2, &[-1]).unwrap();
+    ring.unregister_files().unwrap();
+  }
+
+  #[test]
+  fn test_ring_with_cq_entries() {
+    let ring = LioUring::with_params(
+      Params { sq_entries: 8, ..Default::default() }.cq_entries(64),
+    );
+    assert!(ring.is_ok(), "Failed to create ring: {:?}", ring.err());
+  }
 }
@@ -592,6 +592,22 @@ impl TimeoutFlags {
   }
 }
 
+/// Options for [`AsyncCancel`]. By default it cancels the first request
+/// whose user data matches.
+#[derive(Debug, Clone, Copy)]
+pub struct CancelFlags(u32);
+
+impl CancelFlags {
+  pub const NONE: Self = Self(0);
+
+  /// Cancels every request in flight, ignoring the user data (5.19).
+  pub const ANY: Self = Self(bindings::IORING_ASYNC_CANCEL_ANY);
+
+  pub fn bits(self) -> u32 {
+    self.0
+  }
+}
+
 opcode! {
     /// Register a timeout operation.
     ///
@@ -737,18 +753,20 @@ opcode! {
         user_data: { u64 }
         ;;
 
-        // TODO flags
+        /// Which requests to cancel, see [`CancelFlags`].
+        flags: CancelFlags = CancelFlags::NONE
     }
 
     pub const CODE = bindings::io_uring_op_IORING_OP_ASYNC_CANCEL;
 
     pub fn build(self) -> Entry {
-        let AsyncCancel { user_data } = self;
+        let AsyncCancel { user_data, flags } = self;
 
         let mut sqe = sqe_zeroed();
         sqe.opcode = Self::CODE;
         sqe.fd = -1;
         sqe.__bindgen_anon_2.addr = user_data;
+        sqe.__bindgen_anon_3.cancel_flags = flags.0;
         Entry(sqe)
     }
 }
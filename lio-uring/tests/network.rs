@@ -311,6 +311,49 @@ fn test_recv_closed_connection() {
   assert_eq!(completion.result(), 0); // EOF
 }
 
+#[test]
+fn test_recv_multi_buf_ring() {
+  let port = get_free_port();
+  let listener = TcpListener::bind(format!("127.0.0.1:{}", port)).unwrap();
+
+  let mut client = TcpStream::connect(format!("127.0.0.1:{}", port)).unwrap();
+  let (server_stream, _) = listener.accept().unwrap();
+
+  let mut ring = LioUring::new(8).unwrap();
+
+  const BUF_LEN: usize = 64;
+  let mut bufs = vec![0u8; 4 * BUF_LEN];
+  let mut buf_ring = ring.setup_buf_ring(4, 7).unwrap();
+  for bid in 0..4u16 {
+    let addr = unsafe { bufs.as_mut_ptr().add(bid as usize * BUF_LEN) };
+    unsafe { buf_ring.add(addr, BUF_LEN as u32, bid, bid as i32) };
+  }
+  buf_ring.advance(4);
+
+  let op = RecvMulti::new(server_stream.as_raw_fd(), buf_ring.bgid());
+  unsafe { ring.push(op.build(), 1) }.unwrap();
+  ring.submit().unwrap();
+
+  for msg in [&b"first"[..], &b"second"[..]] {
+    client.write_all(msg).unwrap();
+    let completion = ring.wait().unwrap();
+    assert_eq!(completion.user_data(), 1);
+    assert!(completion.has_more());
+    assert_eq!(completion.result(), msg.len() as i32);
+    let bid = completion.buffer_id().expect("buffer should be selected");
+    let start = bid as usize * BUF_LEN;
+    assert_eq!(&bufs[start..start + msg.len()], msg);
+  }
+
+  // EOF terminates the multishot request.
+  drop(client);
+  let completion = ring.wait().unwrap();
+  assert_eq!(completion.result(), 0);
+  assert!(!completion.has_more());
+
+  unsafe { ring.free_buf_ring(buf_ring) }.unwrap();
+}
+
 // ============================================================================
 // Shutdown Tests
 // ============================================================================
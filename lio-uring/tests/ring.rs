@@ -185,6 +185,28 @@ fn test_wait_timeout_immediate_completion() {
   assert_eq!(result.unwrap().user_data(), 123);
 }
 
+#[test]
+fn test_submit_and_wait_timeout() {
+  let mut ring = LioUring::new(8).unwrap();
+
+  for id in 0..3 {
+    unsafe { ring.push(Nop::new().build(), id) }.unwrap();
+  }
+  // Submits and waits for all three in one call.
+  assert!(
+    ring.submit_and_wait_timeout(3, Some(Duration::from_secs(5))).unwrap()
+  );
+  for _ in 0..3 {
+    assert!(ring.try_wait().unwrap().is_some());
+  }
+
+  let start = std::time::Instant::now();
+  let ready =
+    ring.submit_and_wait_timeout(1, Some(Duration::from_millis(50))).unwrap();
+  assert!(!ready);
+  assert!(start.elapsed() >= Duration::from_millis(40)); // Allow some slack
+}
+
 #[test]
 fn test_peek_does_not_consume() {
   let mut ring = LioUring::new(8).unwrap();
@@ -0,0 +1,96 @@
+//! Counts heap allocations made while the driver dispatches completions.
+//!
+//! Ops are scheduled outside the measured region, so only `Lio::try_run` is
+//! counted, busy-polled like a `lio_tick` loop would. A steady-state tick
+//! should not allocate at all.
+//!
+//! Run with `cargo bench --bench alloc_per_tick`.
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+use lio::{Lio, api};
+
+struct CountingAlloc;
+
+static ALLOCS: AtomicUsize = AtomicUsize::new(0);
+static DONE: AtomicUsize = AtomicUsize::new(0);
+
+// SAFETY: Forwards to the system allocator, only counting calls.
+unsafe impl GlobalAlloc for CountingAlloc {
+  unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+    ALLOCS.fetch_add(1, Ordering::Relaxed);
+    // SAFETY: Same contract as our caller's.
+    unsafe { System.alloc(layout) }
+  }
+
+  unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+    // SAFETY: Same contract as our caller's.
+    unsafe { System.dealloc(ptr, layout) }
+  }
+
+  unsafe fn realloc(
+    &self,
+    ptr: *mut u8,
+    layout: Layout,
+    new_size: usize,
+  ) -> *mut u8 {
+    ALLOCS.fetch_add(1, Ordering::Relaxed);
+    // SAFETY: Same contract as our caller's.
+    unsafe { System.realloc(ptr, layout, new_size) }
+  }
+}
+
+#[global_allocator]
+static GLOBAL: CountingAlloc = CountingAlloc;
+
+const TICKS: usize = 10_000;
+const BATCH: usize = 64;
+
+/// Schedules `BATCH` nops per tick and returns the allocations made by
+/// `try_run()` calls alone, per tick.
+fn allocs_per_tick(name: &str, lio: Lio) {
+  // Warm up so one-time growth of backend buffers isn't counted.
+  for _ in 0..16 {
+    tick(&lio);
+  }
+
+  let mut allocs = 0;
+  for _ in 0..TICKS {
+    allocs += tick(&lio);
+  }
+  println!(
+    "{name:>10}: {allocs} allocations over {TICKS} ticks of {BATCH} nops \
+     ({:.3} per tick)",
+    allocs as f64 / TICKS as f64
+  );
+}
+
+/// Returns the allocations made while completing one batch.
+fn tick(lio: &Lio) -> usize {
+  DONE.store(0, Ordering::Relaxed);
+  for _ in 0..BATCH {
+    api::nop().with_lio(lio).when_done(|_| {
+      DONE.fetch_add(1, Ordering::Relaxed);
+    });
+  }
+
+  let before = ALLOCS.load(Ordering::Relaxed);
+  while DONE.load(Ordering::Relaxed) < BATCH {
+    lio.try_run().unwrap();
+  }
+  ALLOCS.load(Ordering::Relaxed) - before
+}
+
+fn main() {
+  allocs_per_tick("default", Lio::new(1024).unwrap());
+
+  #[cfg(target_os = "linux")]
+  {
+    use lio::backends::pollingv2::Poller;
+    allocs_per_tick(
+      "poller",
+      Lio::new_with_backend(Poller::new(), 1024).unwrap(),
+    );
+  }
+}
@@ -0,0 +1,302 @@
+//! Latency and throughput of common operations, per backend.
+//!
+//! Every benchmark completes one operation at a time, busy-polling the driver
+//! with `try_run`, and reports throughput with p50/p99/p999 latency:
+//!
+//! ```text
+//! nop              io_uring   1250000 ops/s  p50 0.7µs  p99 1.1µs  p999 4.2µs
+//! ```
+//!
+//! Run with `cargo bench --bench ops [-- <filter>...]`, every filter has to
+//! match the benchmark or backend name, e.g `-- accept poller`. `LIO_BENCH_ITERS` scales the iteration counts.
+
+use std::io::{Read, Write};
+use std::net::{TcpListener, TcpStream};
+use std::time::{Duration, Instant};
+
+use lio::api::resource::Resource;
+use lio::typed_op::TypedOp;
+use lio::{Lio, api};
+
+const CAP: usize = 1024;
+
+/// A named way to create a [`Lio`] on one backend.
+struct Backend {
+  name: &'static str,
+  new: fn() -> Lio,
+}
+
+fn backends() -> Vec<Backend> {
+  #[allow(unused_mut)]
+  let mut backends = Vec::new();
+  #[cfg(target_os = "linux")]
+  backends.push(Backend {
+    name: "io_uring",
+    new: || {
+      use lio::backends::io_uring::IoUring;
+      Lio::new_with_backend(IoUring::new(), CAP).unwrap()
+    },
+  });
+  #[cfg(unix)]
+  backends.push(Backend {
+    name: "poller",
+    new: || {
+      use lio::backends::pollingv2::Poller;
+      Lio::new_with_backend(Poller::new(), CAP).unwrap()
+    },
+  });
+  #[cfg(unix)]
+  backends.push(Backend {
+    name: "poller-edge",
+    new: || {
+      use lio::backends::pollingv2::Poller;
+      Lio::new_with_backend(Poller::new().edge_triggered(), CAP).unwrap()
+    },
+  });
+  #[cfg(windows)]
+  backends.push(Backend {
+    name: "iocp",
+    new: || {
+      use lio::backends::Iocp;
+      Lio::new_with_backend(Iocp::new(), CAP).unwrap()
+    },
+  });
+  backends
+}
+
+/// Submits `io` and busy-polls `lio` until it completes.
+fn complete<T>(lio: &Lio, io: api::io::Io<T>) -> T::Result
+where
+  T: TypedOp,
+  T::Result: Send,
+{
+  let mut receiver = io.with_lio(lio).send();
+  loop {
+    lio.try_run().unwrap();
+    if let Some(result) = receiver.try_recv() {
+      return result;
+    }
+  }
+}
+
+/// Measured latencies of one benchmark on one backend.
+struct Stats {
+  samples: Vec<Duration>,
+  total: Duration,
+}
+
+impl Stats {
+  /// Runs `op` `iters` times after a short warm-up, timing each call.
+  fn measure(iters: usize, mut op: impl FnMut()) -> Self {
+    for _ in 0..iters.div_ceil(10) {
+      op();
+    }
+    let mut samples = Vec::with_capacity(iters);
+    let start = Instant::now();
+    for _ in 0..iters {
+      let op_start = Instant::now();
+      op();
+      samples.push(op_start.elapsed());
+    }
+    let total = start.elapsed();
+    samples.sort_unstable();
+    Self { samples, total }
+  }
+
+  fn percentile(&self, p: f64) -> Duration {
+    let idx = ((self.samples.len() - 1) as f64 * p).round() as usize;
+    self.samples[idx]
+  }
+
+  fn report(&self, bench: &str, backend: &str) {
+    let ops = self.samples.len() as f64 / self.total.as_secs_f64();
+    println!(
+      "{bench:<16} {backend:<11} {ops:>9.0} ops/s  p50 {:>8.1?}  p99 {:>8.1?}  p999 {:>8.1?}",
+      self.percentile(0.50),
+      self.percentile(0.99),
+      self.percentile(0.999),
+    );
+  }
+}
+
+#[cfg(unix)]
+fn into_resource(fd: impl std::os::fd::IntoRawFd) -> Resource {
+  use std::os::fd::FromRawFd;
+  // SAFETY: The fd was just given up by its owner.
+  unsafe { Resource::from_raw_fd(fd.into_raw_fd()) }
+}
+
+#[cfg(windows)]
+fn into_resource(fd: impl std::os::windows::io::IntoRawHandle) -> Resource {
+  use std::os::windows::io::FromRawHandle;
+  // SAFETY: The handle was just given up by its owner.
+  unsafe { Resource::from_raw_handle(fd.into_raw_handle()) }
+}
+
+#[cfg(windows)]
+fn into_socket_resource(
+  sock: impl std::os::windows::io::IntoRawSocket,
+) -> Resource {
+  use std::os::windows::io::{FromRawHandle, RawHandle};
+  // SAFETY: The socket was just given up by its owner.
+  unsafe { Resource::from_raw_handle(sock.into_raw_socket() as RawHandle) }
+}
+
+#[cfg(unix)]
+fn into_socket_resource(sock: impl std::os::fd::IntoRawFd) -> Resource {
+  into_resource(sock)
+}
+
+fn bench_nop(lio: &Lio, iters: usize) -> Stats {
+  Stats::measure(iters, || complete(lio, api::nop()).unwrap())
+}
+
+fn bench_timeout(lio: &Lio, iters: usize) -> Stats {
+  Stats::measure(iters / 10, || {
+    complete(lio, api::timeout(Duration::from_micros(10))).unwrap()
+  })
+}
+
+/// Temp file of `len` bytes, removed when dropped.
+struct TempFile {
+  path: std::path::PathBuf,
+  res: Resource,
+}
+
+impl TempFile {
+  fn new(name: &str, len: usize) -> Self {
+    let path = std::env::temp_dir()
+      .join(format!("lio-bench-{name}-{}", std::process::id()));
+    let file = std::fs::OpenOptions::new()
+      .read(true)
+      .write(true)
+      .create(true)
+      .truncate(true)
+      .open(&path)
+      .unwrap();
+    file.set_len(len as u64).unwrap();
+    Self { path, res: into_resource(file) }
+  }
+}
+
+impl Drop for TempFile {
+  fn drop(&mut self) {
+    let _ = std::fs::remove_file(&self.path);
+  }
+}
+
+const FILE_BLOCK: usize = 4096;
+const FILE_BLOCKS: usize = 256;
+
+fn bench_read_at(lio: &Lio, iters: usize) -> Stats {
+  let file = TempFile::new("read", FILE_BLOCK * FILE_BLOCKS);
+  let mut buf = Some(vec![0u8; FILE_BLOCK]);
+  let mut i = 0;
+  Stats::measure(iters, || {
+    let offset = ((i % FILE_BLOCKS) * FILE_BLOCK) as i64;
+    i += 1;
+    let (res, b) =
+      complete(lio, api::read_at(&file.res, buf.take().unwrap(), offset));
+    assert_eq!(res.unwrap() as usize, FILE_BLOCK);
+    buf = Some(b);
+  })
+}
+
+fn bench_write_at(lio: &Lio, iters: usize) -> Stats {
+  let file = TempFile::new("write", FILE_BLOCK * FILE_BLOCKS);
+  let mut buf = Some(vec![7u8; FILE_BLOCK]);
+  let mut i = 0;
+  Stats::measure(iters, || {
+    let offset = ((i % FILE_BLOCKS) * FILE_BLOCK) as i64;
+    i += 1;
+    let (res, b) =
+      complete(lio, api::write_at(&file.res, buf.take().unwrap(), offset));
+    assert_eq!(res.unwrap() as usize, FILE_BLOCK);
+    buf = Some(b);
+  })
+}
+
+const ECHO_LEN: usize = 64;
+
+/// Round trip of `ECHO_LEN` bytes through a blocking echo thread.
+fn bench_tcp_echo(lio: &Lio, iters: usize) -> Stats {
+  let listener = TcpListener::bind("127.0.0.1:0").unwrap();
+  let client = TcpStream::connect(listener.local_addr().unwrap()).unwrap();
+  let (mut server, _) = listener.accept().unwrap();
+  client.set_nodelay(true).unwrap();
+  server.set_nodelay(true).unwrap();
+
+  let echo = std::thread::spawn(move || {
+    let mut buf = [0u8; ECHO_LEN];
+    while server.read_exact(&mut buf).is_ok() {
+      if server.write_all(&buf).is_err() {
+        break;
+      }
+    }
+  });
+
+  let client = into_socket_resource(client);
+  let mut buf = Some(vec![1u8; ECHO_LEN]);
+  let stats = Stats::measure(iters, || {
+    let (res, b) = complete(lio, api::send(&client, buf.take().unwrap(), None));
+    assert_eq!(res.unwrap() as usize, ECHO_LEN);
+    // Vec buffers are sized by capacity, so `b` can be received into as is.
+    let mut b = b;
+    let mut received = 0;
+    while received < ECHO_LEN {
+      let (res, back) = complete(lio, api::recv(&client, b, None));
+      received += res.unwrap() as usize;
+      b = back;
+    }
+    b.resize(ECHO_LEN, 1);
+    buf = Some(b);
+  });
+
+  drop(client);
+  echo.join().unwrap();
+  stats
+}
+
+/// Connect from a std socket, then accept it through lio.
+fn bench_accept(lio: &Lio, iters: usize) -> Stats {
+  let std_listener = TcpListener::bind("127.0.0.1:0").unwrap();
+  let addr = std_listener.local_addr().unwrap();
+  let listener = into_socket_resource(std_listener);
+  Stats::measure(iters / 10, || {
+    let _client = TcpStream::connect(addr).unwrap();
+    complete(lio, api::accept(&listener)).unwrap();
+  })
+}
+
+type Bench = fn(&Lio, usize) -> Stats;
+
+fn main() {
+  // `cargo bench` passes `--bench`, anything else filters.
+  let filter: Vec<String> =
+    std::env::args().skip(1).filter(|a| !a.starts_with("--")).collect();
+  let iters = std::env::var("LIO_BENCH_ITERS")
+    .ok()
+    .and_then(|v| v.parse().ok())
+    .unwrap_or(100_000);
+
+  let benches: [(&str, Bench); 6] = [
+    ("nop", bench_nop),
+    ("timeout", bench_timeout),
+    ("read_at", bench_read_at),
+    ("write_at", bench_write_at),
+    ("tcp_echo", bench_tcp_echo),
+    ("accept", bench_accept),
+  ];
+
+  for (bench, run) in benches {
+    for backend in backends() {
+      let selected =
+        filter.iter().all(|f| bench.contains(f) || backend.name.contains(f));
+      if !selected {
+        continue;
+      }
+      let lio = (backend.new)();
+      run(&lio, iters).report(bench, backend.name);
+    }
+  }
+}
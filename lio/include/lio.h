@@ -6,17 +6,293 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #ifndef __cplusplus
 typedef struct sockaddr sockaddr;
 typedef struct sockaddr_storage sockaddr_storage;
+typedef struct iovec iovec;
 #endif
 
+/**
+ * Start the SQPOLL kernel thread, idling after `sqpoll_idle_ms`.
+ */
+#define LIO_CONFIG_SQPOLL (1 << 0)
+
+/**
+ * Pin the SQPOLL thread to `sqpoll_cpu`.
+ */
+#define LIO_CONFIG_SQPOLL_CPU (1 << 1)
+
+/**
+ * Busy-poll for completions (`O_DIRECT` files only).
+ */
+#define LIO_CONFIG_IOPOLL (1 << 2)
+
+/**
+ * Run completion work cooperatively (Linux 5.19).
+ */
+#define LIO_CONFIG_COOP_TASKRUN (1 << 3)
+
+/**
+ * Defer completion work until the loop waits (Linux 6.1).
+ */
+#define LIO_CONFIG_DEFER_TASKRUN (1 << 4)
+
+/**
+ * Only the creating thread submits (Linux 6.0).
+ */
+#define LIO_CONFIG_SINGLE_ISSUER (1 << 5)
+
+/**
+ * Id returned for an operation that was never submitted, see
+ * [`lio_cancel`].
+ */
+#define LIO_NO_OP UINT64_MAX
+
+/**
+ * Does nothing.
+ */
+#define LIO_SQE_NOP 0
+
+/**
+ * Read into `buf`, at `offset` or the current position if it's -1.
+ */
+#define LIO_SQE_READ 1
+
+/**
+ * Write from `buf`, at `offset` or the current position if it's -1.
+ */
+#define LIO_SQE_WRITE 2
+
+/**
+ * Receive into `buf` with `flags`.
+ */
+#define LIO_SQE_RECV 3
+
+/**
+ * Send from `buf` with `flags`.
+ */
+#define LIO_SQE_SEND 4
+
+/**
+ * Synchronize `fd` with the storage device.
+ */
+#define LIO_SQE_FSYNC 5
+
+/**
+ * Close `fd`.
+ */
+#define LIO_SQE_CLOSE 6
+
+/**
+ * Shut down part of a connection, with `flags` as `how`.
+ */
+#define LIO_SQE_SHUTDOWN 7
+
+/**
+ * Wait `offset` nanoseconds.
+ */
+#define LIO_SQE_TIMEOUT 8
+
+/**
+ * Length of the per-operation arrays in `lio_stats_t`, indexed by kind, see
+ * [`lio_op_name`].
+ */
+#define LIO_OP_KINDS 33
+
 /**
  * Opaque lio driver handle.  Create with [`lio_create`], destroy with
  * [`lio_destroy`].  Not thread-safe; use one handle per thread.
  */
 typedef struct lio_handle_t lio_handle_t;
 
+/**
+ * Handle for submitting to a `lio_handle_t` from other threads.  Create with
+ * [`lio_remote`], destroy with [`lio_remote_destroy`].  Thread-safe.
+ */
+typedef struct lio_remote_t lio_remote_t;
+
+/**
+ * Options for [`lio_create_ex`].  Zero-initialise it and set what you need;
+ * an all-zero config besides `capacity` behaves like [`lio_create`].
+ *
+ * The flags only apply to the io_uring backend and are ignored elsewhere.
+ */
+typedef struct lio_config_t {
+  /**
+   * Maximum number of concurrent operations.
+   */
+  unsigned int capacity;
+  /**
+   * Bitwise OR of `LIO_CONFIG_*` flags.
+   */
+  unsigned int flags;
+  /**
+   * Idle time before the SQPOLL thread sleeps, with `LIO_CONFIG_SQPOLL`.
+   */
+  unsigned int sqpoll_idle_ms;
+  /**
+   * CPU for the SQPOLL thread, with `LIO_CONFIG_SQPOLL_CPU`.
+   */
+  unsigned int sqpoll_cpu;
+  /**
+   * Completion queue size, or 0 for twice `capacity`.
+   */
+  unsigned int cq_entries;
+  /**
+   * Buffers in the pool of [`lio_buf_get`], or 0 for none.  They're
+   * registered with the kernel for [`lio_read_fixed`] and [`lio_write_fixed`].
+   */
+  unsigned int buf_count;
+  /**
+   * Size of each pool buffer in bytes, or 0 for 4096.
+   */
+  unsigned int buf_len;
+} lio_config_t;
+
+/**
+ * An operation for [`lio_submit_batch`].  Fields an operation doesn't use
+ * are ignored.
+ */
+typedef struct lio_sqe_t {
+  /**
+   * One of the `LIO_SQE_*` operations.
+   */
+  unsigned int opcode;
+  /**
+   * `send`/`recv` flags, or `how` for `LIO_SQE_SHUTDOWN`.
+   */
+  int flags;
+  /**
+   * File descriptor, which stays owned by the caller.
+   */
+  intptr_t fd;
+  /**
+   * Buffer to read into or write from.  It stays owned by the caller and
+   * must stay valid until the operation is reaped.
+   */
+  void *buf;
+  /**
+   * Length of `buf`.
+   */
+  uintptr_t len;
+  /**
+   * File offset, or the timeout in nanoseconds for `LIO_SQE_TIMEOUT`.
+   */
+  int64_t offset;
+  /**
+   * Handed back in the operation's `lio_cqe_t`.
+   */
+  void *user_data;
+} lio_sqe_t;
+
+/**
+ * A completed operation, filled in by [`lio_reap`].
+ */
+typedef struct lio_cqe_t {
+  /**
+   * The `user_data` of the operation's `lio_sqe_t`.
+   */
+  void *user_data;
+  /**
+   * Its result: bytes transferred, 0, or a negative errno.
+   */
+  int res;
+} lio_cqe_t;
+
+/**
+ * Counters filled in by [`lio_stats`], see [`Lio::stats`].
+ */
+typedef struct lio_stats_t {
+  /**
+   * Runs of the event loop.
+   */
+  uint64_t ticks;
+  /**
+   * Operations submitted and not completed yet.
+   */
+  uint64_t in_flight;
+  /**
+   * Most operations that can be in flight at once.
+   */
+  uint64_t capacity;
+  /**
+   * Operations submitted.
+   */
+  uint64_t submitted;
+  /**
+   * Operations completed.
+   */
+  uint64_t completed;
+  /**
+   * Flushes that submitted entries to the kernel.
+   */
+  uint64_t flushes;
+  /**
+   * Entries those flushes submitted.
+   */
+  uint64_t flushed;
+  /**
+   * Most entries a single flush submitted.
+   */
+  uint64_t max_flush;
+  /**
+   * Most completions a single tick handled.
+   */
+  uint64_t max_completions;
+  /**
+   * Waits for readiness an operation went back to, poller backend only.
+   */
+  uint64_t rearms;
+  /**
+   * Operations submitted, by kind.
+   */
+  uint64_t op_submitted[LIO_OP_KINDS];
+  /**
+   * Operations completed, by kind.
+   */
+  uint64_t op_completed[LIO_OP_KINDS];
+  /**
+   * Operations completed with an error, by kind.
+   */
+  uint64_t op_failed[LIO_OP_KINDS];
+  /**
+   * Total latency of completed operations in nanoseconds, by kind.
+   */
+  uint64_t op_latency_ns_sum[LIO_OP_KINDS];
+  /**
+   * Upper bound of the median latency in nanoseconds, by kind.
+   */
+  uint64_t op_latency_ns_p50[LIO_OP_KINDS];
+  /**
+   * Upper bound of the 99th percentile latency in nanoseconds, by kind.
+   */
+  uint64_t op_latency_ns_p99[LIO_OP_KINDS];
+  /**
+   * Highest latency in nanoseconds, by kind.
+   */
+  uint64_t op_latency_ns_max[LIO_OP_KINDS];
+} lio_stats_t;
+
+/**
+ * A buffer of the pool set up by `lio_config_t::buf_count`.
+ */
+typedef struct lio_buf_t {
+  /**
+   * Start of the buffer.
+   */
+  uint8_t *data;
+  /**
+   * Size of the buffer, at least the `len` asked for.
+   */
+  uintptr_t cap;
+  /**
+   * Names the buffer to [`lio_buf_put`], [`lio_read_fixed`] and
+   * [`lio_write_fixed`].
+   */
+  uint32_t index;
+} lio_buf_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
@@ -30,10 +306,22 @@ extern "C" {
  */
 struct lio_handle_t *lio_create(unsigned int capacity);
 
+/**
+ * Create a new lio driver configured by `config`.
+ *
+ * Returns a non-null opaque pointer on success, or null if `config` is null
+ * or the kernel rejects the options.  The caller owns the returned handle and
+ * must pass it to [`lio_destroy`] when done.
+ *
+ * # Safety
+ * `config` must be null or point to a valid `lio_config_t`.
+ */
+struct lio_handle_t *lio_create_ex(const struct lio_config_t *config);
+
 /**
  * Destroy a lio handle created by [`lio_create`].
  *
- * After this call `lio` is invalid.
+ * After this call `lio` is invalid, and so is every buffer of its pool.
  *
  * # Safety
  * `lio` must have been returned by [`lio_create`] and must not be used
@@ -51,6 +339,202 @@ void lio_destroy(struct lio_handle_t *lio);
  */
 int lio_tick(struct lio_handle_t *lio);
 
+/**
+ * Like [`lio_tick`], but blocks until at least one operation completes.
+ *
+ * Returns the number of operations that completed, or -1 on error.
+ *
+ * # Safety
+ * `lio` must be a valid handle.
+ */
+int lio_run(struct lio_handle_t *lio);
+
+/**
+ * Like [`lio_run`], but gives up after `timeout_ns` nanoseconds.
+ *
+ * Returns the number of operations that completed, 0 if the timeout
+ * expired first, or -1 on error.
+ *
+ * # Safety
+ * `lio` must be a valid handle.
+ */
+int lio_run_timeout(struct lio_handle_t *lio, uint64_t timeout_ns);
+
+/**
+ * Block until at least `min` operations completed, or `timeout_ns`
+ * nanoseconds passed, see [`Lio::run_min_complete`].  With io_uring this
+ * is a single `io_uring_submit_and_wait_timeout` until [`lio_remote`] was
+ * called.  From then on it waits for one completion at a time, so remote
+ * jobs get to run in between.
+ *
+ * A `timeout_ns` of 0 doesn't wait: it returns right away with what had
+ * already completed.  There's no way to wait without a timeout.
+ *
+ * Returns the number of operations that completed, fewer than `min` if the
+ * timeout expired, or -1 on error.
+ *
+ * # Safety
+ * `lio` must be a valid handle.
+ */
+int lio_run_min_complete(struct lio_handle_t *lio, unsigned int min, uint64_t timeout_ns);
+
+/**
+ * Create a handle for submitting to `lio` from other threads.
+ *
+ * Returns null if the backend can't set up its waker.  The handle may
+ * outlive `lio`, submitting fails after that.
+ *
+ * # Safety
+ * `lio` must be a valid handle.
+ */
+struct lio_remote_t *lio_remote(struct lio_handle_t *lio);
+
+/**
+ * Run `callback(lio, arg)` on the thread driving the handle, at the start of
+ * its next [`lio_tick`], waking it if it's blocked.
+ *
+ * `callback` may submit operations on `lio`, which complete on that thread
+ * as usual.  `lio` is only valid during the callback.
+ *
+ * Returns 0, or `-EPIPE` if the handle was destroyed.
+ *
+ * # Safety
+ * `remote` must be a valid remote handle, and `arg` safe to use from the
+ * driving thread.
+ */
+int lio_remote_submit(const struct lio_remote_t *remote,
+                      void (*callback)(struct lio_handle_t*, void*),
+                      void *arg);
+
+/**
+ * Destroy a remote handle created by [`lio_remote`].
+ *
+ * # Safety
+ * `remote` must have been returned by [`lio_remote`] and must not be used
+ * after this call.
+ */
+void lio_remote_destroy(struct lio_remote_t *remote);
+
+/**
+ * Cancel operation `id`, whose callback then gets `-ECANCELED`.
+ *
+ * Does nothing for an operation that completed. Ops that are too far
+ * along to stop complete as usual, see [`Lio::cancel`].
+ *
+ * Returns 0, or a negative errno if the backend failed to cancel.
+ *
+ * # Safety
+ * `lio` must be a valid handle.
+ */
+int lio_cancel(struct lio_handle_t *lio, uint64_t id);
+
+/**
+ * Submit the `n` operations in `sqes` in one go.  They complete without
+ * callbacks, collect them with [`lio_reap`].
+ *
+ * Returns how many were submitted, fewer than `n` if one was rejected, or
+ * the negative errno of the first one if none were: `-EINVAL` for an
+ * unknown opcode, `-EBUSY` once `capacity` operations are in flight.
+ *
+ * # Safety
+ * `lio` must be a valid handle and `sqes` point to `n` entries, whose fds
+ * and buffers stay valid until their operation is reaped.
+ */
+int lio_submit_batch(struct lio_handle_t *lio, const struct lio_sqe_t *sqes, unsigned int n);
+
+/**
+ * Move up to `max` completions of operations from [`lio_submit_batch`] to
+ * `out`, oldest first.  Operations complete while [`lio_tick`] or
+ * [`lio_run`] runs.
+ *
+ * Returns how many it moved.
+ *
+ * # Safety
+ * `lio` must be a valid handle and `out` point to room for `max` entries.
+ */
+int lio_reap(struct lio_handle_t *lio, struct lio_cqe_t *out, unsigned int max);
+
+/**
+ * Fill `stats` with the counters of `lio`.
+ *
+ * Returns 0, or `-ENOTSUP` if lio was built without the `metrics` feature.
+ *
+ * # Safety
+ * `lio` must be a valid handle and `stats` point to a writable
+ * `lio_stats_t`.
+ */
+int lio_stats(struct lio_handle_t *lio, struct lio_stats_t *stats);
+
+/**
+ * Name of operation kind `kind`, the index into the per-operation arrays of
+ * `lio_stats_t`, e.g. `"read_at"`.
+ *
+ * Returns a static string, or null if `kind` is out of range or lio was
+ * built without the `metrics` feature.
+ */
+const char *lio_op_name(unsigned int kind);
+
+/**
+ * Borrow a pool buffer of at least `len` bytes into `out`.  It stays the
+ * caller's until given back with [`lio_buf_put`], and can be passed to any
+ * operation, though only the `_fixed` ones use the kernel registration.
+ *
+ * Returns 0, `-ENOBUFS` if every buffer that fits is in use, or `-ENOTSUP`
+ * if `lio` was created without a pool.
+ *
+ * # Safety
+ * `lio` must be a valid handle and `out` point to a writable `lio_buf_t`.
+ */
+int lio_buf_get(struct lio_handle_t *lio, uintptr_t len, struct lio_buf_t *out);
+
+/**
+ * Give pool buffer `index` back.  No operation may be using it.
+ *
+ * Returns 0, or `-EINVAL` if it isn't lent out.
+ *
+ * # Safety
+ * `lio` must be a valid handle.
+ */
+int lio_buf_put(struct lio_handle_t *lio, uint32_t index);
+
+/**
+ * Read from `fd` at `offset` into pool buffer `index`, with io_uring's
+ * `READ_FIXED`.  Pass `offset = -1` for current position.
+ *
+ * The buffer stays lent out to the caller.
+ *
+ * - `callback(result, index)`: bytes read (or negative errno), and the
+ *   buffer.  A buffer that isn't lent out gets `-EINVAL`.
+ *
+ * # Safety
+ * `lio` must be valid.
+ */
+uint64_t lio_read_fixed(struct lio_handle_t *lio,
+                        intptr_t fd,
+                        uint32_t index,
+                        int64_t offset,
+                        void (*callback)(int, uint32_t));
+
+/**
+ * Write the first `len` bytes of pool buffer `index` to `fd` at `offset`,
+ * with io_uring's `WRITE_FIXED`.  Pass `offset = -1` for current position.
+ *
+ * The buffer stays lent out to the caller.
+ *
+ * - `callback(result, index)`: bytes written (or negative errno), and the
+ *   buffer.  A buffer that isn't lent out or shorter than `len` gets
+ *   `-EINVAL`.
+ *
+ * # Safety
+ * `lio` must be valid.
+ */
+uint64_t lio_write_fixed(struct lio_handle_t *lio,
+                         intptr_t fd,
+                         uint32_t index,
+                         uintptr_t len,
+                         int64_t offset,
+                         void (*callback)(int, uint32_t));
+
 /**
  * Shut down part of a full-duplex connection.
  *
@@ -61,7 +545,7 @@ int lio_tick(struct lio_handle_t *lio);
  * # Safety
  * `lio` must be a valid handle and `fd` a valid socket.
  */
-void lio_shutdown(struct lio_handle_t *lio, intptr_t fd, int how, void (*callback)(int));
+uint64_t lio_shutdown(struct lio_handle_t *lio, intptr_t fd, int how, void (*callback)(int));
 
 /**
  * Synchronize a file's in-core state with the storage device.
@@ -71,7 +555,7 @@ void lio_shutdown(struct lio_handle_t *lio, intptr_t fd, int how, void (*callbac
  * # Safety
  * `lio` must be a valid handle and `fd` a valid file descriptor.
  */
-void lio_fsync(struct lio_handle_t *lio, intptr_t fd, void (*callback)(int));
+uint64_t lio_fsync(struct lio_handle_t *lio, intptr_t fd, void (*callback)(int));
 
 /**
  * Truncate a file to `len` bytes.
@@ -81,7 +565,7 @@ void lio_fsync(struct lio_handle_t *lio, intptr_t fd, void (*callback)(int));
  * # Safety
  * `lio` must be a valid handle and `fd` a valid file descriptor.
  */
-void lio_truncate(struct lio_handle_t *lio, intptr_t fd, uint64_t len, void (*callback)(int));
+uint64_t lio_truncate(struct lio_handle_t *lio, intptr_t fd, uint64_t len, void (*callback)(int));
 
 /**
  * Write data to `fd` at `offset`.  Pass `offset = -1` for current position.
@@ -96,12 +580,32 @@ void lio_truncate(struct lio_handle_t *lio, intptr_t fd, uint64_t len, void (*ca
  * `lio` must be valid; `buf` must point to at least `buf_len` bytes allocated
  * with `malloc`.
  */
-void lio_write_at(struct lio_handle_t *lio,
-                  intptr_t fd,
-                  uint8_t *buf,
-                  uintptr_t buf_len,
-                  int64_t offset,
-                  void (*callback)(int, uint8_t*, uintptr_t));
+uint64_t lio_write_at(struct lio_handle_t *lio,
+                      intptr_t fd,
+                      uint8_t *buf,
+                      uintptr_t buf_len,
+                      int64_t offset,
+                      void (*callback)(int, uint8_t*, uintptr_t));
+
+/**
+ * Like [`lio_write_at`], but `buf` stays owned by the caller, who keeps it
+ * valid and leaves it alone until the callback.  It can come from any
+ * allocator, such as a [`lio_buf_get`] pool.
+ *
+ * - `callback(result, buf, len)`: bytes written (or negative errno), buffer
+ *
+ * A null `buf` with a nonzero `buf_len` gets `-EINVAL`.
+ *
+ * # Safety
+ * `lio` must be valid; `buf` must point to at least `buf_len` bytes that
+ * stay valid until the callback.
+ */
+uint64_t lio_write_at_borrowed(struct lio_handle_t *lio,
+                               intptr_t fd,
+                               uint8_t *buf,
+                               uintptr_t buf_len,
+                               int64_t offset,
+                               void (*callback)(int, uint8_t*, uintptr_t));
 
 /**
  * Read from `fd` at `offset` into `buf`.  Pass `offset = -1` for current
@@ -114,12 +618,32 @@ void lio_write_at(struct lio_handle_t *lio,
  * # Safety
  * Same requirements as [`lio_write_at`].
  */
-void lio_read_at(struct lio_handle_t *lio,
-                 intptr_t fd,
-                 uint8_t *buf,
-                 uintptr_t buf_len,
-                 int64_t offset,
-                 void (*callback)(int, uint8_t*, uintptr_t));
+uint64_t lio_read_at(struct lio_handle_t *lio,
+                     intptr_t fd,
+                     uint8_t *buf,
+                     uintptr_t buf_len,
+                     int64_t offset,
+                     void (*callback)(int, uint8_t*, uintptr_t));
+
+/**
+ * Like [`lio_read_at`], but `buf` stays owned by the caller, who keeps it
+ * valid and leaves it alone until the callback.  It can come from any
+ * allocator, such as a [`lio_buf_get`] pool.
+ *
+ * - `callback(result, buf, len)`: bytes read (or negative errno), buffer
+ *
+ * A null `buf` with a nonzero `buf_len` gets `-EINVAL`.
+ *
+ * # Safety
+ * `lio` must be valid; `buf` must point to at least `buf_len` bytes that
+ * stay valid until the callback.
+ */
+uint64_t lio_read_at_borrowed(struct lio_handle_t *lio,
+                              intptr_t fd,
+                              uint8_t *buf,
+                              uintptr_t buf_len,
+                              int64_t offset,
+                              void (*callback)(int, uint8_t*, uintptr_t));
 
 /**
  * Create a socket.
@@ -130,11 +654,11 @@ void lio_read_at(struct lio_handle_t *lio,
  * # Safety
  * `lio` must be a valid handle.
  */
-void lio_socket(struct lio_handle_t *lio,
-                int domain,
-                int ty,
-                int proto,
-                void (*callback)(intptr_t));
+uint64_t lio_socket(struct lio_handle_t *lio,
+                    int domain,
+                    int ty,
+                    int proto,
+                    void (*callback)(intptr_t));
 
 /**
  * Bind a socket to an address.
@@ -145,11 +669,11 @@ void lio_socket(struct lio_handle_t *lio,
  * `lio` must be valid; `sock` must point to `sock_len` bytes of a valid
  * `sockaddr`.
  */
-void lio_bind(struct lio_handle_t *lio,
-              intptr_t fd,
-              const sockaddr *sock,
-              socklen_t sock_len,
-              void (*callback)(int));
+uint64_t lio_bind(struct lio_handle_t *lio,
+                  intptr_t fd,
+                  const sockaddr *sock,
+                  socklen_t sock_len,
+                  void (*callback)(int));
 
 /**
  * Accept a connection.
@@ -158,11 +682,38 @@ void lio_bind(struct lio_handle_t *lio,
  *   error); `addr` is heap-allocated `sockaddr_storage` — **caller must free
  *   it** — or null on error.
  *
+ * [`lio_accept_addr`] and [`lio_accept_fd`] skip that allocation.
+ *
  * # Safety
  * `lio` must be valid; `fd` must be a listening socket.
  */
-void lio_accept(struct lio_handle_t *lio, intptr_t fd, void (*callback)(intptr_t,
-                                                                        const sockaddr_storage*));
+uint64_t lio_accept(struct lio_handle_t *lio, intptr_t fd, void (*callback)(intptr_t,
+                                                                            const sockaddr_storage*));
+
+/**
+ * Like [`lio_accept`], but the `addr` given to the callback is only valid
+ * during the callback, so there's nothing to free.
+ *
+ * - `callback(result, addr)`: new socket fd on success (negative errno on
+ *   error); the peer address, or null on error.
+ *
+ * # Safety
+ * `lio` must be valid; `fd` must be a listening socket.
+ */
+uint64_t lio_accept_addr(struct lio_handle_t *lio,
+                         intptr_t fd,
+                         void (*callback)(intptr_t, const sockaddr_storage*));
+
+/**
+ * Accept a connection without asking for the peer address, the cheapest
+ * accept.  Also works on Unix domain sockets.
+ *
+ * - `callback(result)`: new socket fd on success, negative errno on error
+ *
+ * # Safety
+ * `lio` must be valid; `fd` must be a listening socket.
+ */
+uint64_t lio_accept_fd(struct lio_handle_t *lio, intptr_t fd, void (*callback)(intptr_t));
 
 /**
  * Listen for connections on a socket.
@@ -172,7 +723,7 @@ void lio_accept(struct lio_handle_t *lio, intptr_t fd, void (*callback)(intptr_t
  * # Safety
  * `lio` and `fd` must be valid.
  */
-void lio_listen(struct lio_handle_t *lio, intptr_t fd, int backlog, void (*callback)(int));
+uint64_t lio_listen(struct lio_handle_t *lio, intptr_t fd, int backlog, void (*callback)(int));
 
 /**
  * Send data on a connected socket.
@@ -185,12 +736,75 @@ void lio_listen(struct lio_handle_t *lio, intptr_t fd, int backlog, void (*callb
  * `lio` must be valid; `buf` must be at least `buf_len` bytes allocated with
  * `malloc`.
  */
-void lio_send(struct lio_handle_t *lio,
-              intptr_t fd,
-              uint8_t *buf,
-              uintptr_t buf_len,
-              int flags,
-              void (*callback)(int, uint8_t*, uintptr_t));
+uint64_t lio_send(struct lio_handle_t *lio,
+                  intptr_t fd,
+                  uint8_t *buf,
+                  uintptr_t buf_len,
+                  int flags,
+                  void (*callback)(int, uint8_t*, uintptr_t));
+
+/**
+ * Like [`lio_send`], but `buf` stays owned by the caller, who keeps it
+ * valid and leaves it alone until the callback.  It can come from any
+ * allocator, such as a [`lio_buf_get`] pool.
+ *
+ * - `callback(result, buf, len)`: bytes sent (or negative errno), buffer
+ *
+ * A null `buf` with a nonzero `buf_len` gets `-EINVAL`.
+ *
+ * # Safety
+ * `lio` must be valid; `buf` must point to at least `buf_len` bytes that
+ * stay valid until the callback.
+ */
+uint64_t lio_send_borrowed(struct lio_handle_t *lio,
+                           intptr_t fd,
+                           uint8_t *buf,
+                           uintptr_t buf_len,
+                           int flags,
+                           void (*callback)(int, uint8_t*, uintptr_t));
+
+/**
+ * Write several buffers to `fd` at the current position.
+ *
+ * Ownership of every `iov_base` (each `malloc`'d with at least `iov_len`
+ * bytes) transfers to lio, as with [`lio_write_at`].  The `iov` array itself
+ * is only read during this call.
+ *
+ * - `callback(result, iov, iovcnt)`: bytes written (or negative errno), and
+ *   the buffers in their original order.  `iov` is only valid during the
+ *   callback; each `iov_len` is the bytes written from that buffer.  An
+ *   invalid list gets `-EINVAL` with a null `iov`, and nothing is transferred.
+ *
+ * # Safety
+ * `lio` must be valid; `iov` must point to `iovcnt` iovecs with non-null
+ * bases allocated with `malloc`.
+ */
+uint64_t lio_writev(struct lio_handle_t *lio,
+                    intptr_t fd,
+                    const iovec *iov,
+                    int iovcnt,
+                    void (*callback)(int, const iovec*, int));
+
+/**
+ * Send several buffers on a socket as one message.
+ *
+ * Buffer ownership works as in [`lio_writev`].  `addr` addresses the message
+ * on unconnected sockets and must be null on connected ones.
+ *
+ * - `callback(result, iov, iovcnt)`: bytes sent (or negative errno), buffers
+ *
+ * # Safety
+ * `lio` must be valid; `iov` as in [`lio_writev`]; `addr` must be null or
+ * point to `addr_len` bytes of a valid `sockaddr`.
+ */
+uint64_t lio_sendmsg(struct lio_handle_t *lio,
+                     intptr_t fd,
+                     const iovec *iov,
+                     int iovcnt,
+                     const sockaddr *addr,
+                     socklen_t addr_len,
+                     int flags,
+                     void (*callback)(int, const iovec*, int));
 
 /**
  * Receive data from a socket.
@@ -203,12 +817,32 @@ void lio_send(struct lio_handle_t *lio,
  * `lio` must be valid; `buf` must be at least `buf_len` bytes allocated with
  * `malloc`.
  */
-void lio_recv(struct lio_handle_t *lio,
-              intptr_t fd,
-              uint8_t *buf,
-              uintptr_t buf_len,
-              int flags,
-              void (*callback)(int, uint8_t*, uintptr_t));
+uint64_t lio_recv(struct lio_handle_t *lio,
+                  intptr_t fd,
+                  uint8_t *buf,
+                  uintptr_t buf_len,
+                  int flags,
+                  void (*callback)(int, uint8_t*, uintptr_t));
+
+/**
+ * Like [`lio_recv`], but `buf` stays owned by the caller, who keeps it
+ * valid and leaves it alone until the callback.  It can come from any
+ * allocator, such as a [`lio_buf_get`] pool.
+ *
+ * - `callback(result, buf, len)`: bytes received (or negative errno), buffer
+ *
+ * A null `buf` with a nonzero `buf_len` gets `-EINVAL`.
+ *
+ * # Safety
+ * `lio` must be valid; `buf` must point to at least `buf_len` bytes that
+ * stay valid until the callback.
+ */
+uint64_t lio_recv_borrowed(struct lio_handle_t *lio,
+                           intptr_t fd,
+                           uint8_t *buf,
+                           uintptr_t buf_len,
+                           int flags,
+                           void (*callback)(int, uint8_t*, uintptr_t));
 
 /**
  * Close a file descriptor.
@@ -220,7 +854,7 @@ void lio_recv(struct lio_handle_t *lio,
  * # Safety
  * `lio` must be valid; `fd` must be a valid open file descriptor.
  */
-void lio_close(struct lio_handle_t *lio, intptr_t fd, void (*callback)(int));
+uint64_t lio_close(struct lio_handle_t *lio, intptr_t fd, void (*callback)(int));
 
 /**
  * Wait for `millis` milliseconds.
@@ -230,7 +864,7 @@ void lio_close(struct lio_handle_t *lio, intptr_t fd, void (*callback)(int));
  * # Safety
  * `lio` must be a valid handle.
  */
-void lio_timeout(struct lio_handle_t *lio, unsigned int millis, void (*callback)(int));
+uint64_t lio_timeout(struct lio_handle_t *lio, unsigned int millis, void (*callback)(int));
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -23,7 +23,11 @@
 //!   ├─> wait()        (blocking)
 //!   ├─> when_done(F)  (callback)
 //!   ├─> send()    ──> Receiver<T>        (channel-based blocking)
-//!   └─> send_with(Sender<T>)             (custom channel)
+//!   ├─> send_with(Sender<T>)             (custom channel)
+//!   └─> link(Io<U>) / link_timeout(d) ──> Io<Chain<_>>  (one submission)
+//!
+//! Io<T: MultishotOp>
+//!   └─> stream()  ──> IoStream<T>        (one item per completion)
 //! ```
 //!
 //! # Usage Patterns
@@ -54,13 +58,24 @@
 //! threads than where operations were initiated. This is particularly useful for
 //! delegating I/O completion handling to dedicated threads.
 
-use crate::{lio, lio::Lio, registration::Registration, typed_op::TypedOp};
+use crate::{
+  lio,
+  lio::{Lio, OpId},
+  registration::{Registration, StreamSink},
+  typed_op::{MultishotOp, TypedOp},
+};
+
+mod chain;
+pub use chain::{Chain, ChainFuture, ChainPart, Link, Timed};
 
 use std::{
+  cell::{Cell, RefCell},
+  collections::VecDeque,
   future::Future,
   pin::Pin,
+  rc::Rc,
   sync::mpsc as std_mpsc,
-  task::{Context, Poll},
+  task::{Context, Poll, Waker},
   time::Duration,
 };
 
@@ -123,6 +138,7 @@ where
   /// Returns a [`Receiver`] which receives the operation result when complete.
   /// Useful for integrating with channel-based async code or when you need to wait
   /// for the result in a different context than where the operation was started.
+  /// Its [`id`](Receiver::id) cancels the operation, see [`Lio::cancel`].
   ///
   /// # Example
   /// ```no_run
@@ -141,13 +157,15 @@ where
   {
     let (sender, receiver) = std_mpsc::channel();
 
-    self.send_with(sender);
+    let id = self.send_with(sender);
 
-    Receiver { recv: Some(receiver) }
+    Receiver { recv: Some(receiver), id }
   }
 
   /// Sends the operation result through a provided channel sender when complete.
   ///
+  /// Returns the id to [`cancel`](Lio::cancel) it with.
+  ///
   /// # Examples
   ///
   /// ```rust,no_run
@@ -172,16 +190,19 @@ where
   /// }
   /// ```
   #[inline]
-  pub fn send_with(self, sender: std_mpsc::Sender<T::Result>)
+  pub fn send_with(self, sender: std_mpsc::Sender<T::Result>) -> OpId
   where
     T::Result: Send,
   {
     self.when_done(move |res| {
       let _ = sender.send(res);
-    });
+    })
   }
   /// Registers a callback to be invoked when the operation completes.
   ///
+  /// Returns the id to [`cancel`](Lio::cancel) it with, after which the
+  /// callback gets `ECANCELED`.
+  ///
   /// # Example
   ///
   /// ```rust,no_run
@@ -213,7 +234,7 @@ where
   ///     Ok(())
   /// }
   /// ```
-  pub fn when_done<F>(self, f: F)
+  pub fn when_done<F>(self, f: F) -> OpId
   where
     F: FnOnce(T::Result) + Send + 'static,
   {
@@ -225,9 +246,10 @@ where
     // then typed_op was moved to the heap, leaving dangling pointers in the Op.
     let mut boxed = Box::new(typed_op);
     let op = boxed.into_op();
-    lio
+    let id = lio
       .schedule(op, Registration::new_callback_boxed::<T, F>(f, boxed))
       .expect("lio error: lio should handle this");
+    OpId(id)
   }
 }
 
@@ -246,9 +268,15 @@ enum LioHandle {
 /// via a channel.
 pub struct Receiver<T> {
   recv: Option<std_mpsc::Receiver<T>>,
+  id: OpId,
 }
 
 impl<T> Receiver<T> {
+  /// The operation's id, to [`cancel`](Lio::cancel) it with.
+  pub fn id(&self) -> OpId {
+    self.id
+  }
+
   /// Blocks the current thread until the operation completes and returns the result.
   ///
   /// This method will block indefinitely until the I/O operation finishes
@@ -435,6 +463,7 @@ where
 /// - On first poll, submits operation to driver with waker
 /// - On subsequent polls, checks for completion and updates waker
 /// - Returns `Poll::Ready(result)` when the I/O operation finishes
+/// - Cancels the operation if dropped before it finished, see [`Lio::cancel`]
 ///
 /// # Usage
 ///
@@ -451,7 +480,10 @@ where
 ///     //                                             IntoFuture creates IoFuture
 /// }
 /// ```
-pub struct IoFuture<T> {
+pub struct IoFuture<T>
+where
+  T: TypedOp,
+{
   state: IoFutureState<T>,
   lio: Lio,
 }
@@ -513,6 +545,228 @@ where
   }
 }
 
+impl<T> Drop for IoFuture<T>
+where
+  T: TypedOp,
+{
+  fn drop(&mut self) {
+    // The backend may still write into the op's buffers, so the op lives
+    // on in the registration until it let go of them.
+    if let IoFutureState::Inflight { id, op } =
+      std::mem::replace(&mut self.state, IoFutureState::Done)
+    {
+      self.lio.abandon(id, op);
+    }
+  }
+}
+
+impl<T> Io<T>
+where
+  T: MultishotOp,
+{
+  /// Turns a multishot operation into a stream of its completions.
+  ///
+  /// Nothing is submitted until the stream is first polled.
+  ///
+  /// # Example
+  ///
+  /// ```no_run
+  /// use lio::{Lio, net::TcpSocket};
+  ///
+  /// async fn example(lio: &Lio, socket: &TcpSocket) -> std::io::Result<()> {
+  ///     let ring = lio.register_buf_ring(64, 4096)?;
+  ///     let mut chunks = socket.recv_multi(&ring).with_lio(lio).stream();
+  ///     while let Some(chunk) = chunks.next().await {
+  ///         println!("received {} bytes", chunk?.len());
+  ///     }
+  ///     Ok(())
+  /// }
+  /// ```
+  pub fn stream(self) -> IoStream<T> {
+    let (lio, op) = self.into_lio();
+    IoStream {
+      lio,
+      shared: Rc::new(StreamShared {
+        state: RefCell::new(StreamState {
+          op: Box::new(op),
+          items: VecDeque::new(),
+          waker: None,
+          phase: StreamPhase::Idle,
+        }),
+        detached: Cell::new(false),
+      }),
+      id: None,
+    }
+  }
+}
+
+/// Items of an in-progress multishot operation.
+///
+/// Created by [`Io::stream`]. The operation is submitted on the first poll
+/// and stays in flight across items; each completion is queued until taken
+/// with [`next`](Self::next), [`poll_next`](Self::poll_next) or
+/// [`try_next`](Self::try_next).
+///
+/// When the backend ends the operation early (see
+/// [`MultishotOp::resumable`]), the next poll re-submits it.
+pub struct IoStream<T>
+where
+  T: MultishotOp,
+{
+  lio: Lio,
+  shared: Rc<StreamShared<T>>,
+  /// Id of the last submission, cancelled on drop if still in flight.
+  id: Option<u64>,
+}
+
+struct StreamShared<T>
+where
+  T: MultishotOp,
+{
+  state: RefCell<StreamState<T>>,
+  /// The IoStream was dropped, items are discarded as they arrive.
+  detached: Cell<bool>,
+}
+
+struct StreamState<T>
+where
+  T: MultishotOp,
+{
+  /// Boxed so pointers handed out by `into_op` stay valid.
+  op: Box<T>,
+  items: VecDeque<T::Item>,
+  waker: Option<Waker>,
+  phase: StreamPhase,
+}
+
+#[derive(Clone, Copy, PartialEq, Eq)]
+enum StreamPhase {
+  /// Not submitted yet, or stopped early and waiting to be re-submitted.
+  Idle,
+  Inflight,
+  Finished,
+}
+
+impl<T> StreamSink for StreamShared<T>
+where
+  T: MultishotOp,
+{
+  fn push(&self, res: isize, buf_id: Option<u16>, more: bool) {
+    let mut state = self.state.borrow_mut();
+    let item = state.op.extract_item(res, buf_id);
+    if !more {
+      state.phase = if state.op.resumable(res) {
+        StreamPhase::Idle
+      } else {
+        StreamPhase::Finished
+      };
+    }
+    if self.detached.get() {
+      return;
+    }
+    if let Some(item) = item {
+      state.items.push_back(item);
+    }
+    if let Some(waker) = state.waker.take() {
+      waker.wake();
+    }
+  }
+}
+
+impl<T> IoStream<T>
+where
+  T: MultishotOp,
+{
+  /// Waits for the next item, `None` once the operation has finished.
+  #[allow(clippy::should_implement_trait)]
+  pub fn next(&mut self) -> Next<'_, T> {
+    Next { stream: self }
+  }
+
+  /// Polls for the next item, `Ready(None)` once the operation has finished.
+  pub fn poll_next(&mut self, cx: &mut Context<'_>) -> Poll<Option<T::Item>> {
+    if let Some(item) = self.try_next() {
+      return Poll::Ready(Some(item));
+    }
+    let mut state = self.shared.state.borrow_mut();
+    if state.phase == StreamPhase::Finished {
+      return Poll::Ready(None);
+    }
+    state.waker = Some(cx.waker().clone());
+    Poll::Pending
+  }
+
+  /// Takes a queued item without waiting, submitting the operation first if
+  /// it isn't in flight.
+  ///
+  /// Returns `None` both while waiting for data and once finished, see
+  /// [`is_finished`](Self::is_finished).
+  pub fn try_next(&mut self) -> Option<T::Item> {
+    let mut state = self.shared.state.borrow_mut();
+    if let Some(item) = state.items.pop_front() {
+      return Some(item);
+    }
+    if state.phase == StreamPhase::Idle {
+      let op = state.op.into_op();
+      state.phase = StreamPhase::Inflight;
+      drop(state);
+      let id = self
+        .lio
+        .schedule(op, Registration::new_stream(self.shared.clone()))
+        .expect("lio error: failed to schedule operation");
+      self.id = Some(id);
+    }
+    None
+  }
+
+  /// Returns true once the operation has ended and every item was taken.
+  pub fn is_finished(&self) -> bool {
+    let state = self.shared.state.borrow();
+    state.phase == StreamPhase::Finished && state.items.is_empty()
+  }
+}
+
+impl<T> Drop for IoStream<T>
+where
+  T: MultishotOp,
+{
+  fn drop(&mut self) {
+    // The registration keeps `shared` (and the op) alive until the final
+    // completion; drop queued items now so their buffers are released.
+    self.shared.detached.set(true);
+    let mut state = self.shared.state.borrow_mut();
+    state.items.clear();
+    let inflight = state.phase == StreamPhase::Inflight;
+    drop(state);
+    // Nobody takes its items anymore, so stop it instead of running forever.
+    if inflight && let Some(id) = self.id {
+      self.lio.try_cancel(id);
+    }
+  }
+}
+
+/// Future returned by [`IoStream::next`].
+pub struct Next<'a, T>
+where
+  T: MultishotOp,
+{
+  stream: &'a mut IoStream<T>,
+}
+
+impl<T> Future for Next<'_, T>
+where
+  T: MultishotOp,
+{
+  type Output = Option<T::Item>;
+
+  fn poll(
+    mut self: Pin<&mut Self>,
+    cx: &mut Context<'_>,
+  ) -> Poll<Self::Output> {
+    self.stream.poll_next(cx)
+  }
+}
+
 #[cfg(test)]
 mod tests {
   use super::*;
@@ -0,0 +1,367 @@
+//! Ops submitted together as one chain, see [`Io::link`].
+//!
+//! A chain is built out of [`ChainPart`]s: every [`TypedOp`], a [`Link`] of
+//! two parts, and a part with a [`Timed`] last op. [`Chain`] wraps the whole
+//! thing, and `Io<Chain<_>>` is consumed like any other [`Io`].
+
+use std::{
+  future::Future,
+  pin::Pin,
+  sync::{Arc, Mutex, mpsc as std_mpsc},
+  task::{Context, Poll, Waker},
+  time::Duration,
+};
+
+use super::{Io, Receiver};
+use crate::{
+  api::ops,
+  lio::{Lio, OpId},
+  op::Op,
+  registration::Registration,
+  typed_op::TypedOp,
+};
+
+/// One or more ops of a chain, see [`Io::link`].
+///
+/// Implemented for every [`TypedOp`] and the links built out of them.
+pub trait ChainPart: Send + 'static {
+  /// Results of the ops, in the order they are linked.
+  type Result: Send + 'static;
+
+  /// Appends the ops to `ops`, `done` getting their results once every one
+  /// of them completed.
+  #[doc(hidden)]
+  fn push_ops<F>(self, ops: &mut Vec<(Op, Registration)>, done: F)
+  where
+    F: FnOnce(Self::Result) + Send + 'static;
+}
+
+impl<T> ChainPart for T
+where
+  T: TypedOp,
+  T::Result: 'static,
+{
+  type Result = T::Result;
+
+  fn push_ops<F>(self, ops: &mut Vec<(Op, Registration)>, done: F)
+  where
+    F: FnOnce(Self::Result) + Send + 'static,
+  {
+    // Boxed before into_op, the Op points into it.
+    let mut boxed = Box::new(self);
+    let op = boxed.into_op();
+    ops.push((op, Registration::new_callback_boxed::<T, F>(done, boxed)));
+  }
+}
+
+/// `first`, then `second` once it succeeded, see [`Io::link`].
+pub struct Link<A, B> {
+  first: A,
+  second: B,
+}
+
+impl<A, B> ChainPart for Link<A, B>
+where
+  A: ChainPart,
+  B: ChainPart,
+{
+  type Result = (A::Result, B::Result);
+
+  fn push_ops<F>(self, ops: &mut Vec<(Op, Registration)>, done: F)
+  where
+    F: FnOnce(Self::Result) + Send + 'static,
+  {
+    let joined = Arc::new(Mutex::new(Joined {
+      first: None,
+      second: None,
+      done: Some(done),
+    }));
+    let other = joined.clone();
+    self.first.push_ops(ops, move |res| {
+      Joined::finish(&other, |joined| joined.first = Some(res))
+    });
+    self.second.push_ops(ops, move |res| {
+      Joined::finish(&joined, |joined| joined.second = Some(res))
+    });
+  }
+}
+
+/// Results of the halves of a [`Link`], which complete separately.
+struct Joined<A, B, F> {
+  first: Option<A>,
+  second: Option<B>,
+  done: Option<F>,
+}
+
+impl<A, B, F> Joined<A, B, F>
+where
+  F: FnOnce((A, B)),
+{
+  /// Records a result with `set`, calling `done` once both are in.
+  fn finish(this: &Mutex<Self>, set: impl FnOnce(&mut Self)) {
+    let ready = {
+      let mut joined = this.lock().unwrap();
+      set(&mut joined);
+      match (joined.first.is_some(), joined.second.is_some()) {
+        (true, true) => Some((
+          joined.done.take().expect("link completed twice"),
+          joined.first.take().unwrap(),
+          joined.second.take().unwrap(),
+        )),
+        _ => None,
+      }
+    };
+    if let Some((done, first, second)) = ready {
+      done((first, second));
+    }
+  }
+}
+
+/// `part`, with its last op cancelled if it runs for longer than `timeout`,
+/// see [`Io::link_timeout`].
+pub struct Timed<P> {
+  part: P,
+  timeout: Duration,
+}
+
+impl<P> ChainPart for Timed<P>
+where
+  P: ChainPart,
+{
+  type Result = P::Result;
+
+  fn push_ops<F>(self, ops: &mut Vec<(Op, Registration)>, done: F)
+  where
+    F: FnOnce(Self::Result) + Send + 'static,
+  {
+    self.part.push_ops(ops, done);
+    ops::LinkTimeout::new(self.timeout).push_ops(ops, |_| {});
+  }
+}
+
+/// Ops submitted as one chain, made with [`Io::link`] or
+/// [`Io::link_timeout`].
+pub struct Chain<P>(P);
+
+impl<T> Io<T>
+where
+  T: TypedOp + ChainPart,
+{
+  /// Links `next` after this op, submitting both at once.
+  ///
+  /// `next` starts only once this op succeeded. If it fails, `next`
+  /// completes with `ECANCELED` instead of running. On io_uring the kernel
+  /// runs the chain (`IOSQE_IO_LINK`) without a trip back to the event loop
+  /// in between, where a short read or write also counts as failing. Other
+  /// backends submit `next` when this op completes.
+  ///
+  /// The chain runs on the Lio this op is bound to, and completes with the
+  /// results of both. Link more ops onto it the same way.
+  ///
+  /// # Example
+  ///
+  /// ```no_run
+  /// use lio::{Lio, api};
+  ///
+  /// let lio = Lio::new(64).unwrap();
+  /// let wal = api::resource::Resource::stdout();
+  /// let receiver = api::write_at(&wal, b"record".to_vec(), 0)
+  ///   .with_lio(&lio)
+  ///   .link(api::fsync(&wal))
+  ///   .send();
+  /// lio.run().unwrap();
+  /// let ((written, _buf), synced) = receiver.recv();
+  /// ```
+  pub fn link<U>(self, next: Io<U>) -> Io<Chain<Link<T, U>>>
+  where
+    U: TypedOp + ChainPart,
+  {
+    let Io { op, handle } = self;
+    Io { op: Chain(Link { first: op, second: next.op }), handle }
+  }
+
+  /// Cancels the op if it's still running after `timeout`, which makes it
+  /// complete with `ECANCELED`.
+  ///
+  /// io_uring arms the timeout (`IORING_OP_LINK_TIMEOUT`) once the op
+  /// starts. Other backends cancel it off a timer, as far as they can:
+  /// ops that already started on a blocking pool run to completion.
+  ///
+  /// # Example
+  ///
+  /// ```no_run
+  /// use std::time::Duration;
+  /// use lio::{Lio, api};
+  ///
+  /// let lio = Lio::new(64).unwrap();
+  /// let sock = api::resource::Resource::stdin();
+  /// let receiver = api::recv(&sock, vec![0; 1024], None)
+  ///   .with_lio(&lio)
+  ///   .link_timeout(Duration::from_secs(5))
+  ///   .send();
+  /// lio.run().unwrap();
+  /// let (received, buf) = receiver.recv();
+  /// ```
+  pub fn link_timeout(self, timeout: Duration) -> Io<Chain<Timed<T>>> {
+    let Io { op, handle } = self;
+    Io { op: Chain(Timed { part: op, timeout }), handle }
+  }
+}
+
+impl<P> Io<Chain<P>>
+where
+  P: ChainPart,
+{
+  /// Links `next` after the last op of the chain, see [`Io::link`].
+  pub fn link<U>(self, next: Io<U>) -> Io<Chain<Link<P, U>>>
+  where
+    U: TypedOp + ChainPart,
+  {
+    let Io { op: Chain(part), handle } = self;
+    Io { op: Chain(Link { first: part, second: next.op }), handle }
+  }
+
+  /// Cancels the last op of the chain if it's still running after
+  /// `timeout`, see [`Io::link_timeout`].
+  pub fn link_timeout(self, timeout: Duration) -> Io<Chain<Timed<P>>> {
+    let Io { op: Chain(part), handle } = self;
+    Io { op: Chain(Timed { part, timeout }), handle }
+  }
+
+  /// Delivers the results of the chain to a channel receiver, see
+  /// [`Io::send`].
+  #[inline]
+  pub fn send(self) -> Receiver<P::Result> {
+    let (sender, receiver) = std_mpsc::channel();
+
+    let id = self.send_with(sender);
+
+    Receiver { recv: Some(receiver), id }
+  }
+
+  /// Sends the results of the chain through `sender`, see [`Io::send_with`].
+  #[inline]
+  pub fn send_with(self, sender: std_mpsc::Sender<P::Result>) -> OpId {
+    self.when_done(move |res| {
+      let _ = sender.send(res);
+    })
+  }
+
+  /// Calls `f` with the results once every op of the chain completed, see
+  /// [`Io::when_done`].
+  ///
+  /// Returns the id of the first op, cancelling which cancels the chain.
+  pub fn when_done<F>(self, f: F) -> OpId
+  where
+    F: FnOnce(P::Result) + Send + 'static,
+  {
+    let (lio, Chain(part)) = self.into_lio();
+    let mut ops = Vec::new();
+    part.push_ops(&mut ops, f);
+    let id =
+      lio.schedule_chain(ops).expect("lio error: lio should handle this");
+    OpId(id)
+  }
+}
+
+impl<P> IntoFuture for Io<Chain<P>>
+where
+  P: ChainPart + Unpin,
+{
+  type Output = P::Result;
+  type IntoFuture = ChainFuture<P>;
+
+  fn into_future(self) -> Self::IntoFuture {
+    let (lio, Chain(part)) = self.into_lio();
+    ChainFuture {
+      lio,
+      part: Some(part),
+      shared: Arc::new(Mutex::new(ChainShared { result: None, waker: None })),
+      id: None,
+      done: false,
+    }
+  }
+}
+
+/// A future for the results of a chain, the [`IoFuture`](super::IoFuture) of
+/// `Io<Chain<_>>`.
+///
+/// Submits the chain on the first poll, and cancels it if dropped before it
+/// finished.
+pub struct ChainFuture<P>
+where
+  P: ChainPart,
+{
+  lio: Lio,
+  /// The chain until it's submitted.
+  part: Option<P>,
+  shared: Arc<Mutex<ChainShared<P::Result>>>,
+  /// Id of the first op once submitted.
+  id: Option<u64>,
+  done: bool,
+}
+
+struct ChainShared<R> {
+  result: Option<R>,
+  waker: Option<Waker>,
+}
+
+impl<P> Future for ChainFuture<P>
+where
+  P: ChainPart + Unpin,
+{
+  type Output = P::Result;
+
+  fn poll(
+    mut self: Pin<&mut Self>,
+    cx: &mut Context<'_>,
+  ) -> Poll<Self::Output> {
+    let this = &mut *self;
+    if this.done {
+      panic!("ChainFuture polled after completion");
+    }
+    let mut shared = this.shared.lock().unwrap();
+    if let Some(result) = shared.result.take() {
+      this.done = true;
+      return Poll::Ready(result);
+    }
+    shared.waker = Some(cx.waker().clone());
+    drop(shared);
+
+    if let Some(part) = this.part.take() {
+      let shared = this.shared.clone();
+      let mut ops = Vec::new();
+      part.push_ops(&mut ops, move |res| {
+        let waker = {
+          let mut shared = shared.lock().unwrap();
+          shared.result = Some(res);
+          shared.waker.take()
+        };
+        if let Some(waker) = waker {
+          waker.wake();
+        }
+      });
+      let id = this
+        .lio
+        .schedule_chain(ops)
+        .expect("lio error: failed to schedule operation");
+      this.id = Some(id);
+    }
+    Poll::Pending
+  }
+}
+
+impl<P> Drop for ChainFuture<P>
+where
+  P: ChainPart,
+{
+  fn drop(&mut self) {
+    // The ops own their buffers through their registrations, only the
+    // result goes unclaimed.
+    if !self.done
+      && let Some(id) = self.id
+    {
+      self.lio.try_cancel(id);
+    }
+  }
+}
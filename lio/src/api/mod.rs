@@ -74,7 +74,10 @@
 pub mod io;
 pub mod ops;
 pub mod resource;
-use crate::{api::resource::AsResource, buf::BufLike};
+use crate::{
+  api::resource::AsResource,
+  buf::{BufLike, BufRing, LentBuf},
+};
 use io::Io;
 use std::{ffi::CString, net::SocketAddr, time::Duration};
 
@@ -272,6 +275,126 @@ doc_op! {
   }
 }
 
+doc_op! {
+    short: "Reads resource into several buffers at once, filling them in order.",
+    syscall: "readv(2)",
+    doc_link: "https://man7.org/linux/man-pages/man2/readv.2.html",
+
+    ///
+    /// Each buffer is returned holding its share of the bytes read.
+    ///
+    /// # Examples
+    ///
+    /// ```rust,no_run
+    /// async fn readv_example() -> std::io::Result<()> {
+    ///     # use lio::api::resource::Resource;
+    ///     # let fd = Resource::stdin();
+    ///     let (result, bufs) = lio::api::readv(&fd, vec![vec![0u8; 16], vec![0u8; 4096]]).await;
+    ///     let (header, body) = (&bufs[0], &bufs[1]);
+    ///     println!("Read {} bytes: {header:?} then {body:?}", result?);
+    ///     Ok(())
+    /// }
+    /// ```
+    #[cfg(unix)]
+    pub fn readv<B>(res: &impl AsResource, bufs: Vec<B>) -> Io<ops::Readv<B>>
+    where
+        B: BufLike + std::marker::Send + Sync
+    {
+        Io::from_op(ops::Readv::new(res.as_resource().clone(), bufs))
+    }
+}
+
+doc_op! {
+    short: "Writes several buffers at once, without copying them together first.",
+    syscall: "writev(2)",
+    doc_link: "https://man7.org/linux/man-pages/man2/writev.2.html",
+
+    ///
+    /// Like the syscall, this can write less than all buffers; each buffer
+    /// is returned advanced past its share of the bytes written.
+    ///
+    /// # Examples
+    ///
+    /// ```rust,no_run
+    /// async fn writev_example() -> std::io::Result<()> {
+    ///     # use lio::api::resource::Resource;
+    ///     # let fd = Resource::stdout();
+    ///     let header = b"HTTP/1.1 200 OK\r\ncontent-length: 5\r\n\r\n".to_vec();
+    ///     let body = b"hello".to_vec();
+    ///     let (result, _bufs) = lio::api::writev(&fd, vec![header, body]).await;
+    ///     println!("Wrote {} bytes", result?);
+    ///     Ok(())
+    /// }
+    /// ```
+    #[cfg(unix)]
+    pub fn writev<B>(res: &impl AsResource, bufs: Vec<B>) -> Io<ops::Writev<B>>
+    where
+        B: BufLike + std::marker::Send + Sync
+    {
+        Io::from_op(ops::Writev::new(res.as_resource().clone(), bufs))
+    }
+}
+
+doc_op! {
+    short: "Reads resource into a pooled buffer, registered with the kernel when possible.",
+    syscall: "read(2)",
+    doc_link: "https://man7.org/linux/man-pages/man2/read.2.html",
+
+    ///
+    /// On io_uring, if the buffer's [`BufStore`](crate::buf::BufStore) was registered
+    /// through [`Lio::new_with_buf_store`](crate::Lio::new_with_buf_store), this
+    /// submits `IORING_OP_READ_FIXED` and the kernel skips pinning the pages per op.
+    /// Otherwise this behaves like [`read`].
+    ///
+    /// Works on sockets too, as a `recv(2)` without flags.
+    pub fn read_fixed(res: &impl AsResource, buf: LentBuf<'static>) -> Io<ops::ReadFixed> {
+        Io::from_op(ops::ReadFixed::new(res.as_resource().clone(), buf, -1))
+    }
+}
+
+doc_op! {
+    short: "Reads resource into a pooled buffer at a specific offset, registered with the kernel when possible.",
+    syscall: "pread(2)",
+    doc_link: "https://man7.org/linux/man-pages/man2/pread.2.html",
+
+    ///
+    /// See [`read_fixed`] for when the registered buffer path is taken.
+    pub fn read_at_fixed(res: &impl AsResource, buf: LentBuf<'static>, offset: i64) -> Io<ops::ReadFixed> {
+        Io::from_op(ops::ReadFixed::new(res.as_resource().clone(), buf, offset))
+    }
+}
+
+doc_op! {
+    short: "Writes the valid bytes of a pooled buffer, registered with the kernel when possible.",
+    syscall: "write(2)",
+    doc_link: "https://man7.org/linux/man-pages/man2/write.2.html",
+
+    ///
+    /// On io_uring, if the buffer's [`BufStore`](crate::buf::BufStore) was registered
+    /// through [`Lio::new_with_buf_store`](crate::Lio::new_with_buf_store), this
+    /// submits `IORING_OP_WRITE_FIXED`. Otherwise this behaves like [`write`](write()).
+    ///
+    /// Written bytes are consumed from the buffer, so on a short write the
+    /// returned buffer holds only what is left to write.
+    ///
+    /// Works on sockets too, as a `send(2)` without flags.
+    pub fn write_fixed(res: &impl AsResource, buf: LentBuf<'static>) -> Io<ops::WriteFixed> {
+        Io::from_op(ops::WriteFixed::new(res.as_resource().clone(), buf, -1))
+    }
+}
+
+doc_op! {
+    short: "Writes the valid bytes of a pooled buffer at a specific offset, registered with the kernel when possible.",
+    syscall: "pwrite(2)",
+    doc_link: "https://man7.org/linux/man-pages/man2/pwrite.2.html",
+
+    ///
+    /// See [`write_fixed`] for when the registered buffer path is taken.
+    pub fn write_at_fixed(res: &impl AsResource, buf: LentBuf<'static>, offset: i64) -> Io<ops::WriteFixed> {
+        Io::from_op(ops::WriteFixed::new(res.as_resource().clone(), buf, offset))
+    }
+}
+
 doc_op! {
     short: "Truncates a file to a specified length.",
     syscall: "ftruncate(2)",
@@ -354,6 +477,35 @@ doc_op! {
     }
 }
 
+doc_op! {
+    short: "Accepts connections on a listening socket, once per incoming connection.",
+    syscall: "accept(2)",
+
+    ///
+    /// Consume it with [`Io::stream`]. On io_uring this is a single multishot
+    /// `ACCEPT` that stays armed across connections. The polling backend
+    /// accepts in a loop on each readiness event, which switches the listener
+    /// to non-blocking. IOCP runs one accept per connection, re-submitted by
+    /// the stream. Peer addresses are not reported.
+    ///
+    /// # Examples
+    ///
+    /// ```rust,no_run
+    /// async fn accept_multi_example(lio: &lio::Lio) -> std::io::Result<()> {
+    ///     # use lio::api::resource::Resource;
+    ///     # let fd = Resource::stdin();
+    ///     let mut conns = lio::api::accept_multi(&fd).with_lio(lio).stream();
+    ///     while let Some(client_fd) = conns.next().await {
+    ///         println!("Accepted connection: {:?}", client_fd?);
+    ///     }
+    ///     Ok(())
+    /// }
+    /// ```
+    pub fn accept_multi(res: &impl AsResource) -> Io<ops::AcceptMulti> {
+        Io::from_op(ops::AcceptMulti::new(res.as_resource().clone()))
+    }
+}
+
 doc_op! {
     short: "Accepts a connection on a Unix domain socket.",
     syscall: "accept(2)",
@@ -362,6 +514,9 @@ doc_op! {
     /// Unlike [`accept`], this function does not attempt to parse the peer address
     /// into a `SocketAddr`, making it suitable for Unix domain sockets.
     ///
+    /// The kernel isn't asked for the peer address at all, which also makes this
+    /// the cheaper accept on TCP listeners that don't need it.
+    ///
     /// # Examples
     ///
     /// ```rust,no_run
@@ -448,6 +603,42 @@ doc_op! {
     }
 }
 
+doc_op! {
+    short: "Sends data on a connected socket without copying it into the kernel.",
+
+    ///
+    /// Like [`send`], except the kernel reads the data straight from `buf`. The
+    /// buffer is only handed back once the kernel is done with it, which for
+    /// TCP is when the peer acknowledged the data. Pinning pages instead of
+    /// copying only pays off for large buffers, tens of KiB and up.
+    ///
+    /// Uses `IORING_OP_SEND_ZC` on io_uring and [`MSG_ZEROCOPY`] on epoll. Where
+    /// neither is available (kqueue, sockets without `SO_ZEROCOPY` support) it
+    /// behaves like [`send`]. The kernel may still copy the data, e.g. over
+    /// loopback.
+    ///
+    /// [`MSG_ZEROCOPY`]: https://docs.kernel.org/networking/msg_zerocopy.html
+    ///
+    /// # Examples
+    ///
+    /// ```rust,no_run
+    /// async fn send_zc_example() -> std::io::Result<()> {
+    ///     # use lio::api::resource::Resource;
+    ///     # let fd = Resource::stdin();
+    ///     let data = vec![0u8; 4 << 20];
+    ///     let (bytes_sent, _buf) = lio::api::send_zc(&fd, data, None).await;
+    ///     println!("Sent {} bytes", bytes_sent?);
+    ///     Ok(())
+    /// }
+    /// ```
+    pub fn send_zc<B>(res: &impl AsResource, buf: B, flags: Option<i32>) -> Io<ops::SendZc<B>>
+    where
+        B: BufLike + std::marker::Send + Sync
+    {
+        Io::from_op(ops::SendZc::new(res.as_resource().clone(), buf, flags))
+    }
+}
+
 doc_op! {
     short: "Receives data over a socket into provided buffer.",
     syscall: "recv(2)",
@@ -475,10 +666,137 @@ doc_op! {
     }
 }
 
+doc_op! {
+    short: "Sends several buffers over a socket as one message.",
+    syscall: "sendmsg(2)",
+    doc_link: "https://man7.org/linux/man-pages/man2/sendmsg.2.html",
+
+    ///
+    /// `to` addresses the message on unconnected sockets, e.g for UDP, and
+    /// must be `None` on connected ones.
+    ///
+    /// # Examples
+    ///
+    /// ```rust,no_run
+    /// async fn sendmsg_example() -> std::io::Result<()> {
+    ///     # use lio::api::resource::Resource;
+    ///     # let fd = Resource::stdin();
+    ///     let bufs = vec![b"Hello, ".to_vec(), b"server!".to_vec()];
+    ///     let (bytes_sent, _bufs) = lio::api::sendmsg(&fd, bufs, None, None).await;
+    ///     println!("Sent {} bytes", bytes_sent?);
+    ///     Ok(())
+    /// }
+    /// ```
+    #[cfg(unix)]
+    pub fn sendmsg<B>(res: &impl AsResource, bufs: Vec<B>, to: Option<SocketAddr>, flags: Option<i32>) -> Io<ops::SendMsg<B>>
+    where
+        B: BufLike + std::marker::Send + Sync
+    {
+        Io::from_op(ops::SendMsg::new(res.as_resource().clone(), bufs, to, flags))
+    }
+}
+
+doc_op! {
+    short: "Receives a message over a socket into several buffers, with the sender's address.",
+    syscall: "recvmsg(2)",
+    doc_link: "https://man7.org/linux/man-pages/man2/recvmsg.2.html",
+
+    ///
+    /// The address is `None` on connected sockets.
+    ///
+    /// # Examples
+    ///
+    /// ```rust,no_run
+    /// async fn recvmsg_example() -> std::io::Result<()> {
+    ///     # use lio::api::resource::Resource;
+    ///     # let fd = Resource::stdin();
+    ///     let (result, bufs) = lio::api::recvmsg(&fd, vec![vec![0u8; 1500]], None).await;
+    ///     let (received, from) = result?;
+    ///     println!("Received {received} bytes from {from:?}: {:?}", bufs[0]);
+    ///     Ok(())
+    /// }
+    /// ```
+    #[cfg(unix)]
+    pub fn recvmsg<B>(res: &impl AsResource, bufs: Vec<B>, flags: Option<i32>) -> Io<ops::RecvMsg<B>>
+    where
+        B: BufLike + std::marker::Send + Sync
+    {
+        Io::from_op(ops::RecvMsg::new(res.as_resource().clone(), bufs, flags))
+    }
+}
+
+doc_op! {
+    short: "Receives messages over a socket into [`BufRing`] buffers, with their senders' addresses.",
+    syscall: "recvmsg(2)",
+    doc_link: "https://man7.org/linux/man-pages/man2/recvmsg.2.html",
+
+    ///
+    /// Consume it with [`Io::stream`], one [`Datagram`](ops::Datagram) per
+    /// message. On io_uring this is a single multishot `RECVMSG` with buffer
+    /// selection, like [`recv_multi`]. The polling backend fills several
+    /// buffers per `recvmmsg(2)` where there is one.
+    ///
+    /// Each buffer starts with the address and control data, about 200
+    /// bytes, so `ring` must have bigger ones.
+    ///
+    /// # Examples
+    ///
+    /// ```rust,no_run
+    /// async fn recvmsg_multi_example(lio: &lio::Lio) -> std::io::Result<()> {
+    ///     # use lio::api::resource::Resource;
+    ///     # let fd = Resource::stdin();
+    ///     let ring = lio.register_buf_ring(256, 2048)?;
+    ///     let mut datagrams = lio::api::recvmsg_multi(&fd, &ring, None).with_lio(lio).stream();
+    ///     while let Some(datagram) = datagrams.next().await {
+    ///         let datagram = datagram?;
+    ///         println!("Received {:?} from {:?}", &datagram[..], datagram.peer());
+    ///     }
+    ///     Ok(())
+    /// }
+    /// ```
+    #[cfg(unix)]
+    pub fn recvmsg_multi(res: &impl AsResource, ring: &BufRing, flags: Option<i32>) -> Io<ops::RecvMsgMulti> {
+        Io::from_op(ops::RecvMsgMulti::new(res.as_resource().clone(), ring.clone(), flags))
+    }
+}
+
+doc_op! {
+    short: "Receives data over a socket into [`BufRing`] buffers, once per arriving chunk.",
+    syscall: "recv(2)",
+    doc_link: "https://man7.org/linux/man-pages/man2/recv.2.html",
+
+    ///
+    /// Consume it with [`Io::stream`]. On io_uring this is a single multishot
+    /// `RECV` with buffer selection: no buffer is tied up while the socket is
+    /// idle, the kernel takes one from `ring` when data arrives. Other backends
+    /// do the same on readiness.
+    ///
+    /// # Examples
+    ///
+    /// ```rust,no_run
+    /// async fn recv_multi_example(lio: &lio::Lio) -> std::io::Result<()> {
+    ///     # use lio::api::resource::Resource;
+    ///     # let fd = Resource::stdin();
+    ///     let ring = lio.register_buf_ring(64, 4096)?;
+    ///     let mut chunks = lio::api::recv_multi(&fd, &ring, None).with_lio(lio).stream();
+    ///     while let Some(chunk) = chunks.next().await {
+    ///         println!("Received {:?}", &chunk?[..]);
+    ///     }
+    ///     Ok(())
+    /// }
+    /// ```
+    pub fn recv_multi(res: &impl AsResource, ring: &BufRing, flags: Option<i32>) -> Io<ops::RecvMulti> {
+        Io::from_op(ops::RecvMulti::new(res.as_resource().clone(), ring.clone(), flags))
+    }
+}
+
 doc_op! {
     short: "Opens a file relative to a directory file descriptor.",
     syscall: "openat(2)",
 
+    ///
+    /// Files created with `O_CREAT` get mode `0o666`, less the umask. See
+    /// [`fs::OpenOptions`](crate::fs::OpenOptions) to pick another.
     ///
     /// # Examples
     ///
@@ -531,3 +849,33 @@ doc_op! {
         Io::from_op(ops::Tee::new(res_in.as_resource().clone(), res_out.as_resource().clone(), size))
     }
 }
+
+doc_op! {
+    short: "Moves data between file descriptors without copying to userspace, one of them a pipe (Linux only).",
+    syscall: "splice(2)",
+    doc_link: "https://man7.org/linux/man-pages/man2/splice.2.html",
+
+    ///
+    /// Reads `res_in` from `off_in`, or from its file position if that's -1,
+    /// which it must be when `res_in` is a pipe or socket. Waits for room in
+    /// a full `res_out` rather than failing with `EAGAIN`. To send a file
+    /// over a socket, see [`fs::copy_to_socket`](crate::fs::copy_to_socket),
+    /// which splices through a pipe for you.
+    ///
+    /// # Examples
+    ///
+    /// ```rust,no_run
+    /// # #[cfg(target_os = "linux")]
+    /// # async fn example(file: lio::api::resource::Resource, pipe_in: lio::api::resource::Resource) -> std::io::Result<()> {
+    /// // Moves the first 4096 bytes of `file` into a pipe.
+    /// let moved = lio::api::splice(&file, 0, &pipe_in, 4096).await?;
+    /// println!("Moved {} bytes", moved);
+    /// # Ok(())
+    /// # }
+    /// ```
+    #[cfg(linux)]
+    #[cfg_attr(docsrs, doc(cfg(linux)))]
+    pub fn splice(res_in: &impl AsResource, off_in: i64, res_out: &impl AsResource, size: u32) -> Io<ops::Splice> {
+        Io::from_op(ops::Splice::new(res_in.as_resource().clone(), off_in, res_out.as_resource().clone(), size))
+    }
+}
@@ -1,53 +1,92 @@
 // Re-export items from parent module for use by operation implementations
 
 mod accept;
+mod accept_multi;
 mod accept_unix;
 mod bind;
 mod close;
 mod connect;
 mod fsync;
+mod link_timeout;
 mod linkat;
 mod listen;
 mod nop;
 mod openat;
 mod read;
 mod read_at;
+mod read_fixed;
+#[cfg(unix)]
+mod readv;
 mod recv;
+mod recv_multi;
+#[cfg(unix)]
+mod recvmsg;
+#[cfg(unix)]
+mod recvmsg_multi;
 mod send;
+mod send_zc;
+#[cfg(unix)]
+mod sendmsg;
 mod shutdown;
 mod socket;
 mod symlink;
 mod timeout;
 
+#[cfg(linux)]
+mod splice;
 #[cfg(linux)]
 mod tee;
 
 mod truncate;
 mod write;
 mod write_at;
+mod write_fixed;
+#[cfg(unix)]
+mod writev;
+
+#[cfg(unix)]
+pub(crate) mod iovec;
 
 pub use accept::*;
+pub use accept_multi::*;
 pub use accept_unix::*;
 pub use bind::*;
 pub use close::*;
 pub use connect::*;
 pub use fsync::*;
+pub use link_timeout::*;
 pub use linkat::*;
 pub use listen::*;
 pub use nop::*;
 pub use openat::*;
 pub use read::*;
 pub use read_at::*;
+pub use read_fixed::*;
+#[cfg(unix)]
+pub use readv::*;
 pub use recv::*;
+pub use recv_multi::*;
+#[cfg(unix)]
+pub use recvmsg::*;
+#[cfg(unix)]
+pub use recvmsg_multi::*;
 pub use send::*;
+pub use send_zc::*;
+#[cfg(unix)]
+pub use sendmsg::*;
 pub use shutdown::*;
 pub use socket::*;
 pub use symlink::*;
 pub use timeout::*;
 
+#[cfg(linux)]
+pub use splice::*;
 #[cfg(linux)]
 pub use tee::*;
 
 pub use truncate::*;
 pub use write::*;
 pub use write_at::*;
+pub use write_fixed::*;
+#[cfg(unix)]
+pub use writev::*;
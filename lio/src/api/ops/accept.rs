@@ -12,10 +12,13 @@ use crate::{
 };
 
 // Not detach safe.
+//
+// The address is stored inline: ops are boxed before `into_op`, so it stays
+// put until the kernel writes it, without an allocation of its own.
 pub struct Accept {
   res: Resource,
-  addr: Box<libc::sockaddr_storage>,
-  len: Box<libc::socklen_t>,
+  addr: libc::sockaddr_storage,
+  len: libc::socklen_t,
 }
 
 // SAFETY: The UnsafeCells are only written during construction and by the kernel
@@ -29,17 +32,17 @@ impl Accept {
     // SAFETY: libc::sockaddr_storage is a C struct that is safe to zero-initialize.
     // It consists of primitive integer fields where zero is a valid value. The kernel
     // will fill this structure via the accept syscall's output parameter.
-    let addr: Box<libc::sockaddr_storage> = Box::new(unsafe { mem::zeroed() });
-    let len =
-      Box::new(mem::size_of::<libc::sockaddr_storage>() as libc::socklen_t);
+    let addr: libc::sockaddr_storage = unsafe { mem::zeroed() };
+    let len = mem::size_of::<libc::sockaddr_storage>() as libc::socklen_t;
     Self { res, addr, len }
   }
 
+  /// Leaks the address storage, which the returned op points into.
   pub fn to_op(self) -> crate::op::Op {
     crate::op::Op::Accept {
       fd: self.res,
-      addr: Box::into_raw(self.addr),
-      len: Box::into_raw(self.len),
+      addr: Box::into_raw(Box::new(self.addr)),
+      len: Box::into_raw(Box::new(self.len)),
     }
   }
 }
@@ -50,10 +53,10 @@ impl TypedOp for Accept {
   fn into_op(&mut self) -> crate::op::Op {
     Op::Accept {
       fd: self.res.clone(),
-      // SAFETY: self.addr is a Box, so the pointer remains valid even if
-      // `self` (the Accept struct) is later moved to the heap by OpCallback.
-      addr: &mut *self.addr as *mut _,
-      len: &mut *self.len as *mut _,
+      // Valid as long as `self` doesn't move, which it doesn't once boxed
+      // for submission.
+      addr: &raw mut self.addr,
+      len: &raw mut self.len,
     }
   }
   fn extract_result(self, res: isize) -> Self::Result {
@@ -66,7 +69,7 @@ impl TypedOp for Accept {
     // SAFETY: result is valid fd.
     let res = unsafe { Resource::from_raw_fd(result) };
     // SAFETY: self.addr was filled by the kernel via the accept syscall.
-    let addr = unsafe { libc_socketaddr_into_std(&*self.addr as *const _) }?;
+    let addr = unsafe { libc_socketaddr_into_std(&raw const self.addr) }?;
     Ok((res, addr))
   }
 
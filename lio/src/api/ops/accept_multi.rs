@@ -0,0 +1,44 @@
+use std::{io, os::fd::FromRawFd};
+
+use crate::{api::resource::Resource, op::Op, typed_op::MultishotOp};
+
+/// Multishot accept, one completion per incoming connection.
+///
+/// No peer address is reported; query it on the accepted socket if needed.
+/// The stream ends after yielding an error, except `ECONNABORTED` (the peer
+/// gave up before the connection was accepted), which keeps it going.
+pub struct AcceptMulti {
+  res: Resource,
+}
+
+impl AcceptMulti {
+  pub(crate) fn new(res: Resource) -> Self {
+    Self { res }
+  }
+}
+
+impl MultishotOp for AcceptMulti {
+  type Item = io::Result<Resource>;
+
+  fn into_op(&mut self) -> Op {
+    Op::AcceptMulti { fd: self.res.clone() }
+  }
+
+  fn extract_item(
+    &self,
+    res: isize,
+    _buf_id: Option<u16>,
+  ) -> Option<Self::Item> {
+    if res < 0 {
+      return Some(Err(io::Error::from_raw_os_error((-res) as i32)));
+    }
+    // SAFETY: res is a freshly accepted fd, owned by nobody else.
+    Some(Ok(unsafe { Resource::from_raw_fd(res as i32) }))
+  }
+
+  fn resumable(&self, res: isize) -> bool {
+    // The backend may stop a multishot early with a connection (e.g on CQ
+    // overflow).
+    res >= 0 || res == -(libc::ECONNABORTED as isize)
+  }
+}
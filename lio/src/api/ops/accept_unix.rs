@@ -3,11 +3,14 @@
 //! Unlike the regular `Accept` operation which returns a `SocketAddr`,
 //! this operation returns only the accepted file descriptor since Unix
 //! domain socket addresses don't map to `std::net::SocketAddr`.
+//!
+//! It doesn't ask for the peer address at all, so it's the cheaper accept on
+//! any listener whose caller doesn't need one.
 
 use std::{
   io::{self, Error},
-  mem,
   os::fd::{FromRawFd, RawFd},
+  ptr,
 };
 
 use crate::{api::resource::Resource, op::Op, typed_op::TypedOp};
@@ -19,17 +22,11 @@ use crate::{api::resource::Resource, op::Op, typed_op::TypedOp};
 /// the peer address into a `SocketAddr`.
 pub struct AcceptUnix {
   res: Resource,
-  addr: Box<libc::sockaddr_storage>,
-  len: Box<libc::socklen_t>,
 }
 
 impl AcceptUnix {
   pub(crate) fn new(res: Resource) -> Self {
-    // SAFETY: libc::sockaddr_storage is a C struct that is safe to zero-initialize.
-    let addr: Box<libc::sockaddr_storage> = Box::new(unsafe { mem::zeroed() });
-    let len =
-      Box::new(mem::size_of::<libc::sockaddr_storage>() as libc::socklen_t);
-    Self { res, addr, len }
+    Self { res }
   }
 }
 
@@ -39,8 +36,9 @@ impl TypedOp for AcceptUnix {
   fn into_op(&mut self) -> Op {
     Op::Accept {
       fd: self.res.clone(),
-      addr: &mut *self.addr as *mut _,
-      len: &mut *self.len as *mut _,
+      // accept(2) skips writing the peer address when both are null.
+      addr: ptr::null_mut(),
+      len: ptr::null_mut(),
     }
   }
 
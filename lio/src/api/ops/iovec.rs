@@ -0,0 +1,280 @@
+//! Shared plumbing for the vectored ops.
+
+use std::{mem, net::SocketAddr, ptr};
+
+use crate::{
+  buf::BufLike,
+  net_utils::{libc_socketaddr_into_std, std_socketaddr_into_libc},
+};
+
+/// `iovec`s pointing into the buffers of a vectored op.
+#[derive(Default)]
+pub(crate) struct IoVecs(Vec<libc::iovec>);
+
+// SAFETY: The pointers only point into buffers owned by the same op, which
+// are Send + Sync themselves.
+unsafe impl Send for IoVecs {}
+// SAFETY: Same as Send.
+unsafe impl Sync for IoVecs {}
+
+impl IoVecs {
+  pub(crate) fn new<B: BufLike>(bufs: &[B]) -> Self {
+    let iovecs = bufs
+      .iter()
+      .map(|buf| {
+        let slice = buf.buf();
+        libc::iovec { iov_base: slice.as_ptr() as *mut _, iov_len: slice.len() }
+      })
+      .collect();
+    Self(iovecs)
+  }
+
+  pub(crate) fn as_ptr(&self) -> *const libc::iovec {
+    self.0.as_ptr()
+  }
+
+  pub(crate) fn len(&self) -> u32 {
+    self.0.len() as u32
+  }
+}
+
+/// Hands each buffer, in order, its share of the `bytes` an op transferred.
+pub(crate) fn after_each<B: BufLike>(bufs: Vec<B>, mut bytes: usize) -> Vec<B> {
+  bufs
+    .into_iter()
+    .map(|buf| {
+      let n = bytes.min(buf.buf().len());
+      bytes -= n;
+      buf.after(n)
+    })
+    .collect()
+}
+
+/// Bytes of control data a [`MsgHdr`] has room for: one control message
+/// with an `int` of data, like the `UDP_SEGMENT` size a send asks for or the
+/// `UDP_GRO` size a receive reports.
+pub(crate) const CONTROL_LEN: usize = 32;
+
+/// Control data, aligned for the `cmsghdr`s in it.
+#[repr(C, align(8))]
+struct Control([u8; CONTROL_LEN]);
+
+/// A `msghdr` over an op's [`IoVecs`], with room for the peer address and a
+/// control message.
+///
+/// `msg_name` points at `addr` and `msg_control` at `control`, so this must
+/// not move once handed to the backend.
+pub(crate) struct MsgHdr {
+  hdr: libc::msghdr,
+  addr: libc::sockaddr_storage,
+  control: Control,
+}
+
+// SAFETY: `hdr` only points into `addr` and the op's own IoVecs.
+unsafe impl Send for MsgHdr {}
+// SAFETY: Same as Send.
+unsafe impl Sync for MsgHdr {}
+
+impl MsgHdr {
+  pub(crate) fn new() -> Self {
+    // SAFETY: Both are plain C structs where all zeroes is a valid value.
+    unsafe { mem::zeroed() }
+  }
+
+  /// Points the header at `iovecs`, addressed to `to` if it's set.
+  pub(crate) fn send(
+    &mut self,
+    iovecs: &IoVecs,
+    to: Option<SocketAddr>,
+  ) -> *const libc::msghdr {
+    self.fill(iovecs);
+    if let Some(to) = to {
+      self.addr = std_socketaddr_into_libc(to);
+      self.hdr.msg_name = (&raw mut self.addr).cast();
+      self.hdr.msg_namelen = match to {
+        SocketAddr::V4(_) => mem::size_of::<libc::sockaddr_in>(),
+        SocketAddr::V6(_) => mem::size_of::<libc::sockaddr_in6>(),
+      } as libc::socklen_t;
+    }
+    &raw const self.hdr
+  }
+
+  /// Has the next [`send`](Self::send) split into datagrams of `size` bytes
+  /// by the kernel, with a `UDP_SEGMENT` control message.
+  #[cfg(linux)]
+  pub(crate) fn segment_size(&mut self, size: u16) {
+    self.hdr.msg_control = (&raw mut self.control).cast();
+    // SAFETY: CMSG_SPACE only computes a length.
+    self.hdr.msg_controllen =
+      unsafe { libc::CMSG_SPACE(mem::size_of::<u16>() as u32) } as _;
+    // SAFETY: `control` is aligned and has room for a cmsghdr with a u16,
+    // see the test.
+    unsafe {
+      let cmsg = libc::CMSG_FIRSTHDR(&self.hdr);
+      (*cmsg).cmsg_level = libc::SOL_UDP;
+      (*cmsg).cmsg_type = libc::UDP_SEGMENT;
+      (*cmsg).cmsg_len = libc::CMSG_LEN(mem::size_of::<u16>() as u32) as _;
+      ptr::write_unaligned(libc::CMSG_DATA(cmsg).cast::<u16>(), size);
+    }
+  }
+
+  /// Points the header at `iovecs`, taking in the sender's address and a
+  /// control message.
+  pub(crate) fn recv(&mut self, iovecs: &IoVecs) -> *mut libc::msghdr {
+    self.fill(iovecs);
+    self.hdr.msg_name = (&raw mut self.addr).cast();
+    self.hdr.msg_namelen =
+      mem::size_of::<libc::sockaddr_storage>() as libc::socklen_t;
+    self.hdr.msg_control = (&raw mut self.control).cast();
+    self.hdr.msg_controllen = CONTROL_LEN as _;
+    &raw mut self.hdr
+  }
+
+  /// The header a multishot receive lays its buffers out by, see
+  /// [`RecvMsgOut`]. Only the name and control lengths are set.
+  pub(crate) fn recv_multi(&mut self) -> *const libc::msghdr {
+    self.hdr.msg_namelen =
+      mem::size_of::<libc::sockaddr_storage>() as libc::socklen_t;
+    self.hdr.msg_controllen = CONTROL_LEN as _;
+    &raw const self.hdr
+  }
+
+  fn fill(&mut self, iovecs: &IoVecs) {
+    self.hdr.msg_iov = iovecs.as_ptr() as *mut _;
+    self.hdr.msg_iovlen = iovecs.len() as _;
+  }
+
+  /// The address a [`recv`](Self::recv) filled in, if it has an IP one.
+  /// Connected sockets leave it empty.
+  pub(crate) fn peer(&self) -> Option<SocketAddr> {
+    if self.hdr.msg_namelen == 0 {
+      return None;
+    }
+    // SAFETY: `addr` is a sockaddr_storage, filled in by the kernel.
+    unsafe { libc_socketaddr_into_std(&self.addr) }.ok()
+  }
+}
+
+/// Finds the `UDP_GRO` control message in `control`, the control data of a
+/// receive, and returns its datagram size.
+#[cfg(linux)]
+pub(crate) fn gro_size(control: &[u8]) -> Option<u16> {
+  // Copied out, the kernel needn't have aligned it.
+  let mut aligned = Control([0; CONTROL_LEN]);
+  let len = control.len().min(CONTROL_LEN);
+  aligned.0[..len].copy_from_slice(&control[..len]);
+  // SAFETY: A zeroed msghdr is valid; only its control fields are read.
+  let mut hdr: libc::msghdr = unsafe { mem::zeroed() };
+  hdr.msg_control = (&raw mut aligned).cast();
+  hdr.msg_controllen = len as _;
+
+  // SAFETY: The CMSG macros stay within the `len` bytes of `aligned`.
+  unsafe {
+    let mut cmsg = libc::CMSG_FIRSTHDR(&hdr);
+    while !cmsg.is_null() {
+      if (*cmsg).cmsg_level == libc::SOL_UDP
+        && (*cmsg).cmsg_type == libc::UDP_GRO
+      {
+        let size = ptr::read_unaligned(libc::CMSG_DATA(cmsg).cast::<i32>());
+        return Some(size as u16);
+      }
+      cmsg = libc::CMSG_NXTHDR(&hdr, cmsg);
+    }
+  }
+  None
+}
+
+/// What the kernel puts at the start of each buffer of a multishot
+/// `recvmsg`, `struct io_uring_recvmsg_out`.
+///
+/// The buffer goes on with the sender's address, in as many bytes as the
+/// `msg_namelen` of the header the op was submitted with, then the control
+/// data, in `msg_controllen` bytes, then the payload. Backends that run the
+/// op themselves lay buffers out the same way, so one parser handles both.
+#[repr(C)]
+#[derive(Clone, Copy, Default)]
+pub(crate) struct RecvMsgOut {
+  /// Length of the sender's address, which may exceed the room for it.
+  pub(crate) namelen: u32,
+  /// Bytes of control data.
+  pub(crate) controllen: u32,
+  /// Length of the datagram, which may exceed the room for it.
+  pub(crate) payloadlen: u32,
+  /// `msg_flags` of the receive, e.g `MSG_TRUNC`.
+  pub(crate) flags: u32,
+}
+
+impl RecvMsgOut {
+  pub(crate) const LEN: usize = mem::size_of::<Self>();
+
+  /// Where the address, control data and payload start in a buffer laid
+  /// out by `msg`.
+  pub(crate) fn offsets(msg: &libc::msghdr) -> (usize, usize, usize) {
+    let name = Self::LEN;
+    let control = name + msg.msg_namelen as usize;
+    let controllen: usize = msg.msg_controllen as _;
+    (name, control, control + controllen)
+  }
+
+  /// Reads the header at the start of `buf`.
+  pub(crate) fn read(buf: &[u8]) -> Option<Self> {
+    if buf.len() < Self::LEN {
+      return None;
+    }
+    // SAFETY: `buf` holds a whole header, read unaligned.
+    Some(unsafe { ptr::read_unaligned(buf.as_ptr().cast()) })
+  }
+
+  /// Writes the header at `buf`, the start of a multishot buffer.
+  ///
+  /// # Safety
+  ///
+  /// `buf` must be valid for [`LEN`](Self::LEN) bytes of writes.
+  pub(crate) unsafe fn write(self, buf: *mut u8) {
+    // SAFETY: Guaranteed by the caller.
+    unsafe { ptr::write_unaligned(buf.cast(), self) };
+  }
+}
+
+#[cfg(test)]
+mod tests {
+  use super::*;
+
+  #[test]
+  #[cfg(linux)]
+  fn test_segment_size_round_trips() {
+    assert!(unsafe { libc::CMSG_SPACE(4) } as usize <= CONTROL_LEN);
+
+    let mut msg = MsgHdr::new();
+    msg.segment_size(1200);
+    let len = msg.hdr.msg_controllen as usize;
+    // SAFETY: A cmsghdr starts the control data.
+    let cmsg =
+      unsafe { &mut *msg.control.0.as_mut_ptr().cast::<libc::cmsghdr>() };
+    assert_eq!(cmsg.cmsg_type, libc::UDP_SEGMENT);
+    // Reported UDP_GRO sizes are ints.
+    cmsg.cmsg_type = libc::UDP_GRO;
+    cmsg.cmsg_len = unsafe { libc::CMSG_LEN(4) } as _;
+    assert_eq!(gro_size(&msg.control.0[..len]), Some(1200));
+    assert_eq!(gro_size(&[]), None);
+  }
+
+  #[test]
+  fn test_recv_msg_out_layout() {
+    let mut msg = MsgHdr::new();
+    // SAFETY: recv_multi points into `msg`, which is still alive.
+    let (name, control, payload) =
+      RecvMsgOut::offsets(unsafe { &*msg.recv_multi() });
+    assert_eq!(name, 16);
+    assert_eq!(control, 16 + mem::size_of::<libc::sockaddr_storage>());
+    assert_eq!(payload, control + CONTROL_LEN);
+
+    let mut buf = [0u8; 20];
+    let out = RecvMsgOut { namelen: 1, controllen: 2, payloadlen: 3, flags: 4 };
+    // SAFETY: `buf` is longer than a header.
+    unsafe { out.write(buf.as_mut_ptr().add(1)) };
+    let read = RecvMsgOut::read(&buf[1..]).unwrap();
+    assert_eq!((read.namelen, read.payloadlen, read.flags), (1, 3, 4));
+    assert!(RecvMsgOut::read(&buf[..8]).is_none());
+  }
+}
@@ -0,0 +1,53 @@
+use std::io;
+use std::time::Duration;
+
+use crate::typed_op::TypedOp;
+
+/// Timeout of the op linked before it, see
+/// [`Io::link_timeout`](crate::api::io::Io::link_timeout).
+pub struct LinkTimeout {
+  duration: Duration,
+  #[cfg(target_os = "linux")]
+  timespec: libc::timespec,
+}
+
+assert_op_max_size!(LinkTimeout);
+
+impl LinkTimeout {
+  pub(crate) fn new(duration: Duration) -> Self {
+    Self {
+      duration,
+      #[cfg(target_os = "linux")]
+      timespec: libc::timespec {
+        tv_sec: duration.as_secs() as libc::time_t,
+        tv_nsec: duration.subsec_nanos() as libc::c_long,
+      },
+    }
+  }
+
+  pub fn duration(&self) -> Duration {
+    self.duration
+  }
+}
+
+impl TypedOp for LinkTimeout {
+  /// `Ok` if it went off, `ECANCELED` if the op made it in time.
+  type Result = io::Result<()>;
+
+  fn into_op(&mut self) -> crate::op::Op {
+    crate::op::Op::LinkTimeout {
+      duration: self.duration,
+      #[cfg(target_os = "linux")]
+      timespec: &self.timespec as *const libc::timespec,
+    }
+  }
+
+  fn extract_result(self, res: isize) -> Self::Result {
+    match res {
+      0 => Ok(()),
+      #[cfg(target_os = "linux")]
+      res if res == -(libc::ETIME as isize) => Ok(()),
+      res => Err(io::Error::from_raw_os_error((-res) as i32)),
+    }
+  }
+}
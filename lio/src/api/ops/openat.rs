@@ -7,13 +7,20 @@ pub struct OpenAt {
   dir_res: Resource,
   pathname: CString,
   flags: i32,
+  mode: u32,
 }
 
 assert_op_max_size!(OpenAt);
 
 impl OpenAt {
   pub(crate) fn new(dir_res: Resource, pathname: CString, flags: i32) -> Self {
-    Self { dir_res, pathname, flags }
+    Self { dir_res, pathname, flags, mode: 0o666 }
+  }
+
+  /// Creates files with permissions `mode` instead of `0o666`.
+  pub(crate) fn mode(mut self, mode: u32) -> Self {
+    self.mode = mode;
+    self
   }
 
   pub fn to_op(self) -> crate::op::Op {
@@ -21,6 +28,7 @@ impl OpenAt {
       dir_fd: self.dir_res,
       path: self.pathname.as_ptr(),
       flags: self.flags,
+      mode: self.mode,
     }
   }
 }
@@ -33,6 +41,7 @@ impl TypedOp for OpenAt {
       dir_fd: self.dir_res.clone(),
       path: self.pathname.as_ptr(),
       flags: self.flags,
+      mode: self.mode,
     }
   }
 
@@ -0,0 +1,55 @@
+use crate::{
+  BufResult,
+  api::{
+    ops::iovec::{IoVecs, after_each},
+    resource::Resource,
+  },
+  buf::BufLike,
+  typed_op::TypedOp,
+};
+
+pub struct Readv<B>
+where
+  B: Send + Sync,
+{
+  res: Resource,
+  bufs: Option<Vec<B>>,
+  iovecs: IoVecs,
+}
+
+impl<B> Readv<B>
+where
+  B: Send + Sync,
+{
+  pub(crate) fn new(res: Resource, bufs: Vec<B>) -> Self {
+    Self { res, bufs: Some(bufs), iovecs: IoVecs::default() }
+  }
+}
+
+impl<B> TypedOp for Readv<B>
+where
+  B: BufLike + Send + Sync + 'static,
+{
+  type Result = BufResult<i32, Vec<B>>;
+
+  fn into_op(&mut self) -> crate::op::Op {
+    self.iovecs =
+      IoVecs::new(self.bufs.as_ref().expect("buffers not available"));
+    crate::op::Op::Readv {
+      fd: self.res.clone(),
+      iov: self.iovecs.as_ptr(),
+      iovcnt: self.iovecs.len(),
+    }
+  }
+
+  fn extract_result(self, res: isize) -> Self::Result {
+    let bufs = self.bufs.expect("buffers not available");
+    if res < 0 {
+      // On error, return buffers unchanged
+      (Err(std::io::Error::from_raw_os_error((-res) as i32)), bufs)
+    } else {
+      // On success, fill buffers in order with the bytes read
+      (Ok(res as i32), after_each(bufs, res as usize))
+    }
+  }
+}
@@ -0,0 +1,58 @@
+use std::io;
+
+use crate::{
+  api::resource::Resource,
+  buf::{BufRing, RingChunk},
+  typed_op::MultishotOp,
+};
+
+/// Multishot receive into buffers of a [`BufRing`].
+///
+/// Each completion yields the received bytes as a [`RingChunk`]. The stream
+/// ends on EOF or after yielding an error; `ENOBUFS`, meaning every ring
+/// buffer is held by a chunk, is yielded too but keeps the stream going once
+/// chunks are dropped.
+pub struct RecvMulti {
+  res: Resource,
+  ring: BufRing,
+  flags: i32,
+}
+
+impl RecvMulti {
+  pub(crate) fn new(res: Resource, ring: BufRing, flags: Option<i32>) -> Self {
+    Self { res, ring, flags: flags.unwrap_or(0) }
+  }
+}
+
+impl MultishotOp for RecvMulti {
+  type Item = io::Result<RingChunk>;
+
+  fn into_op(&mut self) -> crate::op::Op {
+    crate::op::Op::RecvMulti {
+      fd: self.res.clone(),
+      flags: self.flags,
+      ring: self.ring.clone(),
+    }
+  }
+
+  fn extract_item(
+    &self,
+    res: isize,
+    buf_id: Option<u16>,
+  ) -> Option<Self::Item> {
+    if res < 0 {
+      return Some(Err(io::Error::from_raw_os_error((-res) as i32)));
+    }
+    let chunk = buf_id.map(|bid| self.ring.chunk(bid, res as usize));
+    // EOF selects no buffer.
+    if res == 0 {
+      return None;
+    }
+    Some(Ok(chunk.expect("multishot recv completed without a buffer")))
+  }
+
+  fn resumable(&self, res: isize) -> bool {
+    // The backend may stop a multishot early with data (e.g on CQ overflow).
+    res > 0 || res == -(libc::ENOBUFS as isize)
+  }
+}
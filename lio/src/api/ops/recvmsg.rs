@@ -0,0 +1,67 @@
+use std::net::SocketAddr;
+
+use crate::{
+  BufResult,
+  api::{
+    ops::iovec::{IoVecs, MsgHdr, after_each},
+    resource::Resource,
+  },
+  buf::BufLike,
+  typed_op::TypedOp,
+};
+
+pub struct RecvMsg<B>
+where
+  B: Send + Sync,
+{
+  res: Resource,
+  bufs: Option<Vec<B>>,
+  flags: i32,
+  iovecs: IoVecs,
+  msg: MsgHdr,
+}
+
+impl<B> RecvMsg<B>
+where
+  B: Send + Sync,
+{
+  pub(crate) fn new(res: Resource, bufs: Vec<B>, flags: Option<i32>) -> Self {
+    Self {
+      res,
+      bufs: Some(bufs),
+      flags: flags.unwrap_or(0),
+      iovecs: IoVecs::default(),
+      msg: MsgHdr::new(),
+    }
+  }
+}
+
+impl<B> TypedOp for RecvMsg<B>
+where
+  B: BufLike + Send + Sync + 'static,
+{
+  type Result = BufResult<(i32, Option<SocketAddr>), Vec<B>>;
+
+  fn into_op(&mut self) -> crate::op::Op {
+    self.iovecs =
+      IoVecs::new(self.bufs.as_ref().expect("buffers not available"));
+    crate::op::Op::RecvMsg {
+      fd: self.res.clone(),
+      // Points into `self`, which stays put until the op completes.
+      msg: self.msg.recv(&self.iovecs),
+      flags: self.flags,
+    }
+  }
+
+  fn extract_result(self, res: isize) -> Self::Result {
+    let bufs = self.bufs.expect("buffers not available");
+    if res < 0 {
+      // On error, return buffers unchanged
+      (Err(std::io::Error::from_raw_os_error((-res) as i32)), bufs)
+    } else {
+      // On success, fill buffers in order with the bytes received
+      let peer = self.msg.peer();
+      (Ok((res as i32, peer)), after_each(bufs, res as usize))
+    }
+  }
+}
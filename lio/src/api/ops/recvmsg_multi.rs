@@ -0,0 +1,180 @@
+use std::{io, mem, net::SocketAddr, ops::Range};
+
+use crate::{
+  api::{
+    ops::iovec::{MsgHdr, RecvMsgOut},
+    resource::Resource,
+  },
+  buf::{BufRing, RingChunk},
+  net_utils::libc_socketaddr_into_std,
+  typed_op::MultishotOp,
+};
+
+/// Multishot receive of whole messages into buffers of a [`BufRing`].
+///
+/// Each completion yields one message, with the sender's address, as a
+/// [`Datagram`]. The stream ends and resumes like
+/// [`RecvMulti`](super::RecvMulti)'s.
+pub struct RecvMsgMulti {
+  res: Resource,
+  ring: BufRing,
+  flags: i32,
+  msg: MsgHdr,
+}
+
+impl RecvMsgMulti {
+  /// # Panics
+  ///
+  /// Panics if `ring`'s buffers don't fit a payload after the address and
+  /// control data laid out in front of it.
+  pub(crate) fn new(res: Resource, ring: BufRing, flags: Option<i32>) -> Self {
+    let mut msg = MsgHdr::new();
+    // SAFETY: recv_multi points into `msg`, read before it moves.
+    let (.., payload) = RecvMsgOut::offsets(unsafe { &*msg.recv_multi() });
+    assert!(
+      payload < ring.buf_len() as usize,
+      "BufRing: buffers of {} bytes can't hold a message, they need more \
+       than {payload}",
+      ring.buf_len()
+    );
+    Self { res, ring, flags: flags.unwrap_or(0), msg }
+  }
+}
+
+impl MultishotOp for RecvMsgMulti {
+  type Item = io::Result<Datagram>;
+
+  fn into_op(&mut self) -> crate::op::Op {
+    crate::op::Op::RecvMsgMulti {
+      fd: self.res.clone(),
+      // Points into `self`, which stays put until the op completes.
+      msg: self.msg.recv_multi(),
+      flags: self.flags,
+      ring: self.ring.clone(),
+    }
+  }
+
+  fn extract_item(
+    &self,
+    res: isize,
+    buf_id: Option<u16>,
+  ) -> Option<Self::Item> {
+    if res < 0 {
+      return Some(Err(io::Error::from_raw_os_error((-res) as i32)));
+    }
+    // Even an empty message fills in a header, so no buffer means EOF.
+    let bid = buf_id?;
+    Some(Datagram::new(self.ring.chunk(bid, res as usize)))
+  }
+
+  fn resumable(&self, res: isize) -> bool {
+    // Same as RecvMulti, the backend may stop early with a message.
+    res > 0 || res == -(libc::ENOBUFS as isize)
+  }
+}
+
+/// A message received by a [`RecvMsgMulti`] into a [`BufRing`] buffer.
+///
+/// Derefs to the payload. Like a [`RingChunk`], it gives the buffer back to
+/// the ring when dropped.
+pub struct Datagram {
+  chunk: RingChunk,
+  payload: Range<usize>,
+  peer: Option<SocketAddr>,
+  segment_size: Option<u16>,
+  truncated: bool,
+}
+
+impl Datagram {
+  /// Parses the buffer laid out as described by [`RecvMsgOut`].
+  fn new(chunk: RingChunk) -> io::Result<Self> {
+    let invalid = || io::Error::from(io::ErrorKind::InvalidData);
+    let out = RecvMsgOut::read(&chunk).ok_or_else(invalid)?;
+    let mut template = MsgHdr::new();
+    // SAFETY: recv_multi points into `template`, which is still alive.
+    let (name, control, payload) =
+      RecvMsgOut::offsets(unsafe { &*template.recv_multi() });
+    if chunk.len() < payload {
+      return Err(invalid());
+    }
+
+    let namelen = out.namelen as usize;
+    let peer = if namelen > 0 && namelen <= control - name {
+      // SAFETY: All zeroes is a valid sockaddr_storage.
+      let mut addr: libc::sockaddr_storage = unsafe { mem::zeroed() };
+      // SAFETY: `namelen` bytes fit both the buffer's name area and `addr`.
+      unsafe {
+        std::ptr::copy_nonoverlapping(
+          chunk[name..].as_ptr(),
+          (&raw mut addr).cast::<u8>(),
+          namelen,
+        )
+      };
+      // SAFETY: `addr` is initialized, and only read as the family says.
+      unsafe { libc_socketaddr_into_std(&addr) }.ok()
+    } else {
+      None
+    };
+
+    #[cfg(linux)]
+    let segment_size = {
+      let controllen = (out.controllen as usize).min(payload - control);
+      crate::api::ops::iovec::gro_size(&chunk[control..control + controllen])
+    };
+    #[cfg(not(linux))]
+    let segment_size = None;
+
+    let end = chunk.len().min(payload + out.payloadlen as usize);
+    Ok(Self {
+      chunk,
+      payload: payload..end,
+      peer,
+      segment_size,
+      truncated: out.flags & libc::MSG_TRUNC as u32 != 0,
+    })
+  }
+
+  /// The sender's address, `None` if it isn't an IP one.
+  pub fn peer(&self) -> Option<SocketAddr> {
+    self.peer
+  }
+
+  /// The size of the datagrams coalesced into this one by UDP generic
+  /// receive offload, see [`UdpSocket::set_gro`](crate::net::UdpSocket::set_gro).
+  /// All but the last one are exactly this long.
+  ///
+  /// `None` if it's a single datagram.
+  pub fn segment_size(&self) -> Option<u16> {
+    self.segment_size
+  }
+
+  /// The datagrams this came in as, see
+  /// [`segment_size`](Self::segment_size). Just the payload if it wasn't
+  /// coalesced.
+  pub fn segments(&self) -> std::slice::Chunks<'_, u8> {
+    let size = match self.segment_size {
+      Some(size) if size > 0 => size as usize,
+      _ => self.len().max(1),
+    };
+    self.chunks(size)
+  }
+
+  /// Whether the payload was cut off to fit the buffer, `MSG_TRUNC`.
+  pub fn is_truncated(&self) -> bool {
+    self.truncated
+  }
+}
+
+impl std::ops::Deref for Datagram {
+  type Target = [u8];
+
+  fn deref(&self) -> &[u8] {
+    &self.chunk[self.payload.clone()]
+  }
+}
+
+impl AsRef<[u8]> for Datagram {
+  fn as_ref(&self) -> &[u8] {
+    self
+  }
+}
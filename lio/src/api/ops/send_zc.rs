@@ -0,0 +1,49 @@
+use crate::{
+  BufResult, api::resource::Resource, buf::BufLike, typed_op::TypedOp,
+};
+
+/// Zero-copy [`Send`](super::Send), see [`api::send_zc`](crate::api::send_zc).
+pub struct SendZc<B>
+where
+  B: std::marker::Send + std::marker::Sync,
+{
+  res: Resource,
+  buf: Option<B>,
+  flags: i32,
+}
+
+impl<B> SendZc<B>
+where
+  B: std::marker::Send + std::marker::Sync,
+{
+  pub(crate) fn new(res: Resource, buf: B, flags: Option<i32>) -> Self {
+    Self { res, buf: Some(buf), flags: flags.unwrap_or(0) }
+  }
+}
+
+impl<B> TypedOp for SendZc<B>
+where
+  B: BufLike + std::marker::Send + std::marker::Sync + 'static,
+{
+  type Result = BufResult<i32, B>;
+
+  fn into_op(&mut self) -> crate::op::Op {
+    let slice = self.buf.as_ref().expect("buffer not available").buf();
+    let ptr = slice.as_ptr() as *mut u8;
+    let len = slice.len();
+    crate::op::Op::SendZc {
+      fd: self.res.clone(),
+      flags: self.flags,
+      buffer: crate::op::OpBuf::new(crate::op::RawBuf { ptr, len }),
+    }
+  }
+
+  fn extract_result(self, res: isize) -> Self::Result {
+    let buf = self.buf.expect("buffer not available");
+    if res < 0 {
+      (Err(std::io::Error::from_raw_os_error((-res) as i32)), buf)
+    } else {
+      (Ok(res as i32), buf.after(res as usize))
+    }
+  }
+}
@@ -0,0 +1,90 @@
+use std::net::SocketAddr;
+
+use crate::{
+  BufResult,
+  api::{
+    ops::iovec::{IoVecs, MsgHdr, after_each},
+    resource::Resource,
+  },
+  buf::BufLike,
+  typed_op::TypedOp,
+};
+
+pub struct SendMsg<B>
+where
+  B: std::marker::Send + std::marker::Sync,
+{
+  res: Resource,
+  bufs: Option<Vec<B>>,
+  to: Option<SocketAddr>,
+  flags: i32,
+  /// `UDP_SEGMENT` size to split the message by.
+  #[cfg(linux)]
+  segment_size: Option<u16>,
+  iovecs: IoVecs,
+  msg: MsgHdr,
+}
+
+impl<B> SendMsg<B>
+where
+  B: std::marker::Send + std::marker::Sync,
+{
+  pub(crate) fn new(
+    res: Resource,
+    bufs: Vec<B>,
+    to: Option<SocketAddr>,
+    flags: Option<i32>,
+  ) -> Self {
+    Self {
+      res,
+      bufs: Some(bufs),
+      to,
+      flags: flags.unwrap_or(0),
+      #[cfg(linux)]
+      segment_size: None,
+      iovecs: IoVecs::default(),
+      msg: MsgHdr::new(),
+    }
+  }
+
+  /// Has the kernel send the message as datagrams of `size` bytes each, the
+  /// last one possibly shorter (UDP generic segmentation offload).
+  #[cfg(linux)]
+  pub(crate) fn segment_size(mut self, size: u16) -> Self {
+    self.segment_size = Some(size);
+    self
+  }
+}
+
+impl<B> TypedOp for SendMsg<B>
+where
+  B: BufLike + std::marker::Send + std::marker::Sync + 'static,
+{
+  type Result = BufResult<i32, Vec<B>>;
+
+  fn into_op(&mut self) -> crate::op::Op {
+    self.iovecs =
+      IoVecs::new(self.bufs.as_ref().expect("buffers not available"));
+    #[cfg(linux)]
+    if let Some(size) = self.segment_size {
+      self.msg.segment_size(size);
+    }
+    crate::op::Op::SendMsg {
+      fd: self.res.clone(),
+      // Points into `self`, which stays put until the op completes.
+      msg: self.msg.send(&self.iovecs, self.to),
+      flags: self.flags,
+    }
+  }
+
+  fn extract_result(self, res: isize) -> Self::Result {
+    let bufs = self.bufs.expect("buffers not available");
+    if res < 0 {
+      // On error, return buffers unchanged
+      (Err(std::io::Error::from_raw_os_error((-res) as i32)), bufs)
+    } else {
+      // On success, advance buffers in order past the sent bytes
+      (Ok(res as i32), after_each(bufs, res as usize))
+    }
+  }
+}
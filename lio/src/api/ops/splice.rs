@@ -0,0 +1,54 @@
+use std::io;
+
+use crate::api::resource::Resource;
+use crate::typed_op::TypedOp;
+
+pub struct Splice {
+  res_in: Resource,
+  off_in: i64,
+  res_out: Resource,
+  size: u32,
+}
+
+assert_op_max_size!(Splice);
+
+impl Splice {
+  pub(crate) fn new(
+    res_in: Resource,
+    off_in: i64,
+    res_out: Resource,
+    size: u32,
+  ) -> Self {
+    Self { res_in, off_in, res_out, size }
+  }
+
+  pub fn to_op(self) -> crate::op::Op {
+    crate::op::Op::Splice {
+      fd_in: self.res_in,
+      off_in: self.off_in,
+      fd_out: self.res_out,
+      size: self.size,
+    }
+  }
+}
+
+impl TypedOp for Splice {
+  type Result = io::Result<i32>;
+
+  fn into_op(&mut self) -> crate::op::Op {
+    crate::op::Op::Splice {
+      fd_in: self.res_in.clone(),
+      off_in: self.off_in,
+      fd_out: self.res_out.clone(),
+      size: self.size,
+    }
+  }
+
+  fn extract_result(self, res: isize) -> Self::Result {
+    if res < 0 {
+      Err(io::Error::from_raw_os_error((-res) as i32))
+    } else {
+      Ok(res as i32)
+    }
+  }
+}
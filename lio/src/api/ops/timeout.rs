@@ -1,18 +1,15 @@
 use std::io;
 use std::time::Duration;
 
-#[cfg(linux)]
-use crate::api::resource::Resource;
 use crate::typed_op::TypedOp;
-#[cfg(target_os = "linux")]
-use std::os::fd::{FromRawFd, RawFd};
 
+/// Completes once its duration passed, see [`api::timeout`](crate::api::timeout).
+///
+/// [`Lio`](crate::Lio) keeps it on its timer wheel, no kernel timer involved.
 pub struct Timeout {
   duration: Duration,
   #[cfg(linux)]
   timespec: libc::timespec,
-  #[cfg(target_os = "linux")]
-  timer_res: Resource,
   #[cfg(all(unix, not(target_os = "linux")))]
   timer_id: u64,
 }
@@ -30,10 +27,6 @@ impl Timeout {
     duration: Duration,
     #[allow(unused)] id: u64,
   ) -> Self {
-    #[cfg(target_os = "linux")]
-    let timer_fd =
-      Self::create_timer_fd(duration).expect("Failed to create timerfd");
-
     Self {
       duration,
       #[cfg(linux)]
@@ -41,42 +34,11 @@ impl Timeout {
         tv_sec: duration.as_secs() as libc::time_t,
         tv_nsec: duration.subsec_nanos() as libc::c_long,
       },
-      #[cfg(target_os = "linux")]
-      // SAFETY: timer_fd is valid, just created by create_timer_fd above
-      timer_res: unsafe { Resource::from_raw_fd(timer_fd) },
       #[cfg(kqueue)]
       timer_id: id,
     }
   }
 
-  #[cfg(target_os = "linux")]
-  fn create_timer_fd(duration: Duration) -> std::io::Result<RawFd> {
-    use std::mem::MaybeUninit;
-
-    // Create timerfd
-    let fd = syscall!(timerfd_create(
-      libc::CLOCK_MONOTONIC,
-      libc::TFD_NONBLOCK | libc::TFD_CLOEXEC
-    ))?;
-
-    // Set the timeout
-    // SAFETY: itimerspec is a C struct where all-zeros is a valid representation
-    let mut new_value: libc::itimerspec =
-      unsafe { MaybeUninit::zeroed().assume_init() };
-    new_value.it_value.tv_sec = duration.as_secs() as libc::time_t;
-    new_value.it_value.tv_nsec = duration.subsec_nanos() as libc::c_long;
-    // it_interval is zero (no repeat)
-
-    syscall!(timerfd_settime(
-      fd,
-      0,
-      &new_value as *const libc::itimerspec,
-      std::ptr::null_mut(),
-    ))?;
-
-    Ok(fd)
-  }
-
   pub fn duration(&self) -> Duration {
     self.duration
   }
@@ -94,8 +56,6 @@ impl TypedOp for Timeout {
     crate::op::Op::Timeout {
       duration: self.duration,
       #[cfg(target_os = "linux")]
-      timer_fd: self.timer_res.clone(),
-      #[cfg(target_os = "linux")]
       timespec: &self.timespec as *const libc::timespec,
     }
   }
@@ -109,7 +69,7 @@ impl TypedOp for Timeout {
         libc::ETIME => Ok(()),
         #[cfg(any(target_os = "freebsd", target_os = "macos"))]
         libc::ETIMEDOUT => Ok(()),
-        _ => Err(io::Error::last_os_error()),
+        errno => Err(io::Error::from_raw_os_error(errno)),
       }
     }
   }
@@ -0,0 +1,49 @@
+use crate::{
+  BufResult, api::resource::Resource, buf::LentBuf, typed_op::TypedOp,
+};
+
+/// Write the valid bytes of a [`LentBuf`], using io_uring's `WRITE_FIXED`
+/// when the buffer's [`BufStore`](crate::buf::BufStore) is registered with
+/// the driver.
+///
+/// Backends without registered buffers perform a plain `write`/`pwrite`.
+pub struct WriteFixed {
+  res: Resource,
+  buf: Option<LentBuf<'static>>,
+  offset: i64,
+}
+
+impl WriteFixed {
+  /// `offset == -1` writes at the current position.
+  pub(crate) fn new(res: Resource, buf: LentBuf<'static>, offset: i64) -> Self {
+    Self { res, buf: Some(buf), offset }
+  }
+}
+
+impl TypedOp for WriteFixed {
+  type Result = BufResult<i32, LentBuf<'static>>;
+
+  fn into_op(&mut self) -> crate::op::Op {
+    let buf = self.buf.as_ref().expect("buffer not available");
+    let slice = buf.as_ref();
+    let ptr = slice.as_ptr() as *mut u8;
+    let len = slice.len();
+    crate::op::Op::WriteFixed {
+      fd: self.res.clone(),
+      offset: self.offset,
+      buf_index: u16::try_from(buf.index()).unwrap_or(u16::MAX),
+      buffer: crate::op::OpBuf::new(crate::op::RawBuf { ptr, len }),
+    }
+  }
+
+  fn extract_result(self, res: isize) -> Self::Result {
+    let mut buf = self.buf.expect("buffer not available");
+    if res < 0 {
+      (Err(std::io::Error::from_raw_os_error((-res) as i32)), buf)
+    } else {
+      // Written bytes are consumed, leaving any remainder for a retry.
+      buf.consume(res as usize);
+      (Ok(res as i32), buf)
+    }
+  }
+}
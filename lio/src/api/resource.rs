@@ -70,6 +70,8 @@
 //! ```
 
 use std::sync::Arc;
+#[cfg(linux)]
+use std::sync::PoisonError;
 
 macro_rules! impl_native_convervions {
   ($nice:ident) => {
@@ -119,27 +121,48 @@ type Inner = RawHandle;
 struct Owned {
   /// The platform-specific resource (RawFd on Unix, RawHandle on Windows)
   inner: Inner,
-  // /// Whether to automatically close this resource on drop (not yet implemented)
-  // should_close: AtomicBool,
+  /// Whether to close the resource on drop, false for one borrowed from
+  /// whoever made it.
+  close: bool,
+  /// Fixed-file table the resource is registered in and its slot, told
+  /// when the last clone goes, see [`Resource::on_drop`].
+  #[cfg(linux)]
+  fixed: std::sync::Mutex<Option<(DropQueue, u32)>>,
 }
 
+/// Slots of a fixed-file table whose resources were dropped, for the
+/// backend to clear.
+#[cfg(linux)]
+pub(crate) type DropQueue = Arc<std::sync::Mutex<Vec<u32>>>;
+
 impl Owned {
-  /// Creates a new owned resource.
-  ///
-  /// By default, `should_close` is false, meaning the resource will NOT be automatically
-  /// closed on drop. This must be explicitly enabled via `Resource::close()`.
+  /// Creates a new owned resource, closed on drop.
   fn new(inner: Inner) -> Self {
-    Self { inner /*should_close: AtomicBool::new(true)*/ }
+    Self::with_close(inner, true)
+  }
+
+  fn with_close(inner: Inner, close: bool) -> Self {
+    Self {
+      inner,
+      close,
+      #[cfg(linux)]
+      fixed: std::sync::Mutex::new(None),
+    }
   }
 }
 
 impl Drop for Owned {
-  /// Drops the owned resource, potentially closing it automatically.
-  ///
-  /// If `should_close` is true, this will close the underlying resource. Currently
-  /// unimplemented and will panic if enabled.
+  /// Drops the owned resource, closing it unless it was borrowed.
   fn drop(&mut self) {
-    // if self.should_close.load(Ordering::Acquire) {
+    #[cfg(linux)]
+    if let Some((queue, slot)) =
+      self.fixed.get_mut().unwrap_or_else(PoisonError::into_inner).take()
+    {
+      queue.lock().unwrap_or_else(PoisonError::into_inner).push(slot);
+    }
+    if !self.close {
+      return;
+    }
     let _ = syscall!(close(self.inner));
     // let op = api::close(UniqueResource(Owned {
     //   inner: self.inner,
@@ -148,7 +171,6 @@ impl Drop for Owned {
     //
     // // NOTE: Is this really neccessary?
     // let _ = op.blocking();
-    // }
   }
 }
 
@@ -282,6 +304,16 @@ impl std::os::windows::io::FromRawHandle for Resource {
 }
 
 impl Resource {
+  /// Wraps `fd` without taking ownership of it, dropping the last clone
+  /// leaves it open.
+  ///
+  /// # Safety
+  /// `fd` must stay open as long as the `Resource` or a clone of it lives.
+  #[cfg(unix)]
+  pub(crate) unsafe fn from_raw_fd_borrowed(fd: std::os::fd::RawFd) -> Self {
+    Resource(Arc::new(Owned::with_close(fd, false)))
+  }
+
   /// Returns a `Resource` for standard output (stdout).
   ///
   /// This creates a duplicate of the stdout file descriptor, so the returned
@@ -535,6 +567,42 @@ impl Resource {
   pub fn will_close(&self) -> bool {
     self.count() == 1
   }
+
+  /// Returns a handle that tells whether a `Resource` is this one, without
+  /// keeping the fd open.
+  #[cfg(unix)]
+  pub(crate) fn downgrade(&self) -> WeakResource {
+    WeakResource(Arc::downgrade(&self.0))
+  }
+
+  /// Has the last drop of the resource push `slot` to `queue`, in place of
+  /// whatever an earlier registration asked for.
+  #[cfg(linux)]
+  pub(crate) fn on_drop(&self, queue: &DropQueue, slot: u32) {
+    let mut fixed = self.0.fixed.lock().unwrap_or_else(PoisonError::into_inner);
+    *fixed = Some((queue.clone(), slot));
+  }
+}
+
+/// Identity of a [`Resource`], from [`Resource::downgrade`].
+///
+/// Backends keep these per registered fd. Fd numbers are reused once closed,
+/// the allocation behind a weak reference isn't.
+#[cfg(unix)]
+pub(crate) struct WeakResource(std::sync::Weak<Owned>);
+
+#[cfg(unix)]
+impl WeakResource {
+  /// Whether `res` is the resource this was downgraded from.
+  pub(crate) fn is(&self, res: &Resource) -> bool {
+    std::ptr::eq(self.0.as_ptr(), Arc::as_ptr(&res.0))
+  }
+
+  /// Whether every clone of the resource has been dropped.
+  #[cfg_attr(not(linux), allow(dead_code))]
+  pub(crate) fn is_dropped(&self) -> bool {
+    self.0.strong_count() == 0
+  }
 }
 
 impl std::fmt::Debug for Resource {
@@ -11,6 +11,8 @@
 //! - **[`IoBackend`]**: Unified trait for submission and completion. Each platform has
 //!   specific implementations (io_uring on Linux, kqueue on macOS/BSD, IOCP on Windows).
 //! - **[`OpStore`]**: Thread-local storage for in-flight operations.
+//! - **[`SimBackend`](sim::SimBackend)**: Wraps another backend, injecting
+//!   delays and faults for testing code on top of lio.
 //!
 //! # Design Goals
 //!
@@ -63,6 +65,8 @@ mod impls {
   ))]
   pub mod pollingv2;
 
+  pub mod sim;
+
   #[cfg(windows)]
   mod iocp;
   #[cfg(windows)]
@@ -75,8 +79,17 @@ pub use store::*;
 use std::io;
 use std::time::Duration;
 
+use crate::api::resource::Resource;
+use crate::buf::{BufRing, BufStore};
 use crate::op::Op;
 
+/// Wakes up a backend blocked in [`IoBackend::wait_timeout`], from any
+/// thread. See [`IoBackend::waker`].
+pub trait Wake: Send + Sync {
+  /// Makes the current or next wait return early.
+  fn wake(&self);
+}
+
 /// Error types that can occur when submitting operations to the backend.
 #[derive(Debug)]
 pub enum SubmitErr {
@@ -105,6 +118,16 @@ pub struct OpCompleted {
   /// - `>= 0` on success (the return value, e.g., bytes transferred)
   /// - `< 0` on error (negative errno value)
   pub(crate) result: isize,
+
+  /// More completions follow for the same operation.
+  ///
+  /// Multishot ops deliver every completion. Other ops (zero-copy sends)
+  /// complete with the result of the first one, once the final one arrives.
+  pub(crate) more: bool,
+
+  /// Id of the [`BufRing`] buffer the data landed in, for ops that select
+  /// their buffer themselves.
+  pub(crate) buf_id: Option<u16>,
 }
 
 impl OpCompleted {
@@ -115,7 +138,19 @@ impl OpCompleted {
   /// - `op_id`: The unique ID of the operation
   /// - `result`: The operation result (non-negative for success, negative errno for error)
   pub fn new(op_id: u64, result: isize) -> Self {
-    Self { op_id, result }
+    Self { op_id, result, more: false, buf_id: None }
+  }
+
+  /// Marks that the operation isn't finished and will complete again.
+  pub fn more(mut self, more: bool) -> Self {
+    self.more = more;
+    self
+  }
+
+  /// Records the [`BufRing`] buffer this completion filled.
+  pub fn buf_id(mut self, buf_id: Option<u16>) -> Self {
+    self.buf_id = buf_id;
+    self
   }
 }
 
@@ -189,4 +224,111 @@ pub trait IoBackend {
     &mut self,
     timeout: Option<Duration>,
   ) -> io::Result<&[OpCompleted]>;
+
+  /// Registers every buffer of `store` with the kernel ahead of time.
+  ///
+  /// After this, [`Op::ReadFixed`] and [`Op::WriteFixed`] on buffers lent from
+  /// `store` can skip the per-op page pinning. Must be called after
+  /// [`init`](Self::init) and at most once.
+  ///
+  /// The default implementation does nothing: backends without registered
+  /// buffers run fixed ops as their plain equivalents.
+  fn register_buf_store(&mut self, store: &'static BufStore) -> io::Result<()> {
+    let _ = store;
+    Ok(())
+  }
+
+  /// Hands every free buffer of `ring` to the kernel as provided buffers.
+  ///
+  /// Afterwards [`Op::RecvMulti`] on `ring` lets the kernel pick a buffer
+  /// per completion. Buffers released by dropped
+  /// [`RingChunk`](crate::buf::RingChunk)s must be handed back on the next
+  /// [`flush`](Self::flush).
+  ///
+  /// The default implementation does nothing: backends without provided
+  /// buffers take buffers from `ring` themselves when data is ready.
+  fn register_buf_ring(&mut self, ring: &BufRing) -> io::Result<()> {
+    let _ = ring;
+    Ok(())
+  }
+
+  /// Registers `res` in the backend's table of fixed files.
+  ///
+  /// Ops on `res` then refer to the table slot, which saves looking the fd
+  /// up on every submission. Registering a file twice is a no-op. Once every
+  /// clone of `res` is gone the registration must go by the next
+  /// [`flush`](Self::flush), or the file stays open.
+  ///
+  /// The default implementation does nothing: backends without fixed files
+  /// keep using the fd.
+  fn register_file(&mut self, res: &Resource) -> io::Result<()> {
+    let _ = res;
+    Ok(())
+  }
+
+  /// Removes `res` from the table of fixed files, if it's in there.
+  fn unregister_file(&mut self, res: &Resource) -> io::Result<()> {
+    let _ = res;
+    Ok(())
+  }
+
+  /// Pushes `ops` as one chain: each op starts only once the one before it
+  /// succeeded, and the ones after a failed op complete with `ECANCELED`.
+  /// An [`Op::LinkTimeout`] cancels the op right before it if that one is
+  /// still running once the timeout elapsed.
+  ///
+  /// Returns `false` and leaves `ops` alone if the backend can't chain ops
+  /// itself. [`Lio`](crate::Lio) then pushes them one at a time as the ones
+  /// before complete, with [`cancel`](Self::cancel) standing in for the
+  /// timeouts.
+  ///
+  /// The default implementation chains nothing.
+  fn push_chain(&mut self, ops: &mut Vec<(u64, Op)>) -> io::Result<bool> {
+    let _ = ops;
+    Ok(false)
+  }
+
+  /// Returns a handle that wakes up [`wait_timeout`](Self::wait_timeout)
+  /// from other threads, which [`LioRemote`](crate::LioRemote) uses to get
+  /// the loop to run what it submitted. Called at most once.
+  ///
+  /// The default implementation returns `None`, and remote submissions wait
+  /// for the loop to come around on its own.
+  fn waker(&mut self) -> io::Result<Option<Box<dyn Wake>>> {
+    Ok(None)
+  }
+
+  /// Like [`wait_timeout`](Self::wait_timeout), but keeps waiting until
+  /// `min` operations completed, as long as the timeout allows.
+  ///
+  /// Returning fewer is fine, [`Lio::run_min_complete`] waits again for the
+  /// rest. The default implementation waits for one.
+  ///
+  /// [`Lio::run_min_complete`]: crate::Lio::run_min_complete
+  fn wait_timeout_min(
+    &mut self,
+    min: usize,
+    timeout: Option<Duration>,
+  ) -> io::Result<&[OpCompleted]> {
+    let _ = min;
+    self.wait_timeout(timeout)
+  }
+
+  /// Cancels the in-flight op `id`, which then completes with `ECANCELED`.
+  ///
+  /// Ops that already completed, or are too far along to stop, complete as
+  /// usual. The default implementation cancels nothing.
+  fn cancel(&mut self, id: u64) -> io::Result<()> {
+    let _ = id;
+    Ok(())
+  }
+
+  /// Returns how many times an op found its fd not ready after all and had
+  /// to wait for readiness again, for [`Lio::stats`](crate::Lio::stats).
+  ///
+  /// Completion-based backends never do, which is the default.
+  #[cfg(feature = "metrics")]
+  fn rearms(&self) -> u64 {
+    0
+  }
 }
@@ -1,22 +1,30 @@
 //! `lio`-provided [`IoBackend`] impl for `io_uring`.
 
 use lio_uring::{
-  Entry, LioUring,
+  Completion, Entry, LioUring, SqeFlags,
   operation::{
-    self, Accept, Bind, Close, Connect, Fsync, Ftruncate, LinkAt, Listen,
-    OpenAt, Read, Recv, Send, Shutdown, Socket, SymlinkAt, Tee, Timeout, Write,
+    self, Accept, AcceptMulti, AsyncCancel, Bind, CancelFlags, Close, Connect,
+    Fsync, Ftruncate, LinkAt, LinkTimeout, Listen, OpenAt, PollAdd, Read,
+    ReadFixed, Readv, Recv, RecvMsg, RecvMsgMulti, RecvMulti, Send, SendMsg,
+    SendZc, Shutdown, Socket, Splice, SymlinkAt, Tee, Timeout, Write,
+    WriteFixed, Writev,
   },
 };
 
 use crate::{
-  backends::{IoBackend, OpCompleted},
+  api::resource::{DropQueue, Resource, WeakResource},
+  backends::{IoBackend, OpCompleted, OpStore, Wake},
+  buf::{BufRing, BufStore},
   op::{Op, RawBuf},
 };
-use std::io;
-use std::os::fd::AsRawFd;
+use std::io::{self, IoSlice};
+use std::os::fd::{AsRawFd, FromRawFd, OwnedFd, RawFd};
+use std::sync::PoisonError;
 use std::time::Duration;
 
-fn create_io_uring_entry(op: &Op) -> Entry {
+/// `buf_store` is the store registered as fixed buffers, if any. Fixed ops on
+/// buffers outside of it are submitted as plain reads/writes.
+fn create_io_uring_entry(op: &Op, buf_store: Option<&BufStore>) -> Entry {
   match op {
     Op::Nop => operation::Nop::new().build(),
     Op::Read { fd, buffer } => {
@@ -44,15 +52,72 @@ fn create_io_uring_entry(op: &Op) -> Entry {
       let (ptr, len) = unsafe { buffer.peek::<(*const u8, usize)>() };
       Send::new(fd.as_raw_fd(), ptr, len as u32).flags(*flags).build()
     }
+    Op::SendZc { fd, flags, buffer } => {
+      // SAFETY: OpBuf stores (ptr, len) tuple set by into_op
+      let (ptr, len) = unsafe { buffer.peek::<(*const u8, usize)>() };
+      SendZc::new(fd.as_raw_fd(), ptr, len as u32).flags(*flags).build()
+    }
     Op::Recv { fd, flags, buffer } => {
       // SAFETY: OpBuf stores RawBuf set by into_op
       let RawBuf { ptr, len } = unsafe { buffer.peek::<RawBuf>() };
       Recv::new(fd.as_raw_fd(), ptr, len as u32).flags(*flags).build()
     }
+    Op::RecvMulti { fd, flags, ring } => {
+      RecvMulti::new(fd.as_raw_fd(), ring.group()).flags(*flags).build()
+    }
+    Op::ReadFixed { fd, offset, buf_index, buffer } => {
+      // SAFETY: OpBuf stores RawBuf set by into_op
+      let RawBuf { ptr, len } = unsafe { buffer.peek::<RawBuf>() };
+      let registered =
+        buf_store.is_some_and(|s| s.owns(*buf_index as u32, ptr, len));
+      if registered {
+        ReadFixed::new(fd.as_raw_fd(), ptr, len as u32, *buf_index)
+          .offset(*offset as u64)
+          .build()
+      } else {
+        Read::new(fd.as_raw_fd(), ptr, len as u32)
+          .offset(*offset as u64)
+          .build()
+      }
+    }
+    Op::WriteFixed { fd, offset, buf_index, buffer } => {
+      // SAFETY: OpBuf stores RawBuf set by into_op
+      let RawBuf { ptr, len } = unsafe { buffer.peek::<RawBuf>() };
+      let registered =
+        buf_store.is_some_and(|s| s.owns(*buf_index as u32, ptr, len));
+      if registered {
+        WriteFixed::new(fd.as_raw_fd(), ptr, len as u32, *buf_index)
+          .offset(*offset as u64)
+          .build()
+      } else {
+        Write::new(fd.as_raw_fd(), ptr, len as u32)
+          .offset(*offset as u64)
+          .build()
+      }
+    }
+    // -1 reads and writes at the file position, like readv(2)/writev(2).
+    Op::Readv { fd, iov, iovcnt } => {
+      Readv::new(fd.as_raw_fd(), *iov, *iovcnt).offset(-1i64 as u64).build()
+    }
+    Op::Writev { fd, iov, iovcnt } => {
+      Writev::new(fd.as_raw_fd(), *iov, *iovcnt).offset(-1i64 as u64).build()
+    }
+    Op::SendMsg { fd, msg, flags } => {
+      SendMsg::new(fd.as_raw_fd(), *msg).flags(*flags as u32).build()
+    }
+    Op::RecvMsg { fd, msg, flags } => {
+      RecvMsg::new(fd.as_raw_fd(), *msg).flags(*flags as u32).build()
+    }
+    Op::RecvMsgMulti { fd, msg, flags, ring } => {
+      RecvMsgMulti::new(fd.as_raw_fd(), *msg, ring.group())
+        .flags(*flags as u32)
+        .build()
+    }
     Op::Accept { fd, addr, len } => {
       // Cast sockaddr_storage* to sockaddr*
       Accept::new(fd.as_raw_fd(), (*addr) as *mut libc::sockaddr, *len).build()
     }
+    Op::AcceptMulti { fd } => AcceptMulti::new(fd.as_raw_fd()).build(),
     Op::Connect { fd, addr, len, .. } => {
       Connect::new(fd.as_raw_fd(), (*addr) as *const libc::sockaddr, *len)
         .build()
@@ -66,8 +131,8 @@ fn create_io_uring_entry(op: &Op) -> Entry {
     Op::Socket { domain, ty, proto } => {
       Socket::new(*domain, *ty, *proto).build()
     }
-    Op::OpenAt { dir_fd, path, flags } => {
-      OpenAt::new(dir_fd.as_raw_fd(), *path).flags(*flags).build()
+    Op::OpenAt { dir_fd, path, flags, mode } => {
+      OpenAt::new(dir_fd.as_raw_fd(), *path).flags(*flags).mode(*mode).build()
     }
     Op::Close { fd } => Close::new(*fd).build(),
     Op::Fsync { fd } => Fsync::new(fd.as_raw_fd()).build(),
@@ -89,11 +154,169 @@ fn create_io_uring_entry(op: &Op) -> Entry {
     Op::Tee { fd_in, fd_out, size } => {
       Tee::new(fd_in.as_raw_fd(), fd_out.as_raw_fd(), *size).build()
     }
+    #[cfg(target_os = "linux")]
+    Op::Splice { fd_in, off_in, fd_out, size } => {
+      Splice::new(fd_in.as_raw_fd(), *off_in, fd_out.as_raw_fd(), -1, *size)
+        .build()
+    }
     Op::Timeout { timespec, .. } => {
       // __kernel_timespec has same layout as libc::timespec
       // timespec is already a pointer to data in the boxed TypedOp
       Timeout::new(*timespec as *const _).build()
     }
+    // Same layout as above, the timespec lives in the boxed TypedOp.
+    Op::LinkTimeout { timespec, .. } => {
+      LinkTimeout::new(*timespec as *const _).build()
+    }
+  }
+}
+
+/// The resource `op` works on, for ops that take a fixed file in place of
+/// their fd.
+fn fixed_target(op: &Op) -> Option<&Resource> {
+  match op {
+    Op::Read { fd, .. }
+    | Op::Write { fd, .. }
+    | Op::ReadAt { fd, .. }
+    | Op::WriteAt { fd, .. }
+    | Op::Send { fd, .. }
+    | Op::SendZc { fd, .. }
+    | Op::Recv { fd, .. }
+    | Op::RecvMulti { fd, .. }
+    | Op::ReadFixed { fd, .. }
+    | Op::WriteFixed { fd, .. }
+    | Op::Readv { fd, .. }
+    | Op::Writev { fd, .. }
+    | Op::SendMsg { fd, .. }
+    | Op::RecvMsg { fd, .. }
+    | Op::RecvMsgMulti { fd, .. }
+    | Op::Accept { fd, .. }
+    | Op::AcceptMulti { fd }
+    | Op::Connect { fd, .. }
+    | Op::Shutdown { fd, .. }
+    | Op::Fsync { fd }
+    | Op::Truncate { fd, .. } => Some(fd),
+    _ => None,
+  }
+}
+
+/// The ring's table of fixed files, see [`IoBackend::register_file`].
+///
+/// Slots hold a weak handle on their resource, so an fd number reused after
+/// the registered file was dropped doesn't resolve to the old slot.
+#[derive(Default)]
+struct FixedFiles {
+  /// Registered resource and its fd per slot, `None` for free slots.
+  slots: Vec<Option<(WeakResource, RawFd)>>,
+  /// Slot per fd number, [`FixedFiles::NONE`] where there's none.
+  by_fd: Vec<u32>,
+  free: Vec<u32>,
+  /// Slots whose resources were dropped, see [`FixedFiles::reap`].
+  dropped: DropQueue,
+}
+
+impl FixedFiles {
+  const NONE: u32 = u32::MAX;
+
+  /// Slot `res` is registered at.
+  #[inline]
+  fn slot(&self, res: &Resource) -> Option<u32> {
+    let slot = *self.by_fd.get(res.as_raw_fd() as usize)?;
+    match self.slots.get(slot as usize)? {
+      Some((owner, _)) if owner.is(res) => Some(slot),
+      _ => None,
+    }
+  }
+
+  /// Registers `res`, creating a sparse table of `len` slots the first time.
+  fn insert(
+    &mut self,
+    ring: &mut LioUring,
+    res: &Resource,
+    len: usize,
+  ) -> io::Result<()> {
+    if self.slot(res).is_some() {
+      return Ok(());
+    }
+    if self.slots.is_empty() {
+      ring.register_files(&vec![-1; len])?;
+      self.slots.resize_with(len, || None);
+      self.free = (0..len as u32).rev().collect();
+    }
+    if self.free.is_empty() {
+      self.reclaim(ring)?;
+    }
+    // Same errno the kernel uses once its own direct descriptors run out.
+    let slot =
+      self.free.pop().ok_or(io::Error::from_raw_os_error(libc::ENFILE))?;
+
+    let fd = res.as_raw_fd();
+    if let Err(err) = ring.register_files_update(slot, &[fd]) {
+      self.free.push(slot);
+      return Err(err);
+    }
+    if self.by_fd.len() <= fd as usize {
+      self.by_fd.resize(fd as usize + 1, Self::NONE);
+    }
+    self.by_fd[fd as usize] = slot;
+    self.slots[slot as usize] = Some((res.downgrade(), fd));
+    res.on_drop(&self.dropped, slot);
+    Ok(())
+  }
+
+  /// Clears the slots of resources dropped since the last call, so the
+  /// kernel lets go of their files: a socket only sends its FIN then.
+  fn reap(&mut self, ring: &mut LioUring) -> io::Result<()> {
+    let dropped = {
+      let mut dropped =
+        self.dropped.lock().unwrap_or_else(PoisonError::into_inner);
+      if dropped.is_empty() {
+        return Ok(());
+      }
+      std::mem::take(&mut *dropped)
+    };
+    for slot in dropped {
+      // The slot may have been unregistered and given to another resource
+      // since.
+      let owner = self.slots.get(slot as usize).and_then(Option::as_ref);
+      if owner.is_some_and(|(owner, _)| owner.is_dropped()) {
+        self.clear(ring, slot)?;
+      }
+    }
+    Ok(())
+  }
+
+  fn remove(&mut self, ring: &mut LioUring, res: &Resource) -> io::Result<()> {
+    match self.slot(res) {
+      Some(slot) => self.clear(ring, slot),
+      None => Ok(()),
+    }
+  }
+
+  fn clear(&mut self, ring: &mut LioUring, slot: u32) -> io::Result<()> {
+    // In-flight ops hold their own reference on the file.
+    ring.register_files_update(slot, &[-1])?;
+    if let Some((_, fd)) = self.slots[slot as usize].take()
+      && self.by_fd.get(fd as usize) == Some(&slot)
+    {
+      self.by_fd[fd as usize] = Self::NONE;
+    }
+    self.free.push(slot);
+    Ok(())
+  }
+
+  /// Frees the slots of files whose resources were all dropped without
+  /// unregistering them first, for those [`reap`](Self::reap) didn't see,
+  /// e.g. as they're registered with another ring too.
+  fn reclaim(&mut self, ring: &mut LioUring) -> io::Result<()> {
+    for slot in 0..self.slots.len() {
+      let dropped =
+        self.slots[slot].as_ref().is_some_and(|(owner, _)| owner.is_dropped());
+      if dropped {
+        self.clear(ring, slot as u32)?;
+      }
+    }
+    Ok(())
   }
 }
 
@@ -118,6 +341,120 @@ pub struct IoUring {
   ring: Option<LioUring>,
   /// Reusable buffer for completed operations (avoids allocation per poll/wait).
   completed: Vec<OpCompleted>,
+  /// Pool registered as fixed buffers, see [`IoBackend::register_buf_store`].
+  buf_store: Option<&'static BufStore>,
+  /// Provided-buffer rings, see [`IoBackend::register_buf_ring`].
+  buf_rings: Vec<(BufRing, lio_uring::BufRing)>,
+  /// Setup flags for [`init`](IoBackend::init), whose `cap` sizes the queue.
+  params: lio_uring::Params,
+  /// Registered files, see [`IoBackend::register_file`].
+  files: FixedFiles,
+  /// Capacity from [`init`](IoBackend::init), which also sizes `files`.
+  cap: usize,
+  /// Eventfd of [`waker`](IoBackend::waker), and the buffer of the read
+  /// always armed on it.
+  wake: Option<(OwnedFd, Box<u64>)>,
+  /// Zero-copy sends waiting for their first completion, by op slot.
+  zc_sends: Vec<Option<ZcSend>>,
+  /// Splices pushed on their own, by op slot, see
+  /// [`IoUring::retry_blocked`].
+  splices: Vec<Option<SpliceOut>>,
+  /// Entries pushed with an op's id or [`WAKE_KEY`] whose final completion
+  /// didn't come back yet, which [`Drop`] waits for.
+  in_flight: usize,
+}
+
+/// A pushed [`Op::Splice`], kept so it can go again once its `fd_out` has
+/// room: io_uring doesn't wait for that, a full socket fails it with
+/// `EAGAIN`.
+struct SpliceOut {
+  id: u64,
+  fd_in: RawFd,
+  off_in: i64,
+  fd_out: RawFd,
+  size: u32,
+  state: SpliceState,
+}
+
+#[derive(Clone, Copy, PartialEq, Eq)]
+enum SpliceState {
+  /// Submitted, its completion is the op's unless it's `EAGAIN`.
+  Sent,
+  /// Failed with `EAGAIN`, to be pushed again behind a poll.
+  Blocked,
+  /// Waiting for `fd_out` to turn writable. The splice linked behind the
+  /// poll completes the op, with the poll's error if the poll failed.
+  Polling,
+  /// The poll failed with this, cancelling the splice linked to it.
+  PollFailed(isize),
+}
+
+/// A pushed [`Op::SendZc`], kept in case the kernel refuses it and it has to
+/// go out as a plain send, see [`IoUring::retry_refused`].
+struct ZcSend {
+  id: u64,
+  fd: Resource,
+  flags: i32,
+  buf: RawBuf,
+  state: ZcState,
+}
+
+#[derive(Clone, Copy, PartialEq, Eq)]
+enum ZcState {
+  /// Submitted, nothing came back yet.
+  Sent,
+  /// Refused, with a notification still to come.
+  Refused,
+  /// Refused, to be pushed again as a send.
+  Retry,
+  /// Pushed again as a send, whose completion is the op's.
+  Retried,
+}
+
+/// Whether a `SEND_ZC` completing with `res` was refused by the socket
+/// (`EOPNOTSUPP`, e.g. on Unix sockets) or the kernel (`EINVAL` before 6.0).
+fn zc_refused(res: isize) -> bool {
+  res == -(libc::EOPNOTSUPP as isize) || res == -(libc::EINVAL as isize)
+}
+
+/// `user_data` of the `IORING_OP_ASYNC_CANCEL` entries [`IoBackend::cancel`]
+/// pushes. Not an op id, whose slot is always below the store's capacity.
+const CANCEL_KEY: u64 = u64::MAX;
+
+/// `user_data` of the read armed on the eventfd of [`IoBackend::waker`].
+const WAKE_KEY: u64 = u64::MAX - 1;
+
+/// Wakes the ring by writing to the eventfd its armed read waits on.
+struct EventFdWaker(OwnedFd);
+
+impl Wake for EventFdWaker {
+  fn wake(&self) {
+    let buf = 1u64.to_ne_bytes();
+    // SAFETY: `buf` is 8 bytes, the size eventfd writes must have.
+    let _ = unsafe { libc::write(self.0.as_raw_fd(), buf.as_ptr().cast(), 8) };
+  }
+}
+
+/// A zero-copy send's notification (`IORING_CQE_F_NOTIF`) comes without
+/// `IORING_CQE_F_MORE`, so it ends the op like any final completion.
+fn to_completed(c: Completion) -> OpCompleted {
+  OpCompleted::new(c.user_data(), c.result() as isize)
+    .more(c.has_more())
+    .buf_id(c.buffer_id())
+}
+
+/// Hands every free buffer of `ring` to the kernel's copy `kernel`.
+fn refill_buf_ring(ring: &BufRing, kernel: &mut lio_uring::BufRing) {
+  let mut added = 0;
+  while let Some(bid) = ring.take() {
+    // SAFETY: `bid` came off the free list, so nothing accesses the buffer
+    // until the kernel hands it back in a completion.
+    unsafe { kernel.add(ring.buf_ptr(bid), ring.buf_len(), bid, added) };
+    added += 1;
+  }
+  if added > 0 {
+    kernel.advance(added);
+  }
 }
 
 impl IoUring {
@@ -128,11 +465,47 @@ impl IoUring {
     Self::default()
   }
 
+  /// Create a backend that sets the ring up with `params`, see
+  /// [`LioBuilder`](crate::LioBuilder).
+  pub(crate) fn with_params(params: lio_uring::Params) -> Self {
+    let mut backend = Self::default();
+    backend.params = params;
+    backend
+  }
+
   #[inline]
   fn ring(&mut self) -> &mut LioUring {
     self.ring.as_mut().expect("IoUring not initialized - call init() first")
   }
 
+  /// The SQE for `op`, on its fixed file if it's registered.
+  fn entry(&self, op: &Op) -> Entry {
+    let entry = create_io_uring_entry(op, self.buf_store);
+    match fixed_target(op).and_then(|fd| self.files.slot(fd)) {
+      Some(slot) => entry.fixed_file(slot),
+      None => entry,
+    }
+  }
+
+  /// Pushes the read on the wake eventfd, which completes once a waker
+  /// wrote to it.
+  fn arm_wake(&mut self) -> io::Result<()> {
+    let Some((fd, buf)) = &mut self.wake else { return Ok(()) };
+    let entry =
+      Read::new(fd.as_raw_fd(), (&mut **buf as *mut u64).cast(), 8).build();
+    let ring = self.ring.as_mut().expect("IoUring not initialized");
+    if ring.sq_space_left() == 0 {
+      ring.submit()?;
+    }
+    // SAFETY: The buffer is boxed and lives until the read completed, see
+    // the Drop impl.
+    unsafe { ring.push(entry, WAKE_KEY) }.map_err(|_| {
+      io::Error::new(io::ErrorKind::WouldBlock, "submission queue full")
+    })?;
+    self.in_flight += 1;
+    Ok(())
+  }
+
   /// Poll for completions with optional timeout.
   ///
   /// - `timeout = None`: Block indefinitely
@@ -140,6 +513,7 @@ impl IoUring {
   /// - `timeout = Some(duration)`: Wait up to duration
   fn poll_inner(
     &mut self,
+    min: usize,
     timeout: Option<Duration>,
   ) -> io::Result<&[OpCompleted]> {
     self.completed.clear();
@@ -147,33 +521,26 @@ impl IoUring {
     let ring = self.ring.as_mut().expect("IoUring not initialized");
 
     match timeout {
+      // Lets the kernel wait for all of them, picked up below.
+      _ if min > 1 && timeout != Some(Duration::ZERO) => {
+        ring.submit_and_wait_timeout(min as u32, timeout)?;
+      }
       None => {
         // Block indefinitely for first completion
         let first = ring.wait()?;
-        self
-          .completed
-          .push(OpCompleted::new(first.user_data(), first.result() as isize));
+        self.completed.push(to_completed(first));
       }
       Some(d) if d.is_zero() => {
         // Non-blocking: check if anything is ready
         match ring.try_wait()? {
-          Some(op) => {
-            self
-              .completed
-              .push(OpCompleted::new(op.user_data(), op.result() as isize));
-          }
+          Some(op) => self.completed.push(to_completed(op)),
           None => return Ok(&[]),
         }
       }
       Some(d) => {
         // Wait with timeout
         match ring.wait_timeout(d)? {
-          Some(first) => {
-            self.completed.push(OpCompleted::new(
-              first.user_data(),
-              first.result() as isize,
-            ));
-          }
+          Some(first) => self.completed.push(to_completed(first)),
           None => return Ok(&[]), // Timeout expired
         }
       }
@@ -182,37 +549,315 @@ impl IoUring {
     // Drain any additional completions (non-blocking)
     let ring = self.ring.as_mut().expect("IoUring not initialized");
     while let Ok(Some(op)) = ring.try_wait() {
-      self
-        .completed
-        .push(OpCompleted::new(op.user_data(), op.result() as isize));
+      self.completed.push(to_completed(op));
+    }
+    self.in_flight -= self
+      .completed
+      .iter()
+      .filter(|c| !c.more && c.op_id != CANCEL_KEY)
+      .count();
+
+    // The cancelled op completes on its own, with ECANCELED if it worked.
+    // A wake only makes the wait return, and gets its read armed again.
+    let woken = self.completed.iter().any(|c| c.op_id == WAKE_KEY);
+    self.completed.retain(|c| c.op_id != CANCEL_KEY && c.op_id != WAKE_KEY);
+    if woken {
+      self.arm_wake()?;
     }
+    self.retry_refused()?;
+    self.retry_blocked()?;
 
     Ok(&self.completed)
   }
+
+  /// Keeps a pushed [`Op::SendZc`] around until its first completion.
+  fn track_zc(&mut self, id: u64, op: &Op) {
+    let Op::SendZc { fd, flags, buffer } = op else { return };
+    // SAFETY: OpBuf stores (ptr, len) tuple set by into_op
+    let (ptr, len) = unsafe { buffer.peek::<(*const u8, usize)>() };
+    let slot = OpStore::slot_of(id);
+    if self.zc_sends.len() <= slot {
+      self.zc_sends.resize_with(slot + 1, || None);
+    }
+    self.zc_sends[slot] = Some(ZcSend {
+      id,
+      fd: fd.clone(),
+      flags: *flags,
+      buf: RawBuf { ptr: ptr.cast_mut(), len },
+      state: ZcState::Sent,
+    });
+  }
+
+  /// Sends zero-copy sends the kernel refused again as plain sends, like
+  /// [`api::send_zc`](crate::api::send_zc) promises. The refusal and its
+  /// notification are dropped, so the op only sees the send's completion.
+  ///
+  /// Only sends pushed on their own are retried. In a chain the refusal
+  /// already cancelled the ops linked after it.
+  fn retry_refused(&mut self) -> io::Result<()> {
+    let zc_sends = &mut self.zc_sends;
+    let mut retry = false;
+    self.completed.retain(|c| {
+      let Some(Some(zc)) = zc_sends.get_mut(OpStore::slot_of(c.op_id)) else {
+        return true;
+      };
+      if zc.id != c.op_id {
+        return true;
+      }
+      match zc.state {
+        ZcState::Sent if zc_refused(c.result) => {
+          zc.state = if c.more { ZcState::Refused } else { ZcState::Retry };
+        }
+        // The notification of the refused send.
+        ZcState::Refused => zc.state = ZcState::Retry,
+        _ => {
+          zc_sends[OpStore::slot_of(c.op_id)] = None;
+          return true;
+        }
+      }
+      retry |= zc.state == ZcState::Retry;
+      false
+    });
+    if !retry {
+      return Ok(());
+    }
+
+    for zc in self.zc_sends.iter_mut().flatten() {
+      if zc.state != ZcState::Retry {
+        continue;
+      }
+      let RawBuf { ptr, len } = zc.buf;
+      let entry =
+        Send::new(zc.fd.as_raw_fd(), ptr, len as u32).flags(zc.flags).build();
+      let entry = match self.files.slot(&zc.fd) {
+        Some(slot) => entry.fixed_file(slot),
+        None => entry,
+      };
+      let ring = self.ring.as_mut().expect("IoUring not initialized");
+      if ring.sq_space_left() == 0 {
+        ring.submit()?;
+      }
+      // SAFETY: The buffer belongs to the op, which stays in the store until
+      // this send completes.
+      unsafe { ring.push(entry, zc.id) }.map_err(|_| {
+        io::Error::new(io::ErrorKind::WouldBlock, "submission queue full")
+      })?;
+      self.in_flight += 1;
+      zc.state = ZcState::Retried;
+    }
+    // Out right away, rather than with whatever flush comes next.
+    self.ring().submit()?;
+    Ok(())
+  }
+
+  /// Keeps a pushed [`Op::Splice`] around until it completes.
+  fn track_splice(&mut self, id: u64, op: &Op) {
+    let Op::Splice { fd_in, off_in, fd_out, size } = op else { return };
+    let slot = OpStore::slot_of(id);
+    if self.splices.len() <= slot {
+      self.splices.resize_with(slot + 1, || None);
+    }
+    self.splices[slot] = Some(SpliceOut {
+      id,
+      fd_in: fd_in.as_raw_fd(),
+      off_in: *off_in,
+      fd_out: fd_out.as_raw_fd(),
+      size: *size,
+      state: SpliceState::Sent,
+    });
+  }
+
+  /// Pushes splices that failed with `EAGAIN` again, linked behind a poll
+  /// for `POLLOUT` on their `fd_out`, like the Poller waits for it. Both go
+  /// under the op's id, so [`cancel`](IoBackend::cancel) still reaches them,
+  /// and only the splice's completion gets to the op.
+  fn retry_blocked(&mut self) -> io::Result<()> {
+    let splices = &mut self.splices;
+    let mut retry = false;
+    self.completed.retain_mut(|c| {
+      let slot = OpStore::slot_of(c.op_id);
+      let Some(Some(splice)) = splices.get_mut(slot) else { return true };
+      if splice.id != c.op_id {
+        return true;
+      }
+      match splice.state {
+        SpliceState::Sent if c.result == -(libc::EAGAIN as isize) => {
+          splice.state = SpliceState::Blocked;
+          retry = true;
+          false
+        }
+        SpliceState::Polling => {
+          splice.state = match c.result {
+            0.. => SpliceState::Sent,
+            err => SpliceState::PollFailed(err),
+          };
+          false
+        }
+        state => {
+          if let SpliceState::PollFailed(err) = state {
+            c.result = err;
+          }
+          splices[slot] = None;
+          true
+        }
+      }
+    });
+    if !retry {
+      return Ok(());
+    }
+
+    for splice in self.splices.iter_mut().flatten() {
+      if splice.state != SpliceState::Blocked {
+        continue;
+      }
+      let poll = PollAdd::new(splice.fd_out, libc::POLLOUT as u32).build();
+      let entry = Splice::new(
+        splice.fd_in,
+        splice.off_in,
+        splice.fd_out,
+        -1,
+        splice.size,
+      )
+      .build();
+      let ring = self.ring.as_mut().expect("IoUring not initialized");
+      if ring.sq_space_left() < 2 {
+        ring.submit()?;
+      }
+      // SAFETY: The poll carries no pointers. The splice's fds belong to the
+      // op, which stays in the store until the splice completes.
+      unsafe {
+        ring.push_with_flags(poll, splice.id, SqeFlags::IO_LINK)?;
+        ring.push(entry, splice.id)?;
+      }
+      self.in_flight += 2;
+      splice.state = SpliceState::Polling;
+    }
+    self.ring().submit()?;
+    Ok(())
+  }
+}
+
+/// Cancels whatever is still in flight and waits for it all to come back,
+/// zero-copy notifications included. The ring's teardown in the kernel runs
+/// on its own, so requests left in it could still touch buffers after the
+/// ring is gone, and the [`Lio`](crate::Lio) frees them right after.
+impl Drop for IoUring {
+  fn drop(&mut self) {
+    let in_flight = &mut self.in_flight;
+    let Some(ring) = self.ring.as_mut() else { return };
+    if *in_flight == 0 {
+      return;
+    }
+    let entry = AsyncCancel::new(0).flags(CancelFlags::ANY).build();
+    // Entries still queued go in first, so the cancel sees them.
+    if ring.sq_space_left() == 0 && ring.submit().is_err() {
+      return;
+    }
+    // SAFETY: The entry carries no pointers.
+    if unsafe { ring.push(entry, CANCEL_KEY) }.is_err()
+      || ring.submit().is_err()
+    {
+      return;
+    }
+    while *in_flight > 0 {
+      let c = match ring.wait() {
+        Ok(c) => c,
+        Err(err) if err.kind() == io::ErrorKind::Interrupted => continue,
+        Err(_) => return,
+      };
+      if c.user_data() != CANCEL_KEY && !c.has_more() {
+        *in_flight -= 1;
+      }
+    }
+  }
 }
 
 impl IoBackend for IoUring {
   fn init(&mut self, cap: usize) -> io::Result<()> {
-    let ring = LioUring::new(cap as u32)?;
+    let ring = LioUring::with_params(lio_uring::Params {
+      sq_entries: cap as u32,
+      ..self.params.clone()
+    })?;
     self.ring = Some(ring);
+    self.cap = cap;
     // Pre-allocate completions buffer (reasonable batch size)
     self.completed = Vec::with_capacity(cap.min(256));
     Ok(())
   }
 
   fn push(&mut self, id: u64, op: Op) -> io::Result<()> {
-    let entry = create_io_uring_entry(&op);
+    let entry = self.entry(&op);
 
     // Push to submission queue without syscall
     // SAFETY: entry is a valid SQE created from op, id is used as user_data
     unsafe { self.ring().push(entry, id) }.map_err(|_| {
       io::Error::new(io::ErrorKind::WouldBlock, "submission queue full")
     })?;
+    self.in_flight += 1;
+    self.track_zc(id, &op);
+    self.track_splice(id, &op);
 
     Ok(())
   }
 
+  /// Links the entries with `IOSQE_IO_LINK`, so the kernel runs the chain
+  /// without a trip back to the event loop between ops. A short read or
+  /// write breaks the chain like an error does.
+  fn push_chain(&mut self, ops: &mut Vec<(u64, Op)>) -> io::Result<bool> {
+    // Half a chain would link to whatever gets pushed next.
+    if self.ring().sq_space_left() < ops.len() {
+      return Err(io::Error::new(
+        io::ErrorKind::WouldBlock,
+        "submission queue full",
+      ));
+    }
+    let last = ops.len().saturating_sub(1);
+    for (i, (id, op)) in ops.drain(..).enumerate() {
+      let entry = self.entry(&op);
+      let flags = if i < last { SqeFlags::IO_LINK } else { SqeFlags::NONE };
+      // SAFETY: Same as in push, and there is room for the whole chain.
+      unsafe { self.ring().push_with_flags(entry, id, flags) }?;
+      self.in_flight += 1;
+    }
+    Ok(true)
+  }
+
+  /// An eventfd with a read always armed on it, so a write from another
+  /// thread completes the read and wakes the ring.
+  fn waker(&mut self) -> io::Result<Option<Box<dyn Wake>>> {
+    // SAFETY: eventfd has no memory safety preconditions.
+    let fd = unsafe { libc::eventfd(0, libc::EFD_CLOEXEC) };
+    if fd < 0 {
+      return Err(io::Error::last_os_error());
+    }
+    // SAFETY: `fd` was just returned by eventfd and nothing else owns it.
+    let fd = unsafe { OwnedFd::from_raw_fd(fd) };
+    let waker = EventFdWaker(fd.try_clone()?);
+    self.wake = Some((fd, Box::new(0)));
+    self.arm_wake()?;
+    Ok(Some(Box::new(waker)))
+  }
+
+  /// Submits `IORING_OP_ASYNC_CANCEL` for `id` with the next flush.
+  fn cancel(&mut self, id: u64) -> io::Result<()> {
+    // Out of room, the queue goes to the kernel now instead.
+    if self.ring().sq_space_left() == 0 {
+      self.ring().submit()?;
+    }
+    let entry = AsyncCancel::new(id).build();
+    // SAFETY: The entry only carries the user_data of the op to cancel.
+    unsafe { self.ring().push(entry, CANCEL_KEY) }.map_err(|_| {
+      io::Error::new(io::ErrorKind::WouldBlock, "submission queue full")
+    })
+  }
+
   fn flush(&mut self) -> io::Result<usize> {
+    // Buffers released by dropped chunks go back before anything new runs.
+    for (ring, kernel) in &mut self.buf_rings {
+      refill_buf_ring(ring, kernel);
+    }
+    let ring = self.ring.as_mut().expect("IoUring not initialized");
+    self.files.reap(ring)?;
     // Submit all queued operations with a single syscall
     let submitted = self.ring().submit()?;
     Ok(submitted)
@@ -222,7 +867,43 @@ impl IoBackend for IoUring {
     &mut self,
     timeout: Option<Duration>,
   ) -> io::Result<&[OpCompleted]> {
-    self.poll_inner(timeout)
+    self.poll_inner(1, timeout)
+  }
+
+  fn wait_timeout_min(
+    &mut self,
+    min: usize,
+    timeout: Option<Duration>,
+  ) -> io::Result<&[OpCompleted]> {
+    self.poll_inner(min, timeout)
+  }
+
+  fn register_buf_store(&mut self, store: &'static BufStore) -> io::Result<()> {
+    assert!(self.buf_store.is_none(), "a BufStore is already registered");
+    let slices: Vec<IoSlice<'_>> = store.io_slices();
+    // SAFETY: The store is 'static, so every registered buffer outlives the ring.
+    unsafe { self.ring().register_buffers(&slices) }?;
+    self.buf_store = Some(store);
+    Ok(())
+  }
+
+  fn register_buf_ring(&mut self, ring: &BufRing) -> io::Result<()> {
+    let mut kernel =
+      self.ring().setup_buf_ring(ring.entries() as u32, ring.group())?;
+    refill_buf_ring(ring, &mut kernel);
+    self.buf_rings.push((ring.clone(), kernel));
+    Ok(())
+  }
+
+  fn register_file(&mut self, res: &Resource) -> io::Result<()> {
+    let ring = self.ring.as_mut().expect("IoUring not initialized");
+    self.files.reap(ring)?;
+    self.files.insert(ring, res, self.cap)
+  }
+
+  fn unregister_file(&mut self, res: &Resource) -> io::Result<()> {
+    let ring = self.ring.as_mut().expect("IoUring not initialized");
+    self.files.remove(ring, res)
   }
 }
 
@@ -235,4 +916,48 @@ mod tests {
     let mut backend = IoUring::new();
     backend.init(64).unwrap();
   }
+
+  #[test]
+  fn test_register_buf_ring() {
+    let mut backend = IoUring::new();
+    backend.init(64).unwrap();
+    let ring = BufRing::new(0, 8, 1024);
+    backend.register_buf_ring(&ring).unwrap();
+    // Every buffer was handed to the kernel.
+    assert!(ring.take().is_none());
+  }
+
+  #[test]
+  fn test_register_file() {
+    let mut backend = IoUring::new();
+    backend.init(2).unwrap();
+    let a = Resource::stdout();
+    let b = Resource::stderr();
+    backend.register_file(&a).unwrap();
+    backend.register_file(&a).unwrap();
+    backend.register_file(&b).unwrap();
+    assert_eq!(backend.files.slot(&a), Some(0));
+    assert_eq!(backend.files.slot(&b), Some(1));
+
+    // Full, until a registered file is dropped.
+    let c = Resource::stdout();
+    let err = backend.register_file(&c).unwrap_err();
+    assert_eq!(err.raw_os_error(), Some(libc::ENFILE));
+    drop(a);
+    backend.register_file(&c).unwrap();
+    assert_eq!(backend.files.slot(&c), Some(0));
+
+    backend.unregister_file(&b).unwrap();
+    assert_eq!(backend.files.slot(&b), None);
+  }
+
+  #[test]
+  fn test_register_buf_store() {
+    let store: &'static BufStore =
+      Box::leak(Box::new(BufStore::with_capacity(4)));
+    let mut backend = IoUring::new();
+    backend.init(64).unwrap();
+    backend.register_buf_store(store).unwrap();
+    assert!(backend.buf_store.is_some());
+  }
 }
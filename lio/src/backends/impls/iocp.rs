@@ -21,11 +21,12 @@ use std::collections::{HashMap, HashSet};
 use std::io;
 use std::os::windows::io::{AsRawHandle, RawHandle};
 use std::ptr;
+use std::sync::{Arc, Mutex};
 use std::time::Duration;
 
 use windows_sys::Win32::Foundation::{
-  CloseHandle, ERROR_IO_PENDING, FALSE, GetLastError, HANDLE,
-  INVALID_HANDLE_VALUE, WAIT_TIMEOUT,
+  CloseHandle, ERROR_IO_PENDING, ERROR_NOT_FOUND, ERROR_OPERATION_ABORTED,
+  FALSE, GetLastError, HANDLE, INVALID_HANDLE_VALUE, WAIT_TIMEOUT,
 };
 use windows_sys::Win32::Networking::WinSock::{
   AF_INET, AF_INET6, INVALID_SOCKET, SD_BOTH, SD_RECEIVE, SD_SEND,
@@ -40,14 +41,14 @@ use windows_sys::Win32::Storage::FileSystem::{
   SetEndOfFile, SetFilePointerEx, WriteFile,
 };
 use windows_sys::Win32::System::IO::{
-  CreateIoCompletionPort, GetQueuedCompletionStatus, OVERLAPPED,
+  CancelIoEx, CreateIoCompletionPort, GetQueuedCompletionStatus, OVERLAPPED,
   PostQueuedCompletionStatus,
 };
 use windows_sys::Win32::System::Threading::{
   CreateTimerQueueTimer, DeleteTimerQueueTimer, WT_EXECUTEONLYONCE,
 };
 
-use crate::backends::{IoBackend, OpCompleted};
+use crate::backends::{IoBackend, OpCompleted, Wake};
 use crate::op::{Op, OpBuf, RawBuf};
 
 /// Marker value for wake-up notifications (not a real operation).
@@ -136,6 +137,9 @@ pub struct Iocp {
 
   /// WSA initialization flag
   wsa_initialized: bool,
+
+  /// The port as [`PortWaker`]s see it, cleared before it's closed.
+  waker_port: Option<Arc<Mutex<Option<SendHandle>>>>,
 }
 
 impl Iocp {
@@ -193,9 +197,28 @@ impl Iocp {
   }
 
   /// Convert a Windows error code to lio convention (negative errno).
+  ///
+  /// Ops stopped by `CancelIoEx` complete with `ECANCELED`, like on the
+  /// other backends.
   #[inline]
   fn error_result(error: u32) -> isize {
-    -(error as isize)
+    match error {
+      ERROR_OPERATION_ABORTED => -(libc::ECANCELED as isize),
+      _ => -(error as isize),
+    }
+  }
+
+  /// The handle an overlapped `op` was started on.
+  fn op_handle(op: &Op) -> Option<HANDLE> {
+    match op {
+      Op::Read { fd, .. }
+      | Op::ReadAt { fd, .. }
+      | Op::Write { fd, .. }
+      | Op::WriteAt { fd, .. }
+      | Op::Send { fd, .. }
+      | Op::Recv { fd, .. } => Some(fd.as_raw_handle() as HANDLE),
+      _ => None,
+    }
   }
 
   /// Run a blocking operation and return the result.
@@ -294,7 +317,7 @@ impl Iocp {
         }
       }
 
-      Op::OpenAt { dir_fd: _, path, flags } => {
+      Op::OpenAt { dir_fd: _, path, flags, mode: _ } => {
         // Windows doesn't have openat() - we require absolute paths
         // For now, just use CreateFileW with the path
         // Note: This is a simplified implementation
@@ -848,6 +871,11 @@ impl Drop for Iocp {
       }
     }
 
+    // Wakers outlive the port, so they stop posting to it first.
+    if let Some(waker_port) = &self.waker_port {
+      *waker_port.lock().unwrap() = None;
+    }
+
     // Close the completion port
     if let Some(port) = self.port {
       unsafe {
@@ -895,9 +923,37 @@ impl IoBackend for Iocp {
       Op::Send { .. } => self.start_wsa_send(id, op),
       Op::Recv { .. } => self.start_wsa_recv(id, op),
       Op::Accept { .. } => self.start_accept(id, op),
+      // Accepts one connection and completes for good. The stream then
+      // re-submits it (see `AcceptMulti::resumable`), an accept loop.
+      Op::AcceptMulti { fd } => {
+        let fd = fd.clone();
+        let accept =
+          Op::Accept { fd, addr: ptr::null_mut(), len: ptr::null_mut() };
+        self.start_accept(id, accept)
+      }
       Op::Connect { .. } => self.start_connect(id, op),
       Op::Timeout { .. } => self.start_timer(id, op),
 
+      // No registered buffers on IOCP, fixed ops run as plain reads/writes.
+      Op::ReadFixed { .. } | Op::WriteFixed { .. } => {
+        let op = match op {
+          Op::ReadFixed { fd, offset, buffer, .. } if offset < 0 => {
+            Op::Read { fd, buffer }
+          }
+          Op::ReadFixed { fd, offset, buffer, .. } => {
+            Op::ReadAt { fd, offset, buffer }
+          }
+          Op::WriteFixed { fd, offset, buffer, .. } if offset < 0 => {
+            Op::Write { fd, buffer }
+          }
+          Op::WriteFixed { fd, offset, buffer, .. } => {
+            Op::WriteAt { fd, offset, buffer }
+          }
+          _ => unreachable!(),
+        };
+        self.push(id, op)
+      }
+
       // Blocking operations
       Op::Socket { .. }
       | Op::Bind { .. }
@@ -909,6 +965,8 @@ impl IoBackend for Iocp {
       | Op::OpenAt { .. }
       | Op::LinkAt { .. }
       | Op::SymlinkAt { .. }
+      // No provided buffers on IOCP, so there is nothing to receive into.
+      | Op::RecvMulti { .. }
       | Op::Nop => {
         let result = Self::run_blocking(&op);
         self.immediate.push(ImmediateCompletion { op_id: id, result });
@@ -917,6 +975,54 @@ impl IoBackend for Iocp {
     }
   }
 
+  /// Posts `NOTIFY_KEY` like [`notify`](Iocp::notify), for as long as the
+  /// port is open.
+  fn waker(&mut self) -> io::Result<Option<Box<dyn Wake>>> {
+    let port = Arc::new(Mutex::new(Some(SendHandle(self.port()))));
+    self.waker_port = Some(port.clone());
+    Ok(Some(Box::new(PortWaker(port))))
+  }
+
+  /// Stops overlapped ops with `CancelIoEx`, whose completion then comes
+  /// through the port with `ERROR_OPERATION_ABORTED`. Blocking ops already
+  /// completed in [`push`](IoBackend::push).
+  fn cancel(&mut self, id: u64) -> io::Result<()> {
+    if let Some(timer_state) = self.active_timers.remove(&id) {
+      // Waits for a running callback, so nothing gets posted for it after.
+      unsafe {
+        DeleteTimerQueueTimer(
+          0,
+          timer_state.timer_handle,
+          INVALID_HANDLE_VALUE,
+        );
+      }
+      self.stored_ops.remove(&id);
+      self.immediate.push(ImmediateCompletion {
+        op_id: id,
+        result: -(libc::ECANCELED as isize),
+      });
+      return Ok(());
+    }
+
+    let Some(handle) = self.stored_ops.get(&id).and_then(Self::op_handle)
+    else {
+      return Ok(());
+    };
+    let Some(state) = self.active_ops.values_mut().find(|s| s.op_id == id)
+    else {
+      return Ok(());
+    };
+    let result = unsafe { CancelIoEx(handle, state.overlapped_ptr()) };
+    if result == FALSE {
+      let error = unsafe { GetLastError() };
+      // Completed already, its completion is queued on the port.
+      if error != ERROR_NOT_FOUND {
+        return Err(io::Error::from_raw_os_error(error as i32));
+      }
+    }
+    Ok(())
+  }
+
   fn flush(&mut self) -> io::Result<usize> {
     // IOCP operations are submitted immediately in push()
     Ok(0)
@@ -945,6 +1051,27 @@ impl Iocp {
 // Helper types and functions
 // ═══════════════════════════════════════════════════════════════════════════════
 
+/// A completion port handle, which any thread can post to.
+struct SendHandle(HANDLE);
+
+// SAFETY: Posting to a completion port is thread-safe.
+unsafe impl Send for SendHandle {}
+
+/// Wakes an [`Iocp`] from other threads, see [`IoBackend::waker`].
+struct PortWaker(Arc<Mutex<Option<SendHandle>>>);
+
+impl Wake for PortWaker {
+  fn wake(&self) {
+    if let Some(SendHandle(port)) = *self.0.lock().unwrap() {
+      // SAFETY: The port is open while it's set, the backend clears it
+      // before closing the port.
+      unsafe {
+        PostQueuedCompletionStatus(port, 0, NOTIFY_KEY, ptr::null_mut())
+      };
+    }
+  }
+}
+
 /// Context passed to timer callback.
 #[repr(C)]
 struct TimerCallbackContext {
@@ -0,0 +1,90 @@
+//! Worker threads for ops that readiness polling can't help with.
+//!
+//! Regular files are always "ready", so a `pread` or `fsync` on the event loop
+//! blocks every other fd on it for as long as the disk takes. The pool runs
+//! those ops on its own threads and wakes the loop through the poller's
+//! notifier once they're done.
+
+use std::sync::Arc;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::thread::JoinHandle;
+
+use crossbeam_channel::{Receiver, Sender, TrySendError};
+
+use super::{Poller, sys};
+use crate::op::Op;
+
+/// A bounded set of threads running ops through [`Poller::run_op_blocking`].
+pub(super) struct BlockingPool {
+  jobs: Option<Sender<(u64, Op)>>,
+  done: Receiver<(u64, isize)>,
+  shutdown: Arc<AtomicBool>,
+  threads: Vec<JoinHandle<()>>,
+}
+
+impl BlockingPool {
+  /// Starts `threads` workers sharing a queue of `queue` ops.
+  pub(super) fn new(
+    threads: usize,
+    queue: usize,
+    waker: sys::Waker,
+  ) -> std::io::Result<Self> {
+    let (jobs_tx, jobs_rx) = crossbeam_channel::bounded::<(u64, Op)>(queue);
+    let (done_tx, done_rx) = crossbeam_channel::unbounded();
+    let shutdown = Arc::new(AtomicBool::new(false));
+    let waker = Arc::new(waker);
+
+    let threads = (0..threads)
+      .map(|i| {
+        let jobs = jobs_rx.clone();
+        let done = done_tx.clone();
+        let shutdown = shutdown.clone();
+        let waker = waker.clone();
+        std::thread::Builder::new().name(format!("lio-blocking-{i}")).spawn(
+          move || {
+            while let Ok((id, op)) = jobs.recv() {
+              // Queued ops may point into buffers that are gone by now.
+              if shutdown.load(Ordering::Acquire) {
+                break;
+              }
+              let result = Poller::run_op_blocking(op);
+              if done.send((id, result)).is_err() {
+                break;
+              }
+              waker.wake();
+            }
+          },
+        )
+      })
+      .collect::<std::io::Result<_>>()?;
+
+    Ok(Self { jobs: Some(jobs_tx), done: done_rx, shutdown, threads })
+  }
+
+  /// Queues `op`, handing it back if the queue is full.
+  pub(super) fn try_submit(&self, id: u64, op: Op) -> Result<(), Op> {
+    let jobs = self.jobs.as_ref().expect("pool is shutting down");
+    match jobs.try_send((id, op)) {
+      Ok(()) => Ok(()),
+      Err(
+        TrySendError::Full((_, op)) | TrySendError::Disconnected((_, op)),
+      ) => Err(op),
+    }
+  }
+
+  /// Results of finished ops, as `(id, result)`.
+  pub(super) fn try_complete(&self) -> Option<(u64, isize)> {
+    self.done.try_recv().ok()
+  }
+}
+
+impl Drop for BlockingPool {
+  fn drop(&mut self) {
+    self.shutdown.store(true, Ordering::Release);
+    // Disconnects the queue, so idle workers return.
+    self.jobs = None;
+    for thread in self.threads.drain(..) {
+      let _ = thread.join();
+    }
+  }
+}
@@ -13,6 +13,10 @@ impl Interest {
   pub const READ: Self = Self { bits: 1 << 0 };
   pub const WRITE: Self = Self { bits: 1 << 1 };
   pub const TIMER: Self = Self { bits: 1 << 2 };
+  /// Register edge-triggered and persistent, instead of one-shot.
+  pub const EDGE: Self = Self { bits: 1 << 3 };
+  /// Reported along with the other flags on an error or hang-up.
+  pub const ERROR: Self = Self { bits: 1 << 4 };
   pub const READ_AND_WRITE: Self =
     Self { bits: Self::READ.bits | Self::WRITE.bits };
 
@@ -28,6 +32,14 @@ impl Interest {
     self.bits & Self::TIMER.bits != 0
   }
 
+  pub const fn is_edge(self) -> bool {
+    self.bits & Self::EDGE.bits != 0
+  }
+
+  pub const fn is_error(self) -> bool {
+    self.bits & Self::ERROR.bits != 0
+  }
+
   pub const fn is_none(self) -> bool {
     self.bits == 0
   }
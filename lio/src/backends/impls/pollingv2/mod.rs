@@ -20,10 +20,14 @@ use os::kqueue as sys;
 #[cfg(test)]
 pub(crate) mod tests;
 
+mod blocking;
+mod msg;
+mod zerocopy;
+
 use core::slice;
-use std::collections::HashMap;
+use std::collections::VecDeque;
 use std::io;
-use std::os::fd::RawFd;
+use std::os::fd::{OwnedFd, RawFd};
 use std::time::Duration;
 
 /// Get the current errno value.
@@ -54,8 +58,26 @@ fn syscall_result_ssize(ret: libc::ssize_t) -> isize {
   if ret < 0 { -(get_errno() as isize) } else { ret }
 }
 
+/// Sets `O_NONBLOCK` on `fd`, in lio convention.
+fn set_nonblocking(fd: RawFd) -> isize {
+  // SAFETY: F_GETFL/F_SETFL only read and write the fd's status flags.
+  unsafe {
+    let flags = libc::fcntl(fd, libc::F_GETFL);
+    if flags < 0 {
+      return syscall_result(flags);
+    }
+    syscall_result(libc::fcntl(fd, libc::F_SETFL, flags | libc::O_NONBLOCK))
+  }
+}
+
+/// Connections a multishot accept takes per readiness event.
+const MAX_ACCEPTS_PER_EVENT: usize = 256;
+
+/// `recvmmsg` batches a multishot recvmsg takes per readiness event.
+const MAX_RECV_BATCHES_PER_EVENT: usize = 4;
+
 use crate::backends::pollingv2::interest::Interest;
-use crate::backends::{IoBackend, OpCompleted};
+use crate::backends::{IoBackend, OpCompleted, OpStore, Wake};
 // use crate::operation::Operation;
 mod interest;
 
@@ -230,6 +252,81 @@ struct ImmediateCompletion {
   result: isize,
 }
 
+/// An op registered with the OS poller, waiting for readiness.
+struct Waiting {
+  /// Full op id, the slot alone doesn't tell generations apart.
+  id: u64,
+  /// The fd it's registered on (the duration in ms for kqueue timers).
+  fd: RawFd,
+  op: crate::op::Op,
+  /// The timerfd of a [`Op::Timeout`](crate::op::Op::Timeout) on epoll,
+  /// closed along with the entry.
+  timer: Option<OwnedFd>,
+}
+
+/// An fd registered for good in edge-triggered mode, with the ops waiting on
+/// it in submission order.
+struct FdState {
+  /// Tells the registered fd apart from a later one reusing its number.
+  owner: crate::api::resource::WeakResource,
+  readers: VecDeque<u64>,
+  writers: VecDeque<u64>,
+}
+
+/// A timerfd armed to go off once after `duration`.
+#[cfg(target_os = "linux")]
+fn timer_fd(duration: Duration) -> io::Result<OwnedFd> {
+  use std::os::fd::FromRawFd;
+
+  let fd = syscall!(timerfd_create(
+    libc::CLOCK_MONOTONIC,
+    libc::TFD_NONBLOCK | libc::TFD_CLOEXEC
+  ))?;
+  // SAFETY: fd was just created and is owned by nothing else.
+  let fd = unsafe { OwnedFd::from_raw_fd(fd) };
+
+  // SAFETY: itimerspec is a C struct where all-zeros is a valid
+  // representation, a zero it_interval doesn't repeat.
+  let mut value: libc::itimerspec = unsafe { std::mem::zeroed() };
+  value.it_value.tv_sec = duration.as_secs() as libc::time_t;
+  value.it_value.tv_nsec = duration.subsec_nanos() as libc::c_long;
+  syscall!(timerfd_settime(
+    std::os::fd::AsRawFd::as_raw_fd(&fd),
+    0,
+    &value as *const libc::itimerspec,
+    std::ptr::null_mut(),
+  ))?;
+  Ok(fd)
+}
+
+/// Event key of an fd registered in edge-triggered mode, or for its error
+/// queue in one-shot mode, see [`Poller::watch_errqueue`].
+///
+/// Counts down from below the notifier's `u64::MAX`. An op id only gets up
+/// here with a slot past 2^31, far more ops than a store holds.
+fn fd_key(fd: RawFd) -> u64 {
+  u64::MAX - 1 - fd as u64
+}
+
+/// The fd behind `key`, if it's one from [`fd_key`].
+fn key_fd(key: u64) -> Option<RawFd> {
+  let fd = (u64::MAX - 1).checked_sub(key)?;
+  RawFd::try_from(fd).ok()
+}
+
+/// What running a waiting op on readiness came to.
+enum Progress {
+  /// It would block, so keep waiting for readiness.
+  Blocked,
+  /// A multishot op used up its budget for this event, with more to do.
+  Yielded,
+  /// Its final completion was pushed.
+  Done,
+  /// A zero-copy send went out, its final completion comes once the kernel
+  /// notifies on the fd's error queue, see [`zerocopy`].
+  Sent,
+}
+
 /// Polling-based I/O backend for epoll (Linux) and kqueue (BSD/macOS).
 ///
 /// This backend uses readiness-based polling to handle I/O operations.
@@ -253,10 +350,10 @@ struct ImmediateCompletion {
 pub struct Poller {
   /// The OS-specific polling mechanism (epoll/kqueue)
   sys: Option<sys::OsPoller>,
-  /// Map of operation ID to file descriptor (for cleanup)
-  fd_map: Option<HashMap<u64, RawFd>>,
-  /// Map of operation ID to Op (for completion)
-  op_map: std::collections::HashMap<u64, crate::op::Op>,
+  /// Ops waiting for readiness, indexed by [`OpStore::slot_of`] their id.
+  ///
+  /// [`OpStore::slot_of`]: crate::backends::OpStore::slot_of
+  waiting: Vec<Option<Waiting>>,
   /// Event buffer for polling
   events: Events,
   /// Immediate completions (operations that completed without polling)
@@ -264,6 +361,24 @@ pub struct Poller {
 
   /// Reusing the completed allocation.
   completed: Vec<OpCompleted>,
+
+  /// `(threads, queue)` of the pool [`init`](IoBackend::init) starts, if any.
+  blocking_config: Option<(usize, usize)>,
+  /// Runs blocking ops off the event loop, see [`Poller::with_blocking_pool`].
+  blocking: Option<blocking::BlockingPool>,
+
+  /// Keeps socket fds registered, see [`Poller::edge_triggered`].
+  edge: bool,
+  /// Edge-triggered fds and their waiters, indexed by fd.
+  fds: Vec<Option<FdState>>,
+  /// Fd queues to run at the next wait without an event, as no new edge
+  /// comes for readiness that is already there.
+  retry: Vec<(RawFd, Interest)>,
+  /// Zero-copy sends waiting for their notification.
+  zerocopy: zerocopy::ZeroCopy,
+  /// Attempts that would have blocked, see [`IoBackend::rearms`].
+  #[cfg(feature = "metrics")]
+  rearms: u64,
 }
 
 impl Poller {
@@ -272,14 +387,317 @@ impl Poller {
     Self::default()
   }
 
+  /// Runs blocking file ops on `threads` worker threads instead of the event
+  /// loop.
+  ///
+  /// Covers `ReadAt`, `WriteAt`, `Read`, `Write`, `Fsync`, `OpenAt` and
+  /// `Truncate`, which readiness can't tell apart from ready on regular
+  /// files: without a pool one slow `fsync` stalls every socket on the loop.
+  /// Finished ops wake the loop through the poller's notifier. At most
+  /// `queue` ops wait for a worker, past that they run inline again.
+  ///
+  /// # Panics
+  ///
+  /// Panics if `threads` or `queue` is zero.
+  ///
+  /// # Example
+  ///
+  /// ```
+  /// use lio::{Lio, backends::pollingv2::Poller};
+  ///
+  /// let lio = Lio::new_with_backend(Poller::new().with_blocking_pool(4, 256), 1024).unwrap();
+  /// ```
+  pub fn with_blocking_pool(mut self, threads: usize, queue: usize) -> Self {
+    assert!(threads > 0 && queue > 0, "blocking pool needs threads and queue");
+    self.blocking_config = Some((threads, queue));
+    self
+  }
+
+  /// Registers socket fds once, edge-triggered, instead of arming a one-shot
+  /// registration per op.
+  ///
+  /// An fd stays registered for as long as its [`Resource`] lives, with
+  /// read and write waiters queued per fd, so a recv loop on a socket costs
+  /// no `epoll_ctl`/`kevent` calls after the first. Queued ops are tried at
+  /// the next wait before it blocks, and again on every edge until they
+  /// would block. Covers `Send`, `Recv`, `Accept`, `Connect`, the fixed
+  /// buffer and multishot ops; timeouts and `Tee` stay one-shot.
+  ///
+  /// Fds are switched to `O_NONBLOCK` the first time they are registered.
+  ///
+  /// # Example
+  ///
+  /// ```
+  /// use lio::{Lio, backends::pollingv2::Poller};
+  ///
+  /// let lio = Lio::new_with_backend(Poller::new().edge_triggered(), 1024).unwrap();
+  /// ```
+  ///
+  /// [`Resource`]: crate::api::resource::Resource
+  pub fn edge_triggered(mut self) -> Self {
+    self.edge = true;
+    self
+  }
+
   #[inline]
   fn sys(&self) -> &sys::OsPoller {
     self.sys.as_ref().expect("Poller not initialized - call init() first")
   }
 
-  #[inline]
-  fn fd_map(&mut self) -> &mut HashMap<u64, RawFd> {
-    self.fd_map.as_mut().expect("Poller not initialized - call init() first")
+  /// Parks `op` in its slab slot until `fd` is ready.
+  fn insert_waiting(
+    &mut self,
+    id: u64,
+    fd: RawFd,
+    op: crate::op::Op,
+    timer: Option<OwnedFd>,
+  ) {
+    let slot = OpStore::slot_of(id);
+    if slot >= self.waiting.len() {
+      // Only with ids from a store bigger than the `init` capacity.
+      self.waiting.resize_with(slot + 1, || None);
+    }
+    debug_assert!(self.waiting[slot].is_none(), "slot {slot} is taken");
+    self.waiting[slot] = Some(Waiting { id, fd, op, timer });
+  }
+
+  /// The op waiting on event key `id`. Takes the slab alone, so the result
+  /// doesn't borrow the rest of the poller.
+  fn find_waiting(waiting: &[Option<Waiting>], id: u64) -> &Waiting {
+    match waiting.get(OpStore::slot_of(id)) {
+      Some(Some(waiting)) if waiting.id == id => waiting,
+      _ => panic!("couldn't find op for operation {id}"),
+    }
+  }
+
+  /// The fd an op waits on in edge-triggered mode, and the queue it waits in.
+  /// `None` for ops that keep one-shot registrations.
+  fn edge_fd(
+    op: &crate::op::Op,
+  ) -> Option<(&crate::api::resource::Resource, Interest)> {
+    use crate::op::Op;
+
+    match op {
+      Op::Recv { fd, .. }
+      | Op::RecvMsg { fd, .. }
+      | Op::RecvMulti { fd, .. }
+      | Op::RecvMsgMulti { fd, .. }
+      | Op::Accept { fd, .. }
+      | Op::AcceptMulti { fd }
+      | Op::ReadFixed { fd, .. } => Some((fd, Interest::READ)),
+      Op::Send { fd, .. }
+      | Op::SendZc { fd, .. }
+      | Op::SendMsg { fd, .. }
+      | Op::Connect { fd, .. }
+      | Op::WriteFixed { fd, .. } => Some((fd, Interest::WRITE)),
+      _ => None,
+    }
+  }
+
+  /// Queues `op` on its fd in edge-triggered mode, registering the fd the
+  /// first time it's seen.
+  fn push_edge(&mut self, id: u64, op: crate::op::Op) -> io::Result<()> {
+    use crate::op::Op;
+    use std::os::fd::AsRawFd;
+
+    let (res, interest) = Poller::edge_fd(&op).expect("not an edge op");
+    let fd = res.as_raw_fd();
+    let registered = matches!(
+      self.fds.get(fd as usize),
+      Some(Some(state)) if state.owner.is(res)
+    );
+    if !registered && let Err(e) = self.register_edge(fd, res) {
+      // Same as a failed one-shot registration.
+      let errno = e.raw_os_error().unwrap_or(libc::EIO);
+      let result = Poller::run_op_blocking(op);
+      let result = if result < 0 { result } else { -(errno as isize) };
+      self.immediate.push(ImmediateCompletion { id, result });
+      return Ok(());
+    }
+
+    // These already ran once in `push`.
+    let tried = matches!(
+      op,
+      Op::Connect { .. } | Op::ReadFixed { .. } | Op::WriteFixed { .. }
+    );
+    let Some(state) = &mut self.fds[fd as usize] else { unreachable!() };
+    let queue = if interest.is_readable() {
+      &mut state.readers
+    } else {
+      &mut state.writers
+    };
+    // Behind other waiters it runs when they stop blocking; first in line,
+    // it may not see another edge for readiness that's already there.
+    if queue.is_empty() && !tried {
+      self.retry.push((fd, interest));
+    }
+    queue.push_back(id);
+    self.insert_waiting(id, fd, op, None);
+    Ok(())
+  }
+
+  /// Registers `fd` edge-triggered for reads and writes, for as long as
+  /// `res` lives.
+  fn register_edge(
+    &mut self,
+    fd: RawFd,
+    res: &crate::api::resource::Resource,
+  ) -> io::Result<()> {
+    let result = set_nonblocking(fd);
+    if result < 0 {
+      return Err(io::Error::from_raw_os_error(-result as i32));
+    }
+    let interest = Interest::READ_AND_WRITE | Interest::EDGE;
+    match self.sys().add(fd, fd_key(fd), interest) {
+      // The number was reused while its old file was still registered,
+      // e.g. through a dup.
+      Err(e) if e.raw_os_error() == Some(libc::EEXIST) => {
+        self.sys().modify(fd, fd_key(fd), interest)?
+      }
+      result => result?,
+    }
+
+    let fd = fd as usize;
+    if fd >= self.fds.len() {
+      self.fds.resize_with(fd + 1, || None);
+    }
+    match &mut self.fds[fd] {
+      // Waiters hold the old resource, so it can't have any.
+      Some(state) => state.owner = res.downgrade(),
+      slot => {
+        *slot = Some(FdState {
+          owner: res.downgrade(),
+          readers: VecDeque::new(),
+          writers: VecDeque::new(),
+        })
+      }
+    }
+    Ok(())
+  }
+
+  /// Runs the ops waiting on `fd` for `interest` in order, until one of them
+  /// would block.
+  fn run_fd_waiters(&mut self, fd: RawFd, interest: Interest) {
+    if interest.is_error() {
+      self.zerocopy.drain(fd, &mut self.completed);
+    }
+    let Some(Some(state)) = self.fds.get_mut(fd as usize) else { return };
+    let queues = [
+      (Interest::READ, interest.is_readable(), &mut state.readers),
+      (Interest::WRITE, interest.is_writable(), &mut state.writers),
+    ];
+    for (queue_interest, ready, queue) in queues {
+      if !ready && !interest.is_error() {
+        continue;
+      }
+      while let Some(&id) = queue.front() {
+        #[cfg(target_os = "linux")]
+        if let Some(ran) =
+          msg::run_queued(fd, queue, &self.waiting, &mut self.completed)
+        {
+          if ran == 0 {
+            #[cfg(feature = "metrics")]
+            {
+              self.rearms += 1;
+            }
+            break;
+          }
+          for id in queue.drain(..ran) {
+            self.waiting[OpStore::slot_of(id)] = None;
+          }
+          continue;
+        }
+        let waiting = Poller::find_waiting(&self.waiting, id);
+        let progress = Poller::attempt(
+          id,
+          &waiting.op,
+          &mut self.completed,
+          &mut self.zerocopy,
+        );
+        #[cfg(feature = "metrics")]
+        if matches!(progress, Progress::Blocked | Progress::Yielded) {
+          self.rearms += 1;
+        }
+        match progress {
+          Progress::Blocked => break,
+          Progress::Yielded => {
+            self.retry.push((fd, queue_interest));
+            break;
+          }
+          // The fd's registration already reports its error queue.
+          Progress::Done | Progress::Sent => {
+            queue.pop_front();
+            self.waiting[OpStore::slot_of(id)] = None;
+          }
+        }
+      }
+    }
+  }
+
+  /// Runs the queues [`push_edge`](Self::push_edge) and multishot budgets
+  /// left for later.
+  fn run_retries(&mut self) {
+    let mut retry = std::mem::take(&mut self.retry);
+    for (fd, interest) in retry.drain(..) {
+      self.run_fd_waiters(fd, interest);
+    }
+    // Keeps the allocation, unless running them queued more.
+    if self.retry.is_empty() {
+      self.retry = retry;
+    }
+  }
+
+  /// Runs a waiting op on readiness, pushing its completions.
+  fn attempt(
+    id: u64,
+    op: &crate::op::Op,
+    completed: &mut Vec<OpCompleted>,
+    zerocopy: &mut zerocopy::ZeroCopy,
+  ) -> Progress {
+    use crate::op::Op;
+
+    if let Op::RecvMulti { .. }
+    | Op::RecvMsgMulti { .. }
+    | Op::AcceptMulti { .. } = op
+    {
+      return Poller::multishot_on_event(id, op, completed);
+    }
+    if let Op::SendZc { .. } = op {
+      return zerocopy.send(id, op, completed);
+    }
+    let result = Poller::run_op_on_event(op);
+    let errno = (-result) as i32;
+    if result < 0
+      && (errno == libc::EAGAIN
+        || errno == libc::EWOULDBLOCK
+        || errno == libc::EINPROGRESS
+        || errno == libc::EALREADY)
+    {
+      return Progress::Blocked;
+    }
+    completed.push(OpCompleted::new(id, result));
+    Progress::Done
+  }
+
+  /// Moves the blocking pool's finished ops into `completed`.
+  fn drain_blocking(&mut self) {
+    let Some(pool) = &self.blocking else { return };
+    while let Some((id, result)) = pool.try_complete() {
+      self.completed.push(OpCompleted::new(id, result));
+    }
+  }
+
+  /// Handles an event on the error queue registration of `fd`, which
+  /// one-shot mode keeps for as long as zero-copy sends on it are pending.
+  ///
+  /// Only ERR/HUP are reported on it, so it doesn't take part in readiness.
+  fn watch_errqueue(&mut self, fd: RawFd) -> io::Result<()> {
+    self.zerocopy.drain(fd, &mut self.completed);
+    if self.zerocopy.has_pending(fd) {
+      self.sys().modify(fd, fd_key(fd), Interest::NONE)
+    } else {
+      self.sys().delete(fd)
+    }
   }
 
   /// Run an op by reference using peek (no ownership transfer of buffers).
@@ -322,7 +740,9 @@ impl Poller {
           libc::pwrite(fd, ptr as *const _, len, *offset)
         })
       }
-      Op::Send { fd, flags, buffer } => {
+      // Only reached when registering the fd failed, so no error queue
+      // would be watched: send with a copy.
+      Op::Send { fd, flags, buffer } | Op::SendZc { fd, flags, buffer } => {
         let fd = fd.as_raw_fd();
         // SAFETY: ErasedBuffer stores (ptr, len) tuple set by into_op.
         let (ptr, len) = unsafe { buffer.peek::<(*mut u8, usize)>() };
@@ -340,11 +760,86 @@ impl Poller {
           libc::recv(fd, ptr as *mut _, len, *flags)
         })
       }
+      Op::ReadFixed { fd, offset, buffer, .. } => {
+        let fd = fd.as_raw_fd();
+        // SAFETY: ErasedBuffer stores RawBuf set by into_op
+        let crate::op::RawBuf { ptr, len } =
+          unsafe { buffer.peek::<crate::op::RawBuf>() };
+        // SAFETY: fd is valid (from AsRawFd), ptr/len from buffer are valid per Op invariants.
+        syscall_result_ssize(unsafe {
+          if *offset < 0 {
+            libc::read(fd, ptr as *mut _, len)
+          } else {
+            libc::pread(fd, ptr as *mut _, len, *offset)
+          }
+        })
+      }
+      Op::WriteFixed { fd, offset, buffer, .. } => {
+        let fd = fd.as_raw_fd();
+        // SAFETY: ErasedBuffer stores RawBuf set by into_op
+        let crate::op::RawBuf { ptr, len } =
+          unsafe { buffer.peek::<crate::op::RawBuf>() };
+        // SAFETY: fd is valid (from AsRawFd), ptr/len from buffer are valid per Op invariants.
+        syscall_result_ssize(unsafe {
+          if *offset < 0 {
+            libc::write(fd, ptr as *const _, len)
+          } else {
+            libc::pwrite(fd, ptr as *const _, len, *offset)
+          }
+        })
+      }
+      // SAFETY: fd is valid (from AsRawFd), the iovecs point into buffers
+      // owned by the typed op.
+      Op::Readv { fd, iov, iovcnt } => syscall_result_ssize(unsafe {
+        libc::readv(fd.as_raw_fd(), *iov, *iovcnt as libc::c_int)
+      }),
+      // SAFETY: Same as Readv.
+      Op::Writev { fd, iov, iovcnt } => syscall_result_ssize(unsafe {
+        libc::writev(fd.as_raw_fd(), *iov, *iovcnt as libc::c_int)
+      }),
+      // SAFETY: fd is valid (from AsRawFd), msg and everything it points at
+      // are owned by the typed op.
+      Op::SendMsg { fd, msg, flags } => syscall_result_ssize(unsafe {
+        libc::sendmsg(fd.as_raw_fd(), *msg, *flags)
+      }),
+      // SAFETY: Same as SendMsg.
+      Op::RecvMsg { fd, msg, flags } => syscall_result_ssize(unsafe {
+        libc::recvmsg(fd.as_raw_fd(), *msg, *flags)
+      }),
       // SAFETY: fd is valid (from AsRawFd), addr/len are valid pointers from Op.
       Op::Accept { fd, addr, len } => unsafe {
         syscall_result(libc::accept(fd.as_raw_fd(), *addr as *mut _, *len))
       },
       Op::Timeout { .. } => 0,
+      // Lio runs chains itself here and never pushes these.
+      Op::LinkTimeout { .. } => -(libc::EINVAL as isize),
+      #[cfg(target_os = "linux")]
+      // SAFETY: fd_in/fd_out are valid (from AsRawFd), size is a valid length.
+      Op::Tee { fd_in, fd_out, size } => syscall_result_ssize(unsafe {
+        libc::tee(
+          fd_in.as_raw_fd(),
+          fd_out.as_raw_fd(),
+          *size as libc::size_t,
+          libc::SPLICE_F_NONBLOCK,
+        )
+      }),
+      #[cfg(target_os = "linux")]
+      Op::Splice { fd_in, off_in, fd_out, size } => {
+        let mut off = *off_in;
+        let off_ptr = if off < 0 { std::ptr::null_mut() } else { &raw mut off };
+        // SAFETY: fd_in/fd_out are valid (from AsRawFd), off_ptr is null or
+        // points to `off`, which outlives the call.
+        syscall_result_ssize(unsafe {
+          libc::splice(
+            fd_in.as_raw_fd(),
+            off_ptr,
+            fd_out.as_raw_fd(),
+            std::ptr::null_mut(),
+            *size as libc::size_t,
+            libc::SPLICE_F_MOVE | libc::SPLICE_F_NONBLOCK,
+          )
+        })
+      }
       Op::Connect { fd, addr, len, connect_called } => {
         let fd = fd.as_raw_fd();
         // SAFETY: fd is valid (from AsRawFd), addr is valid pointer from TypedOp.
@@ -368,6 +863,96 @@ impl Poller {
     }
   }
 
+  /// Runs a multishot op on readiness, pushing one completion per result.
+  fn multishot_on_event(
+    id: u64,
+    op: &crate::op::Op,
+    completed: &mut Vec<OpCompleted>,
+  ) -> Progress {
+    use crate::op::Op;
+    use std::os::fd::AsRawFd;
+
+    let is_would_block = |result: isize| {
+      result == -(libc::EAGAIN as isize)
+        || result == -(libc::EWOULDBLOCK as isize)
+    };
+
+    match op {
+      Op::RecvMulti { fd, flags, ring } => {
+        // Every chunk holds a buffer until the consumer drops it, so this
+        // runs at most `ring.entries()` times.
+        loop {
+          let Some(bid) = ring.take() else {
+            completed.push(OpCompleted::new(id, -(libc::ENOBUFS as isize)));
+            return Progress::Done;
+          };
+          // SAFETY: fd is valid (from AsRawFd), the buffer is ours until
+          // `bid` is put back or handed out in a completion.
+          let result = syscall_result_ssize(unsafe {
+            libc::recv(
+              fd.as_raw_fd(),
+              ring.buf_ptr(bid).cast(),
+              ring.buf_len() as usize,
+              // The fd may be blocking, and this loops until it would block.
+              *flags | libc::MSG_DONTWAIT,
+            )
+          });
+          if result > 0 {
+            completed
+              .push(OpCompleted::new(id, result).more(true).buf_id(Some(bid)));
+            continue;
+          }
+          ring.put(bid);
+          if is_would_block(result) {
+            return Progress::Blocked;
+          }
+          completed.push(OpCompleted::new(id, result));
+          return Progress::Done;
+        }
+      }
+      Op::AcceptMulti { fd } => {
+        // Bounded so a connection storm can't starve the other events, the
+        // re-armed registration fires again right away if more are queued.
+        for _ in 0..MAX_ACCEPTS_PER_EVENT {
+          // SAFETY: fd is valid (from AsRawFd), null addr/len is allowed.
+          let result = syscall_result(unsafe {
+            libc::accept(
+              fd.as_raw_fd(),
+              std::ptr::null_mut(),
+              std::ptr::null_mut(),
+            )
+          });
+          if result >= 0 || result == -(libc::ECONNABORTED as isize) {
+            completed.push(OpCompleted::new(id, result).more(true));
+            continue;
+          }
+          if is_would_block(result) {
+            return Progress::Blocked;
+          }
+          completed.push(OpCompleted::new(id, result));
+          return Progress::Done;
+        }
+        Progress::Yielded
+      }
+      Op::RecvMsgMulti { .. } => msg::recv_multi(id, op, completed),
+      _ => panic!("multishot_on_event called for non-multishot op"),
+    }
+  }
+
+  /// Runs `op` on the blocking pool if there is one with room, right here
+  /// otherwise.
+  fn run_blocking(&mut self, id: u64, op: crate::op::Op) {
+    let op = match &self.blocking {
+      Some(pool) => match pool.try_submit(id, op) {
+        Ok(()) => return,
+        Err(op) => op,
+      },
+      None => op,
+    };
+    let result = Poller::run_op_blocking(op);
+    self.immediate.push(ImmediateCompletion { id, result });
+  }
+
   fn run_op_blocking(op: crate::op::Op) -> isize {
     use crate::op::Op;
     use std::os::fd::AsRawFd;
@@ -423,10 +1008,32 @@ impl Poller {
           libc::recv(fd, ptr as *mut _, len, flags)
         })
       }
+      // No registered buffers here, fixed ops are plain reads/writes.
+      op @ (Op::ReadFixed { .. }
+      | Op::WriteFixed { .. }
+      | Op::SendZc { .. }
+      | Op::Readv { .. }
+      | Op::Writev { .. }
+      | Op::SendMsg { .. }
+      | Op::RecvMsg { .. }) => Self::run_op_on_event(&op),
+      #[cfg(target_os = "linux")]
+      op @ Op::Splice { .. } => Self::run_op_on_event(&op),
+      // Only reached when registering the fd failed; report why.
+      Op::RecvMulti { fd, flags, .. } | Op::RecvMsgMulti { fd, flags, .. } => {
+        // SAFETY: fd is valid (from AsRawFd), a zero-length recv writes nothing.
+        syscall_result_ssize(unsafe {
+          libc::recv(fd.as_raw_fd(), std::ptr::null_mut(), 0, flags)
+        })
+      }
       // SAFETY: fd is valid (from AsRawFd), addr/len are valid pointers from Op.
       Op::Accept { fd, addr, len } => unsafe {
         syscall_result(libc::accept(fd.as_raw_fd(), addr as *mut _, len))
       },
+      // Only reached when registering the fd failed; report why.
+      // SAFETY: fd is valid (from AsRawFd), F_GETFL takes no argument.
+      Op::AcceptMulti { fd } => unsafe {
+        syscall_result(libc::fcntl(fd.as_raw_fd(), libc::F_GETFL))
+      },
       Op::Connect { fd, addr, len, connect_called } => {
         let fd = fd.as_raw_fd();
         // SAFETY: fd is valid (from AsRawFd), addr is valid pointer from TypedOp.
@@ -466,8 +1073,13 @@ impl Poller {
         syscall_result(libc::socket(domain, ty, proto))
       },
       // SAFETY: dir_fd is valid (from AsRawFd), path is a valid C string from Op.
-      Op::OpenAt { dir_fd, path, flags } => unsafe {
-        syscall_result(libc::openat(dir_fd.as_raw_fd(), path, flags))
+      Op::OpenAt { dir_fd, path, flags, mode } => unsafe {
+        syscall_result(libc::openat(
+          dir_fd.as_raw_fd(),
+          path,
+          flags,
+          mode as libc::c_uint,
+        ))
       },
       // SAFETY: fd is a valid raw fd from Op (ownership transferred to close).
       Op::Close { fd } => unsafe { syscall_result(libc::close(fd)) },
@@ -507,19 +1119,29 @@ impl Poller {
         std::thread::sleep(duration);
         0
       }
+      Op::LinkTimeout { .. } => -(libc::EINVAL as isize),
       Op::Nop => 0,
     }
   }
 }
 
+impl Wake for sys::Waker {
+  fn wake(&self) {
+    sys::Waker::wake(self)
+  }
+}
+
 impl IoBackend for Poller {
   fn init(&mut self, cap: usize) -> io::Result<()> {
     self.sys = Some(sys::OsPoller::new()?);
-    self.fd_map = Some(HashMap::with_capacity(cap));
-    self.op_map = std::collections::HashMap::with_capacity(cap);
+    self.waiting = (0..cap).map(|_| None).collect();
     self.events = Events::with_capacity(cap.min(4096));
     self.immediate = Vec::with_capacity(64);
     self.completed = Vec::with_capacity(cap.min(256));
+    if let Some((threads, queue)) = self.blocking_config {
+      let waker = self.sys().waker()?;
+      self.blocking = Some(blocking::BlockingPool::new(threads, queue, waker)?);
+    }
     Ok(())
   }
 
@@ -528,41 +1150,113 @@ impl IoBackend for Poller {
     use crate::op::Op;
     use std::os::fd::AsRawFd;
 
-    let fd_and_interest = match &op {
+    #[cfg_attr(not(target_os = "linux"), allow(unused_mut))]
+    let mut timer = None;
+    let (fd, interest) = match &op {
       Op::ReadAt { .. }
       | Op::WriteAt { .. }
       | Op::Read { .. }
-      | Op::Write { .. } => {
-        let result = Poller::run_op_blocking(op);
-        self.immediate.push(ImmediateCompletion { id, result });
+      | Op::Write { .. }
+      | Op::Readv { .. }
+      | Op::Writev { .. }
+      | Op::Fsync { .. }
+      | Op::OpenAt { .. }
+      | Op::Truncate { .. } => {
+        self.run_blocking(id, op);
         return Ok(());
       }
-      Op::Send { fd, .. } => Some((fd.as_raw_fd(), Interest::WRITE)),
-      Op::Recv { fd, .. } => Some((fd.as_raw_fd(), Interest::READ)),
-      Op::Accept { fd, .. } => Some((fd.as_raw_fd(), Interest::READ)),
-      Op::Connect { .. } => None,
+      // Files and sockets both end up here, so try the op right away and
+      // only wait for readiness if it would block.
+      Op::ReadFixed { fd, .. } | Op::WriteFixed { fd, .. } => {
+        let result = Poller::run_op_on_event(&op);
+        if result != -(libc::EAGAIN as isize)
+          && result != -(libc::EWOULDBLOCK as isize)
+        {
+          self.immediate.push(ImmediateCompletion { id, result });
+          return Ok(());
+        }
+        let interest = if matches!(op, Op::ReadFixed { .. }) {
+          Interest::READ
+        } else {
+          Interest::WRITE
+        };
+        (fd.as_raw_fd(), interest)
+      }
+      Op::Send { fd, .. } | Op::SendZc { fd, .. } | Op::SendMsg { fd, .. } => {
+        (fd.as_raw_fd(), Interest::WRITE)
+      }
+      Op::Recv { fd, .. } | Op::RecvMsg { fd, .. } => {
+        (fd.as_raw_fd(), Interest::READ)
+      }
+      Op::RecvMulti { fd, .. } | Op::RecvMsgMulti { fd, .. } => {
+        (fd.as_raw_fd(), Interest::READ)
+      }
+      Op::Accept { fd, .. } => (fd.as_raw_fd(), Interest::READ),
+      Op::AcceptMulti { fd } => {
+        // Each readiness event drains the backlog, which must not block.
+        let result = set_nonblocking(fd.as_raw_fd());
+        if result < 0 {
+          self.immediate.push(ImmediateCompletion { id, result });
+          return Ok(());
+        }
+        (fd.as_raw_fd(), Interest::READ)
+      }
+      // Waits for writability only once the connect is in progress.
+      Op::Connect { fd, .. } => {
+        let fd = fd.as_raw_fd();
+        let result = Poller::run_op_on_event(&op);
+        if result != -(libc::EINPROGRESS as isize) {
+          self.immediate.push(ImmediateCompletion { id, result });
+          return Ok(());
+        }
+        (fd, Interest::WRITE)
+      }
       Op::Bind { .. }
       | Op::Listen { .. }
       | Op::Shutdown { .. }
-      | Op::OpenAt { .. }
-      | Op::Close { .. }
-      | Op::Fsync { .. }
-      | Op::Truncate { .. } => {
+      | Op::Socket { .. }
+      | Op::Close { .. } => {
         let result = Poller::run_op_blocking(op);
         self.immediate.push(ImmediateCompletion { id, result });
         return Ok(());
       }
       #[cfg(target_os = "linux")]
-      Op::Tee { fd_in, .. } => {
-        Some((fd_in.as_raw_fd(), Interest::READ_AND_WRITE))
+      Op::Tee { fd_in, .. } => (fd_in.as_raw_fd(), Interest::READ_AND_WRITE),
+      // Tried right away like the fixed ops. The other end is a file or a
+      // pipe with data in it, so only `fd_out` filling up makes it block.
+      #[cfg(target_os = "linux")]
+      Op::Splice { fd_out, .. } => {
+        let result = Poller::run_op_on_event(&op);
+        if result != -(libc::EAGAIN as isize) {
+          self.immediate.push(ImmediateCompletion { id, result });
+          return Ok(());
+        }
+        (fd_out.as_raw_fd(), Interest::WRITE)
+      }
+      // An armed timerfd turns readable on expiry. Lio keeps its timeouts
+      // on its own wheel, so this is only for ops pushed here directly.
+      #[cfg(target_os = "linux")]
+      Op::Timeout { duration, .. } => {
+        if duration.is_zero() {
+          self.immediate.push(ImmediateCompletion { id, result: 0 });
+          return Ok(());
+        }
+        let fd = timer_fd(*duration)?;
+        let raw = fd.as_raw_fd();
+        timer = Some(fd);
+        (raw, Interest::READ)
+      }
+      // kqueue timers take the duration in ms where the fd would go, and
+      // fire once it elapsed.
+      #[cfg(not(target_os = "linux"))]
+      Op::Timeout { duration, .. } => {
+        (duration.as_millis() as RawFd, Interest::TIMER)
       }
-      Op::Timeout { .. } => None,
-      Op::Nop => {
+      Op::Nop | Op::LinkTimeout { .. } => {
         let result = Poller::run_op_blocking(op);
         self.immediate.push(ImmediateCompletion { id, result });
         return Ok(());
       }
-      Op::Socket { .. } => None,
       Op::LinkAt { .. } | Op::SymlinkAt { .. } => {
         let result = Poller::run_op_blocking(op);
         self.immediate.push(ImmediateCompletion { id, result });
@@ -570,53 +1264,76 @@ impl IoBackend for Poller {
       }
     };
 
-    self.op_map.insert(id, op);
-
-    if let Some((fd, interest)) = fd_and_interest {
-      self.fd_map().insert(id, fd);
-      if let Err(e) = self.sys().add(fd, id, interest) {
-        // Registration failed (e.g., EBADF for invalid fd).
-        // Return as immediate completion with error instead of propagating.
-        self.fd_map().remove(&id);
-        let op = self.op_map.remove(&id).unwrap();
-        let errno = e.raw_os_error().unwrap_or(libc::EIO);
-        // Try the operation anyway - it will fail with a proper error
-        let result = Poller::run_op_blocking(op);
-        let final_result = if result < 0 { result } else { -(errno as isize) };
-        self.immediate.push(ImmediateCompletion { id, result: final_result });
-        return Ok(());
+    let mut op = op;
+    if let Op::Connect { connect_called, .. } = &mut op {
+      // From here on EISCONN means the in-progress connect went through.
+      *connect_called = true;
+    }
+
+    if self.edge && Poller::edge_fd(&op).is_some() {
+      return self.push_edge(id, op);
+    }
+
+    if let Err(e) = self.sys().add(fd, id, interest) {
+      // Registration failed (e.g., EBADF for invalid fd).
+      // Return as immediate completion with error instead of propagating.
+      let errno = e.raw_os_error().unwrap_or(libc::EIO);
+      // Try the operation anyway - it will fail with a proper error
+      let result = Poller::run_op_blocking(op);
+      let final_result = if result < 0 { result } else { -(errno as isize) };
+      self.immediate.push(ImmediateCompletion { id, result: final_result });
+      return Ok(());
+    }
+    self.insert_waiting(id, fd, op, timer);
+
+    Ok(())
+  }
+
+  /// Takes back ops still waiting for readiness. Ones already handed to the
+  /// blocking pool, or sent and waiting for their zero-copy notification,
+  /// run to completion.
+  fn cancel(&mut self, id: u64) -> io::Result<()> {
+    use crate::op::Op;
+
+    let slot = OpStore::slot_of(id);
+    let Some(Waiting { fd, op, timer, .. }) = self
+      .waiting
+      .get_mut(slot)
+      .and_then(|entry| entry.take_if(|waiting| waiting.id == id))
+    else {
+      return Ok(());
+    };
+
+    if self.edge && Poller::edge_fd(&op).is_some() {
+      // The fd stays registered for the other waiters.
+      if let Some(Some(state)) = self.fds.get_mut(fd as usize) {
+        state.readers.retain(|&waiter| waiter != id);
+        state.writers.retain(|&waiter| waiter != id);
       }
+    } else if cfg!(not(target_os = "linux")) && matches!(op, Op::Timeout { .. })
+    {
+      self.sys().delete_timer(id)?;
     } else {
-      match &self.op_map[&id] {
-        Op::Connect { fd, .. } => {
-          let fd = fd.as_raw_fd();
-          let result =
-            Poller::run_op_blocking(self.op_map.remove(&id).unwrap());
-          if result == -(libc::EINPROGRESS as isize) {
-            self.fd_map().insert(id, fd);
-            self.sys().add(fd, id, Interest::WRITE)?;
-          } else {
-            self.immediate.push(ImmediateCompletion { id, result });
-          }
-        }
-        Op::Timeout { duration, .. } => {
-          let duration_ms = duration.as_millis() as RawFd;
-          self.fd_map().insert(id, duration_ms);
-          self.sys().add(duration_ms, id, Interest::TIMER)?;
-          // op stays in op_map; kqueue fires when duration elapses
-        }
-        Op::Socket { .. } => {
-          let result =
-            Poller::run_op_blocking(self.op_map.remove(&id).unwrap());
-          self.immediate.push(ImmediateCompletion { id, result });
-        }
-        _ => {}
-      }
+      self.sys().delete(fd)?;
     }
-
+    drop(timer);
+    self
+      .immediate
+      .push(ImmediateCompletion { id, result: -(libc::ECANCELED as isize) });
     Ok(())
   }
 
+  /// A duplicate of the poller's own notifier, eventfd or pipe on epoll and
+  /// `EVFILT_USER` on kqueue.
+  fn waker(&mut self) -> io::Result<Option<Box<dyn Wake>>> {
+    Ok(Some(Box::new(self.sys().waker()?)))
+  }
+
+  #[cfg(feature = "metrics")]
+  fn rearms(&self) -> u64 {
+    self.rearms
+  }
+
   fn flush(&mut self) -> io::Result<usize> {
     // For epoll/kqueue, operations are registered immediately in push()
     // since each registration is a separate syscall anyway.
@@ -639,6 +1356,12 @@ impl IoBackend for Poller {
     for imm in self.immediate.drain(..) {
       self.completed.push(OpCompleted::new(imm.id, imm.result));
     }
+    self.drain_blocking();
+    self.run_retries();
+
+    // Don't block on readiness with completions already in hand.
+    let timeout =
+      if self.completed.is_empty() { timeout } else { Some(Duration::ZERO) };
 
     // Poll for events
     // Get reference to sys before mutating events to avoid borrow conflict
@@ -660,10 +1383,11 @@ impl IoBackend for Poller {
     // SAFETY: The OS's wait() call filled items_written events into our buffer
     unsafe { self.events.set_len(items_written) };
 
-    // Collect events first to avoid borrow conflicts
-    let events_to_process: Vec<_> = self.events.iter().collect();
+    // Workers may be what woke us up.
+    self.drain_blocking();
 
-    for event in events_to_process {
+    for index in 0..self.events.len() {
+      let event = self.events.get_event(index);
       let operation_id = event.key;
 
       // Skip internal notification events
@@ -671,32 +1395,40 @@ impl IoBackend for Poller {
         continue;
       }
 
-      // Look up fd from our internal map
-      let Some(entry_fd) = self.fd_map().get(&operation_id).copied() else {
-        panic!("couldn't find fd for operation {}", operation_id);
-      };
-
-      // Remove op temporarily; put it back on EAGAIN
-      let op = match self.op_map.remove(&operation_id) {
-        Some(op) => op,
-        None => {
-          panic!("couldn't find op for operation {}", operation_id);
+      if let Some(fd) = key_fd(operation_id) {
+        if self.edge {
+          self.run_fd_waiters(fd, event.interest);
+        } else {
+          self.watch_errqueue(fd)?;
         }
-      };
-      let result = Poller::run_op_on_event(&op);
-
-      // Check for EAGAIN/EINPROGRESS (would block)
-      if result < 0 {
-        let errno = (-result) as i32;
-        if errno == libc::EAGAIN
-          || errno == libc::EWOULDBLOCK
-          || errno == libc::EINPROGRESS
-        {
-          // Put op back and re-arm for more events
-          self.op_map.insert(operation_id, op);
+        continue;
+      }
+
+      let waiting = Poller::find_waiting(&self.waiting, operation_id);
+      let entry_fd = waiting.fd;
+      let progress = Poller::attempt(
+        operation_id,
+        &waiting.op,
+        &mut self.completed,
+        &mut self.zerocopy,
+      );
+      match progress {
+        Progress::Blocked | Progress::Yielded => {
+          // Still waiting, re-arm for more events
+          #[cfg(feature = "metrics")]
+          {
+            self.rearms += 1;
+          }
           self.sys().modify(entry_fd, operation_id, event.interest)?;
           continue;
         }
+        Progress::Sent => {
+          // The fd's registration moves over to its error queue.
+          self.waiting[OpStore::slot_of(operation_id)] = None;
+          self.sys().modify(entry_fd, fd_key(entry_fd), Interest::NONE)?;
+          continue;
+        }
+        Progress::Done => {}
       }
 
       // Operation completed (success or error other than would-block)
@@ -706,10 +1438,8 @@ impl IoBackend for Poller {
       } else {
         self.sys().delete(entry_fd)?;
       }
-      let was_deleted = self.fd_map().remove(&operation_id).is_some();
-      assert!(was_deleted);
-
-      self.completed.push(OpCompleted::new(operation_id, result));
+      // Only now, this closes the timerfd of a timeout.
+      self.waiting[OpStore::slot_of(operation_id)] = None;
     }
 
     Ok(self.completed.as_ref())
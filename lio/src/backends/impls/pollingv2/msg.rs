@@ -0,0 +1,252 @@
+//! Messages several to a syscall: queued [`Op::SendMsg`]s and
+//! [`Op::RecvMsg`]s of an fd go out as one `sendmmsg`/`recvmmsg` on Linux,
+//! and [`Op::RecvMsgMulti`] fills its ring buffers the same way.
+//!
+//! Elsewhere a batch is a single message, run with `sendmsg`/`recvmsg`.
+
+#[cfg(target_os = "linux")]
+use std::collections::VecDeque;
+use std::os::fd::{AsRawFd, RawFd};
+
+use super::{MAX_RECV_BATCHES_PER_EVENT, Progress};
+#[cfg(target_os = "linux")]
+use super::{Poller, Waiting, syscall_result};
+use crate::api::ops::iovec::RecvMsgOut;
+use crate::backends::OpCompleted;
+use crate::op::Op;
+
+/// Most messages per syscall.
+#[cfg(target_os = "linux")]
+const MAX_BATCH: usize = 32;
+#[cfg(not(target_os = "linux"))]
+const MAX_BATCH: usize = 1;
+
+#[cfg(target_os = "linux")]
+use libc::mmsghdr;
+
+/// `struct mmsghdr` where libc has none; batches hold one of them.
+#[cfg(not(target_os = "linux"))]
+#[allow(non_camel_case_types)]
+#[derive(Clone, Copy)]
+struct mmsghdr {
+  msg_hdr: libc::msghdr,
+  msg_len: libc::c_uint,
+}
+
+fn would_block(result: isize) -> bool {
+  result == -(libc::EAGAIN as isize) || result == -(libc::EWOULDBLOCK as isize)
+}
+
+/// Runs `msgs` with `recvmmsg`, returning how many came in.
+#[cfg(target_os = "linux")]
+fn recv_batch(fd: RawFd, msgs: &mut [mmsghdr], flags: i32) -> isize {
+  // SAFETY: fd is valid, each header points at memory owned by its op or
+  // ring buffer. There's no timeout to wait for.
+  syscall_result(unsafe {
+    libc::recvmmsg(
+      fd,
+      msgs.as_mut_ptr(),
+      msgs.len() as u32,
+      flags,
+      std::ptr::null_mut(),
+    )
+  })
+}
+
+/// Runs the one message of `msgs` with `recvmsg`.
+#[cfg(not(target_os = "linux"))]
+fn recv_batch(fd: RawFd, msgs: &mut [mmsghdr], flags: i32) -> isize {
+  // SAFETY: fd is valid, the header points at memory owned by its op or
+  // ring buffer.
+  let result = super::syscall_result_ssize(unsafe {
+    libc::recvmsg(fd, &mut msgs[0].msg_hdr, flags)
+  });
+  if result < 0 {
+    return result;
+  }
+  msgs[0].msg_len = result as libc::c_uint;
+  1
+}
+
+/// Runs the run of [`Op::SendMsg`]s or [`Op::RecvMsg`]s at the front of
+/// `queue`, all waiting on `fd`, with one `sendmmsg`/`recvmmsg`.
+///
+/// Returns how many completed, 0 if they would block, or `None` if the
+/// front op isn't one of a run of at least two. Only sends with an address
+/// are batched: on a stream socket a short write ends a `sendmsg`, but
+/// `sendmmsg` would go on with the next message.
+#[cfg(target_os = "linux")]
+pub(super) fn run_queued(
+  fd: RawFd,
+  queue: &VecDeque<u64>,
+  waiting: &[Option<Waiting>],
+  completed: &mut Vec<OpCompleted>,
+) -> Option<usize> {
+  /// The header, flags and direction of a batchable op.
+  fn batchable(op: &Op) -> Option<(*mut libc::msghdr, i32, bool)> {
+    match op {
+      Op::SendMsg { msg, flags, .. } => {
+        // SAFETY: The typed op owns the header until the op is done.
+        let addressed = !unsafe { &**msg }.msg_name.is_null();
+        addressed.then_some((msg.cast_mut(), *flags, true))
+      }
+      Op::RecvMsg { msg, flags, .. } => Some((*msg, *flags, false)),
+      _ => None,
+    }
+  }
+
+  let (_, flags, send) =
+    batchable(&Poller::find_waiting(waiting, *queue.front()?).op)?;
+  let mut headers = [std::ptr::null_mut(); MAX_BATCH];
+  let mut count = 0;
+  for &id in queue.iter().take(MAX_BATCH) {
+    match batchable(&Poller::find_waiting(waiting, id).op) {
+      Some((msg, f, s)) if f == flags && s == send => headers[count] = msg,
+      _ => break,
+    }
+    count += 1;
+  }
+  if count < 2 {
+    return None;
+  }
+
+  // SAFETY: A zeroed mmsghdr is valid, the headers are copied in below.
+  let mut msgs: [mmsghdr; MAX_BATCH] = unsafe { std::mem::zeroed() };
+  for (msg, &header) in msgs.iter_mut().zip(&headers[..count]) {
+    // SAFETY: The typed ops own their headers until they're done.
+    msg.msg_hdr = unsafe { *header };
+  }
+  let msgs = &mut msgs[..count];
+  let result = if send {
+    // SAFETY: fd is valid, the headers point at memory owned by their ops.
+    syscall_result(unsafe {
+      libc::sendmmsg(fd, msgs.as_mut_ptr(), count as u32, flags)
+    })
+  } else {
+    recv_batch(fd, msgs, flags)
+  };
+
+  if would_block(result) || result == 0 {
+    return Some(0);
+  }
+  let front = *queue.front().unwrap();
+  if result < 0 {
+    // The first message failed, the rest didn't run.
+    completed.push(OpCompleted::new(front, result));
+    return Some(1);
+  }
+  let ran = result as usize;
+  for ((msg, &header), &id) in msgs.iter().zip(&headers).zip(queue).take(ran) {
+    if !send {
+      // What recvmsg would have written back.
+      // SAFETY: Same as when copying the headers in.
+      let header = unsafe { &mut *header };
+      header.msg_namelen = msg.msg_hdr.msg_namelen;
+      header.msg_controllen = msg.msg_hdr.msg_controllen;
+      header.msg_flags = msg.msg_hdr.msg_flags;
+    }
+    completed.push(OpCompleted::new(id, msg.msg_len as isize));
+  }
+  Some(ran)
+}
+
+/// Runs a [`Op::RecvMsgMulti`] on readiness: receives until the socket would
+/// block, a batch of messages per syscall, laying each ring buffer out like
+/// io_uring does (see [`RecvMsgOut`]).
+///
+/// Bounded so a flooded socket can't starve the other events, the re-armed
+/// registration fires again right away if more are queued.
+pub(super) fn recv_multi(
+  id: u64,
+  op: &Op,
+  completed: &mut Vec<OpCompleted>,
+) -> Progress {
+  let Op::RecvMsgMulti { fd, msg, flags, ring } = op else {
+    panic!("recv_multi called for a non-RecvMsgMulti op");
+  };
+  // SAFETY: The typed op owns the header until the op is done.
+  let template = unsafe { &**msg };
+  let (name, control, payload) = RecvMsgOut::offsets(template);
+  // The payload's full length comes back like on io_uring, on Linux.
+  #[cfg(target_os = "linux")]
+  let flags = *flags | libc::MSG_TRUNC;
+  #[cfg(not(target_os = "linux"))]
+  let flags = *flags;
+
+  for _ in 0..MAX_RECV_BATCHES_PER_EVENT {
+    let mut bids = [0u16; MAX_BATCH];
+    let mut count = 0;
+    while count < MAX_BATCH
+      && let Some(bid) = ring.take()
+    {
+      bids[count] = bid;
+      count += 1;
+    }
+    if count == 0 {
+      completed.push(OpCompleted::new(id, -(libc::ENOBUFS as isize)));
+      return Progress::Done;
+    }
+
+    // SAFETY: Zeroed iovecs and headers are valid, filled in below.
+    let mut iovecs: [libc::iovec; MAX_BATCH] = unsafe { std::mem::zeroed() };
+    // SAFETY: Same as above.
+    let mut msgs: [mmsghdr; MAX_BATCH] = unsafe { std::mem::zeroed() };
+    for i in 0..count {
+      let base = ring.buf_ptr(bids[i]);
+      let len = ring.buf_len() as usize;
+      // SAFETY: The ring buffer is ours until its id is put back or handed
+      // out, and the typed op checked it's longer than `payload`.
+      unsafe {
+        iovecs[i] = libc::iovec {
+          iov_base: base.add(payload).cast(),
+          iov_len: len - payload,
+        };
+        let hdr = &mut msgs[i].msg_hdr;
+        hdr.msg_name = base.add(name).cast();
+        hdr.msg_namelen = template.msg_namelen;
+        hdr.msg_control = base.add(control).cast();
+        hdr.msg_controllen = template.msg_controllen;
+      }
+      msgs[i].msg_hdr.msg_iov = &mut iovecs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // The fd may be blocking, and this loops until it would block.
+    let result = recv_batch(
+      fd.as_raw_fd(),
+      &mut msgs[..count],
+      flags | libc::MSG_DONTWAIT,
+    );
+    let ran = result.max(0) as usize;
+    for (msg, &bid) in msgs.iter().zip(&bids).take(ran) {
+      let hdr = &msg.msg_hdr;
+      let out = RecvMsgOut {
+        namelen: hdr.msg_namelen,
+        controllen: hdr.msg_controllen as u32,
+        payloadlen: msg.msg_len,
+        flags: hdr.msg_flags as u32,
+      };
+      // SAFETY: Ring buffers are longer than the header, see above.
+      unsafe { out.write(ring.buf_ptr(bid)) };
+      let filled =
+        (msg.msg_len as usize).min(ring.buf_len() as usize - payload);
+      completed.push(
+        OpCompleted::new(id, (payload + filled) as isize)
+          .more(true)
+          .buf_id(Some(bid)),
+      );
+    }
+    for &bid in &bids[ran..count] {
+      ring.put(bid);
+    }
+    if result > 0 {
+      continue;
+    }
+    if would_block(result) {
+      return Progress::Blocked;
+    }
+    completed.push(OpCompleted::new(id, result));
+    return Progress::Done;
+  }
+  Progress::Yielded
+}
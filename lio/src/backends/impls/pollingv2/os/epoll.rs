@@ -70,6 +70,34 @@ impl OsPoller {
 
     Ok(epoll)
   }
+
+  /// Returns a handle that wakes up [`wait`](ReadinessPoll::wait) from any
+  /// thread, like [`notify`](ReadinessPoll::notify).
+  pub fn waker(&self) -> io::Result<Waker> {
+    let (fd, eventfd) = match &self.notifier {
+      #[cfg(not(target_os = "redox"))]
+      Notifier::EventFd(fd) => (fd.try_clone()?, true),
+      Notifier::Pipe { write_pipe, .. } => (write_pipe.try_clone()?, false),
+    };
+    Ok(Waker { fd, eventfd })
+  }
+}
+
+/// Wakes up an [`OsPoller`] from another thread.
+///
+/// Holds its own duplicate of the notifier fd, so it stays valid on its own.
+pub struct Waker {
+  fd: OwnedFd,
+  eventfd: bool,
+}
+
+impl Waker {
+  pub fn wake(&self) {
+    // An eventfd only accepts 8-byte writes.
+    let buf: [u8; 8] = 1u64.to_ne_bytes();
+    let len = if self.eventfd { buf.len() } else { 1 };
+    let _ = syscall!(write(self.fd.as_raw_fd(), buf.as_ptr().cast(), len));
+  }
 }
 impl Drop for OsPoller {
   fn drop(&mut self) {
@@ -94,8 +122,12 @@ impl ReadinessPoll for OsPoller {
       events |= libc::EPOLLOUT as u32;
     }
 
-    // Use EPOLLONESHOT for consistency with kqueue's EV_ONESHOT behavior
-    events |= libc::EPOLLONESHOT as u32;
+    if interest.is_edge() {
+      events |= libc::EPOLLET as u32;
+    } else {
+      // Use EPOLLONESHOT for consistency with kqueue's EV_ONESHOT behavior
+      events |= libc::EPOLLONESHOT as u32;
+    }
     // Note: EPOLLHUP and EPOLLERR are always reported by the kernel regardless of registration
 
     let mut event = libc::epoll_event { events, u64: key as u64 };
@@ -122,8 +154,12 @@ impl ReadinessPoll for OsPoller {
       events |= libc::EPOLLOUT as u32;
     }
 
-    // Use EPOLLONESHOT for consistency with kqueue's EV_ONESHOT behavior
-    events |= libc::EPOLLONESHOT as u32;
+    if interest.is_edge() {
+      events |= libc::EPOLLET as u32;
+    } else {
+      // Use EPOLLONESHOT for consistency with kqueue's EV_ONESHOT behavior
+      events |= libc::EPOLLONESHOT as u32;
+    }
     // Note: EPOLLHUP and EPOLLERR are always reported by the kernel regardless of registration
 
     let mut event = libc::epoll_event { events, u64: key as u64 };
@@ -276,12 +312,14 @@ impl ReadinessPoll for OsPoller {
     let error_or_hup = is_hup || is_err || is_rdhup;
     let effective_readable = readable || error_or_hup;
 
-    match (effective_readable, writable) {
+    let interest = match (effective_readable, writable) {
       (true, true) => Interest::READ_AND_WRITE,
       (true, false) => Interest::READ,
       (false, true) => Interest::WRITE,
       (false, false) => Interest::READ, // Fallback, shouldn't happen
-    }
+    };
+    // Lets edge-triggered writers see errors that don't set EPOLLOUT.
+    if error_or_hup { interest | Interest::ERROR } else { interest }
   }
 }
 
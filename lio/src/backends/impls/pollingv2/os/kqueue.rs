@@ -52,6 +52,12 @@ impl OsPoller {
     Ok(kqueue)
   }
 
+  /// Returns a handle that wakes up [`wait`](ReadinessPoll::wait) from any
+  /// thread, like [`notify`](ReadinessPoll::notify).
+  pub fn waker(&self) -> io::Result<Waker> {
+    Ok(Waker { kq_fd: self.kq_fd.try_clone()? })
+  }
+
   pub(crate) fn submit_changes(
     &self,
     changelist: &[<Self as ReadinessPoll>::NativeEvent],
@@ -122,6 +128,10 @@ impl OsPoller {
       return Ok(());
     }
 
+    // EV_CLEAR keeps the filter registered and reports each change once.
+    let mode =
+      if interest.is_edge() { libc::EV_CLEAR } else { libc::EV_ONESHOT };
+
     // SAFETY: libc::kevent is a C struct that is safe to zero-initialize.
     // All fields are primitive integers/pointers where zero is a valid bit pattern.
     let mut changes: [libc::kevent; 2] = unsafe { std::mem::zeroed() };
@@ -131,7 +141,7 @@ impl OsPoller {
       changes[n] = libc::kevent {
         ident: fd as libc::uintptr_t,
         filter: libc::EVFILT_READ,
-        flags: libc::EV_ADD | libc::EV_ENABLE | libc::EV_ONESHOT,
+        flags: libc::EV_ADD | libc::EV_ENABLE | mode,
         fflags: 0,
         data: 0,
         udata: key as *mut libc::c_void,
@@ -144,7 +154,7 @@ impl OsPoller {
       changes[n] = libc::kevent {
         ident: fd as libc::uintptr_t,
         filter: libc::EVFILT_WRITE,
-        flags: libc::EV_ADD | libc::EV_ENABLE | libc::EV_ONESHOT,
+        flags: libc::EV_ADD | libc::EV_ENABLE | mode,
         fflags: 0,
         data: 0,
         udata: key as *mut libc::c_void,
@@ -201,6 +211,35 @@ impl OsPoller {
   }
 }
 
+/// Wakes up an [`OsPoller`] from another thread.
+///
+/// Holds its own duplicate of the kqueue fd, which triggers the same
+/// `EVFILT_USER` event as [`notify`](ReadinessPoll::notify).
+pub struct Waker {
+  kq_fd: OwnedFd,
+}
+
+impl Waker {
+  pub fn wake(&self) {
+    let kev = libc::kevent {
+      ident: NOTIFY_IDENT as libc::uintptr_t,
+      filter: libc::EVFILT_USER,
+      flags: 0,
+      fflags: libc::NOTE_TRIGGER,
+      data: 0,
+      udata: NOTIFY_IDENT as *mut libc::c_void,
+    };
+    let _ = syscall!(kevent(
+      self.kq_fd.as_raw_fd(),
+      &kev as *const libc::kevent,
+      1,
+      ptr::null_mut(),
+      0,
+      ptr::null(),
+    ));
+  }
+}
+
 impl ReadinessPoll for OsPoller {
   type NativeEvent = libc::kevent;
 
@@ -0,0 +1,211 @@
+//! `MSG_ZEROCOPY` sends, which back [`Op::SendZc`] on epoll.
+//!
+//! The kernel numbers the zero-copy sends of a socket from 0 and reports
+//! them done in ranges on the socket's error queue, which shows up as
+//! `EPOLLERR`. Sent ops wait here until their number comes up, holding on to
+//! their resource so the fd stays open.
+//!
+//! Where zero-copy isn't available (kqueue, sockets refusing `SO_ZEROCOPY`)
+//! the op is a plain send with a single completion.
+
+use std::collections::VecDeque;
+use std::os::fd::{AsRawFd, RawFd};
+
+use super::{Progress, syscall_result_ssize};
+use crate::api::resource::{Resource, WeakResource};
+use crate::backends::OpCompleted;
+use crate::op::Op;
+
+/// `SO_EE_ORIGIN_ZEROCOPY` from `linux/errqueue.h`, missing from libc.
+#[cfg(target_os = "linux")]
+const SO_EE_ORIGIN_ZEROCOPY: u8 = 5;
+
+/// Zero-copy state of every fd that ran a [`Op::SendZc`], indexed by fd.
+#[derive(Default)]
+pub(super) struct ZeroCopy {
+  fds: Vec<Option<FdZeroCopy>>,
+}
+
+struct FdZeroCopy {
+  /// Tells the socket apart from a later one reusing its number.
+  owner: WeakResource,
+  /// `SO_ZEROCOPY` could be turned on.
+  enabled: bool,
+  /// Number the kernel gives the next zero-copy send.
+  next: u32,
+  /// Sent ops and their number, waiting for the kernel to let go of their
+  /// buffer.
+  pending: VecDeque<(u32, u64, Resource)>,
+}
+
+impl ZeroCopy {
+  /// Runs a [`Op::SendZc`] that `fd` is writable for.
+  ///
+  /// Pushes the bytes sent with `more` set and returns [`Progress::Sent`]
+  /// when a notification is to follow, see [`drain`](Self::drain).
+  pub(super) fn send(
+    &mut self,
+    id: u64,
+    op: &Op,
+    completed: &mut Vec<OpCompleted>,
+  ) -> Progress {
+    let Op::SendZc { fd: res, flags, buffer } = op else {
+      panic!("ZeroCopy::send called for a non-SendZc op");
+    };
+    // SAFETY: ErasedBuffer stores (ptr, len) tuple set by into_op.
+    let (ptr, len) = unsafe { buffer.peek::<(*const u8, usize)>() };
+    let send = |flags| {
+      // SAFETY: fd is valid (from AsRawFd), ptr/len from buffer are valid per
+      // Op invariants.
+      syscall_result_ssize(unsafe {
+        libc::send(res.as_raw_fd(), ptr.cast(), len, flags)
+      })
+    };
+    let would_block = |result: isize| {
+      result == -(libc::EAGAIN as isize)
+        || result == -(libc::EWOULDBLOCK as isize)
+    };
+
+    let state = self.state(res);
+    // Empty sends don't get a number, so no notification would come.
+    let mut zerocopy = state.enabled && len > 0;
+    let mut result =
+      send(if zerocopy { *flags | MSG_ZEROCOPY } else { *flags });
+    // Over the socket's budget for pinned pages, copy this one instead.
+    if zerocopy && result == -(libc::ENOBUFS as isize) {
+      zerocopy = false;
+      result = send(*flags);
+    }
+    if would_block(result) {
+      return Progress::Blocked;
+    }
+    if !zerocopy || result < 0 {
+      completed.push(OpCompleted::new(id, result));
+      return Progress::Done;
+    }
+
+    let seq = state.next;
+    state.next = seq.wrapping_add(1);
+    state.pending.push_back((seq, id, res.clone()));
+    completed.push(OpCompleted::new(id, result).more(true));
+    Progress::Sent
+  }
+
+  /// Whether ops sent on `fd` still wait for their notification.
+  pub(super) fn has_pending(&self, fd: RawFd) -> bool {
+    matches!(
+      self.fds.get(fd as usize),
+      Some(Some(state)) if !state.pending.is_empty()
+    )
+  }
+
+  /// Reads the notifications off `fd`'s error queue, pushing the final
+  /// completion of every op they cover.
+  pub(super) fn drain(&mut self, fd: RawFd, completed: &mut Vec<OpCompleted>) {
+    if !self.has_pending(fd) {
+      return;
+    }
+    let Some(Some(state)) = self.fds.get_mut(fd as usize) else { return };
+    drain_errqueue(fd, |lo, hi| {
+      state.pending.retain(|&(seq, id, _)| {
+        // Ranges may wrap around.
+        let done = seq.wrapping_sub(lo) <= hi.wrapping_sub(lo);
+        if done {
+          completed.push(OpCompleted::new(id, 0));
+        }
+        !done
+      });
+    });
+  }
+
+  /// State of `res`'s fd, starting over if it belonged to another socket.
+  fn state(&mut self, res: &Resource) -> &mut FdZeroCopy {
+    let fd = res.as_raw_fd() as usize;
+    if fd >= self.fds.len() {
+      self.fds.resize_with(fd + 1, || None);
+    }
+    let slot = &mut self.fds[fd];
+    // Pending ops keep their socket open, so a new owner has none.
+    if !slot.as_ref().is_some_and(|state| state.owner.is(res)) {
+      *slot = Some(FdZeroCopy {
+        owner: res.downgrade(),
+        enabled: enable(res.as_raw_fd()),
+        next: 0,
+        pending: VecDeque::new(),
+      });
+    }
+    slot.as_mut().unwrap()
+  }
+}
+
+#[cfg(target_os = "linux")]
+const MSG_ZEROCOPY: libc::c_int = libc::MSG_ZEROCOPY;
+#[cfg(not(target_os = "linux"))]
+const MSG_ZEROCOPY: libc::c_int = 0;
+
+/// Turns on `SO_ZEROCOPY`, which `MSG_ZEROCOPY` is ignored without.
+#[cfg(target_os = "linux")]
+fn enable(fd: RawFd) -> bool {
+  let one: libc::c_int = 1;
+  // SAFETY: fd is valid, the option value is a c_int that outlives the call.
+  let ret = unsafe {
+    libc::setsockopt(
+      fd,
+      libc::SOL_SOCKET,
+      libc::SO_ZEROCOPY,
+      (&one as *const libc::c_int).cast(),
+      std::mem::size_of::<libc::c_int>() as libc::socklen_t,
+    )
+  };
+  ret == 0
+}
+
+#[cfg(not(target_os = "linux"))]
+fn enable(_fd: RawFd) -> bool {
+  false
+}
+
+/// Calls `done` with the `[lo, hi]` range of each zero-copy notification
+/// queued on `fd`, until the queue is empty.
+#[cfg(target_os = "linux")]
+fn drain_errqueue(fd: RawFd, mut done: impl FnMut(u32, u32)) {
+  loop {
+    // Aligned for cmsghdr, and room for a couple of them.
+    let mut control = [0u64; 16];
+    // SAFETY: An all-zero msghdr is valid, no name and no iovecs.
+    let mut msg: libc::msghdr = unsafe { std::mem::zeroed() };
+    msg.msg_control = control.as_mut_ptr().cast();
+    msg.msg_controllen = std::mem::size_of_val(&control) as _;
+
+    // SAFETY: fd is valid, msg points at the control buffer above.
+    let ret = unsafe {
+      libc::recvmsg(fd, &mut msg, libc::MSG_ERRQUEUE | libc::MSG_DONTWAIT)
+    };
+    if ret < 0 {
+      return;
+    }
+
+    // SAFETY: The kernel filled in `msg_controllen` bytes of cmsgs, which
+    // the CMSG macros walk within.
+    unsafe {
+      let mut cmsg = libc::CMSG_FIRSTHDR(&msg);
+      while !cmsg.is_null() {
+        let (level, ty) = ((*cmsg).cmsg_level, (*cmsg).cmsg_type);
+        if (level == libc::SOL_IP && ty == libc::IP_RECVERR)
+          || (level == libc::SOL_IPV6 && ty == libc::IPV6_RECVERR)
+        {
+          let err = std::ptr::read_unaligned(
+            libc::CMSG_DATA(cmsg).cast::<libc::sock_extended_err>(),
+          );
+          if err.ee_errno == 0 && err.ee_origin == SO_EE_ORIGIN_ZEROCOPY {
+            done(err.ee_info, err.ee_data);
+          }
+        }
+        cmsg = libc::CMSG_NXTHDR(&msg, cmsg);
+      }
+    }
+  }
+}
+
+#[cfg(not(target_os = "linux"))]
+fn drain_errqueue(_fd: RawFd, _done: impl FnMut(u32, u32)) {}
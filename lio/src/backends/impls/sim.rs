@@ -0,0 +1,866 @@
+//! Fault injection on top of a real backend, see [`SimBackend`].
+//!
+//! Ops still run on the wrapped backend. What the simulation changes is
+//! when and how they complete: it holds completions back, shuffles the ones
+//! released together, fails ops without running them and shrinks transfers
+//! before they go out, so short reads and writes really are short.
+//!
+//! Every decision comes from a generator seeded by the caller and is made
+//! when the op is pushed, so the same seed and the same ops in the same
+//! order get the same faults and delays.
+
+use std::cmp::Reverse;
+use std::collections::BinaryHeap;
+use std::io;
+use std::ops::Range;
+use std::time::{Duration, Instant};
+
+#[cfg(feature = "metrics")]
+use std::{cell::RefCell, fmt, rc::Rc, str::FromStr};
+
+use crate::{
+  api::resource::Resource,
+  backends::{IoBackend, OpCompleted, OpStore, Wake},
+  buf::{BufRing, BufStore},
+  op::{Op, RawBuf},
+};
+
+#[cfg(feature = "metrics")]
+use crate::metrics::OpKind;
+
+/// Picks the ops a [`Rule`] looks at.
+type Filter = Box<dyn Fn(&Op) -> bool>;
+
+/// What a [`Rule`] does to the ops it hits.
+enum Effect {
+  /// Holds the completion back for a random time in the range.
+  Delay(Range<Duration>),
+  /// Completes with this errno without running the op.
+  Fail(i32),
+  /// Transfers a random part of the buffer, at least one byte.
+  Short,
+}
+
+/// One kind of fault [`SimBackend`] injects, into a share of the ops.
+///
+/// # Example
+///
+/// ```
+/// use std::time::Duration;
+/// use lio::{backends::sim::Rule, op::Op};
+///
+/// // Half of all recvs fail with EAGAIN, in runs of 8.
+/// let storm = Rule::fail(libc::EAGAIN)
+///   .rate(0.5)
+///   .burst(8)
+///   .when(|op| matches!(op, Op::Recv { .. }));
+///
+/// // A disk taking 1-5ms per write.
+/// let slow = Rule::delay(Duration::from_millis(1)..Duration::from_millis(5))
+///   .when(|op| matches!(op, Op::WriteAt { .. } | Op::Fsync { .. }));
+/// ```
+pub struct Rule {
+  effect: Effect,
+  rate: f64,
+  burst: u32,
+  filter: Option<Filter>,
+  /// Ops left in the burst that's running.
+  left: u32,
+}
+
+impl Rule {
+  fn new(effect: Effect) -> Self {
+    Self { effect, rate: 1.0, burst: 1, filter: None, left: 0 }
+  }
+
+  /// Holds completions back for a time picked from `range`, on top of how
+  /// long the op really took. Ops held back for different times complete
+  /// out of order.
+  pub fn delay(range: Range<Duration>) -> Self {
+    Self::new(Effect::Delay(range))
+  }
+
+  /// Completes ops with `errno` without running them.
+  pub fn fail(errno: i32) -> Self {
+    Self::new(Effect::Fail(errno))
+  }
+
+  /// Cuts reads, writes, sends and recvs to a random part of their buffer,
+  /// at least one byte. Ops of other kinds and single byte transfers are
+  /// left alone.
+  pub fn short() -> Self {
+    Self::new(Effect::Short)
+  }
+
+  /// Hits this share of the ops, from 0.0 to 1.0. All of them by default.
+  pub fn rate(mut self, rate: f64) -> Self {
+    self.rate = rate.clamp(0.0, 1.0);
+    self
+  }
+
+  /// Once it hits, hits the next `ops - 1` ops too, for runs of faults like
+  /// an `EAGAIN` storm. A [`rate`](Self::rate) then picks where runs start.
+  pub fn burst(mut self, ops: u32) -> Self {
+    self.burst = ops.max(1);
+    self
+  }
+
+  /// Only looks at ops `filter` returns `true` for, instead of all of them.
+  /// Ops it skips don't count towards a burst.
+  pub fn when(mut self, filter: impl Fn(&Op) -> bool + 'static) -> Self {
+    self.filter = Some(Box::new(filter));
+    self
+  }
+
+  fn hits(&mut self, op: &Op, rng: &mut Rng) -> bool {
+    if self.filter.as_ref().is_some_and(|filter| !filter(op)) {
+      return false;
+    }
+    if self.left > 0 {
+      self.left -= 1;
+      return true;
+    }
+    if rng.chance(self.rate) {
+      self.left = self.burst - 1;
+      return true;
+    }
+    false
+  }
+}
+
+/// SplitMix64, small and plenty random for picking faults.
+struct Rng(u64);
+
+impl Rng {
+  fn next(&mut self) -> u64 {
+    self.0 = self.0.wrapping_add(0x9e37_79b9_7f4a_7c15);
+    let mut z = self.0;
+    z = (z ^ (z >> 30)).wrapping_mul(0xbf58_476d_1ce4_e5b9);
+    z = (z ^ (z >> 27)).wrapping_mul(0x94d0_49bb_1331_11eb);
+    z ^ (z >> 31)
+  }
+
+  fn chance(&mut self, rate: f64) -> bool {
+    // The top 53 bits, as a float in 0..1.
+    ((self.next() >> 11) as f64 / (1u64 << 53) as f64) < rate
+  }
+
+  /// A number in `range`, which must not be empty.
+  fn below(&mut self, range: Range<u64>) -> u64 {
+    range.start + self.next() % (range.end - range.start)
+  }
+
+  fn duration(&mut self, range: &Range<Duration>) -> Duration {
+    let (start, end) = (range.start.as_nanos(), range.end.as_nanos());
+    if end <= start {
+      return range.start;
+    }
+    let nanos = self.below(0..(end - start).min(u64::MAX as u128) as u64);
+    range.start + Duration::from_nanos(nanos)
+  }
+}
+
+/// What the simulation decided for an op in flight on the inner backend.
+struct Plan {
+  id: u64,
+  /// Extra time each completion is held back for.
+  delay: Duration,
+  /// Completions don't come out before this, from a replayed latency.
+  not_before: Option<Instant>,
+  #[cfg(feature = "metrics")]
+  kind: OpKind,
+  #[cfg(feature = "metrics")]
+  pushed: Instant,
+  /// Its entry in the recorded trace, see [`Recording::entry`].
+  #[cfg(feature = "metrics")]
+  entry: Option<usize>,
+}
+
+/// A completion held back until `due`.
+struct Held {
+  due: Instant,
+  /// Arrival order, which breaks ties so an op's completions stay in order.
+  seq: u64,
+  completed: OpCompleted,
+}
+
+impl PartialEq for Held {
+  fn eq(&self, other: &Self) -> bool {
+    (self.due, self.seq) == (other.due, other.seq)
+  }
+}
+
+impl Eq for Held {}
+
+impl PartialOrd for Held {
+  fn partial_cmp(&self, other: &Self) -> Option<std::cmp::Ordering> {
+    Some(self.cmp(other))
+  }
+}
+
+impl Ord for Held {
+  fn cmp(&self, other: &Self) -> std::cmp::Ordering {
+    (self.due, self.seq).cmp(&(other.due, other.seq))
+  }
+}
+
+/// Backend that runs ops on another one, injecting delays, errors, short
+/// transfers and reordering along the way.
+///
+/// Made for testing how code on top of [`Lio`](crate::Lio) copes with
+/// slow disks, partial writes, `EAGAIN` storms and the like, and for
+/// benchmarking its scheduling and backpressure against them. Pointed at
+/// nops, a tmpfs or loopback sockets, no hardware is involved: the [`Rule`]s
+/// stand in for the slow device.
+///
+/// Faults come from [`Rule`]s, checked in the order they were added.
+/// An op failed by a rule never reaches the inner backend. Delays of every
+/// rule that hits add up. With [`reorder`](Self::reorder), completions
+/// released together also come out shuffled.
+///
+/// With the `metrics` feature, a `Trace` of each op's kind, latency and
+/// result can be recorded, e.g. from production with no rules, and replayed
+/// against later runs.
+///
+/// Chains run one op at a time through the driver, so each op of a chain
+/// goes through the rules on its own.
+///
+/// # Example
+///
+/// ```
+/// use std::time::Duration;
+/// use lio::{Lio, api, backends::{pollingv2::Poller, sim::{Rule, SimBackend}}};
+///
+/// let sim = SimBackend::new(Poller::new(), 42)
+///   .rule(Rule::delay(Duration::from_micros(100)..Duration::from_millis(2)))
+///   .rule(Rule::fail(libc::EIO).rate(0.01))
+///   .reorder(true);
+/// let lio = Lio::new_with_backend(sim, 1024).unwrap();
+///
+/// let mut nop = api::nop().with_lio(&lio).send();
+/// let result = loop {
+///   lio.run().unwrap();
+///   if let Some(result) = nop.try_recv() {
+///     break result;
+///   }
+/// };
+/// # let _ = result;
+/// ```
+pub struct SimBackend<B> {
+  inner: B,
+  rng: Rng,
+  rules: Vec<Rule>,
+  reorder: bool,
+  /// Indexed by [`OpStore::slot_of`] the op id.
+  plans: Vec<Option<Plan>>,
+  held: BinaryHeap<Reverse<Held>>,
+  seq: u64,
+  completed: Vec<OpCompleted>,
+  #[cfg(feature = "metrics")]
+  replay: Option<Replay>,
+  #[cfg(feature = "metrics")]
+  recorder: Option<Recorder>,
+}
+
+impl<B: IoBackend> SimBackend<B> {
+  /// Runs ops on `inner`, picking faults with a generator seeded by `seed`.
+  /// Without rules, ops complete as `inner` completes them.
+  pub fn new(inner: B, seed: u64) -> Self {
+    Self {
+      inner,
+      rng: Rng(seed),
+      rules: Vec::new(),
+      reorder: false,
+      plans: Vec::new(),
+      held: BinaryHeap::new(),
+      seq: 0,
+      completed: Vec::new(),
+      #[cfg(feature = "metrics")]
+      replay: None,
+      #[cfg(feature = "metrics")]
+      recorder: None,
+    }
+  }
+
+  /// Adds `rule`, checked after the ones added before it.
+  pub fn rule(mut self, rule: Rule) -> Self {
+    self.rules.push(rule);
+    self
+  }
+
+  /// Shuffles the completions each wait returns. Those of one op, like a
+  /// multishot recv's, still come in the order the op made them.
+  pub fn reorder(mut self, reorder: bool) -> Self {
+    self.reorder = reorder;
+    self
+  }
+
+  /// Decides what the rules and the replay do to `op`. Returns it ready to
+  /// push, or `None` if it failed without running, its completion held.
+  fn plan(&mut self, id: u64, mut op: Op) -> (Option<Op>, Plan) {
+    let mut delay = Duration::ZERO;
+    let mut failed = None;
+    let mut short = false;
+    for rule in &mut self.rules {
+      if !rule.hits(&op, &mut self.rng) {
+        continue;
+      }
+      match &rule.effect {
+        Effect::Delay(range) => delay += self.rng.duration(range),
+        Effect::Fail(errno) => failed = failed.or(Some(*errno)),
+        Effect::Short => short = true,
+      }
+    }
+
+    #[allow(unused_mut)]
+    let mut plan = Plan {
+      id,
+      delay,
+      not_before: None,
+      #[cfg(feature = "metrics")]
+      kind: op.kind(),
+      #[cfg(feature = "metrics")]
+      pushed: Instant::now(),
+      #[cfg(feature = "metrics")]
+      entry: None,
+    };
+    #[allow(unused_mut)]
+    let mut cap = None;
+    #[cfg(feature = "metrics")]
+    if let Some(entry) = self.replay.as_mut().and_then(|r| r.next(plan.kind)) {
+      plan.not_before = Some(plan.pushed + entry.latency);
+      if entry.result < 0 {
+        failed = failed.or(Some(-entry.result as i32));
+      } else if entry.result > 0 {
+        cap = Some(entry.result as usize);
+      }
+    }
+
+    #[cfg(feature = "metrics")]
+    if let Some(recorder) = &self.recorder {
+      plan.entry = Some(recorder.0.borrow_mut().reserve(plan.kind));
+    }
+
+    if let Some(errno) = failed {
+      let completed = OpCompleted::new(id, -(errno as isize));
+      Self::hold(&mut self.held, &mut self.seq, Some(&plan), completed);
+      return (None, plan);
+    }
+    if short || cap.is_some() {
+      shorten(&mut op, &mut self.rng, short, cap);
+    }
+    (Some(op), plan)
+  }
+
+  /// Holds `completed` back as `plan` says, if the op has one.
+  fn hold(
+    held: &mut BinaryHeap<Reverse<Held>>,
+    seq: &mut u64,
+    plan: Option<&Plan>,
+    completed: OpCompleted,
+  ) {
+    let now = Instant::now();
+    let due = plan.map_or(now, |plan| {
+      (now + plan.delay).max(plan.not_before.unwrap_or(now))
+    });
+    *seq += 1;
+    held.push(Reverse(Held { due, seq: *seq, completed }));
+  }
+
+  /// Takes what the inner backend completed within `timeout` and holds it,
+  /// returning how many that were.
+  fn collect(&mut self, timeout: Option<Duration>) -> io::Result<usize> {
+    let Self { inner, plans, held, seq, .. } = self;
+    let completed = inner.wait_timeout(timeout)?;
+    for c in completed {
+      let plan = plans.get(OpStore::slot_of(c.op_id)).and_then(Option::as_ref);
+      let plan = plan.filter(|plan| plan.id == c.op_id);
+      let c = OpCompleted::new(c.op_id, c.result).more(c.more).buf_id(c.buf_id);
+      Self::hold(held, seq, plan, c);
+    }
+    Ok(completed.len())
+  }
+
+  /// Moves every completion due by `now` to `completed`.
+  fn release(&mut self, now: Instant) {
+    while let Some(Reverse(held)) = self.held.peek()
+      && held.due <= now
+    {
+      let Reverse(Held { completed, .. }) = self.held.pop().unwrap();
+      if !completed.more {
+        self.finish(&completed);
+      }
+      self.completed.push(completed);
+    }
+    if self.reorder {
+      self.shuffle();
+    }
+  }
+
+  /// Shuffles `completed` across ops. Each op's own completions keep their
+  /// order, or a multishot op's last one could overtake the rest.
+  fn shuffle(&mut self) {
+    let mut order: Vec<u64> = self.completed.iter().map(|c| c.op_id).collect();
+    for i in (1..order.len()).rev() {
+      let j = self.rng.below(0..i as u64 + 1) as usize;
+      order.swap(i, j);
+    }
+    let mut left: Vec<_> = self.completed.drain(..).map(Some).collect();
+    for id in order {
+      // The op's earliest completion not yet taken.
+      let next =
+        left.iter_mut().find(|c| c.as_ref().is_some_and(|c| c.op_id == id));
+      self.completed.extend(next.and_then(Option::take));
+    }
+  }
+
+  /// Forgets the plan of an op that's done, recording it.
+  fn finish(&mut self, completed: &OpCompleted) {
+    let slot = OpStore::slot_of(completed.op_id);
+    let Some(entry) = self.plans.get_mut(slot) else { return };
+    let Some(plan) = entry.take_if(|plan| plan.id == completed.op_id) else {
+      return;
+    };
+    #[cfg(feature = "metrics")]
+    if let (Some(recorder), Some(entry)) = (&self.recorder, plan.entry) {
+      let mut recording = recorder.0.borrow_mut();
+      if let Some(entry) = recording.entry(entry) {
+        entry.latency = plan.pushed.elapsed();
+        entry.result = completed.result;
+      }
+    }
+    let _ = plan;
+  }
+}
+
+#[cfg(feature = "metrics")]
+impl<B: IoBackend> SimBackend<B> {
+  /// Has each op complete like the next entry of `trace` of the same kind,
+  /// going round again once they're used up: no sooner than its latency,
+  /// with its error without running, or transferring no more than its
+  /// result. Kinds the trace has none of run as they are.
+  ///
+  /// Rules still apply on top.
+  pub fn replay(mut self, trace: Trace) -> Self {
+    self.replay = Some(Replay::new(trace));
+    self
+  }
+
+  /// Appends every op to `recorder`'s trace, in the order they were pushed,
+  /// filled in once they complete. Failed ops are recorded too, with the
+  /// error the rules injected.
+  pub fn record(mut self, recorder: &Recorder) -> Self {
+    self.recorder = Some(recorder.clone());
+    self
+  }
+}
+
+/// Cuts the transfer of `op` to a random length if `random`, and to at most
+/// `cap` bytes. Leaves ops without a plain buffer alone.
+fn shorten(op: &mut Op, rng: &mut Rng, random: bool, cap: Option<usize>) {
+  let pick = |len: usize, rng: &mut Rng| {
+    let mut new = len;
+    if random && len > 1 {
+      new = rng.below(1..len as u64) as usize;
+    }
+    if let Some(cap) = cap {
+      new = new.min(cap);
+    }
+    new
+  };
+  match op {
+    Op::Read { buffer, .. }
+    | Op::Write { buffer, .. }
+    | Op::ReadAt { buffer, .. }
+    | Op::WriteAt { buffer, .. }
+    | Op::Send { buffer, .. }
+    | Op::Recv { buffer, .. }
+    | Op::ReadFixed { buffer, .. }
+    | Op::WriteFixed { buffer, .. } => {
+      // SAFETY: The typed ops of these store a RawBuf, see their into_op.
+      let raw = unsafe { buffer.peek_mut::<RawBuf>() };
+      raw.len = pick(raw.len, rng);
+    }
+    _ => {}
+  }
+}
+
+impl<B: IoBackend> IoBackend for SimBackend<B> {
+  fn init(&mut self, cap: usize) -> io::Result<()> {
+    self.inner.init(cap)?;
+    self.plans.resize_with(cap, || None);
+    self.completed = Vec::with_capacity(cap.min(256));
+    Ok(())
+  }
+
+  fn push(&mut self, id: u64, op: Op) -> io::Result<()> {
+    let (op, plan) = self.plan(id, op);
+    let slot = OpStore::slot_of(id);
+    if slot >= self.plans.len() {
+      // Only with ids from a store bigger than the `init` capacity.
+      self.plans.resize_with(slot + 1, || None);
+    }
+    self.plans[slot] = Some(plan);
+    match op {
+      Some(op) => self.inner.push(id, op),
+      None => Ok(()),
+    }
+  }
+
+  fn flush(&mut self) -> io::Result<usize> {
+    self.inner.flush()
+  }
+
+  fn wait_timeout(
+    &mut self,
+    timeout: Option<Duration>,
+  ) -> io::Result<&[OpCompleted]> {
+    self.wait_timeout_min(1, timeout)
+  }
+
+  fn wait_timeout_min(
+    &mut self,
+    min: usize,
+    timeout: Option<Duration>,
+  ) -> io::Result<&[OpCompleted]> {
+    let _ = min;
+    self.completed.clear();
+    let deadline = timeout.map(|timeout| Instant::now() + timeout);
+    loop {
+      self.collect(Some(Duration::ZERO))?;
+      let now = Instant::now();
+      self.release(now);
+      if !self.completed.is_empty() || deadline.is_some_and(|d| d <= now) {
+        return Ok(&self.completed);
+      }
+      // Wakes up for the next held completion, or the inner backend's.
+      let next = self.held.peek().map(|Reverse(held)| held.due);
+      let until = match (next, deadline) {
+        (Some(a), Some(b)) => Some(a.min(b)),
+        (a, b) => a.or(b),
+      };
+      let wait = until.map(|until| until.saturating_duration_since(now));
+      if self.collect(wait)? == 0 && until.is_none_or(|u| Instant::now() < u) {
+        // Woken up early, e.g. by a LioRemote, which the driver handles.
+        return Ok(&self.completed);
+      }
+    }
+  }
+
+  fn register_buf_store(&mut self, store: &'static BufStore) -> io::Result<()> {
+    self.inner.register_buf_store(store)
+  }
+
+  fn register_buf_ring(&mut self, ring: &BufRing) -> io::Result<()> {
+    self.inner.register_buf_ring(ring)
+  }
+
+  fn register_file(&mut self, res: &Resource) -> io::Result<()> {
+    self.inner.register_file(res)
+  }
+
+  fn unregister_file(&mut self, res: &Resource) -> io::Result<()> {
+    self.inner.unregister_file(res)
+  }
+
+  fn waker(&mut self) -> io::Result<Option<Box<dyn Wake>>> {
+    self.inner.waker()
+  }
+
+  /// Ops done but held back complete as they are.
+  fn cancel(&mut self, id: u64) -> io::Result<()> {
+    self.inner.cancel(id)
+  }
+
+  #[cfg(feature = "metrics")]
+  fn rearms(&self) -> u64 {
+    self.inner.rearms()
+  }
+}
+
+/// One op of a [`Trace`].
+#[cfg(feature = "metrics")]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct TraceEntry {
+  pub kind: OpKind,
+  /// From push to completion.
+  pub latency: Duration,
+  /// What it completed with, a negative errno on failure.
+  pub result: isize,
+}
+
+/// Ops and how they completed, recorded by a [`Recorder`] and replayed by
+/// [`SimBackend::replay`].
+///
+/// Prints as, and parses from, one op per line: its
+/// [kind name](OpKind::name), latency in nanoseconds and result, separated
+/// by spaces. Empty lines and ones starting with `#` are skipped.
+///
+/// ```
+/// use lio::backends::sim::Trace;
+///
+/// let trace: Trace = "# kind latency result\nrecv 52000 1200\nrecv 9000 -11\n"
+///   .parse()
+///   .unwrap();
+/// assert_eq!(trace.entries().len(), 2);
+/// assert_eq!(trace.to_string(), "recv 52000 1200\nrecv 9000 -11\n");
+/// ```
+#[cfg(feature = "metrics")]
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct Trace {
+  entries: Vec<TraceEntry>,
+}
+
+#[cfg(feature = "metrics")]
+impl Trace {
+  pub fn new() -> Self {
+    Self::default()
+  }
+
+  pub fn push(&mut self, entry: TraceEntry) {
+    self.entries.push(entry);
+  }
+
+  pub fn entries(&self) -> &[TraceEntry] {
+    &self.entries
+  }
+}
+
+#[cfg(feature = "metrics")]
+impl fmt::Display for Trace {
+  fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+    for entry in &self.entries {
+      writeln!(
+        f,
+        "{} {} {}",
+        entry.kind.name(),
+        entry.latency.as_nanos(),
+        entry.result
+      )?;
+    }
+    Ok(())
+  }
+}
+
+#[cfg(feature = "metrics")]
+impl FromStr for Trace {
+  type Err = io::Error;
+
+  fn from_str(s: &str) -> io::Result<Self> {
+    let invalid = |line: usize| {
+      io::Error::new(
+        io::ErrorKind::InvalidData,
+        format!("trace line {line} isn't `kind latency result`"),
+      )
+    };
+    let mut trace = Trace::new();
+    for (i, line) in s.lines().enumerate() {
+      let line = line.trim();
+      if line.is_empty() || line.starts_with('#') {
+        continue;
+      }
+      let mut fields = line.split_ascii_whitespace();
+      let (Some(kind), Some(latency), Some(result), None) =
+        (fields.next(), fields.next(), fields.next(), fields.next())
+      else {
+        return Err(invalid(i + 1));
+      };
+      let kind = OpKind::ALL
+        .into_iter()
+        .find(|k| k.name() == kind)
+        .ok_or_else(|| invalid(i + 1))?;
+      let latency = latency.parse().map_err(|_| invalid(i + 1))?;
+      let result = result.parse().map_err(|_| invalid(i + 1))?;
+      trace.push(TraceEntry {
+        kind,
+        latency: Duration::from_nanos(latency),
+        result,
+      });
+    }
+    Ok(trace)
+  }
+}
+
+/// Collects the [`Trace`] of a [`SimBackend`], see
+/// [`SimBackend::record`]. Clones share the trace.
+#[cfg(feature = "metrics")]
+#[derive(Clone, Default)]
+pub struct Recorder(Rc<RefCell<Recording>>);
+
+#[cfg(feature = "metrics")]
+impl Recorder {
+  pub fn new() -> Self {
+    Self::default()
+  }
+
+  /// Takes what was recorded so far, leaving the trace empty. Ops still in
+  /// flight are in there with a latency and result of 0.
+  pub fn take(&self) -> Trace {
+    let mut recording = self.0.borrow_mut();
+    recording.taken += recording.trace.entries.len();
+    std::mem::take(&mut recording.trace)
+  }
+}
+
+#[cfg(feature = "metrics")]
+#[derive(Default)]
+struct Recording {
+  trace: Trace,
+  /// Entries taken out before the ones in `trace`.
+  taken: usize,
+}
+
+#[cfg(feature = "metrics")]
+impl Recording {
+  /// Adds an entry for an op of `kind` just pushed, returning its index.
+  fn reserve(&mut self, kind: OpKind) -> usize {
+    let entry = TraceEntry { kind, latency: Duration::ZERO, result: 0 };
+    self.trace.push(entry);
+    self.taken + self.trace.entries.len() - 1
+  }
+
+  /// The entry at `index`, unless it was taken out already.
+  fn entry(&mut self, index: usize) -> Option<&mut TraceEntry> {
+    self.trace.entries.get_mut(index.checked_sub(self.taken)?)
+  }
+}
+
+/// Where a replay is in its trace, per kind.
+#[cfg(feature = "metrics")]
+struct Replay {
+  /// Entries of each kind, by [`OpKind`] index.
+  by_kind: Vec<Vec<TraceEntry>>,
+  next: Vec<usize>,
+}
+
+#[cfg(feature = "metrics")]
+impl Replay {
+  fn new(trace: Trace) -> Self {
+    let mut by_kind = vec![Vec::new(); OpKind::COUNT];
+    for entry in trace.entries {
+      by_kind[entry.kind as usize].push(entry);
+    }
+    Self { by_kind, next: vec![0; OpKind::COUNT] }
+  }
+
+  fn next(&mut self, kind: OpKind) -> Option<TraceEntry> {
+    let entries = &self.by_kind[kind as usize];
+    if entries.is_empty() {
+      return None;
+    }
+    let next = &mut self.next[kind as usize];
+    let entry = entries[*next % entries.len()];
+    *next += 1;
+    Some(entry)
+  }
+}
+
+#[cfg(test)]
+mod tests {
+  use super::*;
+  use crate::backends::dummy::DummyBackend;
+
+  fn sim(seed: u64) -> SimBackend<DummyBackend> {
+    SimBackend::new(DummyBackend::new(), seed)
+  }
+
+  /// Pushes `n` nops and waits for all of them, returning their results in
+  /// completion order.
+  fn run_nops(backend: &mut impl IoBackend, n: u64) -> Vec<(u64, isize)> {
+    backend.init(64).unwrap();
+    for id in 0..n {
+      backend.push(id, Op::Nop).unwrap();
+    }
+    let mut done = Vec::new();
+    while (done.len() as u64) < n {
+      let completed = backend.wait_timeout(None).unwrap();
+      done.extend(completed.iter().map(|c| (c.op_id, c.result)));
+    }
+    done
+  }
+
+  #[test]
+  fn test_passes_through() {
+    let done = run_nops(&mut sim(1), 4);
+    assert_eq!(done, vec![(0, 0), (1, 0), (2, 0), (3, 0)]);
+  }
+
+  #[test]
+  fn test_fail_is_deterministic() {
+    let rule = || Rule::fail(libc::EAGAIN).rate(0.3).burst(3);
+    let first = run_nops(&mut sim(7).rule(rule()), 32);
+    let again = run_nops(&mut sim(7).rule(rule()), 32);
+    assert_eq!(first, again);
+
+    let failed: Vec<_> = first.iter().filter(|(_, res)| *res < 0).collect();
+    assert!(!failed.is_empty() && failed.len() < 32);
+    assert!(failed.iter().all(|(_, res)| *res == -libc::EAGAIN as isize));
+  }
+
+  #[test]
+  fn test_delay_holds_completions() {
+    let delay = Duration::from_millis(5)..Duration::from_millis(10);
+    let mut backend = sim(3).rule(Rule::delay(delay));
+    backend.init(8).unwrap();
+    let start = Instant::now();
+    backend.push(0, Op::Nop).unwrap();
+    assert!(backend.wait_timeout(Some(Duration::ZERO)).unwrap().is_empty());
+    // The dummy backend never blocks, so waits come back early.
+    while backend.wait_timeout(None).unwrap().is_empty() {}
+    assert!(start.elapsed() >= Duration::from_millis(5));
+  }
+
+  #[test]
+  fn test_filter_and_short() {
+    let mut buf = [0u8; 100];
+    let ptr = buf.as_mut_ptr();
+    let mut op = Op::Nop;
+    let mut rng = Rng(9);
+    shorten(&mut op, &mut rng, true, None);
+    assert!(matches!(op, Op::Nop));
+
+    let mut op = Op::Recv {
+      fd: Resource::stdin(),
+      flags: 0,
+      buffer: crate::op::OpBuf::new(RawBuf { ptr, len: 100 }),
+    };
+    shorten(&mut op, &mut rng, true, Some(60));
+    let Op::Recv { buffer, .. } = &op else { unreachable!() };
+    // SAFETY: Set up as a RawBuf above.
+    let RawBuf { len, .. } = unsafe { buffer.peek::<RawBuf>() };
+    assert!((1..=60).contains(&len));
+
+    let mut rule = Rule::fail(libc::EIO).when(|op| matches!(op, Op::Nop));
+    assert!(!rule.hits(&op, &mut rng));
+    assert!(rule.hits(&Op::Nop, &mut rng));
+  }
+
+  #[cfg(feature = "metrics")]
+  #[test]
+  fn test_trace_round_trips() {
+    let text = "nop 1000 0\nread_at 250000 -5\n";
+    let trace: Trace = text.parse().unwrap();
+    assert_eq!(trace.entries()[1].kind, OpKind::ReadAt);
+    assert_eq!(trace.entries()[1].latency, Duration::from_micros(250));
+    assert_eq!(trace.to_string(), text);
+    assert!("nop 1000".parse::<Trace>().is_err());
+    assert!("bogus 1 0".parse::<Trace>().is_err());
+  }
+
+  #[cfg(feature = "metrics")]
+  #[test]
+  fn test_record_and_replay() {
+    let recorder = Recorder::new();
+    let done = run_nops(
+      &mut sim(5).rule(Rule::fail(libc::EIO).rate(0.5)).record(&recorder),
+      16,
+    );
+    let trace = recorder.take();
+    assert_eq!(trace.entries().len(), 16);
+    assert!(recorder.take().entries().is_empty());
+
+    // Replaying brings the same failures back, without the rule.
+    let replayed = run_nops(&mut sim(99).replay(trace), 16);
+    assert_eq!(done, replayed);
+  }
+}
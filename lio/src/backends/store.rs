@@ -115,6 +115,19 @@ impl OpStore {
     }
   }
 
+  /// Returns how many operations are in the store.
+  pub fn occupied(&self) -> usize {
+    self.next_slot as usize - self.free_list.len()
+  }
+
+  /// Returns the slot `id` lives in, which is below the store's capacity.
+  ///
+  /// Backends key their own per-op state by it, so it lives in a slab sized
+  /// like the store instead of a map.
+  pub fn slot_of(id: u64) -> usize {
+    Index::from_u64(id).slot() as usize
+  }
+
   /// Allocates the next available slot index and generation.
   fn next_id(&mut self) -> Option<Index> {
     // First try to reuse a freed slot
@@ -174,19 +187,45 @@ impl OpStore {
   /// was invalid (not found, already removed, or stale generation).
   pub fn remove(&mut self, id: u64) -> bool {
     let index = Index::from_u64(id);
-    let slot = match self.raw_get_mut_slot(index) {
-      Some(slot) => slot,
-      None => return false,
+    if self.raw_get_mut_slot(index).is_none() {
+      return false;
+    }
+    self.free_slot(index);
+    true
+  }
+
+  /// Runs `f` on an operation's registration, then removes the operation if
+  /// `f` returned `true`.
+  ///
+  /// Looks the slot up once, where [`get_mut`](Self::get_mut) followed by
+  /// [`remove`](Self::remove) would do it twice. Returns `false` if the ID is
+  /// invalid, without calling `f`.
+  pub fn update_or_remove(
+    &mut self,
+    id: u64,
+    f: impl FnOnce(&mut Registration) -> bool,
+  ) -> bool {
+    let index = Index::from_u64(id);
+    let Some(entry) =
+      self.raw_get_mut_slot(index).and_then(|slot| slot.entry.as_mut())
+    else {
+      return false;
     };
+    if f(entry) {
+      self.free_slot(index);
+    }
+    true
+  }
 
+  /// Empties a slot known to match `index`.
+  fn free_slot(&mut self, index: Index) {
+    let slot = &mut self.slots[index.slot() as usize];
     // Remove the entry
     slot.entry = None;
     // Increment generation for next use (ABA protection)
     slot.generation = slot.generation.strict_add(1);
     // Return slot to free list
     self.free_list.push_back(index.slot());
-
-    true
   }
 
   /// Gets mutable access to an operation's registration.
@@ -320,6 +359,37 @@ mod tests {
     assert!(registration.is_some());
   }
 
+  #[test]
+  fn test_slot_of() {
+    let mut store = OpStore::with_capacity(4);
+    let first = store.insert(dummy_stored_op());
+    let second = store.insert(dummy_stored_op());
+    assert_eq!(OpStore::slot_of(first), 0);
+    assert_eq!(OpStore::slot_of(second), 1);
+
+    // A reused slot keeps its index under the new generation.
+    store.remove(first);
+    let reused = store.insert(dummy_stored_op());
+    assert_ne!(reused, first);
+    assert_eq!(OpStore::slot_of(reused), 0);
+  }
+
+  #[test]
+  fn test_update_or_remove() {
+    let mut store = OpStore::new();
+    let id = store.insert(dummy_stored_op());
+
+    // Kept when the closure says so.
+    assert!(store.update_or_remove(id, |_| false));
+    assert!(store.get(id).is_some());
+
+    assert!(store.update_or_remove(id, |_| true));
+    assert!(store.get(id).is_none());
+
+    // Stale ids don't reach the closure.
+    assert!(!store.update_or_remove(id, |_| panic!("called for stale id")));
+  }
+
   #[test]
   fn test_get_works() {
     let mut store = OpStore::new();
@@ -6,8 +6,9 @@
 //!
 //! # Buffer Pool
 //!
-//! The [`BufStore`] (requires `buf` feature) provides a pool of reusable 4096-byte buffers
-//! to avoid heap allocations. Each buffer is protected by a mutex for concurrent access.
+//! The [`BufStore`] (requires `buf` feature) provides a pool of reusable buffers in
+//! [size classes](SizeClass), 4096 bytes by default, to avoid heap allocations. Lending
+//! and returning on the thread that made the pool doesn't contend with other threads.
 //!
 //! ```
 //! use lio::buf::BufStore;
@@ -21,6 +22,21 @@
 //! }
 //! ```
 //!
+//! # Aligned buffers
+//!
+//! `O_DIRECT` files (see [`OpenOptions::direct`](crate::fs::OpenOptions::direct))
+//! need buffers aligned to the device's block size. An [`AlignedBuf`] is a
+//! heap buffer of any power of two alignment, and [`BufStore`] buffers are
+//! aligned to their size rounded up to a power of two, up to 4096 bytes, so
+//! classes of 512 or 4096 byte buffers qualify too.
+//!
+//! # Buffer rings
+//!
+//! A [`BufRing`] is a pool the I/O backend picks from itself, for multishot
+//! receives: sockets don't hold a buffer until data arrives for them, which
+//! keeps memory bounded by the ring rather than the number of connections.
+//! Data comes back as [`RingChunk`]s that return to the ring on drop.
+//!
 //! # Feature `zeroize`
 //!
 //! When the `zeroize` feature is enabled, [`LentBuf`]fers are
@@ -93,11 +109,13 @@ impl BufLike for Vec<u8> {
 impl<B> Sealed for B where B: BufLike {}
 
 use std::{
-  array,
   cell::UnsafeCell,
-  slice,
-  sync::atomic::{AtomicBool, AtomicUsize, Ordering},
-  time::Duration,
+  ptr, slice,
+  sync::{
+    Arc, Condvar, Mutex,
+    atomic::{self, AtomicBool, AtomicU32, AtomicU64, AtomicUsize, Ordering},
+  },
+  time::{Duration, Instant},
 };
 
 use crossbeam_channel::{Receiver, Sender};
@@ -132,10 +150,10 @@ impl<'a> BufLike for LentBuf<'a> {
   fn after(self, bw: usize) -> Self {
     let cell = &self.pool.buffers[self.index as usize];
     assert!(
-      bw <= BUF_LEN,
+      bw <= self.capacity(),
       "LentBuf::after: bytes written ({}) exceeds buffer capacity ({})",
       bw,
-      BUF_LEN
+      self.capacity()
     );
     cell.len.store(bw, Ordering::Release);
     self
@@ -154,16 +172,10 @@ impl<'a> AsRef<[u8]> for LentBuf<'a> {
 
 impl<'a> Drop for LentBuf<'a> {
   fn drop(&mut self) {
-    let cell = &self.pool.buffers[self.index as usize];
-
     #[cfg(feature = "zeroize")]
     self.zeroize();
 
-    // Mark buffer as available
-    cell.in_use.store(false, Ordering::Release);
-
-    // Return index to free list
-    let _ = self.pool.free_tx.send(self.index);
+    self.pool.put(self.index);
   }
 }
 
@@ -180,13 +192,13 @@ impl<'a> LentBuf<'a> {
   /// # Security Properties
   ///
   /// - Guarantees memory is overwritten (compiler cannot optimize away)
-  /// - Clears the full buffer capacity (4096 bytes), not just the valid data range
+  /// - Clears the full buffer [capacity](Self::capacity), not just the valid data range
   /// - Resets `pos` and `len` to 0
   /// - Uses [`zeroize::Zeroize`](https://docs.rs/zeroize) trait for secure erasure
   ///
   /// # Performance
   ///
-  /// This is equivalent to a 4096-byte `memset(0)` operation. For most use cases,
+  /// This is equivalent to a `memset(0)` of the buffer's capacity. For most use cases,
   /// the overhead is negligible compared to I/O costs.
   ///
   /// # Example
@@ -304,6 +316,55 @@ impl<'a> bytes::Buf for LentBuf<'a> {
 }
 
 impl<'a> LentBuf<'a> {
+  /// Index of this buffer within its [`BufStore`].
+  ///
+  /// When the store is registered with an io_uring ring this is also the
+  /// kernel's fixed-buffer index.
+  pub fn index(&self) -> u32 {
+    self.index
+  }
+
+  /// Size of the buffer, that of its [`SizeClass`].
+  pub fn capacity(&self) -> usize {
+    self.pool.buffers[self.index as usize].buf.get().len()
+  }
+
+  /// Appends `data` after the current valid range of the buffer.
+  ///
+  /// # Panics
+  ///
+  /// Panics if the data doesn't fit in the remaining capacity.
+  pub fn extend_from_slice(&mut self, data: &[u8]) {
+    let cell = &self.pool.buffers[self.index as usize];
+    let len = cell.len.load(Ordering::Acquire);
+    assert!(
+      len + data.len() <= self.capacity(),
+      "LentBuf::extend_from_slice: {} bytes doesn't fit, only {} remaining",
+      data.len(),
+      self.capacity() - len
+    );
+    // SAFETY: We have exclusive access via in_use flag
+    let buf = unsafe { &mut *cell.buf.get() };
+    buf[len..len + data.len()].copy_from_slice(data);
+    cell.len.store(len + data.len(), Ordering::Release);
+  }
+
+  /// Marks `cnt` bytes of the valid range as consumed, e.g after a write.
+  pub(crate) fn consume(&mut self, cnt: usize) {
+    let cell = &self.pool.buffers[self.index as usize];
+    let pos = cell.pos.load(Ordering::Acquire);
+    let len = cell.len.load(Ordering::Acquire);
+    assert!(cnt <= len - pos, "LentBuf::consume: past end of buffer");
+    cell.pos.store(pos + cnt, Ordering::Release);
+  }
+
+  /// Keeps the buffer lent out without a handle to it, for C code that
+  /// tracks it by index. [`BufStore::lent`] takes it back.
+  #[cfg(feature = "unstable_ffi")]
+  pub(crate) fn into_index(self) -> u32 {
+    std::mem::ManuallyDrop::new(self).index
+  }
+
   /// Returns an iterator over `chunk_size` chunks of the buffer.
   ///
   /// The last chunk may be shorter if the buffer length is not evenly divisible.
@@ -327,34 +388,235 @@ impl<'a> LentBuf<'a> {
   }
 }
 
+/// A heap buffer whose start and capacity are multiples of its alignment,
+/// for `O_DIRECT` I/O.
+///
+/// Like a `Vec<u8>`, I/O covers its whole capacity and the bytes transferred
+/// become its [`len`](Self::len).
+///
+/// ```
+/// use lio::buf::AlignedBuf;
+///
+/// let mut buf = AlignedBuf::new(8192, 4096);
+/// assert_eq!(buf.as_mut_slice().as_ptr() as usize % 4096, 0);
+/// assert!(buf.is_empty());
+/// ```
+pub struct AlignedBuf {
+  ptr: ptr::NonNull<u8>,
+  layout: std::alloc::Layout,
+  len: usize,
+}
+
+// SAFETY: AlignedBuf owns its allocation, like a Vec<u8>.
+unsafe impl Send for AlignedBuf {}
+// SAFETY: ---- :: ----
+unsafe impl Sync for AlignedBuf {}
+
+impl AlignedBuf {
+  /// A zeroed buffer of `cap` bytes aligned to `align`.
+  ///
+  /// # Panics
+  ///
+  /// Panics if `align` isn't a power of two, or `cap` is 0 or not a multiple
+  /// of it.
+  pub fn new(cap: usize, align: usize) -> Self {
+    assert!(
+      cap > 0 && align.is_power_of_two() && cap.is_multiple_of(align),
+      "AlignedBuf: {cap} bytes can't be aligned to {align}"
+    );
+    let layout = std::alloc::Layout::from_size_align(cap, align)
+      .expect("AlignedBuf: too large");
+    // SAFETY: The layout isn't zero-sized.
+    let ptr = unsafe { std::alloc::alloc_zeroed(layout) };
+    let Some(ptr) = ptr::NonNull::new(ptr) else {
+      std::alloc::handle_alloc_error(layout);
+    };
+    Self { ptr, layout, len: 0 }
+  }
+
+  /// The alignment of the start and capacity.
+  pub fn align(&self) -> usize {
+    self.layout.align()
+  }
+
+  /// Size of the buffer.
+  pub fn capacity(&self) -> usize {
+    self.layout.size()
+  }
+
+  /// Bytes transferred by the last I/O.
+  pub fn len(&self) -> usize {
+    self.len
+  }
+
+  /// Returns true if the last I/O transferred nothing, or there was none.
+  pub fn is_empty(&self) -> bool {
+    self.len == 0
+  }
+
+  /// The whole buffer, e.g to fill before a write.
+  pub fn as_mut_slice(&mut self) -> &mut [u8] {
+    // SAFETY: The allocation is capacity bytes, initialised and owned.
+    unsafe { slice::from_raw_parts_mut(self.ptr.as_ptr(), self.capacity()) }
+  }
+}
+
+impl BufLike for AlignedBuf {
+  fn buf(&self) -> &[u8] {
+    // SAFETY: The allocation is capacity bytes, initialised and owned.
+    unsafe { slice::from_raw_parts(self.ptr.as_ptr(), self.capacity()) }
+  }
+
+  fn after(mut self, bytes: usize) -> Self {
+    self.len = bytes.min(self.capacity());
+    self
+  }
+}
+
+impl AsRef<[u8]> for AlignedBuf {
+  /// The bytes transferred by the last I/O.
+  fn as_ref(&self) -> &[u8] {
+    &self.buf()[..self.len]
+  }
+}
+
+impl Drop for AlignedBuf {
+  fn drop(&mut self) {
+    // SAFETY: Allocated in `new` with this layout.
+    unsafe { std::alloc::dealloc(self.ptr.as_ptr(), self.layout) };
+  }
+}
+
+/// Buffer size of [`BufStore::with_capacity`] stores.
 const BUF_LEN: usize = 4096;
 
+/// Arenas at least this big are aligned to it and marked for transparent
+/// huge pages.
+const HUGE_PAGE: usize = 2 << 20;
+
+/// Buffers are aligned to their size, up to this, which also suits
+/// `O_DIRECT`.
+const MAX_BUF_ALIGN: usize = 4096;
+
+/// Terminates a free list, see [`FreeStack`].
+const NIL: u32 = u32::MAX;
+
+/// A buffer's memory inside the arena of its [`BufStore`].
+struct RawBuf(*mut [u8]);
+
+impl RawBuf {
+  fn get(&self) -> *mut [u8] {
+    self.0
+  }
+}
+
 /// A single buffer cell in the pool.
 ///
-/// Contains the actual buffer data and atomic metadata for thread-safe access.
+/// Points at the cell's buffer in the arena, with atomic metadata for
+/// thread-safe access.
 struct BufCell {
-  buf: UnsafeCell<[u8; BUF_LEN]>,
+  buf: RawBuf,
   len: AtomicUsize,
   pos: AtomicUsize,
   in_use: AtomicBool,
+  /// Index of the size class in [`BufStore::classes`].
+  class: u32,
+  /// Next buffer on the [`FreeStack`] this one is on.
+  next: AtomicU32,
 }
 
-// SAFETY: BufCell is Sync because access to the UnsafeCell is synchronized
+// SAFETY: BufCell is Sync because access to the buffer is synchronized
 // via the atomic in_use flag. Only one thread can access the buffer at a time
-// (enforced by the CAS in try_get).
+// (enforced by taking its index off a free list).
 unsafe impl Sync for BufCell {}
+// SAFETY: The buffer is owned by the store's arena, not by the thread that
+// made the cell.
+unsafe impl Send for BufCell {}
+
+/// The size of a [`BufStore`]'s buffers, and how many of that size it holds.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct SizeClass {
+  /// Size of each buffer in bytes.
+  pub buf_len: usize,
+  /// Number of buffers.
+  pub count: usize,
+}
 
-impl BufCell {
+impl SizeClass {
+  /// `count` buffers of `buf_len` bytes.
+  pub const fn new(buf_len: usize, count: usize) -> Self {
+    Self { buf_len, count }
+  }
+}
+
+/// Lock-free stack of free buffer indexes, linked through [`BufCell::next`].
+///
+/// The head packs a push/pop counter above the index so a pop can't succeed
+/// on a head that was popped and pushed back in between (ABA).
+struct FreeStack(AtomicU64);
+
+impl FreeStack {
   fn new() -> Self {
-    Self {
-      buf: UnsafeCell::new(array::from_fn::<_, BUF_LEN, _>(|_| 0)),
-      len: AtomicUsize::new(0),
-      pos: AtomicUsize::new(0),
-      in_use: AtomicBool::new(false),
+    Self(AtomicU64::new(NIL as u64))
+  }
+
+  fn bump(head: u64, index: u32) -> u64 {
+    ((head >> 32).wrapping_add(1) << 32) | index as u64
+  }
+
+  fn push(&self, cells: &[BufCell], index: u32) {
+    let mut head = self.0.load(Ordering::Relaxed);
+    loop {
+      cells[index as usize].next.store(head as u32, Ordering::Relaxed);
+      match self.0.compare_exchange_weak(
+        head,
+        Self::bump(head, index),
+        Ordering::Release,
+        Ordering::Relaxed,
+      ) {
+        Ok(_) => return,
+        Err(actual) => head = actual,
+      }
+    }
+  }
+
+  fn pop(&self, cells: &[BufCell]) -> Option<u32> {
+    let mut head = self.0.load(Ordering::Acquire);
+    loop {
+      let index = head as u32;
+      if index == NIL {
+        return None;
+      }
+      // May be stale if `index` was popped meanwhile; the counter in the
+      // head then fails the exchange.
+      let next = cells[index as usize].next.load(Ordering::Relaxed);
+      match self.0.compare_exchange_weak(
+        head,
+        Self::bump(head, next),
+        Ordering::Acquire,
+        Ordering::Acquire,
+      ) {
+        Ok(_) => return Some(index),
+        Err(actual) => head = actual,
+      }
     }
   }
 }
 
+/// The free buffers of one [`SizeClass`].
+struct Class {
+  buf_len: usize,
+  count: usize,
+  /// Free buffers only the owning thread touches, without atomics.
+  local: UnsafeCell<Vec<u32>>,
+  /// Most buffers `local` holds, half the class. The owner returns the rest
+  /// to `shared`, so other threads don't go without while some are free.
+  local_cap: usize,
+  /// Free buffers any thread can take, which the owning thread falls back
+  /// to once `local` runs out.
+  shared: FreeStack,
+}
+
 /// A pool of reusable buffers for I/O operations.
 ///
 /// Provides zero-allocation buffer lending using an index-based design.
@@ -362,15 +624,26 @@ impl BufCell {
 ///
 /// # Design
 ///
-/// - All buffers allocated once at initialization (zero runtime allocations)
+/// - One contiguous arena for all buffers, allocated at initialization
+///   (zero runtime allocations). Arenas of 2 MiB and up are aligned for, and
+///   on Linux advised to use, transparent huge pages
+/// - Buffers come in [size classes](SizeClass), each aligned to its size (up
+///   to 4 KiB)
 /// - Index-based lending (LentBuf holds index, not mutex guard)
-/// - Lock-free free list using crossbeam SegQueue
-/// - Atomic flags for exclusive access (no mutexes per buffer)
+/// - The thread that made the store, normally the one running the `Lio` it
+///   is registered with, lends and returns through a plain per-class list
+///   of up to half the class
+/// - Everything else goes through a lock-free stack per class, which any
+///   thread takes from
+///
+/// Threads other than the owner only miss the buffers on the owner's list.
+/// When such a thread blocks in [`get`](Self::get), the owner spills its list
+/// for it the next time it lends or returns a buffer.
 ///
 /// # Example
 ///
 /// ```
-/// use lio::buf::BufStore;
+/// use lio::buf::{BufStore, SizeClass};
 ///
 /// let buf_store = BufStore::with_capacity(64); // 64 * 4KB allocated once
 ///
@@ -379,11 +652,53 @@ impl BufCell {
 /// } else {
 ///     // All buffers in use
 /// }
+///
+/// // Room for TLS records next to small messages.
+/// let buf_store = BufStore::with_classes(&[
+///   SizeClass::new(2048, 256),
+///   SizeClass::new(16 * 1024, 64),
+///   SizeClass::new(64 * 1024, 16),
+/// ]);
+/// let record = buf_store.try_get_len(16 * 1024 + 5).unwrap();
+/// assert_eq!(record.capacity(), 64 * 1024);
 /// ```
 pub struct BufStore {
   buffers: Box<[BufCell]>,
-  free_tx: Sender<u32>,
-  free_rx: Receiver<u32>,
+  /// Sorted by buffer size.
+  classes: Box<[Class]>,
+  arena: *mut u8,
+  layout: std::alloc::Layout,
+  /// Identifies the owning thread, see [`thread_token`].
+  owner: usize,
+  available: AtomicUsize,
+  /// Threads blocked in `get`, woken through `returned`.
+  waiting: AtomicUsize,
+  wait_lock: Mutex<()>,
+  returned: Condvar,
+}
+
+// SAFETY: The arena is owned by the store and only freed on drop. Buffers in
+// it are handed out exclusively through the free lists, and each class's
+// `local` list is only touched by the owning thread.
+unsafe impl Send for BufStore {}
+// SAFETY: ---- :: ----
+unsafe impl Sync for BufStore {}
+
+/// Returns a value unique to the calling thread among running threads.
+fn thread_token() -> usize {
+  thread_local! {
+    static TOKEN: u8 = const { 0 };
+  }
+  TOKEN.with(|token| ptr::from_ref(token) as usize)
+}
+
+impl std::fmt::Debug for BufStore {
+  fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+    f.debug_struct("BufStore")
+      .field("capacity", &self.capacity())
+      .field("available", &self.available())
+      .finish_non_exhaustive()
+  }
 }
 
 impl Default for BufStore {
@@ -402,19 +717,106 @@ impl BufStore {
   ///
   /// - `cap`: Number of 4096-byte buffers to allocate in the pool
   pub fn with_capacity(cap: usize) -> Self {
-    let mut buffers = Vec::with_capacity(cap);
-    let (free_tx, free_rx) = crossbeam_channel::unbounded();
+    Self::with_classes(&[SizeClass::new(BUF_LEN, cap)])
+  }
 
-    for i in 0..cap {
-      buffers.push(BufCell::new());
-      // Pre-populate the channel with all buffer indices
-      free_tx.send(i as u32).expect("channel should not be full");
+  /// Creates a pool with buffers of every class in `classes`, in one arena.
+  ///
+  /// Buffers are aligned to their size rounded up to a power of two, up to
+  /// 4096 bytes, which suits `O_DIRECT` for classes of 512 or 4096 bytes.
+  ///
+  /// The calling thread becomes the pool's owner, which lends and returns
+  /// buffers without contention.
+  ///
+  /// # Panics
+  ///
+  /// Panics if a class has buffers of 0 bytes, or the pool would hold
+  /// `u32::MAX` buffers or more.
+  pub fn with_classes(classes: &[SizeClass]) -> Self {
+    let mut sorted = classes.to_vec();
+    sorted.sort_by_key(|class| class.buf_len);
+    assert!(
+      sorted.iter().all(|class| class.buf_len > 0),
+      "BufStore: buffers can't be empty"
+    );
+    let total: usize = sorted.iter().map(|class| class.count).sum();
+    assert!(total < NIL as usize, "BufStore: too many buffers");
+
+    // Lay the classes out back to back, each buffer aligned to its size.
+    let mut offsets = Vec::with_capacity(sorted.len());
+    let mut size = 0usize;
+    for class in &sorted {
+      let align = class.buf_len.next_power_of_two().min(MAX_BUF_ALIGN);
+      let stride = class.buf_len.next_multiple_of(align);
+      size = size.next_multiple_of(align);
+      offsets.push((size, stride));
+      size += stride * class.count;
+    }
+    let align = if size >= HUGE_PAGE { HUGE_PAGE } else { MAX_BUF_ALIGN };
+    let layout = std::alloc::Layout::from_size_align(size.max(1), align)
+      .expect("BufStore: arena too large");
+    // SAFETY: The layout isn't zero-sized.
+    let arena = unsafe { std::alloc::alloc_zeroed(layout) };
+    if arena.is_null() {
+      std::alloc::handle_alloc_error(layout);
+    }
+    #[cfg(linux)]
+    if size >= HUGE_PAGE {
+      // SAFETY: The range is the arena just allocated. Only advice, no harm
+      // if the kernel doesn't take it.
+      unsafe { libc::madvise(arena.cast(), size, libc::MADV_HUGEPAGE) };
     }
 
-    Self { buffers: buffers.into_boxed_slice(), free_tx, free_rx }
+    let mut buffers = Vec::with_capacity(total);
+    let mut store_classes = Vec::with_capacity(sorted.len());
+    for (class_index, (class, (offset, stride))) in
+      sorted.iter().zip(offsets).enumerate()
+    {
+      for i in 0..class.count {
+        // SAFETY: The offset lies within the arena, laid out above.
+        let ptr = unsafe { arena.add(offset + i * stride) };
+        buffers.push(BufCell {
+          buf: RawBuf(ptr::slice_from_raw_parts_mut(ptr, class.buf_len)),
+          len: AtomicUsize::new(0),
+          pos: AtomicUsize::new(0),
+          in_use: AtomicBool::new(false),
+          class: class_index as u32,
+          next: AtomicU32::new(NIL),
+        });
+      }
+      store_classes.push(Class {
+        buf_len: class.buf_len,
+        count: class.count,
+        local: UnsafeCell::new(Vec::with_capacity(class.count / 2)),
+        local_cap: class.count / 2,
+        shared: FreeStack::new(),
+      });
+    }
+    // Everything starts out shared, so any thread can take the first
+    // buffers. The owner's own list fills up as it returns them.
+    for (index, cell) in buffers.iter().enumerate().rev() {
+      store_classes[cell.class as usize].shared.push(&buffers, index as u32);
+    }
+
+    Self {
+      buffers: buffers.into_boxed_slice(),
+      classes: store_classes.into_boxed_slice(),
+      arena,
+      layout,
+      owner: thread_token(),
+      available: AtomicUsize::new(total),
+      waiting: AtomicUsize::new(0),
+      wait_lock: Mutex::new(()),
+      returned: Condvar::new(),
+    }
   }
 
-  /// Tries to borrow a buffer from the pool.
+  fn is_owner(&self) -> bool {
+    thread_token() == self.owner
+  }
+
+  /// Tries to borrow a buffer from the pool, of the smallest class that has
+  /// one free.
   ///
   /// Returns `None` if all buffers are currently in use.
   /// The buffer is automatically returned to the pool when dropped.
@@ -428,10 +830,91 @@ impl BufStore {
   /// - `Some(LentBuf)`: A borrowed buffer from the pool
   /// - `None`: All buffers are in use
   pub fn try_get(&self) -> Option<LentBuf<'_>> {
-    let index = self.free_rx.try_recv().ok()?;
+    self.try_get_len(0)
+  }
+
+  /// Tries to borrow a buffer of at least `len` bytes, from the smallest
+  /// class that fits and has one free.
+  ///
+  /// Returns `None` if no class fits or all that do are in use.
+  pub fn try_get_len(&self, len: usize) -> Option<LentBuf<'_>> {
+    if self.is_owner() && self.waiting.load(Ordering::SeqCst) > 0 {
+      self.spill();
+    }
+    let index = self.pop(len)?;
     Some(self.acquire_buffer(index))
   }
 
+  /// Pops a free buffer of at least `len` bytes, from the smallest class that
+  /// fits and has one.
+  fn pop(&self, len: usize) -> Option<u32> {
+    let owner = self.is_owner();
+    self.classes.iter().filter(|class| class.buf_len >= len).find_map(|class| {
+      let local = if owner {
+        // SAFETY: Only the owning thread touches `local`, and never
+        // reentrantly.
+        unsafe { &mut *class.local.get() }.pop()
+      } else {
+        None
+      };
+      local.or_else(|| class.shared.pop(&self.buffers))
+    })
+  }
+
+  /// Puts buffer `index` back on a free list, see [`LentBuf`]'s drop.
+  fn put(&self, index: u32) {
+    let cell = &self.buffers[index as usize];
+    let class = &self.classes[cell.class as usize];
+    cell.in_use.store(false, Ordering::Release);
+    self.available.fetch_add(1, Ordering::Relaxed);
+
+    if self.is_owner() {
+      // SAFETY: Only the owning thread touches `local`, and never
+      // reentrantly.
+      let local = unsafe { &mut *class.local.get() };
+      if local.len() < class.local_cap {
+        local.push(index);
+        // Pairs with the increment in `wait_for`: either this sees the
+        // waiter, or the waiter came after and gets what's spilled next.
+        if self.waiting.load(Ordering::SeqCst) > 0 {
+          self.spill();
+        }
+        return;
+      }
+    }
+    class.shared.push(&self.buffers, index);
+    self.wake_waiting();
+  }
+
+  /// Moves the owner's lists to the shared stacks, for the threads blocked in
+  /// `get`, which can't reach them.
+  fn spill(&self) {
+    // Under the lock, so a thread about to wait can't miss the wakeup.
+    let _guard = self.wait_lock.lock().unwrap_or_else(|e| e.into_inner());
+    if self.waiting.load(Ordering::SeqCst) == 0 {
+      return;
+    }
+    for class in &self.classes {
+      // SAFETY: Only the owning thread touches `local`, and never
+      // reentrantly.
+      let local = unsafe { &mut *class.local.get() };
+      while let Some(index) = local.pop() {
+        class.shared.push(&self.buffers, index);
+      }
+    }
+    self.returned.notify_all();
+  }
+
+  fn wake_waiting(&self) {
+    // Orders the push before the check, against the waiter counting itself
+    // before it pops.
+    atomic::fence(Ordering::SeqCst);
+    if self.waiting.load(Ordering::SeqCst) > 0 {
+      let _guard = self.wait_lock.lock().unwrap_or_else(|e| e.into_inner());
+      self.returned.notify_all();
+    }
+  }
+
   /// Blocks until a buffer is available and returns it.
   ///
   /// This will wait indefinitely until a buffer becomes available.
@@ -441,8 +924,7 @@ impl BufStore {
   ///
   /// A borrowed buffer from the pool
   pub fn get(&self) -> LentBuf<'_> {
-    let index = self.free_rx.recv().expect("channel should not disconnect");
-    self.acquire_buffer(index)
+    self.wait_for(None).expect("waits without a deadline")
   }
 
   /// Tries to borrow a buffer with a timeout.
@@ -458,10 +940,37 @@ impl BufStore {
   /// - `Some(LentBuf)`: A borrowed buffer from the pool
   /// - `None`: Timeout expired before a buffer became available
   pub fn get_timeout(&self, timeout: Duration) -> Option<LentBuf<'_>> {
-    match self.free_rx.recv_timeout(timeout) {
-      Ok(index) => Some(self.acquire_buffer(index)),
-      Err(_) => None,
+    self.wait_for(Some(Instant::now() + timeout))
+  }
+
+  fn wait_for(&self, deadline: Option<Instant>) -> Option<LentBuf<'_>> {
+    if let Some(buf) = self.try_get() {
+      return Some(buf);
     }
+    // Counted under the lock, which a spilling owner takes to check it.
+    let mut guard = self.wait_lock.lock().unwrap_or_else(|e| e.into_inner());
+    self.waiting.fetch_add(1, Ordering::SeqCst);
+    let buf = loop {
+      // Checked under the lock, so a return in between still wakes us. Not
+      // through `try_get`, whose spilling would take the lock again.
+      if let Some(index) = self.pop(0) {
+        break Some(self.acquire_buffer(index));
+      }
+      guard = match deadline {
+        None => self.returned.wait(guard).unwrap_or_else(|e| e.into_inner()),
+        Some(deadline) => {
+          let Some(left) = deadline.checked_duration_since(Instant::now())
+          else {
+            break None;
+          };
+          let waited = self.returned.wait_timeout(guard, left);
+          waited.unwrap_or_else(|e| e.into_inner()).0
+        }
+      };
+    };
+    drop(guard);
+    self.waiting.fetch_sub(1, Ordering::SeqCst);
+    buf
   }
 
   /// Internal helper to acquire a buffer by index.
@@ -474,6 +983,7 @@ impl BufStore {
       "BufStore invariant violated: buffer {} (popped from free_list) already in use",
       index
     );
+    self.available.fetch_sub(1, Ordering::Relaxed);
 
     // Reset state for new use
     cell.len.store(0, Ordering::Relaxed);
@@ -487,11 +997,207 @@ impl BufStore {
     self.buffers.len()
   }
 
+  /// Returns the pool's size classes, smallest first.
+  pub fn classes(&self) -> impl Iterator<Item = SizeClass> + '_ {
+    self.classes.iter().map(|class| SizeClass::new(class.buf_len, class.count))
+  }
+
   /// Returns the number of currently available buffers.
   ///
   /// Note: This is a snapshot and may be stale immediately.
   pub fn available(&self) -> usize {
-    self.free_rx.len()
+    self.available.load(Ordering::Relaxed)
+  }
+
+  /// Returns one [`IoSlice`](std::io::IoSlice) per buffer, in index order.
+  ///
+  /// Used to register the pool with io_uring as fixed buffers, so that the
+  /// slice at index `i` matches [`LentBuf::index`] `i`.
+  pub(crate) fn io_slices(&self) -> Vec<std::io::IoSlice<'_>> {
+    self
+      .buffers
+      .iter()
+      .map(|cell| {
+        // SAFETY: The slices only describe address ranges for registration
+        // and are dropped before any buffer is lent out through them.
+        let buf = unsafe { &*cell.buf.get() };
+        std::io::IoSlice::new(buf)
+      })
+      .collect()
+  }
+
+  /// Takes back the buffer at `index` given up through
+  /// [`LentBuf::into_index`], with its valid range emptied, or `None` if it
+  /// isn't lent out.
+  #[cfg(feature = "unstable_ffi")]
+  pub(crate) fn lent(&self, index: u32) -> Option<LentBuf<'_>> {
+    let cell = self.buffers.get(index as usize)?;
+    if !cell.in_use.load(Ordering::Acquire) {
+      return None;
+    }
+    cell.len.store(0, Ordering::Relaxed);
+    cell.pos.store(0, Ordering::Relaxed);
+    Some(LentBuf { index, pool: self })
+  }
+
+  /// Returns true if `[ptr, ptr + len)` lies inside the buffer at `index`.
+  pub(crate) fn owns(&self, index: u32, ptr: *const u8, len: usize) -> bool {
+    let Some(cell) = self.buffers.get(index as usize) else {
+      return false;
+    };
+    let start = cell.buf.get() as *const u8 as usize;
+    let ptr = ptr as usize;
+    ptr >= start && ptr + len <= start + cell.buf.get().len()
+  }
+}
+
+impl Drop for BufStore {
+  fn drop(&mut self) {
+    // SAFETY: Allocated in `with_classes` with this layout. Lent buffers
+    // borrow the store, so none are left.
+    unsafe { std::alloc::dealloc(self.arena, self.layout) };
+  }
+}
+
+/// A ring of equally sized buffers that the kernel fills on its own.
+///
+/// Unlike [`BufStore`], nothing is lent out before an operation starts: a
+/// multishot receive ([`api::recv_multi`](crate::api::recv_multi)) only takes
+/// a buffer once data has arrived and hands it over as a [`RingChunk`].
+/// Dropping the chunk gives the buffer back to the ring, so the memory in use
+/// is `entries * buf_len` no matter how many sockets share the ring.
+///
+/// Created with [`Lio::register_buf_ring`](crate::Lio::register_buf_ring).
+#[derive(Clone)]
+pub struct BufRing {
+  inner: Arc<BufRingInner>,
+}
+
+struct BufRingInner {
+  group: u16,
+  entries: u16,
+  buf_len: u32,
+  mem: Box<[UnsafeCell<u8>]>,
+  free_tx: Sender<u16>,
+  free_rx: Receiver<u16>,
+}
+
+// SAFETY: A buffer is only accessed by whoever holds its id: the backend (or
+// kernel) after taking it from the free list, then the RingChunk it's handed
+// to. Ids go back to the free list only once that access has ended.
+unsafe impl Send for BufRingInner {}
+// SAFETY: ---- :: ----
+unsafe impl Sync for BufRingInner {}
+
+impl BufRing {
+  /// Allocates `entries` buffers of `buf_len` bytes for buffer group `group`.
+  pub(crate) fn new(group: u16, entries: u16, buf_len: u32) -> Self {
+    let (free_tx, free_rx) = crossbeam_channel::unbounded();
+    for bid in 0..entries {
+      free_tx.send(bid).expect("channel should not be full");
+    }
+    let mem = (0..entries as usize * buf_len as usize)
+      .map(|_| UnsafeCell::new(0))
+      .collect();
+    Self {
+      inner: Arc::new(BufRingInner {
+        group,
+        entries,
+        buf_len,
+        mem,
+        free_tx,
+        free_rx,
+      }),
+    }
+  }
+
+  /// Buffer group id the kernel selects buffers from.
+  pub fn group(&self) -> u16 {
+    self.inner.group
+  }
+
+  /// Number of buffers in the ring.
+  pub fn entries(&self) -> u16 {
+    self.inner.entries
+  }
+
+  /// Size of each buffer, the most a single chunk can hold.
+  pub fn buf_len(&self) -> u32 {
+    self.inner.buf_len
+  }
+
+  /// Takes a free buffer id.
+  ///
+  /// Used by backends that pick buffers themselves, and by io_uring backends
+  /// to collect ids to hand to the kernel.
+  pub(crate) fn take(&self) -> Option<u16> {
+    self.inner.free_rx.try_recv().ok()
+  }
+
+  /// Puts `bid` back on the free list.
+  pub(crate) fn put(&self, bid: u16) {
+    let _ = self.inner.free_tx.send(bid);
+  }
+
+  /// Start of the buffer `bid`, valid for [`buf_len`](Self::buf_len) bytes.
+  pub(crate) fn buf_ptr(&self, bid: u16) -> *mut u8 {
+    assert!(bid < self.inner.entries, "BufRing: buffer id {bid} out of range");
+    let offset = bid as usize * self.inner.buf_len as usize;
+    UnsafeCell::raw_get(self.inner.mem[offset..].as_ptr())
+  }
+
+  /// Wraps buffer `bid`, holding `len` received bytes, into a chunk.
+  pub(crate) fn chunk(&self, bid: u16, len: usize) -> RingChunk {
+    assert!(len <= self.inner.buf_len as usize, "BufRing: chunk too long");
+    RingChunk { ring: self.clone(), bid, len }
+  }
+}
+
+/// Data received into a [`BufRing`] buffer.
+///
+/// Derefs to the received bytes. The buffer returns to the ring when the
+/// chunk is dropped; while chunks are held, the ring has that many fewer
+/// buffers to receive into.
+pub struct RingChunk {
+  ring: BufRing,
+  bid: u16,
+  len: usize,
+}
+
+impl RingChunk {
+  /// Id of the ring buffer holding the data.
+  pub fn buf_id(&self) -> u16 {
+    self.bid
+  }
+}
+
+impl std::ops::Deref for RingChunk {
+  type Target = [u8];
+
+  fn deref(&self) -> &[u8] {
+    // SAFETY: The chunk holds `bid`, nothing else accesses the buffer until it
+    // is dropped. `len` was checked against the buffer size in `chunk`.
+    unsafe { slice::from_raw_parts(self.ring.buf_ptr(self.bid), self.len) }
+  }
+}
+
+impl AsRef<[u8]> for RingChunk {
+  fn as_ref(&self) -> &[u8] {
+    self
+  }
+}
+
+impl Drop for RingChunk {
+  fn drop(&mut self) {
+    #[cfg(feature = "zeroize")]
+    zeroize::Zeroize::zeroize(
+      // SAFETY: Same as in deref, the chunk still owns the buffer.
+      unsafe {
+        slice::from_raw_parts_mut(self.ring.buf_ptr(self.bid), self.len)
+      },
+    );
+
+    self.ring.put(self.bid);
   }
 }
 
@@ -632,6 +1338,43 @@ mod tests {
     assert_eq!(buf.chunk(), b"!");
   }
 
+  #[test]
+  fn test_lent_buf_extend_and_consume() {
+    let store = Box::leak(Box::new(BufStore::with_capacity(1)));
+    let mut buf = store.try_get().expect("should get buffer from pool");
+
+    buf.extend_from_slice(b"Hello");
+    buf.extend_from_slice(b", World");
+    assert_eq!(buf.as_ref(), b"Hello, World");
+
+    buf.consume(7);
+    assert_eq!(buf.as_ref(), b"World");
+  }
+
+  #[test]
+  #[should_panic]
+  fn test_lent_buf_extend_overflow() {
+    let store = Box::leak(Box::new(BufStore::with_capacity(1)));
+    let mut buf = store.try_get().expect("should get buffer from pool");
+    buf.extend_from_slice(&[0u8; BUF_LEN + 1]);
+  }
+
+  #[test]
+  fn test_bufstore_io_slices_match_indices() {
+    let store = Box::leak(Box::new(BufStore::with_capacity(4)));
+    let slices = store.io_slices();
+    assert_eq!(slices.len(), 4);
+
+    let buf = store.try_get().unwrap();
+    let slice = &slices[buf.index() as usize];
+    assert_eq!(slice.as_ptr(), buf.buf().as_ptr());
+    assert_eq!(slice.len(), BUF_LEN);
+
+    assert!(store.owns(buf.index(), buf.buf().as_ptr(), BUF_LEN));
+    assert!(!store.owns(buf.index(), buf.buf().as_ptr(), BUF_LEN + 1));
+    assert!(!store.owns(4, buf.buf().as_ptr(), 1));
+  }
+
   // ============================================================================
   // BufStore Tests
   // ============================================================================
@@ -955,4 +1698,211 @@ mod tests {
     let available: Vec<_> = (0..32).filter_map(|_| store.try_get()).collect();
     assert_eq!(available.len(), 32, "no buffers should be lost");
   }
+
+  #[test]
+  fn test_bufstore_size_classes() {
+    let store = Box::leak(Box::new(BufStore::with_classes(&[
+      SizeClass::new(16 * 1024, 1),
+      SizeClass::new(2048, 2),
+    ])));
+    assert_eq!(
+      store.classes().collect::<Vec<_>>(),
+      [SizeClass::new(2048, 2), SizeClass::new(16 * 1024, 1)]
+    );
+    assert_eq!(store.capacity(), 3);
+
+    // Smallest class that fits.
+    let small = store.try_get().unwrap();
+    assert_eq!(small.capacity(), 2048);
+    let big = store.try_get_len(4096).unwrap();
+    assert_eq!(big.capacity(), 16 * 1024);
+    assert!(store.try_get_len(4096).is_none());
+    assert!(store.try_get_len(64 * 1024).is_none());
+
+    // Falls through to a bigger class once the small one runs out.
+    drop(big);
+    let small2 = store.try_get().unwrap();
+    assert_eq!(small2.capacity(), 2048);
+    let big = store.try_get().unwrap();
+    assert_eq!(big.capacity(), 16 * 1024);
+    assert_eq!(store.available(), 0);
+    drop((small, small2, big));
+    assert_eq!(store.available(), 3);
+  }
+
+  #[test]
+  fn test_bufstore_arena_layout() {
+    let store = Box::leak(Box::new(BufStore::with_classes(&[
+      SizeClass::new(1000, 2),
+      SizeClass::new(8192, 2),
+    ])));
+    let slices = store.io_slices();
+    for (slice, expected) in slices.iter().zip([1000, 1000, 8192, 8192]) {
+      assert_eq!(slice.len(), expected);
+    }
+    // One arena, each buffer aligned to its size up to a page.
+    assert_eq!(slices[0].as_ptr() as usize % 1024, 0);
+    assert_eq!(slices[1].as_ptr() as usize - slices[0].as_ptr() as usize, 1024);
+    assert_eq!(slices[2].as_ptr() as usize % 4096, 0);
+    assert_eq!(slices[3].as_ptr() as usize - slices[2].as_ptr() as usize, 8192);
+    assert!(slices[2].as_ptr() > slices[1].as_ptr());
+
+    let mut buf = store.try_get().unwrap();
+    buf.extend_from_slice(&[1; 1000]);
+    assert!(store.owns(buf.index(), buf.buf().as_ptr(), 1000));
+    assert!(!store.owns(buf.index(), buf.buf().as_ptr(), 1001));
+  }
+
+  #[test]
+  #[should_panic(expected = "doesn't fit")]
+  fn test_lent_buf_extend_past_class() {
+    let store =
+      Box::leak(Box::new(BufStore::with_classes(&[SizeClass::new(16, 1)])));
+    let mut buf = store.try_get().unwrap();
+    buf.extend_from_slice(&[0; 17]);
+  }
+
+  #[test]
+  #[cfg(feature = "unstable_ffi")]
+  fn test_lent_buf_into_index() {
+    let store = BufStore::with_capacity(2);
+    let mut buf = store.try_get().unwrap();
+    buf.extend_from_slice(b"kept");
+    let index = buf.into_index();
+    assert_eq!(store.available(), 1);
+
+    let buf = store.lent(index).expect("still lent out");
+    assert!(buf.as_ref().is_empty());
+    drop(buf);
+    assert_eq!(store.available(), 2);
+    assert!(store.lent(index).is_none());
+    assert!(store.lent(2).is_none());
+  }
+
+  #[test]
+  fn test_aligned_buf() {
+    for align in [512, 4096] {
+      let mut buf = AlignedBuf::new(align * 2, align);
+      assert_eq!(buf.buf().as_ptr() as usize % align, 0);
+      assert_eq!((buf.align(), buf.capacity()), (align, align * 2));
+      assert!(buf.as_ref().is_empty());
+
+      buf.as_mut_slice()[..4].copy_from_slice(b"data");
+      let buf = buf.after(4);
+      assert_eq!(buf.as_ref(), b"data");
+      assert_eq!(buf.buf().len(), align * 2);
+    }
+  }
+
+  #[test]
+  #[should_panic]
+  fn test_aligned_buf_rejects_partial_blocks() {
+    AlignedBuf::new(1000, 512);
+  }
+
+  #[test]
+  #[cfg(not(miri))]
+  fn test_bufstore_cross_thread_return() {
+    let store: &'static BufStore =
+      Box::leak(Box::new(BufStore::with_capacity(4)));
+    let bufs: Vec<_> = (0..4).map(|_| store.try_get().unwrap()).collect();
+    assert!(store.try_get().is_none());
+
+    // Returned from elsewhere, the owner can take them all again.
+    std::thread::spawn(move || drop(bufs)).join().unwrap();
+    assert_eq!(store.available(), 4);
+    let again: Vec<_> = (0..4).map(|_| store.try_get().unwrap()).collect();
+    assert!(store.try_get().is_none());
+
+    // Returned by the owner, which keeps at most half for itself.
+    drop(again);
+    let taken = std::thread::spawn(move || {
+      (0..2).map(|_| store.get()).collect::<Vec<_>>().len()
+    });
+    assert_eq!(taken.join().unwrap(), 2);
+    assert_eq!(store.available(), 4);
+  }
+
+  #[test]
+  #[cfg(not(miri))]
+  fn test_bufstore_owner_spills_for_waiter() {
+    let store: &'static BufStore =
+      Box::leak(Box::new(BufStore::with_capacity(4)));
+    drop((0..4).map(|_| store.try_get().unwrap()).collect::<Vec<_>>());
+
+    // Two are shared, two on the owner's list, out of the waiter's reach.
+    let waiter = std::thread::spawn(move || {
+      let shared: Vec<_> = (0..2).map(|_| store.get()).collect();
+      let spilled = store.get();
+      (shared.len(), spilled.index())
+    });
+    while store.waiting.load(Ordering::SeqCst) == 0 {
+      std::thread::yield_now();
+    }
+    // The owner lending anything spills its list for the blocked thread.
+    let lent = store.try_get().unwrap();
+    let (shared, spilled) = waiter.join().unwrap();
+    assert_eq!(shared, 2);
+    assert_ne!(spilled, lent.index());
+  }
+
+  #[test]
+  #[cfg(not(miri))]
+  fn test_bufstore_get_from_other_thread() {
+    let store: &'static BufStore =
+      Box::leak(Box::new(BufStore::with_capacity(1)));
+    let buf = store.try_get().unwrap();
+
+    let waiter = std::thread::spawn(move || store.get().index());
+    while store.waiting.load(Ordering::SeqCst) == 0 {
+      std::thread::yield_now();
+    }
+    // The owner returns it where the blocked thread can take it.
+    drop(buf);
+    assert_eq!(waiter.join().unwrap(), 0);
+
+    assert!(store.get_timeout(Duration::from_millis(10)).is_some());
+    let held = store.try_get().unwrap();
+    let timed_out = std::thread::spawn(move || {
+      store.get_timeout(Duration::from_millis(10)).is_none()
+    });
+    assert!(timed_out.join().unwrap());
+    drop(held);
+  }
+
+  #[test]
+  fn test_buf_ring_chunk_returns_buffer() {
+    let ring = BufRing::new(0, 2, 16);
+    let a = ring.take().unwrap();
+    let b = ring.take().unwrap();
+    assert!(ring.take().is_none());
+
+    // SAFETY: `a` was taken from the free list, nothing else uses it.
+    unsafe { ring.buf_ptr(a).copy_from_nonoverlapping(b"hello".as_ptr(), 5) };
+    let chunk = ring.chunk(a, 5);
+    assert_eq!(&*chunk, b"hello");
+    assert_eq!(chunk.buf_id(), a);
+
+    drop(chunk);
+    assert_eq!(ring.take(), Some(a));
+    ring.put(b);
+    assert_eq!(ring.take(), Some(b));
+  }
+
+  #[test]
+  fn test_buf_ring_buffers_dont_overlap() {
+    let ring = BufRing::new(3, 4, 64);
+    assert_eq!(ring.group(), 3);
+    for bid in 1..ring.entries() {
+      let prev = ring.buf_ptr(bid - 1) as usize;
+      assert_eq!(ring.buf_ptr(bid) as usize - prev, ring.buf_len() as usize);
+    }
+  }
+
+  #[test]
+  #[should_panic(expected = "out of range")]
+  fn test_buf_ring_id_out_of_range() {
+    let ring = BufRing::new(0, 4, 64);
+    ring.buf_ptr(4);
+  }
 }
@@ -0,0 +1,172 @@
+//! Spinning for completions before [`Lio::run`](crate::Lio::run) blocks, see
+//! [`BusyPoll`].
+//!
+//! Blocking costs a sleep and a wakeup in the kernel for every completion,
+//! which under bursty traffic is most of the latency. Spinning on the
+//! completion queue instead finds what arrives within the window without
+//! either, at the cost of a busy CPU.
+
+use std::time::{Duration, Instant};
+
+/// How long [`Lio::run`](crate::Lio::run) and
+/// [`Lio::run_timeout`](crate::Lio::run_timeout) poll for completions before
+/// blocking in the kernel.
+///
+/// Each poll is what [`Lio::try_run`](crate::Lio::try_run) does: on io_uring a
+/// look at the completion queue without a syscall, on the polling backend a
+/// zero timeout `epoll_wait`/`kevent`. Pair it with
+/// [`Socket::set_busy_poll`](crate::net::Socket::set_busy_poll) to have the
+/// kernel poll the device queue too.
+///
+/// # Example
+///
+/// ```no_run
+/// use std::time::Duration;
+/// use lio::{BusyPoll, Lio};
+///
+/// let lio = Lio::builder(1024)
+///   .busy_poll(BusyPoll::Adaptive { max: Duration::from_micros(50) })
+///   .build()
+///   .unwrap();
+/// ```
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub enum BusyPoll {
+  /// Blocks right away, the default.
+  #[default]
+  Off,
+  /// Spins for this long every time.
+  Fixed(Duration),
+  /// Spins for about twice the recent time runs waited for a completion, at
+  /// most `max`. Once that's longer than `max`, spinning would mostly miss,
+  /// so it blocks right away until completions come quicker again.
+  Adaptive {
+    /// Longest spin.
+    max: Duration,
+  },
+}
+
+/// Weight of the newest wait in the average, as a shift: 1/8.
+const WEIGHT_SHIFT: u32 = 3;
+
+/// A [`BusyPoll`] and the waits it adapts to.
+#[derive(Debug, Default)]
+pub(crate) struct Spinner {
+  mode: BusyPoll,
+  /// Moving average of how long runs waited for their first completion, in
+  /// nanoseconds. Waits are capped at twice the maximum spin, so a long idle
+  /// stretch only counts as a miss.
+  average: u64,
+}
+
+impl Spinner {
+  pub(crate) fn new(mode: BusyPoll) -> Self {
+    Self { mode, average: 0 }
+  }
+
+  pub(crate) fn set_mode(&mut self, mode: BusyPoll) {
+    *self = Self::new(mode);
+  }
+
+  pub(crate) fn is_off(&self) -> bool {
+    self.mode == BusyPoll::Off
+  }
+
+  /// How long the next run spins.
+  pub(crate) fn window(&self) -> Duration {
+    match self.mode {
+      BusyPoll::Off => Duration::ZERO,
+      BusyPoll::Fixed(window) => window,
+      BusyPoll::Adaptive { max } => {
+        let max = nanos(max);
+        if self.average >= max {
+          return Duration::ZERO;
+        }
+        Duration::from_nanos(self.average.saturating_mul(2).min(max))
+      }
+    }
+  }
+
+  /// Notes that a run started at `start` got its first completion, or gave
+  /// up waiting, just now.
+  pub(crate) fn record(&mut self, start: Instant) {
+    self.record_wait(start.elapsed());
+  }
+
+  fn record_wait(&mut self, waited: Duration) {
+    let BusyPoll::Adaptive { max } = self.mode else { return };
+    let sample = nanos(waited).min(nanos(max).saturating_mul(2));
+    // Fixed point, the shifts dropping bits below a few nanoseconds.
+    self.average =
+      self.average - (self.average >> WEIGHT_SHIFT) + (sample >> WEIGHT_SHIFT);
+  }
+}
+
+fn nanos(duration: Duration) -> u64 {
+  duration.as_nanos().min(u64::MAX as u128) as u64
+}
+
+#[cfg(test)]
+mod tests {
+  use super::*;
+
+  fn us(us: u64) -> Duration {
+    Duration::from_micros(us)
+  }
+
+  fn adaptive(max: u64) -> Spinner {
+    Spinner::new(BusyPoll::Adaptive { max: us(max) })
+  }
+
+  #[test]
+  fn test_off_and_fixed() {
+    let mut spinner = Spinner::default();
+    assert!(spinner.is_off());
+    assert_eq!(spinner.window(), Duration::ZERO);
+
+    spinner.set_mode(BusyPoll::Fixed(us(20)));
+    spinner.record_wait(us(1000));
+    assert_eq!(spinner.window(), us(20));
+  }
+
+  #[test]
+  fn test_adaptive_follows_short_waits() {
+    let mut spinner = adaptive(100);
+    // Starts out spinning for nothing, then learns the waits.
+    assert_eq!(spinner.window(), Duration::ZERO);
+    for _ in 0..64 {
+      spinner.record_wait(us(10));
+    }
+    let window = spinner.window();
+    assert!(window > us(18) && window <= us(20), "{window:?}");
+  }
+
+  #[test]
+  fn test_adaptive_caps_at_max() {
+    let mut spinner = adaptive(100);
+    for _ in 0..64 {
+      spinner.record_wait(us(80));
+    }
+    assert_eq!(spinner.window(), us(100));
+  }
+
+  #[test]
+  fn test_adaptive_stops_and_recovers() {
+    let mut spinner = adaptive(100);
+    for _ in 0..64 {
+      spinner.record_wait(us(10));
+    }
+    // Idle: every wait is longer than any spin would be.
+    for _ in 0..64 {
+      spinner.record_wait(Duration::from_secs(1));
+    }
+    assert_eq!(spinner.window(), Duration::ZERO);
+
+    // A burst brings it back within a handful of completions.
+    let mut completions = 0;
+    while spinner.window().is_zero() {
+      spinner.record_wait(us(5));
+      completions += 1;
+    }
+    assert!(completions <= 8, "took {completions} completions");
+  }
+}
@@ -3,6 +3,7 @@
 //! The C API is built around an opaque `lio_t` handle that wraps a [`Lio`]
 //! driver. Each handle is single-threaded; the caller is responsible for
 //! ensuring that no two threads call functions on the same handle concurrently.
+//! Other threads hand work to it through a `lio_remote_t`, see [`lio_remote`].
 //!
 //! ## Typical usage
 //!
@@ -11,11 +12,11 @@
 //! if (!lio) { /* handle error */ }
 //!
 //! // Submit an operation
-//! lio_timeout(lio, 100, my_callback);
+//! uint64_t id = lio_timeout(lio, 100, my_callback);
 //!
-//! // Drive the event loop (non-blocking)
+//! // Drive the event loop, sleeping until something completes
 //! while (pending_work) {
-//!     lio_tick(lio);
+//!     lio_run(lio);
 //! }
 //!
 //! lio_destroy(lio);
@@ -30,19 +31,64 @@
 //!
 //! Operations that accept a `buf` pointer take **ownership** of that buffer.
 //! The buffer is returned via the callback and must be freed by the caller.
+//!
+//! Their `_borrowed` variants leave the buffer with the caller instead, who
+//! only has to keep it valid until the callback, so it can live in an arena or
+//! slab.  A handle created with `lio_config_t::buf_count` also has a pool of
+//! buffers registered with the kernel, see [`lio_buf_get`]:
+//!
+//! ```c
+//! lio_buf_t buf;
+//! if (lio_buf_get(lio, 1500, &buf) == 0) {
+//!     lio_read_fixed(lio, fd, buf.index, 0, on_read);
+//! }
+//! // in on_read(res, index): use buf.data, then lio_buf_put(lio, index)
+//! ```
+//!
+//! ## Cancellation
+//!
+//! Every operation returns an id to pass to [`lio_cancel`], after which its
+//! callback gets `-ECANCELED` unless it completed first. Operations rejected
+//! before they were submitted call back right away and return [`LIO_NO_OP`].
+//!
+//! ## Batches
+//!
+//! [`lio_submit_batch`] submits an array of `lio_sqe_t` at once, each
+//! carrying a `user_data` pointer.  Those operations don't call back, their
+//! `lio_cqe_t` waits for [`lio_reap`] instead:
+//!
+//! ```c
+//! lio_sqe_t sqes[64] = {0};
+//! // fill in opcode, fd, buf, len and user_data ...
+//! int submitted = lio_submit_batch(lio, sqes, 64);
+//!
+//! lio_cqe_t cqes[64];
+//! lio_tick(lio);
+//! int n = lio_reap(lio, cqes, 64);
+//! for (int i = 0; i < n; i++) {
+//!     handle(cqes[i].user_data, cqes[i].res);
+//! }
+//! ```
+//!
+//! ## Metrics
+//!
+//! With the `metrics` feature, [`lio_stats`] copies out the handle's counters,
+//! cheap enough to call every second. Without it, it returns `-ENOTSUP`.
 #![allow(clippy::not_unsafe_ptr_arg_deref)]
 
 use std::{
   mem,
   net::{Ipv4Addr, Ipv6Addr, SocketAddr, SocketAddrV4, SocketAddrV6},
-  ptr,
+  ptr, slice,
   time::Duration,
 };
 
 use crate::{
-  Lio,
+  Lio, LioRemote, OpId,
   api::{self, resource::Resource},
+  buf::{BufLike, BufStore, SizeClass},
   net_utils,
+  op::{Op, OpBuf, RawBuf},
 };
 
 #[cfg(unix)]
@@ -55,6 +101,9 @@ use std::os::fd::{FromRawFd, RawFd};
 #[allow(non_camel_case_types)]
 pub struct lio_handle_t {
   inner: Lio,
+  /// Pool of `lio_config_t::buf_count` buffers, leaked so the driver can
+  /// register it and freed by [`lio_destroy`] after the driver.
+  bufs: Option<&'static BufStore>,
 }
 
 /// Cast a raw `*mut lio_handle_t` back to `&mut lio_handle_t`.
@@ -89,6 +138,85 @@ fn resource_to_fd(r: &Resource) -> libc::intptr_t {
   r.as_raw_fd() as libc::intptr_t
 }
 
+/// Take ownership of the `malloc`'d buffers `iov` describes, or `None` if the
+/// list itself is invalid.
+///
+/// # Safety
+/// `iov` must point to `iovcnt` iovecs, each with a non-null `iov_base` of at
+/// least `iov_len` bytes allocated with `malloc`.
+#[cfg(unix)]
+unsafe fn iovecs_to_bufs(
+  iov: *const libc::iovec,
+  iovcnt: libc::c_int,
+) -> Option<Vec<Vec<u8>>> {
+  if iovcnt < 0 || (iov.is_null() && iovcnt > 0) {
+    return None;
+  }
+  if iovcnt == 0 {
+    return Some(Vec::new());
+  }
+  // SAFETY: caller guarantees iov points to iovcnt iovecs, non-null checked above
+  let iovecs = unsafe { std::slice::from_raw_parts(iov, iovcnt as usize) };
+  let bufs = iovecs
+    .iter()
+    .map(|v| {
+      // SAFETY: C caller transfers malloc ownership of each buffer
+      unsafe { Vec::from_raw_parts(v.iov_base.cast(), v.iov_len, v.iov_len) }
+    })
+    .collect();
+  Some(bufs)
+}
+
+/// Return ownership of `bufs` to C, as iovecs over the original pointers
+/// that are valid for the duration of `f`.
+#[cfg(unix)]
+fn bufs_to_iovecs(
+  bufs: Vec<Vec<u8>>,
+  f: impl FnOnce(*const libc::iovec, libc::c_int),
+) {
+  let iovecs: Vec<libc::iovec> = bufs
+    .into_iter()
+    .map(|buf| {
+      let mut buf = mem::ManuallyDrop::new(buf);
+      libc::iovec { iov_base: buf.as_mut_ptr().cast(), iov_len: buf.len() }
+    })
+    .collect();
+  f(iovecs.as_ptr(), iovecs.len() as libc::c_int);
+}
+
+/// A buffer that stays owned by C, for the `_borrowed` operations.
+struct CBuf {
+  ptr: *mut u8,
+  len: usize,
+}
+
+impl CBuf {
+  /// `None` for a null `ptr` with a nonzero `len`.
+  fn new(ptr: *mut u8, len: usize) -> Option<Self> {
+    (!ptr.is_null() || len == 0).then_some(Self { ptr, len })
+  }
+}
+
+// SAFETY: Callers of the `_borrowed` operations keep the buffer valid and
+// leave it alone until the callback.
+unsafe impl Send for CBuf {}
+// SAFETY: ---- :: ----
+unsafe impl Sync for CBuf {}
+
+impl BufLike for CBuf {
+  fn buf(&self) -> &[u8] {
+    if self.ptr.is_null() {
+      return &[];
+    }
+    // SAFETY: valid for len bytes, see the Send impl
+    unsafe { slice::from_raw_parts(self.ptr, self.len) }
+  }
+
+  fn after(self, bytes: usize) -> Self {
+    Self { len: bytes, ..self }
+  }
+}
+
 /// Converts a raw libc::sockaddr pointer and length into a safe std::net::SocketAddr.
 fn sockaddr_to_socketaddr(
   raw_addr_ptr: *const libc::sockaddr,
@@ -143,14 +271,122 @@ fn sockaddr_to_socketaddr(
 #[unsafe(no_mangle)]
 pub extern "C" fn lio_create(capacity: libc::c_uint) -> *mut lio_handle_t {
   match Lio::new(capacity as usize) {
-    Ok(inner) => Box::into_raw(Box::new(lio_handle_t { inner })),
+    Ok(inner) => Box::into_raw(Box::new(lio_handle_t { inner, bufs: None })),
     Err(_) => ptr::null_mut(),
   }
 }
 
+/// Start the SQPOLL kernel thread, idling after `sqpoll_idle_ms`.
+pub const LIO_CONFIG_SQPOLL: u32 = 1 << 0;
+/// Pin the SQPOLL thread to `sqpoll_cpu`.
+pub const LIO_CONFIG_SQPOLL_CPU: u32 = 1 << 1;
+/// Busy-poll for completions (`O_DIRECT` files only).
+pub const LIO_CONFIG_IOPOLL: u32 = 1 << 2;
+/// Run completion work cooperatively (Linux 5.19).
+pub const LIO_CONFIG_COOP_TASKRUN: u32 = 1 << 3;
+/// Defer completion work until the loop waits (Linux 6.1).
+pub const LIO_CONFIG_DEFER_TASKRUN: u32 = 1 << 4;
+/// Only the creating thread submits (Linux 6.0).
+pub const LIO_CONFIG_SINGLE_ISSUER: u32 = 1 << 5;
+
+/// Options for [`lio_create_ex`].  Zero-initialise it and set what you need;
+/// an all-zero config besides `capacity` behaves like [`lio_create`].
+///
+/// The flags only apply to the io_uring backend and are ignored elsewhere.
+#[repr(C)]
+#[allow(non_camel_case_types)]
+pub struct lio_config_t {
+  /// Maximum number of concurrent operations.
+  pub capacity: libc::c_uint,
+  /// Bitwise OR of `LIO_CONFIG_*` flags.
+  pub flags: libc::c_uint,
+  /// Idle time before the SQPOLL thread sleeps, with `LIO_CONFIG_SQPOLL`.
+  pub sqpoll_idle_ms: libc::c_uint,
+  /// CPU for the SQPOLL thread, with `LIO_CONFIG_SQPOLL_CPU`.
+  pub sqpoll_cpu: libc::c_uint,
+  /// Completion queue size, or 0 for twice `capacity`.
+  pub cq_entries: libc::c_uint,
+  /// Buffers in the pool of [`lio_buf_get`], or 0 for none.  They're
+  /// registered with the kernel for [`lio_read_fixed`] and [`lio_write_fixed`].
+  pub buf_count: libc::c_uint,
+  /// Size of each pool buffer in bytes, or 0 for 4096.
+  pub buf_len: libc::c_uint,
+}
+
+/// Create a new lio driver configured by `config`.
+///
+/// Returns a non-null opaque pointer on success, or null if `config` is null
+/// or the kernel rejects the options.  The caller owns the returned handle and
+/// must pass it to [`lio_destroy`] when done.
+///
+/// # Safety
+/// `config` must be null or point to a valid `lio_config_t`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_create_ex(
+  config: *const lio_config_t,
+) -> *mut lio_handle_t {
+  if config.is_null() {
+    return ptr::null_mut();
+  }
+  // SAFETY: caller guarantees config points to a valid lio_config_t
+  let config = unsafe { &*config };
+
+  let mut builder = Lio::builder(config.capacity as usize);
+  if config.flags & LIO_CONFIG_SQPOLL != 0 {
+    builder =
+      builder.sqpoll(Duration::from_millis(config.sqpoll_idle_ms as u64));
+  }
+  if config.flags & LIO_CONFIG_SQPOLL_CPU != 0 {
+    builder = builder.sqpoll_cpu(config.sqpoll_cpu);
+  }
+  if config.flags & LIO_CONFIG_IOPOLL != 0 {
+    builder = builder.iopoll();
+  }
+  if config.flags & LIO_CONFIG_COOP_TASKRUN != 0 {
+    builder = builder.coop_taskrun();
+  }
+  if config.flags & LIO_CONFIG_DEFER_TASKRUN != 0 {
+    builder = builder.defer_taskrun();
+  }
+  if config.flags & LIO_CONFIG_SINGLE_ISSUER != 0 {
+    builder = builder.single_issuer();
+  }
+  if config.cq_entries != 0 {
+    builder = builder.cq_entries(config.cq_entries);
+  }
+  let bufs = (config.buf_count != 0).then(|| {
+    let len = if config.buf_len == 0 { 4096 } else { config.buf_len };
+    let class = SizeClass::new(len as usize, config.buf_count as usize);
+    &*Box::leak(Box::new(BufStore::with_classes(&[class])))
+  });
+  if let Some(store) = bufs {
+    builder = builder.buf_store(store);
+  }
+
+  match builder.build() {
+    Ok(inner) => Box::into_raw(Box::new(lio_handle_t { inner, bufs })),
+    Err(_) => {
+      // SAFETY: leaked above, and the failed driver is gone
+      unsafe { free_bufs(bufs) };
+      ptr::null_mut()
+    }
+  }
+}
+
+/// Free a pool leaked by [`lio_create_ex`].
+///
+/// # Safety
+/// Nothing may use `bufs` afterwards, including a driver it's registered with.
+unsafe fn free_bufs(bufs: Option<&'static BufStore>) {
+  if let Some(store) = bufs {
+    // SAFETY: caller guarantees store came from Box::leak and is unused
+    drop(unsafe { Box::from_raw(ptr::from_ref(store).cast_mut()) });
+  }
+}
+
 /// Destroy a lio handle created by [`lio_create`].
 ///
-/// After this call `lio` is invalid.
+/// After this call `lio` is invalid, and so is every buffer of its pool.
 ///
 /// # Safety
 /// `lio` must have been returned by [`lio_create`] and must not be used
@@ -159,7 +395,11 @@ pub extern "C" fn lio_create(capacity: libc::c_uint) -> *mut lio_handle_t {
 pub unsafe extern "C" fn lio_destroy(lio: *mut lio_handle_t) {
   if !lio.is_null() {
     // SAFETY: caller guarantees lio is valid and no longer used
-    drop(unsafe { Box::from_raw(lio) });
+    let lio = unsafe { Box::from_raw(lio) };
+    let bufs = lio.bufs;
+    drop(lio);
+    // SAFETY: the driver that registered the pool was dropped above
+    unsafe { free_bufs(bufs) };
   }
 }
 
@@ -178,6 +418,598 @@ pub unsafe extern "C" fn lio_tick(lio: *mut lio_handle_t) -> libc::c_int {
   }
 }
 
+/// Like [`lio_tick`], but blocks until at least one operation completes.
+///
+/// Returns the number of operations that completed, or -1 on error.
+///
+/// # Safety
+/// `lio` must be a valid handle.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_run(lio: *mut lio_handle_t) -> libc::c_int {
+  // SAFETY: caller guarantees lio is valid per fn contract
+  match unsafe { handle(lio) }.inner.run() {
+    Ok(n) => n as libc::c_int,
+    Err(_) => -1,
+  }
+}
+
+/// Like [`lio_run`], but gives up after `timeout_ns` nanoseconds.
+///
+/// Returns the number of operations that completed, 0 if the timeout
+/// expired first, or -1 on error.
+///
+/// # Safety
+/// `lio` must be a valid handle.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_run_timeout(
+  lio: *mut lio_handle_t,
+  timeout_ns: u64,
+) -> libc::c_int {
+  let timeout = Duration::from_nanos(timeout_ns);
+  // SAFETY: caller guarantees lio is valid per fn contract
+  match unsafe { handle(lio) }.inner.run_timeout(timeout) {
+    Ok(n) => n as libc::c_int,
+    Err(_) => -1,
+  }
+}
+
+/// Block until at least `min` operations completed, or `timeout_ns`
+/// nanoseconds passed, see [`Lio::run_min_complete`].  With io_uring this
+/// is a single `io_uring_submit_and_wait_timeout` until [`lio_remote`] was
+/// called.  From then on it waits for one completion at a time, so remote
+/// jobs get to run in between.
+///
+/// A `timeout_ns` of 0 doesn't wait: it returns right away with what had
+/// already completed.  There's no way to wait without a timeout.
+///
+/// Returns the number of operations that completed, fewer than `min` if the
+/// timeout expired, or -1 on error.
+///
+/// # Safety
+/// `lio` must be a valid handle.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_run_min_complete(
+  lio: *mut lio_handle_t,
+  min: libc::c_uint,
+  timeout_ns: u64,
+) -> libc::c_int {
+  let timeout = Some(Duration::from_nanos(timeout_ns));
+  // SAFETY: caller guarantees lio is valid per fn contract
+  match unsafe { handle(lio) }.inner.run_min_complete(min as usize, timeout) {
+    Ok(n) => n as libc::c_int,
+    Err(_) => -1,
+  }
+}
+
+// ─── Remote submission ───────────────────────────────────────────────────────
+
+/// Handle for submitting to a `lio_handle_t` from other threads.  Create with
+/// [`lio_remote`], destroy with [`lio_remote_destroy`].  Thread-safe.
+#[allow(non_camel_case_types)]
+pub struct lio_remote_t {
+  inner: LioRemote,
+  /// Pool of the handle, for the one `lio_remote_submit` callbacks get.
+  bufs: Option<&'static BufStore>,
+}
+
+/// The `arg` of [`lio_remote_submit`], which C hands across threads.
+struct SendPtr(*mut libc::c_void);
+
+// SAFETY: The caller of `lio_remote_submit` vouches for `arg` being usable on
+// the owning thread.
+unsafe impl Send for SendPtr {}
+
+/// Create a handle for submitting to `lio` from other threads.
+///
+/// Returns null if the backend can't set up its waker.  The handle may
+/// outlive `lio`, submitting fails after that.
+///
+/// # Safety
+/// `lio` must be a valid handle.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_remote(
+  lio: *mut lio_handle_t,
+) -> *mut lio_remote_t {
+  // SAFETY: caller guarantees lio is valid per fn contract
+  let lio = unsafe { handle(lio) };
+  match lio.inner.remote() {
+    Ok(inner) => {
+      Box::into_raw(Box::new(lio_remote_t { inner, bufs: lio.bufs }))
+    }
+    Err(_) => ptr::null_mut(),
+  }
+}
+
+/// Run `callback(lio, arg)` on the thread driving the handle, at the start of
+/// its next [`lio_tick`], waking it if it's blocked.
+///
+/// `callback` may submit operations on `lio`, which complete on that thread
+/// as usual.  `lio` is only valid during the callback.
+///
+/// Returns 0, or `-EPIPE` if the handle was destroyed.
+///
+/// # Safety
+/// `remote` must be a valid remote handle, and `arg` safe to use from the
+/// driving thread.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_remote_submit(
+  remote: *const lio_remote_t,
+  callback: extern "C" fn(*mut lio_handle_t, *mut libc::c_void),
+  arg: *mut libc::c_void,
+) -> libc::c_int {
+  let arg = SendPtr(arg);
+  // SAFETY: caller guarantees remote is valid per fn contract
+  let lio_remote_t { inner: remote, bufs } = unsafe { &*remote };
+  // Callbacks only run while the handle, and so its pool, is alive.
+  let bufs = *bufs;
+  let submitted = remote.submit(move |lio| {
+    let arg = arg;
+    let mut handle = lio_handle_t { inner: lio.clone(), bufs };
+    callback(&mut handle, arg.0);
+  });
+  match submitted {
+    Ok(()) => 0,
+    Err(_) => -libc::EPIPE,
+  }
+}
+
+/// Destroy a remote handle created by [`lio_remote`].
+///
+/// # Safety
+/// `remote` must have been returned by [`lio_remote`] and must not be used
+/// after this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_remote_destroy(remote: *mut lio_remote_t) {
+  if !remote.is_null() {
+    // SAFETY: caller guarantees remote is valid and no longer used
+    drop(unsafe { Box::from_raw(remote) });
+  }
+}
+
+/// Id returned for an operation that was never submitted, see
+/// [`lio_cancel`].
+pub const LIO_NO_OP: u64 = u64::MAX;
+
+/// Cancel operation `id`, whose callback then gets `-ECANCELED`.
+///
+/// Does nothing for an operation that completed. Ops that are too far
+/// along to stop complete as usual, see [`Lio::cancel`].
+///
+/// Returns 0, or a negative errno if the backend failed to cancel.
+///
+/// # Safety
+/// `lio` must be a valid handle.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_cancel(
+  lio: *mut lio_handle_t,
+  id: u64,
+) -> libc::c_int {
+  // SAFETY: caller guarantees lio is valid per fn contract
+  match unsafe { handle(lio) }.inner.cancel(OpId(id)) {
+    Ok(()) => 0,
+    Err(e) => -e.raw_os_error().unwrap_or(1),
+  }
+}
+
+// ─── Batched submission ──────────────────────────────────────────────────────
+
+/// Does nothing.
+pub const LIO_SQE_NOP: u32 = 0;
+/// Read into `buf`, at `offset` or the current position if it's -1.
+pub const LIO_SQE_READ: u32 = 1;
+/// Write from `buf`, at `offset` or the current position if it's -1.
+pub const LIO_SQE_WRITE: u32 = 2;
+/// Receive into `buf` with `flags`.
+pub const LIO_SQE_RECV: u32 = 3;
+/// Send from `buf` with `flags`.
+pub const LIO_SQE_SEND: u32 = 4;
+/// Synchronize `fd` with the storage device.
+pub const LIO_SQE_FSYNC: u32 = 5;
+/// Close `fd`.
+pub const LIO_SQE_CLOSE: u32 = 6;
+/// Shut down part of a connection, with `flags` as `how`.
+pub const LIO_SQE_SHUTDOWN: u32 = 7;
+/// Wait `offset` nanoseconds.
+pub const LIO_SQE_TIMEOUT: u32 = 8;
+
+/// An operation for [`lio_submit_batch`].  Fields an operation doesn't use
+/// are ignored.
+#[repr(C)]
+#[allow(non_camel_case_types)]
+pub struct lio_sqe_t {
+  /// One of the `LIO_SQE_*` operations.
+  pub opcode: libc::c_uint,
+  /// `send`/`recv` flags, or `how` for `LIO_SQE_SHUTDOWN`.
+  pub flags: libc::c_int,
+  /// File descriptor, which stays owned by the caller.
+  pub fd: libc::intptr_t,
+  /// Buffer to read into or write from.  It stays owned by the caller and
+  /// must stay valid until the operation is reaped.
+  pub buf: *mut libc::c_void,
+  /// Length of `buf`.
+  pub len: usize,
+  /// File offset, or the timeout in nanoseconds for `LIO_SQE_TIMEOUT`.
+  pub offset: i64,
+  /// Handed back in the operation's `lio_cqe_t`.
+  pub user_data: *mut libc::c_void,
+}
+
+/// A completed operation, filled in by [`lio_reap`].
+#[repr(C)]
+#[allow(non_camel_case_types)]
+pub struct lio_cqe_t {
+  /// The `user_data` of the operation's `lio_sqe_t`.
+  pub user_data: *mut libc::c_void,
+  /// Its result: bytes transferred, 0, or a negative errno.
+  pub res: libc::c_int,
+}
+
+/// The op `sqe` describes, or `None` for an unknown opcode.
+///
+/// # Safety
+/// The fd and buffer of `sqe` must stay valid until the op completes.
+unsafe fn sqe_to_op(sqe: &lio_sqe_t) -> Option<Op> {
+  // SAFETY: caller guarantees fd outlives the op
+  let fd = || unsafe { Resource::from_raw_fd_borrowed(sqe.fd as RawFd) };
+  let buffer = || OpBuf::new(RawBuf { ptr: sqe.buf.cast(), len: sqe.len });
+  let op = match sqe.opcode {
+    LIO_SQE_NOP => Op::Nop,
+    LIO_SQE_READ if sqe.offset < 0 => Op::Read { fd: fd(), buffer: buffer() },
+    LIO_SQE_READ => {
+      Op::ReadAt { fd: fd(), offset: sqe.offset, buffer: buffer() }
+    }
+    LIO_SQE_WRITE if sqe.offset < 0 => Op::Write { fd: fd(), buffer: buffer() },
+    LIO_SQE_WRITE => {
+      Op::WriteAt { fd: fd(), offset: sqe.offset, buffer: buffer() }
+    }
+    LIO_SQE_RECV => Op::Recv { fd: fd(), flags: sqe.flags, buffer: buffer() },
+    LIO_SQE_SEND => Op::Send { fd: fd(), flags: sqe.flags, buffer: buffer() },
+    LIO_SQE_FSYNC => Op::Fsync { fd: fd() },
+    LIO_SQE_CLOSE => Op::Close { fd: sqe.fd as RawFd },
+    LIO_SQE_SHUTDOWN => Op::Shutdown { fd: fd(), how: sqe.flags },
+    LIO_SQE_TIMEOUT => Op::Timeout {
+      duration: Duration::from_nanos(sqe.offset.max(0) as u64),
+      // Timeouts stay on the timer wheel, which doesn't need it.
+      #[cfg(target_os = "linux")]
+      timespec: ptr::null(),
+    },
+    _ => return None,
+  };
+  Some(op)
+}
+
+/// Submit the `n` operations in `sqes` in one go.  They complete without
+/// callbacks, collect them with [`lio_reap`].
+///
+/// Returns how many were submitted, fewer than `n` if one was rejected, or
+/// the negative errno of the first one if none were: `-EINVAL` for an
+/// unknown opcode, `-EBUSY` once `capacity` operations are in flight.
+///
+/// # Safety
+/// `lio` must be a valid handle and `sqes` point to `n` entries, whose fds
+/// and buffers stay valid until their operation is reaped.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_submit_batch(
+  lio: *mut lio_handle_t,
+  sqes: *const lio_sqe_t,
+  n: libc::c_uint,
+) -> libc::c_int {
+  if n == 0 {
+    return 0;
+  }
+  // SAFETY: caller guarantees sqes points to n entries
+  let sqes = unsafe { slice::from_raw_parts(sqes, n as usize) };
+  let mut invalid = false;
+  let ops = sqes.iter().map_while(|sqe| {
+    // SAFETY: caller guarantees the entries stay valid until reaped
+    let op = unsafe { sqe_to_op(sqe) };
+    invalid = op.is_none();
+    Some((op?, sqe.user_data as u64))
+  });
+  // SAFETY: caller guarantees lio is valid per fn contract
+  let (submitted, res) = unsafe { handle(lio) }.inner.schedule_reaped(ops);
+  let err = match res {
+    Err(e) => -e.raw_os_error().unwrap_or(1),
+    Ok(()) if invalid => -libc::EINVAL,
+    Ok(()) => 0,
+  };
+  if submitted == 0 { err } else { submitted as libc::c_int }
+}
+
+/// Move up to `max` completions of operations from [`lio_submit_batch`] to
+/// `out`, oldest first.  Operations complete while [`lio_tick`] or
+/// [`lio_run`] runs.
+///
+/// Returns how many it moved.
+///
+/// # Safety
+/// `lio` must be a valid handle and `out` point to room for `max` entries.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_reap(
+  lio: *mut lio_handle_t,
+  out: *mut lio_cqe_t,
+  max: libc::c_uint,
+) -> libc::c_int {
+  let mut next = out;
+  // SAFETY: caller guarantees lio is valid per fn contract
+  let reaped = unsafe { handle(lio) }.inner.reap(max as usize, |data, res| {
+    let cqe = lio_cqe_t { user_data: data as *mut _, res: res as libc::c_int };
+    // SAFETY: caller guarantees room for max entries, of which reap passes
+    // at most max
+    unsafe {
+      next.write(cqe);
+      next = next.add(1);
+    }
+  });
+  reaped as libc::c_int
+}
+
+// ─── Metrics ─────────────────────────────────────────────────────────────────
+
+/// Length of the per-operation arrays in `lio_stats_t`, indexed by kind, see
+/// [`lio_op_name`].
+pub const LIO_OP_KINDS: usize = 33;
+
+#[cfg(feature = "metrics")]
+const _: () = assert!(crate::metrics::OpKind::COUNT == LIO_OP_KINDS);
+
+/// Counters filled in by [`lio_stats`], see [`Lio::stats`].
+#[repr(C)]
+#[allow(non_camel_case_types)]
+pub struct lio_stats_t {
+  /// Runs of the event loop.
+  pub ticks: u64,
+  /// Operations submitted and not completed yet.
+  pub in_flight: u64,
+  /// Most operations that can be in flight at once.
+  pub capacity: u64,
+  /// Operations submitted.
+  pub submitted: u64,
+  /// Operations completed.
+  pub completed: u64,
+  /// Flushes that submitted entries to the kernel.
+  pub flushes: u64,
+  /// Entries those flushes submitted.
+  pub flushed: u64,
+  /// Most entries a single flush submitted.
+  pub max_flush: u64,
+  /// Most completions a single tick handled.
+  pub max_completions: u64,
+  /// Waits for readiness an operation went back to, poller backend only.
+  pub rearms: u64,
+  /// Operations submitted, by kind.
+  pub op_submitted: [u64; LIO_OP_KINDS],
+  /// Operations completed, by kind.
+  pub op_completed: [u64; LIO_OP_KINDS],
+  /// Operations completed with an error, by kind.
+  pub op_failed: [u64; LIO_OP_KINDS],
+  /// Total latency of completed operations in nanoseconds, by kind.
+  pub op_latency_ns_sum: [u64; LIO_OP_KINDS],
+  /// Upper bound of the median latency in nanoseconds, by kind.
+  pub op_latency_ns_p50: [u64; LIO_OP_KINDS],
+  /// Upper bound of the 99th percentile latency in nanoseconds, by kind.
+  pub op_latency_ns_p99: [u64; LIO_OP_KINDS],
+  /// Highest latency in nanoseconds, by kind.
+  pub op_latency_ns_max: [u64; LIO_OP_KINDS],
+}
+
+/// Fill `stats` with the counters of `lio`.
+///
+/// Returns 0, or `-ENOTSUP` if lio was built without the `metrics` feature.
+///
+/// # Safety
+/// `lio` must be a valid handle and `stats` point to a writable
+/// `lio_stats_t`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_stats(
+  lio: *mut lio_handle_t,
+  stats: *mut lio_stats_t,
+) -> libc::c_int {
+  #[cfg(feature = "metrics")]
+  {
+    use crate::metrics::OpKind;
+
+    // SAFETY: caller guarantees lio is valid per fn contract
+    let snapshot = unsafe { handle(lio) }.inner.stats();
+    let per_op = |f: fn(&crate::metrics::OpStats) -> u64| {
+      OpKind::ALL.map(|kind| f(snapshot.op(kind)))
+    };
+    let out = lio_stats_t {
+      ticks: snapshot.ticks,
+      in_flight: snapshot.in_flight as u64,
+      capacity: snapshot.capacity as u64,
+      submitted: snapshot.submitted,
+      completed: snapshot.completed,
+      flushes: snapshot.flushed.count(),
+      flushed: snapshot.flushed.sum(),
+      max_flush: snapshot.flushed.max(),
+      max_completions: snapshot.completions.max(),
+      rearms: snapshot.rearms,
+      op_submitted: per_op(|op| op.submitted),
+      op_completed: per_op(|op| op.completed),
+      op_failed: per_op(|op| op.failed),
+      op_latency_ns_sum: per_op(|op| op.latency.sum()),
+      op_latency_ns_p50: per_op(|op| op.latency.quantile(0.5)),
+      op_latency_ns_p99: per_op(|op| op.latency.quantile(0.99)),
+      op_latency_ns_max: per_op(|op| op.latency.max()),
+    };
+    // SAFETY: caller guarantees stats is writable per fn contract
+    unsafe { stats.write(out) };
+    0
+  }
+  #[cfg(not(feature = "metrics"))]
+  {
+    let _ = (lio, stats);
+    -libc::ENOTSUP
+  }
+}
+
+/// Name of operation kind `kind`, the index into the per-operation arrays of
+/// `lio_stats_t`, e.g. `"read_at"`.
+///
+/// Returns a static string, or null if `kind` is out of range or lio was
+/// built without the `metrics` feature.
+#[unsafe(no_mangle)]
+pub extern "C" fn lio_op_name(kind: libc::c_uint) -> *const libc::c_char {
+  #[cfg(feature = "metrics")]
+  if let Some(kind) = crate::metrics::OpKind::ALL.get(kind as usize) {
+    return kind.c_name().as_ptr();
+  }
+  let _ = kind;
+  ptr::null()
+}
+
+// ─── Buffer pool ─────────────────────────────────────────────────────────────
+
+/// A buffer of the pool set up by `lio_config_t::buf_count`.
+#[repr(C)]
+#[allow(non_camel_case_types)]
+pub struct lio_buf_t {
+  /// Start of the buffer.
+  pub data: *mut u8,
+  /// Size of the buffer, at least the `len` asked for.
+  pub cap: usize,
+  /// Names the buffer to [`lio_buf_put`], [`lio_read_fixed`] and
+  /// [`lio_write_fixed`].
+  pub index: u32,
+}
+
+/// Borrow a pool buffer of at least `len` bytes into `out`.  It stays the
+/// caller's until given back with [`lio_buf_put`], and can be passed to any
+/// operation, though only the `_fixed` ones use the kernel registration.
+///
+/// Returns 0, `-ENOBUFS` if every buffer that fits is in use, or `-ENOTSUP`
+/// if `lio` was created without a pool.
+///
+/// # Safety
+/// `lio` must be a valid handle and `out` point to a writable `lio_buf_t`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_buf_get(
+  lio: *mut lio_handle_t,
+  len: usize,
+  out: *mut lio_buf_t,
+) -> libc::c_int {
+  // SAFETY: caller guarantees lio is valid per fn contract
+  let Some(store) = unsafe { handle(lio) }.bufs else {
+    return -libc::ENOTSUP;
+  };
+  let Some(buf) = store.try_get_len(len) else {
+    return -libc::ENOBUFS;
+  };
+  let data = buf.buf().as_ptr().cast_mut();
+  let cap = buf.capacity();
+  // SAFETY: caller guarantees out is writable
+  unsafe { out.write(lio_buf_t { data, cap, index: buf.into_index() }) };
+  0
+}
+
+/// Give pool buffer `index` back.  No operation may be using it.
+///
+/// Returns 0, or `-EINVAL` if it isn't lent out.
+///
+/// # Safety
+/// `lio` must be a valid handle.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_buf_put(
+  lio: *mut lio_handle_t,
+  index: u32,
+) -> libc::c_int {
+  // SAFETY: caller guarantees lio is valid per fn contract
+  match unsafe { handle(lio) }.bufs.and_then(|store| store.lent(index)) {
+    Some(buf) => {
+      drop(buf);
+      0
+    }
+    None => -libc::EINVAL,
+  }
+}
+
+/// Read from `fd` at `offset` into pool buffer `index`, with io_uring's
+/// `READ_FIXED`.  Pass `offset = -1` for current position.
+///
+/// The buffer stays lent out to the caller.
+///
+/// - `callback(result, index)`: bytes read (or negative errno), and the
+///   buffer.  A buffer that isn't lent out gets `-EINVAL`.
+///
+/// # Safety
+/// `lio` must be valid.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_read_fixed(
+  lio: *mut lio_handle_t,
+  fd: libc::intptr_t,
+  index: u32,
+  offset: i64,
+  callback: extern "C" fn(libc::c_int, u32),
+) -> u64 {
+  // SAFETY: caller guarantees lio is valid per fn contract
+  let lio = unsafe { handle(lio) };
+  let Some(buf) = lio.bufs.and_then(|store| store.lent(index)) else {
+    callback(-libc::EINVAL, index);
+    return LIO_NO_OP;
+  };
+  // SAFETY: caller guarantees fd is valid per fn contract
+  let resource = unsafe { fd_to_resource(fd) };
+  api::read_at_fixed(&resource, buf, offset)
+    .with_lio(&lio.inner)
+    .when_done(move |(res, buf)| {
+      let code = match res {
+        Ok(n) => n,
+        Err(e) => -e.raw_os_error().unwrap_or(1),
+      };
+      callback(code, buf.into_index());
+      // Don't close the fd - C owns it
+      std::mem::forget(resource);
+    })
+    .0
+}
+
+/// Write the first `len` bytes of pool buffer `index` to `fd` at `offset`,
+/// with io_uring's `WRITE_FIXED`.  Pass `offset = -1` for current position.
+///
+/// The buffer stays lent out to the caller.
+///
+/// - `callback(result, index)`: bytes written (or negative errno), and the
+///   buffer.  A buffer that isn't lent out or shorter than `len` gets
+///   `-EINVAL`.
+///
+/// # Safety
+/// `lio` must be valid.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_write_fixed(
+  lio: *mut lio_handle_t,
+  fd: libc::intptr_t,
+  index: u32,
+  len: usize,
+  offset: i64,
+  callback: extern "C" fn(libc::c_int, u32),
+) -> u64 {
+  // SAFETY: caller guarantees lio is valid per fn contract
+  let lio = unsafe { handle(lio) };
+  let Some(buf) = lio.bufs.and_then(|store| store.lent(index)) else {
+    callback(-libc::EINVAL, index);
+    return LIO_NO_OP;
+  };
+  if len > buf.capacity() {
+    callback(-libc::EINVAL, buf.into_index());
+    return LIO_NO_OP;
+  }
+  // SAFETY: caller guarantees fd is valid per fn contract
+  let resource = unsafe { fd_to_resource(fd) };
+  api::write_at_fixed(&resource, buf.after(len), offset)
+    .with_lio(&lio.inner)
+    .when_done(move |(res, buf)| {
+      let code = match res {
+        Ok(n) => n,
+        Err(e) => -e.raw_os_error().unwrap_or(1),
+      };
+      callback(code, buf.into_index());
+      // Don't close the fd - C owns it
+      std::mem::forget(resource);
+    })
+    .0
+}
+
 // ─── Socket / fd operations ───────────────────────────────────────────────────
 
 /// Shut down part of a full-duplex connection.
@@ -194,7 +1026,7 @@ pub unsafe extern "C" fn lio_shutdown(
   fd: libc::intptr_t,
   how: libc::c_int,
   callback: extern "C" fn(libc::c_int),
-) {
+) -> u64 {
   // SAFETY: caller guarantees fd is valid per fn contract
   let resource = unsafe { fd_to_resource(fd) };
   // SAFETY: caller guarantees lio is valid per fn contract
@@ -207,7 +1039,8 @@ pub unsafe extern "C" fn lio_shutdown(
       });
       // Don't close the fd - C owns it
       std::mem::forget(resource);
-    });
+    })
+    .0
 }
 
 /// Synchronize a file's in-core state with the storage device.
@@ -221,20 +1054,21 @@ pub unsafe extern "C" fn lio_fsync(
   lio: *mut lio_handle_t,
   fd: libc::intptr_t,
   callback: extern "C" fn(libc::c_int),
-) {
+) -> u64 {
   // SAFETY: caller guarantees fd is valid per fn contract
   let resource = unsafe { fd_to_resource(fd) };
   // SAFETY: caller guarantees lio is valid per fn contract
-  api::fsync(&resource).with_lio(&unsafe { handle(lio) }.inner).when_done(
-    move |res| {
+  api::fsync(&resource)
+    .with_lio(&unsafe { handle(lio) }.inner)
+    .when_done(move |res| {
       callback(match res {
         Ok(_) => 0,
         Err(e) => -e.raw_os_error().unwrap_or(1),
       });
       // Don't close the fd - C owns it
       std::mem::forget(resource);
-    },
-  );
+    })
+    .0
 }
 
 /// Truncate a file to `len` bytes.
@@ -249,7 +1083,7 @@ pub unsafe extern "C" fn lio_truncate(
   fd: libc::intptr_t,
   len: u64,
   callback: extern "C" fn(libc::c_int),
-) {
+) -> u64 {
   // SAFETY: caller guarantees fd is valid per fn contract
   let resource = unsafe { fd_to_resource(fd) };
   // SAFETY: caller guarantees lio is valid per fn contract
@@ -262,7 +1096,8 @@ pub unsafe extern "C" fn lio_truncate(
       });
       // Don't close the fd - C owns it
       std::mem::forget(resource);
-    });
+    })
+    .0
 }
 
 /// Write data to `fd` at `offset`.  Pass `offset = -1` for current position.
@@ -284,7 +1119,7 @@ pub unsafe extern "C" fn lio_write_at(
   buf_len: usize,
   offset: i64,
   callback: extern "C" fn(libc::c_int, *mut u8, usize),
-) {
+) -> u64 {
   // SAFETY: C caller transfers malloc ownership of buf with size buf_len
   let vec = unsafe { Vec::from_raw_parts(buf, buf_len, buf_len) };
   // SAFETY: caller guarantees fd is valid per fn contract
@@ -304,7 +1139,49 @@ pub unsafe extern "C" fn lio_write_at(
       callback(code, ptr, len);
       // Don't close the fd - C owns it
       std::mem::forget(resource);
-    });
+    })
+    .0
+}
+
+/// Like [`lio_write_at`], but `buf` stays owned by the caller, who keeps it
+/// valid and leaves it alone until the callback.  It can come from any
+/// allocator, such as a [`lio_buf_get`] pool.
+///
+/// - `callback(result, buf, len)`: bytes written (or negative errno), buffer
+///
+/// A null `buf` with a nonzero `buf_len` gets `-EINVAL`.
+///
+/// # Safety
+/// `lio` must be valid; `buf` must point to at least `buf_len` bytes that
+/// stay valid until the callback.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_write_at_borrowed(
+  lio: *mut lio_handle_t,
+  fd: libc::intptr_t,
+  buf: *mut u8,
+  buf_len: usize,
+  offset: i64,
+  callback: extern "C" fn(libc::c_int, *mut u8, usize),
+) -> u64 {
+  let Some(mem) = CBuf::new(buf, buf_len) else {
+    callback(-libc::EINVAL, buf, buf_len);
+    return LIO_NO_OP;
+  };
+  // SAFETY: caller guarantees fd is valid per fn contract
+  let resource = unsafe { fd_to_resource(fd) };
+  // SAFETY: caller guarantees lio is valid per fn contract
+  api::write_at(&resource, mem, offset)
+    .with_lio(&unsafe { handle(lio) }.inner)
+    .when_done(move |(res, mem)| {
+      let code = match res {
+        Ok(n) => n,
+        Err(e) => -e.raw_os_error().unwrap_or(1),
+      };
+      callback(code, mem.ptr, mem.len);
+      // Don't close the fd - C owns it
+      std::mem::forget(resource);
+    })
+    .0
 }
 
 /// Read from `fd` at `offset` into `buf`.  Pass `offset = -1` for current
@@ -324,7 +1201,7 @@ pub unsafe extern "C" fn lio_read_at(
   buf_len: usize,
   offset: i64,
   callback: extern "C" fn(libc::c_int, *mut u8, usize),
-) {
+) -> u64 {
   // SAFETY: C caller transfers malloc ownership of buf with size buf_len
   let vec = unsafe { Vec::from_raw_parts(buf, buf_len, buf_len) };
   // SAFETY: caller guarantees fd is valid per fn contract
@@ -344,7 +1221,49 @@ pub unsafe extern "C" fn lio_read_at(
       callback(code, ptr, len);
       // Don't close the fd - C owns it
       std::mem::forget(resource);
-    });
+    })
+    .0
+}
+
+/// Like [`lio_read_at`], but `buf` stays owned by the caller, who keeps it
+/// valid and leaves it alone until the callback.  It can come from any
+/// allocator, such as a [`lio_buf_get`] pool.
+///
+/// - `callback(result, buf, len)`: bytes read (or negative errno), buffer
+///
+/// A null `buf` with a nonzero `buf_len` gets `-EINVAL`.
+///
+/// # Safety
+/// `lio` must be valid; `buf` must point to at least `buf_len` bytes that
+/// stay valid until the callback.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_read_at_borrowed(
+  lio: *mut lio_handle_t,
+  fd: libc::intptr_t,
+  buf: *mut u8,
+  buf_len: usize,
+  offset: i64,
+  callback: extern "C" fn(libc::c_int, *mut u8, usize),
+) -> u64 {
+  let Some(mem) = CBuf::new(buf, buf_len) else {
+    callback(-libc::EINVAL, buf, buf_len);
+    return LIO_NO_OP;
+  };
+  // SAFETY: caller guarantees fd is valid per fn contract
+  let resource = unsafe { fd_to_resource(fd) };
+  // SAFETY: caller guarantees lio is valid per fn contract
+  api::read_at(&resource, mem, offset)
+    .with_lio(&unsafe { handle(lio) }.inner)
+    .when_done(move |(res, mem)| {
+      let code = match res {
+        Ok(n) => n,
+        Err(e) => -e.raw_os_error().unwrap_or(1),
+      };
+      callback(code, mem.ptr, mem.len);
+      // Don't close the fd - C owns it
+      std::mem::forget(resource);
+    })
+    .0
 }
 
 /// Create a socket.
@@ -361,7 +1280,7 @@ pub unsafe extern "C" fn lio_socket(
   ty: libc::c_int,
   proto: libc::c_int,
   callback: extern "C" fn(libc::intptr_t),
-) {
+) -> u64 {
   // SAFETY: caller guarantees lio is valid per fn contract
   api::socket(domain, ty, proto)
     .with_lio(&unsafe { handle(lio) }.inner)
@@ -376,7 +1295,8 @@ pub unsafe extern "C" fn lio_socket(
         }
         Err(e) => -e.raw_os_error().unwrap_or(1) as libc::intptr_t,
       });
-    });
+    })
+    .0
 }
 
 /// Bind a socket to an address.
@@ -393,27 +1313,28 @@ pub unsafe extern "C" fn lio_bind(
   sock: *const libc::sockaddr,
   sock_len: libc::socklen_t,
   callback: extern "C" fn(libc::c_int),
-) {
+) -> u64 {
   let addr = match sockaddr_to_socketaddr(sock, sock_len) {
     Some(a) => a,
     None => {
       callback(-libc::EINVAL);
-      return;
+      return LIO_NO_OP;
     }
   };
   // SAFETY: caller guarantees fd is valid per fn contract
   let resource = unsafe { fd_to_resource(fd) };
   // SAFETY: caller guarantees lio is valid per fn contract
-  api::bind(&resource, addr).with_lio(&unsafe { handle(lio) }.inner).when_done(
-    move |res| {
+  api::bind(&resource, addr)
+    .with_lio(&unsafe { handle(lio) }.inner)
+    .when_done(move |res| {
       callback(match res {
         Ok(_) => 0,
         Err(e) => -e.raw_os_error().unwrap_or(1),
       });
       // Don't close the fd - C owns it
       std::mem::forget(resource);
-    },
-  );
+    })
+    .0
 }
 
 /// Accept a connection.
@@ -422,6 +1343,8 @@ pub unsafe extern "C" fn lio_bind(
 ///   error); `addr` is heap-allocated `sockaddr_storage` — **caller must free
 ///   it** — or null on error.
 ///
+/// [`lio_accept_addr`] and [`lio_accept_fd`] skip that allocation.
+///
 /// # Safety
 /// `lio` must be valid; `fd` must be a listening socket.
 #[unsafe(no_mangle)]
@@ -429,12 +1352,13 @@ pub unsafe extern "C" fn lio_accept(
   lio: *mut lio_handle_t,
   fd: libc::intptr_t,
   callback: extern "C" fn(libc::intptr_t, *const libc::sockaddr_storage),
-) {
+) -> u64 {
   // SAFETY: caller guarantees fd is valid per fn contract
   let resource = unsafe { fd_to_resource(fd) };
   // SAFETY: caller guarantees lio is valid per fn contract
-  api::accept(&resource).with_lio(&unsafe { handle(lio) }.inner).when_done(
-    move |res| {
+  api::accept(&resource)
+    .with_lio(&unsafe { handle(lio) }.inner)
+    .when_done(move |res| {
       let (code, addr_ptr) = match res {
         Ok((new_res, addr)) => {
           let fd = resource_to_fd(&new_res);
@@ -454,8 +1378,82 @@ pub unsafe extern "C" fn lio_accept(
       callback(code, addr_ptr);
       // Don't close the listener fd - C owns it
       std::mem::forget(resource);
-    },
-  );
+    })
+    .0
+}
+
+/// Like [`lio_accept`], but the `addr` given to the callback is only valid
+/// during the callback, so there's nothing to free.
+///
+/// - `callback(result, addr)`: new socket fd on success (negative errno on
+///   error); the peer address, or null on error.
+///
+/// # Safety
+/// `lio` must be valid; `fd` must be a listening socket.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_accept_addr(
+  lio: *mut lio_handle_t,
+  fd: libc::intptr_t,
+  callback: extern "C" fn(libc::intptr_t, *const libc::sockaddr_storage),
+) -> u64 {
+  // SAFETY: caller guarantees fd is valid per fn contract
+  let resource = unsafe { fd_to_resource(fd) };
+  // SAFETY: caller guarantees lio is valid per fn contract
+  api::accept(&resource)
+    .with_lio(&unsafe { handle(lio) }.inner)
+    .when_done(move |res| {
+      match res {
+        Ok((new_res, addr)) => {
+          let fd = resource_to_fd(&new_res);
+          // C caller now owns the fd and is responsible for closing it.
+          std::mem::forget(new_res);
+          let addr = net_utils::std_socketaddr_into_libc(addr);
+          callback(fd, &addr);
+        }
+        Err(e) => callback(
+          -e.raw_os_error().unwrap_or(1) as libc::intptr_t,
+          ptr::null(),
+        ),
+      }
+      // Don't close the listener fd - C owns it
+      std::mem::forget(resource);
+    })
+    .0
+}
+
+/// Accept a connection without asking for the peer address, the cheapest
+/// accept.  Also works on Unix domain sockets.
+///
+/// - `callback(result)`: new socket fd on success, negative errno on error
+///
+/// # Safety
+/// `lio` must be valid; `fd` must be a listening socket.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_accept_fd(
+  lio: *mut lio_handle_t,
+  fd: libc::intptr_t,
+  callback: extern "C" fn(libc::intptr_t),
+) -> u64 {
+  // SAFETY: caller guarantees fd is valid per fn contract
+  let resource = unsafe { fd_to_resource(fd) };
+  // SAFETY: caller guarantees lio is valid per fn contract
+  api::accept_unix(&resource)
+    .with_lio(&unsafe { handle(lio) }.inner)
+    .when_done(move |res| {
+      let code = match res {
+        Ok(new_res) => {
+          let fd = resource_to_fd(&new_res);
+          // C caller now owns the fd and is responsible for closing it.
+          std::mem::forget(new_res);
+          fd
+        }
+        Err(e) => -e.raw_os_error().unwrap_or(1) as libc::intptr_t,
+      };
+      callback(code);
+      // Don't close the listener fd - C owns it
+      std::mem::forget(resource);
+    })
+    .0
 }
 
 /// Listen for connections on a socket.
@@ -470,7 +1468,7 @@ pub unsafe extern "C" fn lio_listen(
   fd: libc::intptr_t,
   backlog: libc::c_int,
   callback: extern "C" fn(libc::c_int),
-) {
+) -> u64 {
   // SAFETY: caller guarantees fd is valid per fn contract
   let resource = unsafe { fd_to_resource(fd) };
   // SAFETY: caller guarantees lio is valid per fn contract
@@ -483,7 +1481,8 @@ pub unsafe extern "C" fn lio_listen(
       });
       // Don't close the fd - C owns it
       std::mem::forget(resource);
-    });
+    })
+    .0
 }
 
 /// Send data on a connected socket.
@@ -503,7 +1502,7 @@ pub unsafe extern "C" fn lio_send(
   buf_len: usize,
   flags: libc::c_int,
   callback: extern "C" fn(libc::c_int, *mut u8, usize),
-) {
+) -> u64 {
   // SAFETY: C caller transfers malloc ownership of buf with size buf_len
   let vec = unsafe { Vec::from_raw_parts(buf, buf_len, buf_len) };
   // SAFETY: caller guarantees fd is valid per fn contract
@@ -523,7 +1522,148 @@ pub unsafe extern "C" fn lio_send(
       callback(code, ptr, len);
       // Don't close the fd - C owns it
       std::mem::forget(resource);
-    });
+    })
+    .0
+}
+
+/// Like [`lio_send`], but `buf` stays owned by the caller, who keeps it
+/// valid and leaves it alone until the callback.  It can come from any
+/// allocator, such as a [`lio_buf_get`] pool.
+///
+/// - `callback(result, buf, len)`: bytes sent (or negative errno), buffer
+///
+/// A null `buf` with a nonzero `buf_len` gets `-EINVAL`.
+///
+/// # Safety
+/// `lio` must be valid; `buf` must point to at least `buf_len` bytes that
+/// stay valid until the callback.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_send_borrowed(
+  lio: *mut lio_handle_t,
+  fd: libc::intptr_t,
+  buf: *mut u8,
+  buf_len: usize,
+  flags: libc::c_int,
+  callback: extern "C" fn(libc::c_int, *mut u8, usize),
+) -> u64 {
+  let Some(mem) = CBuf::new(buf, buf_len) else {
+    callback(-libc::EINVAL, buf, buf_len);
+    return LIO_NO_OP;
+  };
+  // SAFETY: caller guarantees fd is valid per fn contract
+  let resource = unsafe { fd_to_resource(fd) };
+  // SAFETY: caller guarantees lio is valid per fn contract
+  api::send(&resource, mem, Some(flags))
+    .with_lio(&unsafe { handle(lio) }.inner)
+    .when_done(move |(res, mem)| {
+      let code = match res {
+        Ok(n) => n,
+        Err(e) => -e.raw_os_error().unwrap_or(1),
+      };
+      callback(code, mem.ptr, mem.len);
+      // Don't close the fd - C owns it
+      std::mem::forget(resource);
+    })
+    .0
+}
+
+/// Write several buffers to `fd` at the current position.
+///
+/// Ownership of every `iov_base` (each `malloc`'d with at least `iov_len`
+/// bytes) transfers to lio, as with [`lio_write_at`].  The `iov` array itself
+/// is only read during this call.
+///
+/// - `callback(result, iov, iovcnt)`: bytes written (or negative errno), and
+///   the buffers in their original order.  `iov` is only valid during the
+///   callback; each `iov_len` is the bytes written from that buffer.  An
+///   invalid list gets `-EINVAL` with a null `iov`, and nothing is transferred.
+///
+/// # Safety
+/// `lio` must be valid; `iov` must point to `iovcnt` iovecs with non-null
+/// bases allocated with `malloc`.
+#[cfg(unix)]
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_writev(
+  lio: *mut lio_handle_t,
+  fd: libc::intptr_t,
+  iov: *const libc::iovec,
+  iovcnt: libc::c_int,
+  callback: extern "C" fn(libc::c_int, *const libc::iovec, libc::c_int),
+) -> u64 {
+  // SAFETY: caller guarantees iov describes iovcnt malloc'd buffers
+  let Some(bufs) = (unsafe { iovecs_to_bufs(iov, iovcnt) }) else {
+    callback(-libc::EINVAL, ptr::null(), 0);
+    return LIO_NO_OP;
+  };
+  // SAFETY: caller guarantees fd is valid per fn contract
+  let resource = unsafe { fd_to_resource(fd) };
+  // SAFETY: caller guarantees lio is valid per fn contract
+  api::writev(&resource, bufs)
+    .with_lio(&unsafe { handle(lio) }.inner)
+    .when_done(move |(res, bufs)| {
+      let code = match res {
+        Ok(n) => n,
+        Err(e) => -e.raw_os_error().unwrap_or(1),
+      };
+      // Return buffer ownership to C - caller will free them
+      bufs_to_iovecs(bufs, |iov, iovcnt| callback(code, iov, iovcnt));
+      // Don't close the fd - C owns it
+      std::mem::forget(resource);
+    })
+    .0
+}
+
+/// Send several buffers on a socket as one message.
+///
+/// Buffer ownership works as in [`lio_writev`].  `addr` addresses the message
+/// on unconnected sockets and must be null on connected ones.
+///
+/// - `callback(result, iov, iovcnt)`: bytes sent (or negative errno), buffers
+///
+/// # Safety
+/// `lio` must be valid; `iov` as in [`lio_writev`]; `addr` must be null or
+/// point to `addr_len` bytes of a valid `sockaddr`.
+#[cfg(unix)]
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_sendmsg(
+  lio: *mut lio_handle_t,
+  fd: libc::intptr_t,
+  iov: *const libc::iovec,
+  iovcnt: libc::c_int,
+  addr: *const libc::sockaddr,
+  addr_len: libc::socklen_t,
+  flags: libc::c_int,
+  callback: extern "C" fn(libc::c_int, *const libc::iovec, libc::c_int),
+) -> u64 {
+  let to = match sockaddr_to_socketaddr(addr, addr_len) {
+    Some(to) => Some(to),
+    None if addr.is_null() => None,
+    None => {
+      callback(-libc::EINVAL, iov, iovcnt);
+      return LIO_NO_OP;
+    }
+  };
+  // SAFETY: caller guarantees iov describes iovcnt malloc'd buffers
+  let Some(bufs) = (unsafe { iovecs_to_bufs(iov, iovcnt) }) else {
+    callback(-libc::EINVAL, ptr::null(), 0);
+    return LIO_NO_OP;
+  };
+  // SAFETY: caller guarantees fd is valid per fn contract
+  let resource = unsafe { fd_to_resource(fd) };
+  // SAFETY: caller guarantees lio is valid per fn contract
+  api::sendmsg(&resource, bufs, to, Some(flags))
+    .with_lio(&unsafe { handle(lio) }.inner)
+    .when_done(move |(res, bufs)| {
+      let code = match res {
+        Ok(n) => n,
+        Err(e) => -e.raw_os_error().unwrap_or(1),
+      };
+      // Return buffer ownership to C - caller will free them
+      bufs_to_iovecs(bufs, |iov, iovcnt| callback(code, iov, iovcnt));
+      // Don't close the fd - C owns it
+      std::mem::forget(resource);
+    })
+    .0
 }
 
 /// Receive data from a socket.
@@ -543,7 +1683,7 @@ pub unsafe extern "C" fn lio_recv(
   buf_len: usize,
   flags: libc::c_int,
   callback: extern "C" fn(libc::c_int, *mut u8, usize),
-) {
+) -> u64 {
   // SAFETY: C caller transfers malloc ownership of buf with size buf_len
   let vec = unsafe { Vec::from_raw_parts(buf, buf_len, buf_len) };
   // SAFETY: caller guarantees fd is valid per fn contract
@@ -563,7 +1703,49 @@ pub unsafe extern "C" fn lio_recv(
       callback(code, ptr, len);
       // Don't close the fd - C owns it
       std::mem::forget(resource);
-    });
+    })
+    .0
+}
+
+/// Like [`lio_recv`], but `buf` stays owned by the caller, who keeps it
+/// valid and leaves it alone until the callback.  It can come from any
+/// allocator, such as a [`lio_buf_get`] pool.
+///
+/// - `callback(result, buf, len)`: bytes received (or negative errno), buffer
+///
+/// A null `buf` with a nonzero `buf_len` gets `-EINVAL`.
+///
+/// # Safety
+/// `lio` must be valid; `buf` must point to at least `buf_len` bytes that
+/// stay valid until the callback.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn lio_recv_borrowed(
+  lio: *mut lio_handle_t,
+  fd: libc::intptr_t,
+  buf: *mut u8,
+  buf_len: usize,
+  flags: libc::c_int,
+  callback: extern "C" fn(libc::c_int, *mut u8, usize),
+) -> u64 {
+  let Some(mem) = CBuf::new(buf, buf_len) else {
+    callback(-libc::EINVAL, buf, buf_len);
+    return LIO_NO_OP;
+  };
+  // SAFETY: caller guarantees fd is valid per fn contract
+  let resource = unsafe { fd_to_resource(fd) };
+  // SAFETY: caller guarantees lio is valid per fn contract
+  api::recv(&resource, mem, Some(flags))
+    .with_lio(&unsafe { handle(lio) }.inner)
+    .when_done(move |(res, mem)| {
+      let code = match res {
+        Ok(n) => n,
+        Err(e) => -e.raw_os_error().unwrap_or(1),
+      };
+      callback(code, mem.ptr, mem.len);
+      // Don't close the fd - C owns it
+      std::mem::forget(resource);
+    })
+    .0
 }
 
 /// Close a file descriptor.
@@ -579,16 +1761,17 @@ pub unsafe extern "C" fn lio_close(
   lio: *mut lio_handle_t,
   fd: libc::intptr_t,
   callback: extern "C" fn(libc::c_int),
-) {
+) -> u64 {
   // SAFETY: caller guarantees lio is valid per fn contract
-  api::close(fd as RawFd).with_lio(&unsafe { handle(lio) }.inner).when_done(
-    move |res| {
+  api::close(fd as RawFd)
+    .with_lio(&unsafe { handle(lio) }.inner)
+    .when_done(move |res| {
       callback(match res {
         Ok(_) => 0,
         Err(e) => -e.raw_os_error().unwrap_or(1),
       });
-    },
-  );
+    })
+    .0
 }
 
 /// Wait for `millis` milliseconds.
@@ -602,7 +1785,7 @@ pub unsafe extern "C" fn lio_timeout(
   lio: *mut lio_handle_t,
   millis: libc::c_uint,
   callback: extern "C" fn(libc::c_int),
-) {
+) -> u64 {
   // SAFETY: caller guarantees lio is valid per fn contract
   api::timeout(Duration::from_millis(millis as u64))
     .with_lio(&unsafe { handle(lio) }.inner)
@@ -611,5 +1794,6 @@ pub unsafe extern "C" fn lio_timeout(
         Ok(_) => 0,
         Err(e) => -e.raw_os_error().unwrap_or(1),
       });
-    });
+    })
+    .0
 }
@@ -0,0 +1,350 @@
+//! Streaming a file over a socket, see [`copy_to_socket`].
+
+use std::{
+  collections::VecDeque,
+  future::{Future, IntoFuture, poll_fn},
+  io,
+  ops::Range,
+  pin::Pin,
+  rc::Rc,
+  task::Poll,
+};
+
+use crate::{
+  Lio,
+  api::{
+    io::Io,
+    resource::{AsResource, Resource},
+  },
+  fs::File,
+  typed_op::TypedOp,
+};
+
+/// Chunks [`CopyToSocket`] keeps in flight by default.
+const DEFAULT_CHUNKS: usize = 4;
+
+/// Chunk size of [`CopyToSocket`] by default, a pipe's default capacity.
+const DEFAULT_CHUNK_SIZE: u32 = 64 * 1024;
+
+/// Sends the bytes of `file` in `range` to `socket`.
+///
+/// On Linux this splices the file into pipes and the pipes into the socket,
+/// so the data never passes through userspace. Elsewhere it reads the file
+/// into buffers and sends those. Either way a few chunks are read ahead of
+/// the one being sent, see [`CopyToSocket::chunks`].
+///
+/// Resolves to the bytes sent, which is fewer than the range only if the
+/// file ends before it does. An error from any read or send ends the copy,
+/// after which it's unknown how much of the range the peer got.
+///
+/// # Examples
+///
+/// ```rust,no_run
+/// use lio::{fs::{self, File}, net::TcpSocket};
+///
+/// async fn serve(file: &File, len: u64, socket: &TcpSocket) -> std::io::Result<()> {
+///     let sent = fs::copy_to_socket(file, socket, 0..len).chunks(8).await?;
+///     assert_eq!(sent, len);
+///     Ok(())
+/// }
+/// ```
+pub fn copy_to_socket(
+  file: &File,
+  socket: &impl AsResource,
+  range: Range<u64>,
+) -> CopyToSocket {
+  CopyToSocket {
+    file: file.as_resource().clone(),
+    socket: socket.as_resource().clone(),
+    range,
+    chunks: DEFAULT_CHUNKS,
+    chunk_size: DEFAULT_CHUNK_SIZE,
+    lio: None,
+  }
+}
+
+/// A copy from a file to a socket, started by awaiting it.
+///
+/// Created by [`copy_to_socket`].
+#[must_use = "the copy only starts when awaited"]
+pub struct CopyToSocket {
+  file: Resource,
+  socket: Resource,
+  range: Range<u64>,
+  chunks: usize,
+  chunk_size: u32,
+  lio: Option<Lio>,
+}
+
+impl CopyToSocket {
+  /// Runs the copy on `lio` instead of the global one, like
+  /// [`Io::with_lio`].
+  pub fn with_lio(mut self, lio: &Lio) -> Self {
+    self.lio = Some(lio.clone());
+    self
+  }
+
+  /// Keeps up to `chunks` chunks read ahead of the socket, 4 by default.
+  ///
+  /// On Linux each takes a pipe.
+  ///
+  /// # Panics
+  ///
+  /// Panics if `chunks` is 0.
+  pub fn chunks(mut self, chunks: usize) -> Self {
+    assert!(chunks > 0, "chunks must be at least 1");
+    self.chunks = chunks;
+    self
+  }
+
+  /// Reads the file `bytes` at a time, 64 KiB by default.
+  ///
+  /// On Linux, pipes are grown to fit chunks bigger than that if the system
+  /// allows it, and chunks that don't fit go through in parts.
+  ///
+  /// # Panics
+  ///
+  /// Panics if `bytes` is 0.
+  pub fn chunk_size(mut self, bytes: u32) -> Self {
+    assert!(bytes > 0, "chunk size must be at least 1");
+    self.chunk_size = bytes;
+    self
+  }
+
+  async fn run(self) -> io::Result<u64> {
+    let Range { start, end } = self.range;
+    let shared =
+      Rc::new(Shared { file: self.file, socket: self.socket, lio: self.lio });
+
+    let mut spare: Vec<Slot> = Vec::new();
+    let mut ahead: VecDeque<Chunk> = VecDeque::new();
+    let mut next = start;
+    let mut sent = 0;
+    loop {
+      while ahead.len() < self.chunks && next < end {
+        let slot = match spare.pop() {
+          Some(slot) => slot,
+          None => Slot::new(self.chunk_size)?,
+        };
+        let len = (end - next).min(self.chunk_size as u64) as u32;
+        ahead.push_back(Chunk::fill(&shared, slot, next, len).await);
+        next += len as u64;
+      }
+      let Some(chunk) = ahead.pop_front() else { return Ok(sent) };
+
+      let (offset, len) = (chunk.offset, chunk.len);
+      let (res, slot) = chunk.done().await;
+      let filled = res?;
+      if filled == 0 {
+        // The file ended before the range did.
+        return Ok(sent);
+      }
+      let (res, slot) = drain(shared.clone(), slot, filled).await;
+      res?;
+      sent += filled as u64;
+
+      if filled < len {
+        // What's left of this chunk goes before the ones read ahead.
+        let rest =
+          Chunk::fill(&shared, slot, offset + filled as u64, len - filled);
+        ahead.push_front(rest.await);
+      } else {
+        spare.push(slot);
+      }
+    }
+  }
+}
+
+impl IntoFuture for CopyToSocket {
+  type Output = io::Result<u64>;
+  type IntoFuture = Pin<Box<dyn Future<Output = io::Result<u64>>>>;
+
+  fn into_future(self) -> Self::IntoFuture {
+    Box::pin(self.run())
+  }
+}
+
+/// What every step of a copy needs.
+struct Shared {
+  file: Resource,
+  socket: Resource,
+  lio: Option<Lio>,
+}
+
+impl Shared {
+  fn bind<T: TypedOp>(&self, io: Io<T>) -> Io<T> {
+    match &self.lio {
+      Some(lio) => io.with_lio(lio),
+      None => io,
+    }
+  }
+}
+
+type Filled = (io::Result<u32>, Slot);
+
+/// A chunk being read ahead.
+struct Chunk {
+  offset: u64,
+  len: u32,
+  state: ChunkState,
+}
+
+enum ChunkState {
+  Running(Pin<Box<dyn Future<Output = Filled>>>),
+  Done(Filled),
+}
+
+impl Chunk {
+  /// Starts reading `len` bytes at `offset` into `slot`, submitting the
+  /// read before returning.
+  async fn fill(
+    shared: &Rc<Shared>,
+    slot: Slot,
+    offset: u64,
+    len: u32,
+  ) -> Self {
+    let mut fut = Box::pin(fill(shared.clone(), slot, offset, len));
+    let state = match poll_fn(|cx| Poll::Ready(fut.as_mut().poll(cx))).await {
+      Poll::Ready(filled) => ChunkState::Done(filled),
+      Poll::Pending => ChunkState::Running(fut),
+    };
+    Self { offset, len, state }
+  }
+
+  async fn done(self) -> Filled {
+    match self.state {
+      ChunkState::Running(fut) => fut.await,
+      ChunkState::Done(filled) => filled,
+    }
+  }
+}
+
+#[cfg(linux)]
+use pipe::{Slot, drain, fill};
+
+#[cfg(not(linux))]
+use buffered::{Slot, drain, fill};
+
+/// Splicing through a pipe per chunk.
+#[cfg(linux)]
+mod pipe {
+  use std::{io, os::fd::FromRawFd, rc::Rc};
+
+  use super::{DEFAULT_CHUNK_SIZE, Filled, Shared};
+  use crate::api::{self, resource::Resource};
+
+  pub(super) struct Slot {
+    read: Resource,
+    write: Resource,
+  }
+
+  impl Slot {
+    pub(super) fn new(chunk_size: u32) -> io::Result<Self> {
+      let mut fds = [0; 2];
+      syscall!(pipe2(fds.as_mut_ptr(), libc::O_NONBLOCK | libc::O_CLOEXEC))?;
+      // SAFETY: pipe2 just opened both ends.
+      let (read, write) = unsafe {
+        (Resource::from_raw_fd(fds[0]), Resource::from_raw_fd(fds[1]))
+      };
+      if chunk_size > DEFAULT_CHUNK_SIZE {
+        // Best effort, a pipe that stays small fills in parts.
+        let _ = syscall!(fcntl(fds[1], libc::F_SETPIPE_SZ, chunk_size as i32));
+      }
+      Ok(Self { read, write })
+    }
+  }
+
+  pub(super) async fn fill(
+    shared: Rc<Shared>,
+    slot: Slot,
+    offset: u64,
+    len: u32,
+  ) -> Filled {
+    let splice = api::splice(&shared.file, offset as i64, &slot.write, len);
+    let res = shared.bind(splice).await;
+    (res.map(|n| n as u32), slot)
+  }
+
+  pub(super) async fn drain(
+    shared: Rc<Shared>,
+    slot: Slot,
+    len: u32,
+  ) -> (io::Result<()>, Slot) {
+    let mut left = len;
+    while left > 0 {
+      let splice = api::splice(&slot.read, -1, &shared.socket, left);
+      match shared.bind(splice).await {
+        Ok(0) => return (Err(io::ErrorKind::WriteZero.into()), slot),
+        Ok(n) => left -= n as u32,
+        Err(err) => return (Err(err), slot),
+      }
+    }
+    (Ok(()), slot)
+  }
+}
+
+/// Reading into and sending from a buffer per chunk.
+#[cfg(not(linux))]
+mod buffered {
+  use std::{io, rc::Rc};
+
+  use super::{Filled, Shared};
+  use crate::{api, buf::BufLike};
+
+  /// A buffer whose I/O covers `data[pos..end]`, each transfer moving `pos`
+  /// on.
+  pub(super) struct Slot {
+    data: Box<[u8]>,
+    pos: usize,
+    end: usize,
+  }
+
+  impl BufLike for Slot {
+    fn buf(&self) -> &[u8] {
+      &self.data[self.pos..self.end]
+    }
+
+    fn after(mut self, bytes: usize) -> Self {
+      self.pos += bytes;
+      self
+    }
+  }
+
+  impl Slot {
+    pub(super) fn new(chunk_size: u32) -> io::Result<Self> {
+      let data = vec![0; chunk_size as usize].into_boxed_slice();
+      Ok(Self { data, pos: 0, end: 0 })
+    }
+  }
+
+  pub(super) async fn fill(
+    shared: Rc<Shared>,
+    mut slot: Slot,
+    offset: u64,
+    len: u32,
+  ) -> Filled {
+    (slot.pos, slot.end) = (0, len as usize);
+    let read = api::read_at(&shared.file, slot, offset as i64);
+    let (res, slot) = shared.bind(read).await;
+    (res.map(|n| n as u32), slot)
+  }
+
+  pub(super) async fn drain(
+    shared: Rc<Shared>,
+    mut slot: Slot,
+    len: u32,
+  ) -> (io::Result<()>, Slot) {
+    (slot.pos, slot.end) = (0, len as usize);
+    while slot.pos < slot.end {
+      let (res, next) =
+        shared.bind(api::send(&shared.socket, slot, None)).await;
+      slot = next;
+      match res {
+        Ok(0) => return (Err(io::ErrorKind::WriteZero.into()), slot),
+        Ok(_) => {}
+        Err(err) => return (Err(err), slot),
+      }
+    }
+    (Ok(()), slot)
+  }
+}
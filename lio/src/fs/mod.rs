@@ -1,5 +1,41 @@
-// mod open_options;
+//! Async file I/O for lio.
+//!
+//! [`File`] wraps a [`Resource`](crate::api::resource::Resource) opened through
+//! [`OpenOptions`], with positional reads and writes that return
+//! [`Io<T>`](crate::api::io::Io) like everything else in lio.
+//! [`copy_to_socket`] streams a file over a socket, without copying it
+//! through userspace on Linux, and [`SequentialReader`] scans one with
+//! reads kept in flight.
+//!
+//! # Direct I/O
+//!
+//! On Linux, [`OpenOptions::direct`] opens files with `O_DIRECT`, bypassing the
+//! page cache. I/O on them must be aligned to the device's block size, which
+//! [`File`] checks before submitting. See [`AlignedBuf`](crate::buf::AlignedBuf)
+//! for buffers that fit.
+//!
+//! ```rust,no_run
+//! # #[cfg(target_os = "linux")]
+//! async fn read_block() -> std::io::Result<()> {
+//!     use lio::{buf::AlignedBuf, fs::OpenOptions};
+//!
+//!     let file = OpenOptions::new()
+//!         .read(true)
+//!         .direct(true)
+//!         .direct_alignment(4096)
+//!         .open("/var/lib/store/blob")
+//!         .await?;
+//!     let (result, buf) = file.read_at(AlignedBuf::new(4096, 4096), 0).await;
+//!     println!("Read {} bytes: {:?}", result?, buf.as_ref());
+//!     Ok(())
+//! }
+//! ```
 
-// pub use open_options::OpenOptions;
-// pub mod ops;
-// pub use crate::fs::open_options::File;
+mod copy;
+mod open_options;
+mod sequential;
+
+pub mod ops;
+pub use copy::{CopyToSocket, copy_to_socket};
+pub use open_options::{File, OpenOptions};
+pub use sequential::SequentialReader;
@@ -3,9 +3,11 @@ use std::{io, path::Path};
 use crate::{
   api::{
     io::Io,
-    resource::{FromResource, Resource},
+    ops,
+    resource::{AsResource, FromResource, Resource},
   },
-  fs::ops::OpenatFile,
+  buf::BufLike,
+  fs::ops::{FileReadAt, FileWriteAt, OpenatFile},
 };
 
 /// Options and flags which can be used to configure how a file is opened.
@@ -23,6 +25,10 @@ pub struct OpenOptions {
   create_new: bool,
   #[cfg(unix)]
   mode: Option<u32>,
+  #[cfg(linux)]
+  direct: bool,
+  #[cfg(linux)]
+  direct_alignment: usize,
 }
 
 impl OpenOptions {
@@ -40,6 +46,10 @@ impl OpenOptions {
       create_new: false,
       #[cfg(unix)]
       mode: None,
+      #[cfg(linux)]
+      direct: false,
+      #[cfg(linux)]
+      direct_alignment: 512,
     }
   }
 
@@ -123,6 +133,45 @@ impl OpenOptions {
     self
   }
 
+  /// Sets the option to bypass the page cache with `O_DIRECT`.
+  ///
+  /// Reads and writes on the opened [`File`] then need buffers, lengths and
+  /// offsets aligned to the device's logical block size, see
+  /// [`direct_alignment`](Self::direct_alignment).
+  /// [`File::read_at`] and [`File::write_at`] check this before submitting
+  /// and fail with `EINVAL` otherwise. [`AlignedBuf`](crate::buf::AlignedBuf)
+  /// and [`BufStore`](crate::buf::BufStore) buffers of 512 or 4096 bytes fit.
+  ///
+  /// To poll the device for completions instead of waiting for interrupts,
+  /// build the [`Lio`](crate::Lio) with
+  /// [`LioBuilder::iopoll`](crate::LioBuilder::iopoll).
+  ///
+  /// # Platform-specific behavior
+  ///
+  /// This option is only available on Linux.
+  #[cfg(linux)]
+  #[must_use]
+  pub const fn direct(mut self, direct: bool) -> Self {
+    self.direct = direct;
+    self
+  }
+
+  /// Sets the alignment [`direct`](Self::direct) files check I/O against.
+  ///
+  /// Defaults to 512, which most devices accept. Use 4096 for devices with
+  /// 4K logical blocks.
+  ///
+  /// # Panics
+  ///
+  /// Panics if `align` isn't a power of two.
+  #[cfg(linux)]
+  #[must_use]
+  pub const fn direct_alignment(mut self, align: usize) -> Self {
+    assert!(align.is_power_of_two(), "alignment must be a power of two");
+    self.direct_alignment = align;
+    self
+  }
+
   /// Opens a file at `path` with the options specified by `self`.
   ///
   /// # Errors
@@ -131,11 +180,16 @@ impl OpenOptions {
   /// permission to access the file, or if any of the options specified are invalid
   /// for the given file.
   pub fn open<P: AsRef<Path>>(&self, path: P) -> Io<OpenatFile> {
-    let flags = self.make_flags()?;
+    Io::from_op(self.open_inner(path.as_ref()).unwrap_or_else(OpenatFile::fail))
+  }
 
-    // let path_bytes = path.as_ref().as_os_str().as_bytes();
-    // let dirfd = libc::AT_FDCWD;
-    self.open_inner(flags, path.as_ref())
+  /// The alignment files opened with these options need.
+  fn alignment(&self) -> Option<usize> {
+    #[cfg(linux)]
+    if self.direct {
+      return Some(self.direct_alignment);
+    }
+    None
   }
 
   #[cfg(unix)]
@@ -170,55 +224,130 @@ impl OpenOptions {
     if self.truncate {
       flags |= libc::O_TRUNC;
     }
-    Ok(flags)
+
+    #[cfg(linux)]
+    if self.direct {
+      flags |= libc::O_DIRECT;
+    }
+    Ok(flags | libc::O_CLOEXEC)
+  }
+
+  #[cfg(unix)]
+  fn open_inner(&self, path: &Path) -> io::Result<OpenatFile> {
+    use std::{ffi::CString, os::unix::ffi::OsStrExt};
+
+    let flags = self.make_flags()?;
+    let path = CString::new(path.as_os_str().as_bytes())?;
+    // SAFETY: AT_FDCWD isn't an open fd, so it's borrowed and never closed.
+    let cwd = unsafe { Resource::from_raw_fd_borrowed(libc::AT_FDCWD) };
+    let op =
+      ops::OpenAt::new(cwd, path, flags).mode(self.mode.unwrap_or(0o666));
+    Ok(OpenatFile::new(op, self.alignment()))
   }
 
-  // #[cfg(unix)]
-  fn open_inner(&self, flags: libc::c_int, path: &Path) -> Io<OpenatFile> {
-    todo!();
+  #[cfg(not(unix))]
+  fn open_inner(&self, _path: &Path) -> io::Result<OpenatFile> {
     // TODO: Implement for Windows using NtCreateFile or similar
-    // Err(std::io::Error::new(
-    //   std::io::ErrorKind::Unsupported,
-    //   "OpenOptions is currently only supported on Unix platforms",
-    // ))
-  }
-
-  // #[cfg(not(unix))]
-  // async fn open_inner(&self, _path: &Path) -> std::io::Result<Resource> {
-  //   // TODO: Implement for Windows using NtCreateFile or similar
-  //   Err(std::io::Error::new(
-  //     std::io::ErrorKind::Unsupported,
-  //     "OpenOptions is currently only supported on Unix platforms",
-  //   ))
-  // }
+    Err(std::io::Error::new(
+      std::io::ErrorKind::Unsupported,
+      "OpenOptions is currently only supported on Unix platforms",
+    ))
+  }
 }
 
-pub struct File(Resource);
+/// An open file.
+///
+/// Opened by [`OpenOptions::open`], or [`File::open`] and friends for the
+/// common cases. Reads and writes are positional, so one `File` can have many
+/// in flight.
+///
+/// # Examples
+///
+/// ```rust,no_run
+/// use lio::fs::File;
+///
+/// async fn read_header() -> std::io::Result<Vec<u8>> {
+///     let file = File::open("/tmp/data.bin").await?;
+///     let (result, buf) = file.read_at(Vec::with_capacity(512), 0).await;
+///     result?;
+///     Ok(buf)
+/// }
+/// ```
+pub struct File {
+  res: Resource,
+  /// Alignment that I/O must have, for `O_DIRECT` files.
+  align: Option<usize>,
+}
 
 impl File {
-  pub fn open<P: AsRef<Path>>(path: P) -> io::Result<Self> {
+  pub(crate) fn new(res: Resource, align: Option<usize>) -> Self {
+    Self { res, align }
+  }
+
+  /// Opens a file in read-only mode.
+  pub fn open<P: AsRef<Path>>(path: P) -> Io<OpenatFile> {
     OpenOptions::new().read(true).open(path.as_ref())
   }
 
-  pub fn create<P: AsRef<Path>>(path: P) -> io::Result<Self> {
+  /// Opens a file in write-only mode, creating or truncating it.
+  pub fn create<P: AsRef<Path>>(path: P) -> Io<OpenatFile> {
     OpenOptions::new()
       .write(true)
       .create(true)
       .truncate(true)
       .open(path.as_ref())
   }
-  pub fn create_new<P: AsRef<Path>>(path: P) -> io::Result<File> {
+
+  /// Creates a new file in read-write mode, failing if it already exists.
+  pub fn create_new<P: AsRef<Path>>(path: P) -> Io<OpenatFile> {
     OpenOptions::new()
       .read(true)
       .write(true)
       .create_new(true)
       .open(path.as_ref())
   }
+
+  /// Reads into `buf` from `offset`, like [`api::read_at`](crate::api::read_at).
+  ///
+  /// On a [`direct`](OpenOptions::direct) file, a `buf` or `offset` that isn't
+  /// a multiple of [`alignment`](Self::alignment) fails with `EINVAL` before
+  /// submitting.
+  pub fn read_at<B>(&self, buf: B, offset: i64) -> Io<FileReadAt<B>>
+  where
+    B: BufLike + Send + Sync,
+  {
+    Io::from_op(FileReadAt::new(self.res.clone(), buf, offset, self.align))
+  }
+
+  /// Writes `buf` at `offset`, like [`api::write_at`](crate::api::write_at).
+  ///
+  /// On a [`direct`](OpenOptions::direct) file, a `buf` or `offset` that isn't
+  /// a multiple of [`alignment`](Self::alignment) fails with `EINVAL` before
+  /// submitting.
+  pub fn write_at<B>(&self, buf: B, offset: i64) -> Io<FileWriteAt<B>>
+  where
+    B: BufLike + Send + Sync,
+  {
+    Io::from_op(FileWriteAt::new(self.res.clone(), buf, offset, self.align))
+  }
+
+  /// The alignment I/O on this file needs, if it was opened
+  /// [`direct`](OpenOptions::direct).
+  pub fn alignment(&self) -> Option<usize> {
+    self.align
+  }
+}
+
+impl AsResource for File {
+  fn as_resource(&self) -> &Resource {
+    &self.res
+  }
 }
 
 impl FromResource for File {
+  /// Wraps `resource`, which isn't checked for `O_DIRECT`.
   fn from_resource(resource: Resource) -> Self {
-    File(resource)
+    File::new(resource, None)
   }
 }
 
@@ -1,42 +1,203 @@
+//! Internal operation types for file I/O.
+//!
+//! These adapt the low-level operations in [`api::ops`](crate::api::ops) to
+//! [`File`]. They implement [`TypedOp`] and are returned by methods on
+//! [`File`] and [`OpenOptions`](crate::fs::OpenOptions).
+//!
+//! # Available Operations
+//!
+//! - [`OpenatFile`]: Open operation that returns a [`File`]
+//! - [`FileReadAt`]: Positional read, checked against `O_DIRECT` alignment
+//! - [`FileWriteAt`]: Positional write, checked against `O_DIRECT` alignment
+
 use std::io;
 
 use crate::{
-  api::{ops, resource::FromResource},
+  BufResult,
+  api::{ops, resource::Resource},
+  buf::BufLike,
   fs::File,
-  operation::{OpMeta, Operation, OperationExt},
+  op::Op,
+  typed_op::TypedOp,
 };
 
-pub struct OpenatFile(ops::OpenAt);
+/// Open operation specialized for [`File`].
+///
+/// Options that can't be opened, like a path with a nul byte, fail without
+/// reaching the OS.
+///
+/// You typically won't create this directly; it's returned by
+/// [`OpenOptions::open()`](crate::fs::OpenOptions::open).
+pub struct OpenatFile(Open);
+
+enum Open {
+  Submit { inner: ops::OpenAt, align: Option<usize> },
+  Fail(io::Error),
+}
+
+impl OpenatFile {
+  pub(crate) fn new(inner: ops::OpenAt, align: Option<usize>) -> Self {
+    Self(Open::Submit { inner, align })
+  }
+
+  pub(crate) fn fail(err: io::Error) -> Self {
+    Self(Open::Fail(err))
+  }
+}
 
-impl OperationExt for OpenatFile {
+impl TypedOp for OpenatFile {
   type Result = io::Result<File>;
+
+  fn into_op(&mut self) -> Op {
+    match &mut self.0 {
+      Open::Submit { inner, .. } => inner.into_op(),
+      Open::Fail(_) => Op::Nop,
+    }
+  }
+
+  fn extract_result(self, res: isize) -> Self::Result {
+    match self.0 {
+      Open::Submit { inner, align } => {
+        Ok(File::new(inner.extract_result(res)?, align))
+      }
+      Open::Fail(err) => Err(err),
+    }
+  }
+}
+
+/// Whether `buf` and `offset` can be used on a file opened with alignment
+/// `align`.
+fn is_aligned(align: Option<usize>, buf: &[u8], offset: i64) -> bool {
+  let Some(align) = align else { return true };
+  (buf.as_ptr() as usize).is_multiple_of(align)
+    && buf.len().is_multiple_of(align)
+    && offset >= 0
+    && (offset as u64).is_multiple_of(align as u64)
+}
+
+fn misaligned() -> io::Error {
+  io::Error::from_raw_os_error(libc::EINVAL)
 }
 
-impl Operation for OpenatFile {
-  fn run_blocking(&self) -> isize {
-    self.0.run_blocking()
+/// Positional read on a [`File`].
+///
+/// On an `O_DIRECT` file, a buffer or offset that isn't aligned fails with
+/// `EINVAL` without reaching the OS, returning the buffer untouched.
+///
+/// You typically won't create this directly; it's returned by
+/// [`File::read_at()`](crate::fs::File::read_at).
+pub struct FileReadAt<B>(Checked<ops::ReadAt<B>, B>)
+where
+  B: Send + Sync;
+
+/// Positional write on a [`File`].
+///
+/// On an `O_DIRECT` file, a buffer or offset that isn't aligned fails with
+/// `EINVAL` without reaching the OS, returning the buffer untouched.
+///
+/// You typically won't create this directly; it's returned by
+/// [`File::write_at()`](crate::fs::File::write_at).
+pub struct FileWriteAt<B>(Checked<ops::WriteAt<B>, B>)
+where
+  B: Send + Sync;
+
+enum Checked<T, B> {
+  Aligned(T),
+  Misaligned(B),
+}
+
+impl<B> FileReadAt<B>
+where
+  B: BufLike + Send + Sync,
+{
+  pub(crate) fn new(
+    res: Resource,
+    buf: B,
+    offset: i64,
+    align: Option<usize>,
+  ) -> Self {
+    Self(if is_aligned(align, buf.buf(), offset) {
+      Checked::Aligned(ops::ReadAt::new(res, buf, offset))
+    } else {
+      Checked::Misaligned(buf)
+    })
   }
-  fn meta(&self) -> OpMeta {
-    self.0.meta()
+}
+
+impl<B> FileWriteAt<B>
+where
+  B: BufLike + Send + Sync,
+{
+  pub(crate) fn new(
+    res: Resource,
+    buf: B,
+    offset: i64,
+    align: Option<usize>,
+  ) -> Self {
+    Self(if is_aligned(align, buf.buf(), offset) {
+      Checked::Aligned(ops::WriteAt::new(res, buf, offset))
+    } else {
+      Checked::Misaligned(buf)
+    })
   }
-  fn result(&mut self, ret: isize) -> *const () {
-    let ptr =
-      self.0.result(ret) as *const <ops::Socket as OperationExt>::Result;
+}
 
-    // SAFETY: The pointer was just created by Accept::result and points to valid Accept::Result
-    let accept_result = unsafe { ptr.read() };
+impl<B> TypedOp for FileReadAt<B>
+where
+  B: BufLike + Send + Sync + 'static,
+{
+  type Result = BufResult<i32, B>;
 
-    let socket_result = accept_result.map(File::from_resource);
+  fn into_op(&mut self) -> Op {
+    match &mut self.0 {
+      Checked::Aligned(inner) => inner.into_op(),
+      Checked::Misaligned(_) => Op::Nop,
+    }
+  }
 
-    // Box the result and return pointer
-    Box::into_raw(Box::new(socket_result)) as *const ()
+  fn extract_result(self, res: isize) -> Self::Result {
+    match self.0 {
+      Checked::Aligned(inner) => inner.extract_result(res),
+      Checked::Misaligned(buf) => (Err(misaligned()), buf),
+    }
   }
-  fn cap(&self) -> i32 {
-    self.0.cap()
+}
+
+impl<B> TypedOp for FileWriteAt<B>
+where
+  B: BufLike + Send + Sync + 'static,
+{
+  type Result = BufResult<i32, B>;
+
+  fn into_op(&mut self) -> Op {
+    match &mut self.0 {
+      Checked::Aligned(inner) => inner.into_op(),
+      Checked::Misaligned(_) => Op::Nop,
+    }
   }
 
-  #[cfg(linux)]
-  fn create_entry(&self) -> lio_uring::submission::Entry {
-    self.0.create_entry()
+  fn extract_result(self, res: isize) -> Self::Result {
+    match self.0 {
+      Checked::Aligned(inner) => inner.extract_result(res),
+      Checked::Misaligned(buf) => (Err(misaligned()), buf),
+    }
+  }
+}
+
+#[cfg(test)]
+mod tests {
+  use super::*;
+
+  #[test]
+  fn test_is_aligned() {
+    let buf = crate::buf::AlignedBuf::new(1024, 512);
+    let bytes = buf.buf();
+    assert!(is_aligned(None, &bytes[1..], 3));
+    assert!(is_aligned(Some(512), bytes, 512));
+    assert!(!is_aligned(Some(512), &bytes[..100], 0));
+    assert!(!is_aligned(Some(512), &bytes[1..513], 0));
+    assert!(!is_aligned(Some(512), bytes, 100));
+    assert!(!is_aligned(Some(512), bytes, -512));
+    assert!(!is_aligned(Some(4096), bytes, 0));
   }
 }
@@ -0,0 +1,245 @@
+//! Reading a file front to back with reads kept in flight, see
+//! [`SequentialReader`].
+
+use std::{
+  collections::VecDeque,
+  future::{Future, IntoFuture},
+  io,
+  pin::Pin,
+  task::{Context, Poll},
+};
+
+use crate::{
+  Lio,
+  api::{
+    self,
+    io::IoFuture,
+    ops::ReadFixed,
+    resource::{AsResource, Resource},
+  },
+  buf::{BufStore, LentBuf},
+  fs::File,
+};
+
+/// Reads [`SequentialReader`] starts with in flight.
+const DEFAULT_WINDOW: usize = 8;
+
+/// Most reads [`SequentialReader`] grows to by default.
+const DEFAULT_MAX_WINDOW: usize = 64;
+
+/// Reads a file front to back, keeping a window of reads ahead of the
+/// caller.
+///
+/// Chunks come out in file order, each in a buffer from a [`BufStore`]
+/// that goes back to it when dropped. With the store registered through
+/// [`LioBuilder::buf_store`](crate::LioBuilder::buf_store), io_uring reads
+/// into them with `READ_FIXED`.
+///
+/// The window starts at 8 reads. Each time the caller asks for a chunk that
+/// hasn't been read yet, the reads took longer than the caller did with the
+/// chunk before, so the window grows by one, up to
+/// [`max_window`](Self::max_window). Every read in it holds a buffer, so the
+/// store needs the maximum window's worth plus the chunks the caller keeps.
+///
+/// A read that comes up short ends the chunk there; the next one resumes
+/// from where it stopped. On a [`direct`](crate::fs::OpenOptions::direct)
+/// file, where that would be misaligned, a short read ends the file.
+///
+/// # Examples
+///
+/// ```rust,no_run
+/// use lio::{buf::{BufStore, SizeClass}, fs::{File, SequentialReader}};
+///
+/// async fn scan(file: &File) -> std::io::Result<u64> {
+///     let store: &'static BufStore = Box::leak(Box::new(
+///         BufStore::with_classes(&[SizeClass::new(256 * 1024, 72)]),
+///     ));
+///     let mut reader = SequentialReader::new(file, store);
+///     let mut total = 0;
+///     while let Some(chunk) = reader.next().await {
+///         total += chunk?.as_ref().len() as u64;
+///     }
+///     Ok(total)
+/// }
+/// ```
+pub struct SequentialReader {
+  file: Resource,
+  store: &'static BufStore,
+  lio: Option<Lio>,
+  chunk_size: usize,
+  window: usize,
+  max_window: usize,
+  /// Offset of the next read to submit.
+  next: u64,
+  ahead: VecDeque<Read>,
+  /// Whether a short read ends the file.
+  direct: bool,
+  done: bool,
+}
+
+/// A read in the window.
+struct Read {
+  offset: u64,
+  len: usize,
+  fut: IoFuture<ReadFixed>,
+  /// Whether the caller already waited on it, and grew the window.
+  waited: bool,
+}
+
+impl SequentialReader {
+  /// Reads `file` from the start into buffers from `store`.
+  ///
+  /// Chunks are as big as the biggest buffers in `store`, see
+  /// [`chunk_size`](Self::chunk_size).
+  pub fn new(file: &File, store: &'static BufStore) -> Self {
+    let chunk_size =
+      store.classes().map(|class| class.buf_len).max().unwrap_or(0);
+    Self {
+      file: file.as_resource().clone(),
+      store,
+      lio: None,
+      chunk_size,
+      window: DEFAULT_WINDOW,
+      max_window: DEFAULT_MAX_WINDOW,
+      next: 0,
+      ahead: VecDeque::new(),
+      direct: file.alignment().is_some(),
+      done: false,
+    }
+  }
+
+  /// Runs the reads on `lio` instead of the global one, like
+  /// [`Io::with_lio`](crate::api::io::Io::with_lio).
+  pub fn with_lio(mut self, lio: &Lio) -> Self {
+    self.lio = Some(lio.clone());
+    self
+  }
+
+  /// Starts reading at `offset` instead of the start of the file.
+  pub fn offset(mut self, offset: u64) -> Self {
+    self.next = offset;
+    self
+  }
+
+  /// Reads into buffers of at least `bytes`, taken from the smallest class
+  /// in the store that fits. A chunk is as long as its buffer.
+  pub fn chunk_size(mut self, bytes: usize) -> Self {
+    self.chunk_size = bytes;
+    self
+  }
+
+  /// Starts with `window` reads in flight, 8 by default.
+  ///
+  /// # Panics
+  ///
+  /// Panics if `window` is 0.
+  pub fn window(mut self, window: usize) -> Self {
+    assert!(window > 0, "window must be at least 1");
+    self.window = window;
+    self.max_window = self.max_window.max(window);
+    self
+  }
+
+  /// Grows the window to at most `max` reads, 64 by default. Set it to the
+  /// [`window`](Self::window) to keep that fixed.
+  ///
+  /// # Panics
+  ///
+  /// Panics if `max` is 0.
+  pub fn max_window(mut self, max: usize) -> Self {
+    assert!(max > 0, "max window must be at least 1");
+    self.max_window = max;
+    self.window = self.window.min(max);
+    self
+  }
+
+  /// Reads the window holds right now.
+  pub fn current_window(&self) -> usize {
+    self.window
+  }
+
+  /// Waits for the next chunk, `None` at the end of the file.
+  ///
+  /// Fails with `ENOBUFS` if the store has no buffer left for a read and
+  /// none are in flight, until the caller drops some chunks.
+  #[allow(clippy::should_implement_trait)]
+  pub fn next(
+    &mut self,
+  ) -> impl Future<Output = Option<io::Result<LentBuf<'static>>>> + '_ {
+    std::future::poll_fn(|cx| self.poll_next(cx))
+  }
+
+  /// Polls for the next chunk, `Ready(None)` at the end of the file.
+  pub fn poll_next(
+    &mut self,
+    cx: &mut Context<'_>,
+  ) -> Poll<Option<io::Result<LentBuf<'static>>>> {
+    if self.done {
+      return Poll::Ready(None);
+    }
+    self.fill_window(cx);
+    let Some(head) = self.ahead.front_mut() else {
+      return Poll::Ready(Some(Err(io::Error::from_raw_os_error(
+        libc::ENOBUFS,
+      ))));
+    };
+
+    let (res, buf) = match Pin::new(&mut head.fut).poll(cx) {
+      Poll::Ready(done) => done,
+      Poll::Pending => {
+        if !head.waited {
+          head.waited = true;
+          self.window = (self.window + 1).min(self.max_window);
+        }
+        return Poll::Pending;
+      }
+    };
+    let Read { offset, len, .. } = self.ahead.pop_front().unwrap();
+    match res {
+      Err(err) => {
+        self.finish();
+        Poll::Ready(Some(Err(err)))
+      }
+      Ok(0) => {
+        self.finish();
+        Poll::Ready(None)
+      }
+      Ok(n) if (n as usize) < len => {
+        // The reads after this one start past where it stopped.
+        self.ahead.clear();
+        self.next = offset + n as u64;
+        if self.direct {
+          self.finish();
+        }
+        Poll::Ready(Some(Ok(buf)))
+      }
+      Ok(_) => Poll::Ready(Some(Ok(buf))),
+    }
+  }
+
+  /// Submits reads until the window is full or the store runs dry.
+  fn fill_window(&mut self, cx: &mut Context<'_>) {
+    while self.ahead.len() < self.window {
+      let Some(buf) = self.store.try_get_len(self.chunk_size) else {
+        return;
+      };
+      let len = buf.capacity();
+      let read = api::read_at_fixed(&self.file, buf, self.next as i64);
+      let read = match &self.lio {
+        Some(lio) => read.with_lio(lio),
+        None => read,
+      };
+      let mut fut = read.into_future();
+      // The first poll only submits.
+      assert!(Pin::new(&mut fut).poll(cx).is_pending());
+      self.ahead.push_back(Read { offset: self.next, len, fut, waited: false });
+      self.next += len as u64;
+    }
+  }
+
+  /// Stops reading, cancelling what's still in flight.
+  fn finish(&mut self) {
+    self.done = true;
+    self.ahead.clear();
+  }
+}
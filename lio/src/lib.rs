@@ -47,8 +47,11 @@
 #[macro_use]
 mod macros;
 pub mod buf;
+mod busy_poll;
 #[cfg(feature = "unstable_ffi")]
 pub mod ffi;
+#[cfg(feature = "metrics")]
+pub mod metrics;
 mod net_utils;
 
 pub mod net;
@@ -56,6 +59,7 @@ pub mod net;
 pub mod fs;
 
 pub use buf::BufResult;
+pub use busy_poll::BusyPoll;
 
 pub mod op;
 pub mod typed_op;
@@ -66,10 +70,15 @@ mod registration;
 #[path = "backends/backends.rs"]
 pub mod backends;
 
+mod remote;
+pub mod rt;
+mod timer;
+
 pub mod api;
 #[cfg_attr(docsrs, doc(hidden))]
 pub mod test_utils;
 
 // Re-export core types
 mod lio;
-pub use lio::{Lio, install_global, uninstall_global};
+pub use lio::{Lio, LioBuilder, OpId, install_global, uninstall_global};
+pub use remote::LioRemote;
@@ -1,10 +1,28 @@
 use crate::{
-  backends::{IoBackend, OpStore},
+  api::resource::AsResource,
+  backends::{IoBackend, OpCompleted, OpStore},
+  buf::{BufRing, BufStore},
+  busy_poll::{BusyPoll, Spinner},
   op::Op,
   registration::Registration,
+  remote::{Inbox, LioRemote},
+  timer::TimerWheel,
+  typed_op::TypedOp,
 };
 
-use std::{cell::RefCell, io, rc::Rc, task::Waker, time::Duration};
+#[cfg(feature = "metrics")]
+use crate::metrics::{Metrics, Stats};
+#[cfg(feature = "unstable_ffi")]
+use crate::registration::ReapQueue;
+
+use std::{
+  cell::RefCell,
+  collections::VecDeque,
+  io,
+  rc::Rc,
+  task::Waker,
+  time::{Duration, Instant},
+};
 
 thread_local! {
   static GLOBAL_LIO: RefCell<Option<Lio>> = const { RefCell::new(None) };
@@ -43,10 +61,94 @@ pub(crate) fn get_global() -> Option<Lio> {
 }
 
 struct LioInner {
-  store: OpStore,
+  /// Dropped before `store`, whose registrations free the buffers of ops
+  /// that never completed. io_uring cancels what's in flight and waits for
+  /// it as it drops, the Poller's ops are done once its pool is joined.
   io: Box<dyn IoBackend>,
+  store: OpStore,
+  /// Group id for the next [`BufRing`].
+  next_buf_group: u16,
+  /// Chains the backend can't run itself, indexed by [`OpStore::slot_of`]
+  /// the op in flight. Grows on the first one.
+  links: Vec<Option<Linked>>,
+  /// Links whose op completed in the batch being dispatched, and its result.
+  links_done: Vec<(Linked, isize)>,
+  /// Every pending [`Op::Timeout`], which the backend only ever waits for the
+  /// nearest of.
+  timers: TimerWheel,
+  /// Timers that went off in the batch being dispatched.
+  expired: Vec<u64>,
+  /// Timers taken off the wheel by [`Lio::cancel`], completing with
+  /// `ECANCELED` on the next run.
+  cancelled: Vec<u64>,
+  /// Jobs from [`LioRemote`]s, once the first one was made.
+  remote: Option<Rc<Inbox>>,
+  /// How [`Lio::run`] spins before it blocks.
+  spinner: Spinner,
+  /// Completions of ops from [`Lio::schedule_reaped`], until
+  /// [`Lio::reap`] takes them.
+  #[cfg(feature = "unstable_ffi")]
+  reaped: Rc<ReapQueue>,
+  #[cfg(feature = "metrics")]
+  metrics: Metrics,
+}
+
+/// An op of a chain [`Lio`] runs one op at a time, see
+/// [`IoBackend::push_chain`].
+enum Linked {
+  /// In flight, the `rest` of the chain goes out once it succeeded.
+  Op { id: u64, timer: Option<u64>, rest: VecDeque<(u64, Op)> },
+  /// Timer standing in for the link timeout of `target`, which is cancelled
+  /// if it goes off first. `None` once `target` completed.
+  Timer { id: u64, target: Option<u64> },
+}
+
+impl Linked {
+  fn id(&self) -> u64 {
+    match self {
+      Self::Op { id, .. } | Self::Timer { id, .. } => *id,
+    }
+  }
+}
+
+/// The link of in-flight op `id`, if it's part of a chain.
+fn link_mut(links: &mut [Option<Linked>], id: u64) -> Option<&mut Linked> {
+  links.get_mut(OpStore::slot_of(id))?.as_mut().filter(|link| link.id() == id)
+}
+
+/// Pushes op `id` to the backend, or onto the timer wheel for a timeout.
+fn push_op(
+  io: &mut dyn IoBackend,
+  timers: &mut TimerWheel,
+  id: u64,
+  op: Op,
+) -> io::Result<()> {
+  match op {
+    Op::Timeout { duration, .. } => {
+      timers.insert(id, deadline(duration));
+      Ok(())
+    }
+    op => io.push(id, op),
+  }
 }
 
+/// When a timer of `duration` started now goes off.
+fn deadline(duration: Duration) -> Instant {
+  let now = Instant::now();
+  // The wheel holds anything this far out until it comes closer.
+  now
+    .checked_add(duration)
+    .unwrap_or(now + Duration::from_secs(u32::MAX as u64))
+}
+
+/// Identifies a submitted op, to [`cancel`](Lio::cancel) it.
+///
+/// Returned by [`Io::when_done`](crate::api::io::Io::when_done) and
+/// [`Receiver::id`](crate::api::io::Receiver::id). Stays tied to its op: once
+/// that completed, a new op in the same slot doesn't take the id over.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct OpId(pub(crate) u64);
+
 #[derive(Clone)]
 pub struct Lio {
   inner: Rc<RefCell<LioInner>>,
@@ -94,6 +196,12 @@ impl Lio {
     }
   }
 
+  /// Returns a [`LioBuilder`] for a driver of capacity `cap`, to tune how the
+  /// io_uring backend sets up its ring.
+  pub fn builder(cap: usize) -> LioBuilder {
+    LioBuilder::new(cap)
+  }
+
   /// Creates a new Lio driver with the specified backend and capacity.
   ///
   /// # Arguments
@@ -115,39 +223,517 @@ impl Lio {
   {
     backend.init(cap)?;
 
-    let inner =
-      LioInner { io: Box::new(backend), store: OpStore::with_capacity(cap) };
+    let inner = LioInner {
+      io: Box::new(backend),
+      store: OpStore::with_capacity(cap),
+      next_buf_group: 0,
+      links: Vec::new(),
+      links_done: Vec::new(),
+      timers: TimerWheel::with_capacity(cap),
+      expired: Vec::new(),
+      cancelled: Vec::new(),
+      remote: None,
+      spinner: Spinner::default(),
+      #[cfg(feature = "unstable_ffi")]
+      reaped: Rc::default(),
+      #[cfg(feature = "metrics")]
+      metrics: Metrics::new(cap),
+    };
     Ok(Self { inner: Rc::new(RefCell::new(inner)) })
   }
 
+  /// Creates a new Lio driver with the default backend, registering every
+  /// buffer of `store` with the kernel up front.
+  ///
+  /// [`api::read_fixed`](crate::api::read_fixed), [`api::write_fixed`](crate::api::write_fixed)
+  /// and friends on buffers lent from `store` then submit io_uring's
+  /// `READ_FIXED`/`WRITE_FIXED`, which skip pinning the buffer pages on every op.
+  /// Backends without registered buffers accept the store and run those ops as
+  /// plain reads/writes.
+  ///
+  /// # Errors
+  ///
+  /// Fails if the registration is rejected, e.g because the pool exceeds
+  /// `RLIMIT_MEMLOCK` on older kernels.
+  ///
+  /// # Example
+  ///
+  /// ```
+  /// use lio::{Lio, buf::BufStore};
+  ///
+  /// let store: &'static BufStore = Box::leak(Box::new(BufStore::with_capacity(64)));
+  /// let lio = Lio::new_with_buf_store(1024, store).unwrap();
+  /// ```
+  pub fn new_with_buf_store(
+    cap: usize,
+    store: &'static BufStore,
+  ) -> io::Result<Self> {
+    let lio = Self::new(cap)?;
+    lio.inner.borrow_mut().io.register_buf_store(store)?;
+    Ok(lio)
+  }
+
+  /// Creates a [`BufRing`] of `entries` buffers, `buf_len` bytes each, and
+  /// registers it with the backend.
+  ///
+  /// Multishot receives on the ring ([`api::recv_multi`](crate::api::recv_multi))
+  /// only take a buffer when data arrives, so the ring can be shared by any
+  /// number of sockets at a fixed `entries * buf_len` bytes of memory.
+  ///
+  /// # Errors
+  ///
+  /// Fails if `entries` isn't a power of two no larger than 32768, or the
+  /// backend rejects the ring (io_uring needs Linux 5.19).
+  ///
+  /// # Example
+  ///
+  /// ```no_run
+  /// use lio::Lio;
+  ///
+  /// let lio = Lio::new(1024).unwrap();
+  /// // 256 * 4KiB = 1MiB of receive buffers, shared by all connections.
+  /// let ring = lio.register_buf_ring(256, 4096).unwrap();
+  /// ```
+  pub fn register_buf_ring(
+    &self,
+    entries: u16,
+    buf_len: u32,
+  ) -> io::Result<BufRing> {
+    if !entries.is_power_of_two() || entries > 1 << 15 || buf_len == 0 {
+      return Err(io::Error::new(
+        io::ErrorKind::InvalidInput,
+        "BufRing needs a power of two entries (at most 32768) and buf_len > 0",
+      ));
+    }
+    let mut inner = self.inner.borrow_mut();
+    let ring = BufRing::new(inner.next_buf_group, entries, buf_len);
+    inner.io.register_buf_ring(&ring)?;
+    inner.next_buf_group += 1;
+    Ok(ring)
+  }
+
+  /// Registers `res` in the driver's table of fixed files, so io_uring ops on
+  /// it skip the fd lookup the kernel otherwise does on every op.
+  ///
+  /// Worth it for long-lived files and sockets that see many ops. The table
+  /// holds up to `cap` files; registering one twice is a no-op. Other
+  /// backends accept the file and keep using its fd.
+  ///
+  /// The kernel holds on to a registered file until its slot is cleared.
+  /// That happens on the next run of the loop after every handle on it was
+  /// dropped, so only then does a registered socket send its FIN.
+  /// [`unregister_file`](Self::unregister_file) clears it right away.
+  ///
+  /// # Errors
+  ///
+  /// Fails with `ENFILE` when every slot holds a live file.
+  ///
+  /// # Example
+  ///
+  /// ```no_run
+  /// use lio::{Lio, fs::File};
+  ///
+  /// async fn with_segment(lio: &Lio) -> std::io::Result<()> {
+  ///   let segment = File::open("/var/lib/db/segment-0001").with_lio(lio).await?;
+  ///   lio.register_file(&segment)?;
+  ///   // ... reads on `segment` ...
+  ///   lio.unregister_file(&segment)
+  /// }
+  /// ```
+  pub fn register_file(&self, res: &impl AsResource) -> io::Result<()> {
+    self.inner.borrow_mut().io.register_file(res.as_resource())
+  }
+
+  /// Removes `res` from the table of fixed files, see
+  /// [`register_file`](Self::register_file). Does nothing if it isn't
+  /// registered.
+  pub fn unregister_file(&self, res: &impl AsResource) -> io::Result<()> {
+    self.inner.borrow_mut().io.unregister_file(res.as_resource())
+  }
+
   pub(crate) fn schedule(
     &self,
     op: Op,
     notifier: Registration,
   ) -> io::Result<u64> {
     let mut inner = self.inner.borrow_mut();
+    let LioInner { store, io, timers, .. } = &mut *inner;
     // Inserting first because of a stable pointer to push is required.
-    let id = inner.store.insert(notifier);
+    let id = store.insert(notifier);
+    #[cfg(feature = "metrics")]
+    let kind = op.kind();
 
-    match inner.io.push(id, op) {
-      Ok(()) => Ok(id),
+    match push_op(io.as_mut(), timers, id, op) {
+      Ok(()) => {
+        #[cfg(feature = "metrics")]
+        inner.metrics.submitted(id, kind);
+        Ok(id)
+      }
       Err(err) => {
-        assert!(inner.store.remove(id));
+        assert!(store.remove(id));
         Err(err)
       }
     }
   }
 
+  /// Schedules `ops` under one borrow, each completing with its `user_data`
+  /// into the queue [`reap`](Self::reap) takes from instead of calling back.
+  ///
+  /// Stops at the first op that doesn't fit in the store or the backend
+  /// refuses, returning how many went out before it along with the error.
+  #[cfg(feature = "unstable_ffi")]
+  pub(crate) fn schedule_reaped(
+    &self,
+    ops: impl IntoIterator<Item = (Op, u64)>,
+  ) -> (usize, io::Result<()>) {
+    let mut inner = self.inner.borrow_mut();
+    let LioInner {
+      store,
+      io,
+      timers,
+      reaped,
+      #[cfg(feature = "metrics")]
+      metrics,
+      ..
+    } = &mut *inner;
+    let mut scheduled = 0;
+    for (op, user_data) in ops {
+      let reg = Registration::new_reap(reaped.clone(), user_data);
+      let Ok(id) = store.try_insert(reg) else {
+        return (scheduled, Err(io::Error::from_raw_os_error(libc::EBUSY)));
+      };
+      #[cfg(feature = "metrics")]
+      let kind = op.kind();
+      if let Err(err) = push_op(io.as_mut(), timers, id, op) {
+        assert!(store.remove(id));
+        return (scheduled, Err(err));
+      }
+      #[cfg(feature = "metrics")]
+      metrics.submitted(id, kind);
+      scheduled += 1;
+    }
+    (scheduled, Ok(()))
+  }
+
+  /// Passes up to `max` completions of ops from
+  /// [`schedule_reaped`](Self::schedule_reaped) to `f` as
+  /// `(user_data, result)`, oldest first. Returns how many it passed.
+  #[cfg(feature = "unstable_ffi")]
+  pub(crate) fn reap(
+    &self,
+    max: usize,
+    mut f: impl FnMut(u64, isize),
+  ) -> usize {
+    let queue = self.inner.borrow().reaped.clone();
+    let mut reaped = queue.borrow_mut();
+    let n = max.min(reaped.len());
+    for (user_data, res) in reaped.drain(..n) {
+      f(user_data, res);
+    }
+    n
+  }
+
+  /// Submits `ops` as one chain, see [`IoBackend::push_chain`].
+  ///
+  /// Backends that can't chain ops get them one at a time, each once the one
+  /// before succeeded, with a timer on the wheel and [`IoBackend::cancel`]
+  /// for every [`Op::LinkTimeout`].
+  ///
+  /// Returns the id of the first op, cancelling which cancels the chain.
+  pub(crate) fn schedule_chain(
+    &self,
+    ops: Vec<(Op, Registration)>,
+  ) -> io::Result<u64> {
+    let mut inner = self.inner.borrow_mut();
+    let LioInner {
+      store,
+      io,
+      links,
+      timers,
+      #[cfg(feature = "metrics")]
+      metrics,
+      ..
+    } = &mut *inner;
+    let mut chain: Vec<(u64, Op)> =
+      ops.into_iter().map(|(op, reg)| (store.insert(reg), op)).collect();
+    let first = chain.first().map_or(0, |(id, _)| *id);
+    // The backend may take the ops out of `chain`.
+    #[cfg(feature = "metrics")]
+    let kinds: Vec<_> = chain.iter().map(|(id, op)| (*id, op.kind())).collect();
+
+    let pushed = io.push_chain(&mut chain);
+    #[cfg(feature = "metrics")]
+    if pushed.is_ok() {
+      for (id, kind) in kinds {
+        metrics.submitted(id, kind);
+      }
+    }
+    match pushed {
+      Ok(true) => Ok(first),
+      Ok(false) => {
+        Self::push_linked(store, io.as_mut(), timers, links, chain.into());
+        Ok(first)
+      }
+      Err(err) => {
+        for (id, _) in &chain {
+          assert!(store.remove(*id));
+        }
+        Err(err)
+      }
+    }
+  }
+
+  /// Pushes the first op of `rest`, and the timer for its link timeout if
+  /// one follows, leaving the others for when it succeeded.
+  ///
+  /// Returns how many ops it completed itself, because pushing failed.
+  fn push_linked(
+    store: &mut OpStore,
+    io: &mut dyn IoBackend,
+    timers: &mut TimerWheel,
+    links: &mut Vec<Option<Linked>>,
+    mut rest: VecDeque<(u64, Op)>,
+  ) -> usize {
+    let Some((id, op)) = rest.pop_front() else { return 0 };
+    if let Err(err) = push_op(io, timers, id, op) {
+      let errno = err.raw_os_error().unwrap_or(libc::EIO);
+      Self::settle(store, id, -(errno as isize));
+      return 1 + Self::cancel_linked(store, rest);
+    }
+
+    let mut timer = None;
+    if let Some(&(timer_id, Op::LinkTimeout { duration, .. })) = rest.front() {
+      rest.pop_front();
+      timers.insert(timer_id, deadline(duration));
+      timer = Some(timer_id);
+      Self::insert_link(
+        links,
+        Linked::Timer { id: timer_id, target: Some(id) },
+      );
+    }
+    if timer.is_some() || !rest.is_empty() {
+      Self::insert_link(links, Linked::Op { id, timer, rest });
+    }
+    0
+  }
+
+  fn insert_link(links: &mut Vec<Option<Linked>>, link: Linked) {
+    let slot = OpStore::slot_of(link.id());
+    if slot >= links.len() {
+      links.resize_with(slot + 1, || None);
+    }
+    links[slot] = Some(link);
+  }
+
+  /// Moves the chains along past the links that completed in the last batch.
+  /// Returns how many ops that completed without the backend.
+  fn advance_links(
+    store: &mut OpStore,
+    io: &mut dyn IoBackend,
+    timers: &mut TimerWheel,
+    links: &mut Vec<Option<Linked>>,
+    done: &mut Vec<(Linked, isize)>,
+  ) -> io::Result<usize> {
+    let mut settled = 0;
+    while let Some((link, res)) = done.pop() {
+      match link {
+        Linked::Op { timer, rest, .. } => {
+          if let Some(timer) = timer
+            && let Some(Linked::Timer { target, .. }) = link_mut(links, timer)
+          {
+            *target = None;
+            settled += Self::cancel_op(store, io, timers, links, done, timer)?;
+          }
+          settled += if res < 0 {
+            Self::cancel_linked(store, rest)
+          } else {
+            Self::push_linked(store, io, timers, links, rest)
+          };
+        }
+        // Went off before its op completed.
+        Linked::Timer { target: Some(target), .. } if res >= 0 => {
+          if let Some(Linked::Op { timer, .. }) = link_mut(links, target) {
+            *timer = None;
+          }
+          settled += Self::cancel_op(store, io, timers, links, done, target)?;
+        }
+        Linked::Timer { .. } => {}
+      }
+    }
+    Ok(settled)
+  }
+
+  /// Cancels in-flight op `id` of a chain.
+  ///
+  /// A timer comes off the wheel and completes with `ECANCELED` right away,
+  /// its link joining `done`. Returns how many ops that completed.
+  fn cancel_op(
+    store: &mut OpStore,
+    io: &mut dyn IoBackend,
+    timers: &mut TimerWheel,
+    links: &mut [Option<Linked>],
+    done: &mut Vec<(Linked, isize)>,
+    id: u64,
+  ) -> io::Result<usize> {
+    if !timers.remove(id) {
+      io.cancel(id)?;
+      return Ok(0);
+    }
+    let res = -(libc::ECANCELED as isize);
+    Self::settle(store, id, res);
+    if let Some(link) = links.get_mut(OpStore::slot_of(id))
+      && link.as_ref().is_some_and(|link| link.id() == id)
+    {
+      done.push((link.take().unwrap(), res));
+    }
+    Ok(1)
+  }
+
+  /// Completes the ops of a chain that won't run with `ECANCELED`.
+  fn cancel_linked(store: &mut OpStore, rest: VecDeque<(u64, Op)>) -> usize {
+    let cancelled = rest.len();
+    for (id, _) in rest {
+      Self::settle(store, id, -(libc::ECANCELED as isize));
+    }
+    cancelled
+  }
+
+  /// Completes op `id` with `res` without it going through the backend.
+  fn settle(store: &mut OpStore, id: u64, res: isize) {
+    let found = store.update_or_remove(id, |op| {
+      op.set_done(res);
+      op.result_consumed()
+    });
+    assert!(found, "lio bookkeeping bug: linked op doesn't exist in store.");
+  }
+
+  /// Cancels op `id`, which then completes with `ECANCELED` unless it
+  /// completes some other way first. Does nothing for ops that completed.
+  ///
+  /// Timeouts come off the timer wheel and complete on the next run. Other
+  /// ops are cancelled by the backend: io_uring submits
+  /// `IORING_OP_ASYNC_CANCEL`, the poller stops waiting for readiness and IOCP
+  /// calls `CancelIoEx`. Ops that already started on the poller's blocking
+  /// pool, or that the kernel can't interrupt, run to completion.
+  ///
+  /// For a chain, cancelling its first op cancels the ops after it.
+  ///
+  /// # Example
+  ///
+  /// ```no_run
+  /// use lio::{Lio, api};
+  ///
+  /// let lio = Lio::new(64).unwrap();
+  /// let sock = api::resource::Resource::stdin();
+  /// let receiver = api::recv(&sock, vec![0; 1024], None).with_lio(&lio).send();
+  /// // The peer went away.
+  /// lio.cancel(receiver.id()).unwrap();
+  /// lio.run().unwrap();
+  /// let (received, _buf) = receiver.recv();
+  /// assert_eq!(received.unwrap_err().raw_os_error(), Some(libc::ECANCELED));
+  /// ```
+  pub fn cancel(&self, id: OpId) -> io::Result<()> {
+    let mut inner = self.inner.borrow_mut();
+    let LioInner { store, io, timers, cancelled, .. } = &mut *inner;
+    let OpId(id) = id;
+    if matches!(store.get(id), None | Some(Registration::Done(_))) {
+      return Ok(());
+    }
+    if timers.remove(id) {
+      cancelled.push(id);
+      return Ok(());
+    }
+    io.cancel(id)
+  }
+
+  /// [`cancel`](Self::cancel) for destructors, which can run during dispatch
+  /// where the op can't be cancelled. It completes eventually then.
+  pub(crate) fn try_cancel(&self, id: u64) {
+    if self.inner.try_borrow_mut().is_ok() {
+      let _ = self.cancel(OpId(id));
+    }
+  }
+
+  /// Gives up on op `id` of a future dropped while it's in flight.
+  ///
+  /// Cancels it, with `op` dropped once the backend let go of it instead of
+  /// waking anyone. If it completed already, drops both right away.
+  pub(crate) fn abandon<T: TypedOp>(&self, id: u64, op: Box<T>) {
+    // Dropped by a callback that runs during dispatch, which can't touch
+    // the store. Better to leak the op than to free memory still in use.
+    let Ok(mut inner) = self.inner.try_borrow_mut() else {
+      std::mem::forget(op);
+      return;
+    };
+    match inner.store.get_mut(id) {
+      Some(reg @ Registration::Pending(_)) => reg.detach(op),
+      Some(_) => {
+        assert!(inner.store.remove(id));
+        return;
+      }
+      None => return,
+    }
+    drop(inner);
+    // Nothing else to do if the backend fails to, it completes eventually.
+    let _ = self.cancel(OpId(id));
+  }
+
+  /// Returns a handle for submitting to this Lio from other threads, see
+  /// [`LioRemote`].
+  ///
+  /// # Errors
+  ///
+  /// Fails if the backend can't set up its waker, e.g with too many open
+  /// files.
+  pub fn remote(&self) -> io::Result<LioRemote> {
+    let mut inner = self.inner.borrow_mut();
+    if inner.remote.is_none() {
+      let waker = inner.io.waker()?;
+      inner.remote = Some(Rc::new(Inbox::new(waker)));
+    }
+    Ok(inner.remote.as_ref().unwrap().remote())
+  }
+
+  /// Returns a snapshot of this Lio's counters, see [`Stats`].
+  ///
+  /// Ops of a chain that complete without reaching the backend, because an
+  /// op before them failed, count as submitted but not completed.
+  ///
+  /// # Example
+  ///
+  /// ```no_run
+  /// use lio::{Lio, api, metrics::OpKind};
+  ///
+  /// let lio = Lio::new(64).unwrap();
+  /// let nop = api::nop().with_lio(&lio).send();
+  /// while nop.try_recv().is_none() {
+  ///   lio.run().unwrap();
+  /// }
+  ///
+  /// let stats = lio.stats();
+  /// assert_eq!(stats.op(OpKind::Nop).completed, 1);
+  /// assert_eq!(stats.in_flight, 0);
+  /// ```
+  #[cfg(feature = "metrics")]
+  #[cfg_attr(docsrs, doc(cfg(feature = "metrics")))]
+  pub fn stats(&self) -> Stats {
+    let inner = self.inner.borrow();
+    inner.metrics.snapshot(inner.store.occupied(), inner.io.rearms())
+  }
+
   /// Non-blocking poll for completed operations.
   ///
   /// Returns immediately, processing any completions that are ready.
   pub fn try_run(&self) -> io::Result<usize> {
-    self.run_inner(Some(Duration::ZERO))
+    self.run_inner(Some(Duration::ZERO), 1)
   }
 
   /// Block until at least one operation completes.
+  ///
+  /// With [`set_busy_poll`](Self::set_busy_poll), polls for a while before
+  /// it blocks.
   pub fn run(&self) -> io::Result<usize> {
-    self.run_inner(None)
+    self.run_spinning(None)
   }
 
   /// Run the event loop with a timeout.
@@ -155,44 +741,229 @@ impl Lio {
   /// Waits for at least one operation to complete or until the timeout expires,
   /// whichever comes first. Returns `Ok(true)` if completions were processed,
   /// `Ok(false)` if the timeout expired with no completions.
+  ///
+  /// Spins like [`run`](Self::run), for no longer than `timeout`.
   pub fn run_timeout(&self, timeout: Duration) -> io::Result<usize> {
-    self.run_inner(Some(timeout))
+    self.run_spinning(Some(timeout))
+  }
+
+  /// Has [`run`](Self::run) and [`run_timeout`](Self::run_timeout) poll for
+  /// completions before blocking, see [`BusyPoll`]. An adaptive mode starts
+  /// learning afresh.
+  ///
+  /// # Example
+  ///
+  /// ```no_run
+  /// use std::time::Duration;
+  /// use lio::{BusyPoll, Lio, api};
+  ///
+  /// let lio = Lio::new(64).unwrap();
+  /// lio.set_busy_poll(BusyPoll::Fixed(Duration::from_micros(20)));
+  /// let nop = api::nop().with_lio(&lio).send();
+  /// while nop.try_recv().is_none() {
+  ///   lio.run().unwrap();
+  /// }
+  /// ```
+  pub fn set_busy_poll(&self, mode: BusyPoll) {
+    self.inner.borrow_mut().spinner.set_mode(mode);
+  }
+
+  /// Run the event loop until at least `min` operations completed, or until
+  /// `timeout` passes if one is given.
+  ///
+  /// Returns how many completed, which is fewer than `min` only if the
+  /// timeout expired. A `min` of 0 doesn't wait at all. The io_uring backend
+  /// waits for all of them in one `io_uring_enter`, without waking up for
+  /// each completion. Once a [`remote`](Self::remote) exists it waits for one
+  /// at a time instead, so jobs submitted meanwhile get to run.
+  ///
+  /// # Example
+  ///
+  /// ```no_run
+  /// use std::time::Duration;
+  /// use lio::{Lio, api};
+  ///
+  /// let lio = Lio::new(64).unwrap();
+  /// for _ in 0..8 {
+  ///   api::nop().with_lio(&lio).when_done(|_| {});
+  /// }
+  /// let timeout = Duration::from_millis(10);
+  /// let done = lio.run_min_complete(8, Some(timeout)).unwrap();
+  /// assert_eq!(done, 8);
+  /// ```
+  pub fn run_min_complete(
+    &self,
+    min: usize,
+    timeout: Option<Duration>,
+  ) -> io::Result<usize> {
+    if min == 0 {
+      return self.try_run();
+    }
+    let until = timeout.map(deadline);
+    // A remote's wake is a single completion, which wouldn't end a kernel
+    // wait for more, and its jobs may be what the rest are waiting on.
+    let batch = self.inner.borrow().remote.is_none();
+    let mut count = 0;
+    loop {
+      let left =
+        until.map(|until| until.saturating_duration_since(Instant::now()));
+      let wait = if batch { min - count } else { 1 };
+      count += self.run_inner(left, wait)?;
+      if count >= min || left.is_some_and(|left| left.is_zero()) {
+        return Ok(count);
+      }
+    }
   }
 
-  fn run_inner(&self, timeout: Option<Duration>) -> io::Result<usize> {
+  /// Polls for the spinner's window, then waits up to `timeout` if nothing
+  /// completed.
+  fn run_spinning(&self, timeout: Option<Duration>) -> io::Result<usize> {
+    let (off, window) = {
+      let spinner = &self.inner.borrow().spinner;
+      (spinner.is_off(), spinner.window())
+    };
+    if off {
+      return self.run_inner(timeout, 1);
+    }
+    let start = Instant::now();
+    let window = timeout.map_or(window, |timeout| timeout.min(window));
+
+    let mut count = 0;
+    if !window.is_zero() {
+      loop {
+        count = self.run_inner(Some(Duration::ZERO), 1)?;
+        if count > 0 || start.elapsed() >= window {
+          break;
+        }
+        std::hint::spin_loop();
+      }
+    }
+    if count == 0 {
+      let left = timeout.map(|timeout| timeout.saturating_sub(start.elapsed()));
+      count = self.run_inner(left, 1)?;
+    }
+    self.inner.borrow_mut().spinner.record(start);
+    Ok(count)
+  }
+
+  /// Runs what [`LioRemote`]s submitted, before their ops get flushed.
+  fn run_remote(&self) {
+    let Some(inbox) = self.inner.borrow().remote.clone() else { return };
+    for job in inbox.take() {
+      job(self);
+    }
+  }
+
+  /// One run of the event loop, telling the backend to wait for `min`
+  /// completions.
+  fn run_inner(
+    &self,
+    timeout: Option<Duration>,
+    min: usize,
+  ) -> io::Result<usize> {
+    self.run_remote();
     let mut inner = self.inner.borrow_mut();
-    inner.io.flush()?;
-
-    // Copy completion data to release borrow on inner.io
-    let completed: Vec<_> = inner
-      .io
-      .wait_timeout(timeout)?
-      .iter()
-      .map(|c| (c.op_id, c.result))
-      .collect();
-
-    // Collect IDs to remove (callbacks consume the result, wakers don't)
-    let mut to_remove = Vec::new();
-
-    for (op_id, result) in &completed {
-      let Some(op) = inner.store.get_mut(*op_id) else {
-        panic!("lio bookkeeping bug: completed op doesn't exist in store.");
-      };
-      op.set_done(*result);
+    // Split the borrow so completions are dispatched straight out of the
+    // backend's buffer, without copying the batch anywhere first.
+    let LioInner {
+      store,
+      io,
+      links,
+      links_done,
+      timers,
+      expired,
+      cancelled,
+      #[cfg(feature = "metrics")]
+      metrics,
+      ..
+    } = &mut *inner;
+    #[allow(unused_variables)]
+    let flushed = io.flush()?;
+    #[cfg(feature = "metrics")]
+    metrics.flushed(flushed);
 
-      // If the result was consumed (callback path), mark for removal.
-      // Waker path leaves result in place for check_done to consume.
-      if op.result_consumed() {
-        to_remove.push(*op_id);
+    // Waits no longer than until the nearest timer goes off.
+    let timeout = match timers.next_deadline() {
+      Some(deadline) => {
+        let until = deadline.saturating_duration_since(Instant::now());
+        Some(timeout.map_or(until, |timeout| timeout.min(until)))
+      }
+      None => timeout,
+    };
+    // Cancelled timers complete right away.
+    let timeout =
+      if cancelled.is_empty() { timeout } else { Some(Duration::ZERO) };
+
+    let completed = io.wait_timeout_min(min, timeout)?;
+    let mut count = completed.len();
+
+    for c in completed {
+      #[cfg(feature = "metrics")]
+      if !c.more {
+        metrics.completed(c.op_id, c.result);
       }
+      Self::dispatch(store, links, links_done, c);
+    }
+    if !timers.is_empty() {
+      timers.expire(Instant::now(), expired);
+      count += expired.len();
+      for id in expired.drain(..) {
+        #[cfg(feature = "metrics")]
+        metrics.completed(id, 0);
+        Self::dispatch(store, links, links_done, &OpCompleted::new(id, 0));
+      }
+    }
+    count += cancelled.len();
+    for id in cancelled.drain(..) {
+      let c = OpCompleted::new(id, -(libc::ECANCELED as isize));
+      #[cfg(feature = "metrics")]
+      metrics.completed(id, c.result);
+      Self::dispatch(store, links, links_done, &c);
     }
 
-    // Remove consumed entries
-    for id in to_remove {
-      inner.store.remove(id);
+    if !links_done.is_empty() {
+      count +=
+        Self::advance_links(store, io.as_mut(), timers, links, links_done)?;
     }
+    #[cfg(feature = "metrics")]
+    metrics.tick(count);
+    Ok(count)
+  }
+
+  /// Hands completion `c` to its registration.
+  fn dispatch(
+    store: &mut OpStore,
+    links: &mut [Option<Linked>],
+    links_done: &mut Vec<(Linked, isize)>,
+    c: &OpCompleted,
+  ) {
+    let found = store.update_or_remove(c.op_id, |op| {
+      // Multishot ops stay registered until their final completion.
+      if let Registration::Stream(stream) = op {
+        stream.sink.push(c.result, c.buf_id, c.more);
+        return !c.more;
+      }
+      // Zero-copy sends hold on to their buffer until the final one.
+      if c.more {
+        op.set_more(c.result);
+        return false;
+      }
+
+      op.set_done(c.result);
 
-    Ok(completed.len())
+      // If the result was consumed (callback path), remove it now.
+      // Waker path leaves result in place for check_done to consume.
+      op.result_consumed()
+    });
+    if !found {
+      panic!("lio bookkeeping bug: completed op doesn't exist in store.");
+    }
+    if !c.more
+      && let Some(link) = links.get_mut(OpStore::slot_of(c.op_id))
+      && link.as_ref().is_some_and(|link| link.id() == c.op_id)
+    {
+      links_done.push((link.take().unwrap(), c.result));
+    }
   }
 
   pub(crate) fn check_done(&self, key: u64) -> Result<isize, Error> {
@@ -214,3 +985,177 @@ impl Lio {
     }
   }
 }
+
+/// Configures io_uring setup flags before creating a [`Lio`].
+///
+/// The defaults match [`Lio::new`]. The options only apply to the io_uring
+/// backend; on other platforms [`build`](Self::build) ignores them and creates
+/// the default backend. Flags the running kernel doesn't know make `build`
+/// fail with `EINVAL`.
+///
+/// # Example
+///
+/// ```no_run
+/// use std::time::Duration;
+/// use lio::Lio;
+///
+/// let lio = Lio::builder(1024)
+///   .sqpoll(Duration::from_millis(100))
+///   .sqpoll_cpu(2)
+///   .cq_entries(8192)
+///   .build()
+///   .unwrap();
+/// ```
+#[derive(Debug, Clone)]
+#[cfg_attr(not(linux), allow(dead_code))]
+pub struct LioBuilder {
+  cap: usize,
+  sqpoll_idle: Option<Duration>,
+  sqpoll_cpu: Option<u32>,
+  iopoll: bool,
+  cq_entries: Option<u32>,
+  coop_taskrun: bool,
+  defer_taskrun: bool,
+  single_issuer: bool,
+  buf_store: Option<&'static BufStore>,
+  busy_poll: BusyPoll,
+}
+
+impl LioBuilder {
+  /// Starts a builder for a driver of capacity `cap`, see [`Lio::new`].
+  pub fn new(cap: usize) -> Self {
+    Self {
+      cap,
+      sqpoll_idle: None,
+      sqpoll_cpu: None,
+      iopoll: false,
+      cq_entries: None,
+      coop_taskrun: false,
+      defer_taskrun: false,
+      single_issuer: false,
+      buf_store: None,
+      busy_poll: BusyPoll::Off,
+    }
+  }
+
+  /// Polls the submission queue from a kernel thread, so submitting doesn't
+  /// need a syscall while the thread is awake. It sleeps after `idle` without
+  /// work.
+  ///
+  /// Needs `CAP_SYS_NICE` before Linux 5.11.
+  pub fn sqpoll(mut self, idle: Duration) -> Self {
+    self.sqpoll_idle = Some(idle);
+    self
+  }
+
+  /// Pins the [`sqpoll`](Self::sqpoll) thread to `cpu`. Has no effect
+  /// without it.
+  pub fn sqpoll_cpu(mut self, cpu: u32) -> Self {
+    self.sqpoll_cpu = Some(cpu);
+    self
+  }
+
+  /// Busy-polls for completions instead of waiting for interrupts.
+  ///
+  /// Only works for `O_DIRECT` files on devices that support polling; other
+  /// ops fail with `EOPNOTSUPP`.
+  pub fn iopoll(mut self) -> Self {
+    self.iopoll = true;
+    self
+  }
+
+  /// Sizes the completion queue to `entries` instead of twice the capacity,
+  /// which leaves room for bursts of multishot completions.
+  pub fn cq_entries(mut self, entries: u32) -> Self {
+    self.cq_entries = Some(entries);
+    self
+  }
+
+  /// Runs completion work when the thread next enters the kernel instead of
+  /// interrupting it (Linux 5.19).
+  pub fn coop_taskrun(mut self) -> Self {
+    self.coop_taskrun = true;
+    self
+  }
+
+  /// Defers completion work until the driver waits for completions, which
+  /// batches it (Linux 6.1). Implies [`single_issuer`](Self::single_issuer).
+  pub fn defer_taskrun(mut self) -> Self {
+    self.defer_taskrun = true;
+    self
+  }
+
+  /// Promises the kernel that only the creating thread submits, which `Lio`
+  /// already guarantees by not being `Send` (Linux 6.0).
+  pub fn single_issuer(mut self) -> Self {
+    self.single_issuer = true;
+    self
+  }
+
+  /// Registers every buffer of `store` with the driver, see
+  /// [`Lio::new_with_buf_store`].
+  pub fn buf_store(mut self, store: &'static BufStore) -> Self {
+    self.buf_store = Some(store);
+    self
+  }
+
+  /// Spins for completions before [`Lio::run`] blocks, see
+  /// [`Lio::set_busy_poll`]. Unlike the other options, this applies to every
+  /// backend.
+  pub fn busy_poll(mut self, mode: BusyPoll) -> Self {
+    self.busy_poll = mode;
+    self
+  }
+
+  /// Creates the driver.
+  ///
+  /// # Errors
+  ///
+  /// Fails if the kernel rejects the setup flags or the
+  /// [`buf_store`](Self::buf_store) registration.
+  pub fn build(self) -> io::Result<Lio> {
+    let store = self.buf_store;
+    let busy_poll = self.busy_poll;
+    let lio = self.build_backend()?;
+    lio.set_busy_poll(busy_poll);
+    if let Some(store) = store {
+      lio.inner.borrow_mut().io.register_buf_store(store)?;
+    }
+    Ok(lio)
+  }
+
+  fn build_backend(self) -> io::Result<Lio> {
+    #[cfg(linux)]
+    {
+      use crate::backends::io_uring::IoUring;
+
+      let mut params = lio_uring::Params::default();
+      if let Some(idle) = self.sqpoll_idle {
+        params = params.sqpoll(idle.as_millis().min(u32::MAX as u128) as u32);
+        if let Some(cpu) = self.sqpoll_cpu {
+          params = params.sq_thread_cpu(cpu);
+        }
+      }
+      if self.iopoll {
+        params = params.iopoll();
+      }
+      if let Some(entries) = self.cq_entries {
+        params = params.cq_entries(entries);
+      }
+      if self.coop_taskrun {
+        params = params.coop_taskrun();
+      }
+      if self.defer_taskrun {
+        params = params.defer_taskrun();
+      }
+      if self.single_issuer {
+        params = params.single_issuer();
+      }
+      Lio::new_with_backend(IoUring::with_params(params), self.cap)
+    }
+    #[cfg(not(linux))]
+    {
+      Lio::new(self.cap)
+    }
+  }
+}
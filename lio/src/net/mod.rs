@@ -2,13 +2,14 @@
 //!
 //! This module provides high-level abstractions for network I/O operations using lio's
 //! async runtime. It includes both low-level socket primitives and higher-level TCP
-//! abstractions.
+//! and UDP abstractions.
 //!
 //! # Main Types
 //!
 //! - [`Socket`]: Low-level async socket wrapper that provides direct access to socket operations
 //! - [`TcpListener`]: High-level TCP server for accepting incoming connections
 //! - [`TcpSocket`]: High-level TCP client/server connection for sending and receiving data
+//! - [`UdpSocket`]: UDP socket sending and receiving datagrams, one at a time or in batches
 //!
 //! # Features
 //!
@@ -131,7 +132,13 @@
 
 mod socket;
 mod tcp;
+#[cfg(unix)]
+mod udp;
 
+#[cfg(unix)]
+pub use crate::api::ops::Datagram;
 pub use socket::*;
 pub use tcp::*;
+#[cfg(unix)]
+pub use udp::*;
 pub mod ops;
@@ -11,14 +11,20 @@
 //!
 //! - [`SocketAccept`]: Accept operation that returns a [`Socket`]
 //! - [`SocketNew`]: Socket creation operation that returns a [`Socket`]
+//! - [`TcpAccept`]: Accept operation that returns a [`TcpSocket`]
+//! - [`TcpIncoming`]: Multishot accept yielding [`TcpSocket`]s
+//! - [`UdpSendTo`]: Datagram send to an address
+//! - [`UdpRecvFrom`]: Datagram receive with the sender's address
 
 use std::{io, net::SocketAddr, os::fd::FromRawFd};
 
+#[cfg(unix)]
+use crate::{BufResult, buf::BufLike};
 #[allow(unused_imports)] // TcpListener used in doc links
 use crate::{
   api::{ops, resource::FromResource},
   net::{Socket, TcpListener, TcpSocket},
-  typed_op::TypedOp,
+  typed_op::{MultishotOp, TypedOp},
 };
 
 /// Accept operation specialized for [`Socket`].
@@ -113,3 +119,133 @@ impl TypedOp for TcpAccept {
     Ok((TcpSocket::from_resource(resource), addr))
   }
 }
+
+/// Multishot accept specialized for [`TcpSocket`].
+///
+/// Returned by [`TcpListener::incoming()`](crate::net::TcpListener::incoming).
+pub struct TcpIncoming {
+  inner: ops::AcceptMulti,
+}
+
+impl TcpIncoming {
+  pub(crate) fn new(res: crate::api::resource::Resource) -> Self {
+    Self { inner: ops::AcceptMulti::new(res) }
+  }
+}
+
+impl MultishotOp for TcpIncoming {
+  type Item = io::Result<TcpSocket>;
+
+  fn into_op(&mut self) -> crate::op::Op {
+    self.inner.into_op()
+  }
+
+  fn extract_item(
+    &self,
+    res: isize,
+    buf_id: Option<u16>,
+  ) -> Option<Self::Item> {
+    let item = self.inner.extract_item(res, buf_id)?;
+    Some(item.map(TcpSocket::from_resource))
+  }
+
+  fn resumable(&self, res: isize) -> bool {
+    self.inner.resumable(res)
+  }
+}
+
+/// Datagram send specialized for [`UdpSocket`](crate::net::UdpSocket), a [`SendMsg`](ops::SendMsg)
+/// of one buffer to an address.
+///
+/// You typically won't create this directly; it's returned by
+/// [`UdpSocket::send_to()`](crate::net::UdpSocket::send_to).
+#[cfg(unix)]
+pub struct UdpSendTo<B>
+where
+  B: Send + Sync,
+{
+  inner: ops::SendMsg<B>,
+}
+
+#[cfg(unix)]
+impl<B> UdpSendTo<B>
+where
+  B: BufLike + Send + Sync,
+{
+  pub(crate) fn new(
+    res: crate::api::resource::Resource,
+    buf: B,
+    to: SocketAddr,
+  ) -> Self {
+    Self { inner: ops::SendMsg::new(res, vec![buf], Some(to), None) }
+  }
+
+  #[cfg(linux)]
+  pub(crate) fn segment_size(self, size: u16) -> Self {
+    Self { inner: self.inner.segment_size(size) }
+  }
+}
+
+#[cfg(unix)]
+impl<B> TypedOp for UdpSendTo<B>
+where
+  B: BufLike + Send + Sync + 'static,
+{
+  type Result = BufResult<i32, B>;
+
+  fn into_op(&mut self) -> crate::op::Op {
+    self.inner.into_op()
+  }
+
+  fn extract_result(self, res: isize) -> Self::Result {
+    let (result, mut bufs) = self.inner.extract_result(res);
+    (result, bufs.pop().expect("sent one buffer"))
+  }
+}
+
+/// Datagram receive specialized for [`UdpSocket`](crate::net::UdpSocket), a
+/// [`RecvMsg`](ops::RecvMsg) into one buffer.
+///
+/// You typically won't create this directly; it's returned by
+/// [`UdpSocket::recv_from()`](crate::net::UdpSocket::recv_from).
+#[cfg(unix)]
+pub struct UdpRecvFrom<B>
+where
+  B: Send + Sync,
+{
+  inner: ops::RecvMsg<B>,
+}
+
+#[cfg(unix)]
+impl<B> UdpRecvFrom<B>
+where
+  B: BufLike + Send + Sync,
+{
+  pub(crate) fn new(res: crate::api::resource::Resource, buf: B) -> Self {
+    Self { inner: ops::RecvMsg::new(res, vec![buf], None) }
+  }
+}
+
+#[cfg(unix)]
+impl<B> TypedOp for UdpRecvFrom<B>
+where
+  B: BufLike + Send + Sync + 'static,
+{
+  type Result = BufResult<(i32, SocketAddr), B>;
+
+  fn into_op(&mut self) -> crate::op::Op {
+    self.inner.into_op()
+  }
+
+  fn extract_result(self, res: isize) -> Self::Result {
+    let (result, mut bufs) = self.inner.extract_result(res);
+    let buf = bufs.pop().expect("received into one buffer");
+    let result = result.and_then(|(len, peer)| {
+      let peer = peer.ok_or_else(|| {
+        io::Error::new(io::ErrorKind::InvalidData, "sender has no IP address")
+      })?;
+      Ok((len, peer))
+    });
+    (result, buf)
+  }
+}
@@ -332,6 +332,57 @@ impl Socket {
     api::shutdown(&self.0, how)
   }
 
+  /// Has the kernel busy-poll the device queue for up to `budget` when a
+  /// receive finds nothing, instead of waiting for an interrupt
+  /// (`SO_BUSY_POLL`). With `prefer`, the device's interrupts stay masked
+  /// while the socket keeps polling it (`SO_PREFER_BUSY_POLL`, Linux 5.11).
+  /// Without it that option is turned back off if it was on.
+  ///
+  /// Goes well with [`BusyPoll`](crate::BusyPoll), spinning in lio between
+  /// the kernel's polls. A `budget` above the `net.core.busy_read` sysctl
+  /// needs `CAP_NET_ADMIN`, and a zero one turns it off.
+  #[cfg(linux)]
+  pub fn set_busy_poll(
+    &self,
+    budget: std::time::Duration,
+    prefer: bool,
+  ) -> std::io::Result<()> {
+    use std::os::fd::AsRawFd;
+
+    let fd = self.0.as_raw_fd();
+    let usecs = budget.as_micros().min(libc::c_int::MAX as u128) as libc::c_int;
+    let len = std::mem::size_of::<libc::c_int>() as libc::socklen_t;
+    syscall!(setsockopt(
+      fd,
+      libc::SOL_SOCKET,
+      libc::SO_BUSY_POLL,
+      (&raw const usecs).cast(),
+      len,
+    ))?;
+    let mut current: libc::c_int = 0;
+    let mut current_len = len;
+    // Kernels without the option never prefer busy polling.
+    let preferred = syscall!(getsockopt(
+      fd,
+      libc::SOL_SOCKET,
+      libc::SO_PREFER_BUSY_POLL,
+      (&raw mut current).cast(),
+      &mut current_len,
+    ))
+    .is_ok_and(|_| current != 0);
+    if prefer != preferred {
+      let value = prefer as libc::c_int;
+      syscall!(setsockopt(
+        fd,
+        libc::SOL_SOCKET,
+        libc::SO_PREFER_BUSY_POLL,
+        (&raw const value).cast(),
+        len,
+      ))?;
+    }
+    Ok(())
+  }
+
   /// Returns the local address this socket is bound to.
   pub fn local_addr(&self) -> std::io::Result<SocketAddr> {
     use std::os::fd::AsRawFd;
@@ -10,7 +10,8 @@ use crate::{
     ops::{self, Recv, Shutdown},
     resource::{AsResource, FromResource, IntoResource, Resource},
   },
-  net::ops::TcpAccept,
+  buf::{BufRing, LentBuf},
+  net::ops::{TcpAccept, TcpIncoming},
 };
 
 use super::socket::Socket;
@@ -168,6 +169,36 @@ impl TcpListener {
     Io::from_op(socket_accept_op)
   }
 
+  /// Accepts connections as they come in, one [`TcpSocket`] per item.
+  ///
+  /// Unlike calling [`accept`](Self::accept) in a loop, this submits a single
+  /// multishot accept on io_uring that stays armed across connections, see
+  /// [`api::accept_multi`]. The remote peer's address isn't reported.
+  ///
+  /// The stream yields until an error. Dropping it cancels the accept.
+  /// Connections accepted before the cancel lands are closed, later ones wait
+  /// in the listener's backlog.
+  ///
+  /// # Examples
+  ///
+  /// ```rust,no_run
+  /// use lio::{Lio, net::TcpListener};
+  ///
+  /// async fn example(lio: &Lio) -> std::io::Result<()> {
+  ///     let listener = TcpListener::bind_async("127.0.0.1:8080").await?;
+  ///
+  ///     let mut incoming = listener.incoming().with_lio(lio).stream();
+  ///     while let Some(socket) = incoming.next().await {
+  ///         let socket = socket?;
+  ///         // Handle the socket...
+  ///     }
+  ///     Ok(())
+  /// }
+  /// ```
+  pub fn incoming(&self) -> Io<TcpIncoming> {
+    Io::from_op(TcpIncoming::new(self.0.as_resource().clone()))
+  }
+
   /// Returns the local address this listener is bound to.
   pub fn local_addr(&self) -> io::Result<SocketAddr> {
     self.0.local_addr()
@@ -374,6 +405,52 @@ impl TcpSocket {
     self.0.send(vec)
   }
 
+  /// Receives data as it arrives, into buffers of a shared [`BufRing`].
+  ///
+  /// Unlike [`recv`](Self::recv), no buffer is pinned to this socket while it
+  /// is idle: each chunk takes a ring buffer only when data shows up, and gives
+  /// it back when dropped. See [`api::recv_multi`].
+  ///
+  /// # Examples
+  ///
+  /// ```rust,no_run
+  /// use lio::{Lio, net::TcpSocket};
+  ///
+  /// async fn example(lio: &Lio, socket: TcpSocket) -> std::io::Result<()> {
+  ///     // Shared by every connection of this Lio.
+  ///     let ring = lio.register_buf_ring(1024, 16 * 1024)?;
+  ///
+  ///     let mut chunks = socket.recv_multi(&ring).with_lio(lio).stream();
+  ///     while let Some(chunk) = chunks.next().await {
+  ///         let chunk = chunk?;
+  ///         println!("Data: {:?}", &chunk[..]);
+  ///     }
+  ///     // Peer closed the connection.
+  ///     Ok(())
+  /// }
+  /// ```
+  pub fn recv_multi(&self, ring: &BufRing) -> Io<ops::RecvMulti> {
+    api::recv_multi(self, ring, None)
+  }
+
+  /// Receives data into a pooled buffer.
+  ///
+  /// Uses io_uring's `READ_FIXED` when the buffer's store was registered via
+  /// [`Lio::new_with_buf_store`](crate::Lio::new_with_buf_store), see
+  /// [`api::read_fixed`].
+  pub fn recv_fixed(&self, buf: LentBuf<'static>) -> Io<ops::ReadFixed> {
+    api::read_fixed(self, buf)
+  }
+
+  /// Sends the valid bytes of a pooled buffer.
+  ///
+  /// Uses io_uring's `WRITE_FIXED` when the buffer's store was registered via
+  /// [`Lio::new_with_buf_store`](crate::Lio::new_with_buf_store), see
+  /// [`api::write_fixed`].
+  pub fn send_fixed(&self, buf: LentBuf<'static>) -> Io<ops::WriteFixed> {
+    api::write_fixed(self, buf)
+  }
+
   /// Shuts down the read, write, or both halves of this connection.
   ///
   /// This operation disables further send and/or receive operations on the socket.
@@ -416,4 +493,15 @@ impl TcpSocket {
   pub fn shutdown(&self, how: i32) -> Io<Shutdown> {
     self.0.shutdown(how)
   }
+
+  /// Busy-polls the device queue on receives, see
+  /// [`Socket::set_busy_poll`].
+  #[cfg(linux)]
+  pub fn set_busy_poll(
+    &self,
+    budget: std::time::Duration,
+    prefer: bool,
+  ) -> io::Result<()> {
+    self.0.set_busy_poll(budget, prefer)
+  }
 }
@@ -0,0 +1,398 @@
+use std::{
+  future::{Future, IntoFuture, poll_fn},
+  io,
+  net::{SocketAddr, ToSocketAddrs},
+  pin::Pin,
+  task::Poll,
+};
+
+use crate::{
+  BufResult, Lio,
+  api::{
+    self,
+    io::Io,
+    ops::{self, Connect},
+    resource::{AsResource, FromResource, IntoResource, Resource},
+  },
+  buf::{BufLike, BufRing},
+  net::ops::{UdpRecvFrom, UdpSendTo},
+};
+
+use super::socket::Socket;
+
+/// A UDP socket.
+///
+/// Created by binding to a local address, after which it sends datagrams to
+/// and receives them from any peer. [`connect`](Self::connect) fixes the
+/// peer, for [`send`](Self::send) and [`recv`](Self::recv).
+///
+/// For many datagrams per second, there's a batched form of each direction:
+///
+/// - [`send_batch`](Self::send_batch) submits many sends at once. On
+///   io_uring they go in with one `io_uring_enter`. The polling backend
+///   needs [edge-triggered] mode to queue several ops on an fd, and sends
+///   them with one `sendmmsg(2)` per readiness event on Linux.
+/// - [`recv_from_multi`](Self::recv_from_multi) is a multishot receive into a
+///   [`BufRing`], one `RECVMSG` on io_uring that stays armed, and on the
+///   polling backend a `recvmmsg(2)` filling many buffers at once.
+///
+/// On Linux, UDP segmentation offload cuts the per-datagram cost further:
+/// [`send_segments_to`](Self::send_segments_to) hands the kernel many
+/// datagrams in one buffer, and [`set_gro`](Self::set_gro) has it coalesce
+/// received ones.
+///
+/// # Examples
+///
+/// ```rust,no_run
+/// use lio::net::UdpSocket;
+///
+/// async fn echo() -> std::io::Result<()> {
+///     let socket = UdpSocket::bind_async("127.0.0.1:4433").await?;
+///     loop {
+///         let (result, buf) = socket.recv_from(Vec::with_capacity(1500)).await;
+///         let (_, peer) = result?;
+///         let (result, _) = socket.send_to(buf, peer).await;
+///         result?;
+///     }
+/// }
+/// ```
+///
+/// [edge-triggered]: crate::backends::pollingv2::Poller::edge_triggered
+pub struct UdpSocket(Socket);
+
+impl IntoResource for UdpSocket {
+  fn into_resource(self) -> Resource {
+    self.0.into_resource()
+  }
+}
+
+impl AsResource for UdpSocket {
+  fn as_resource(&self) -> &Resource {
+    self.0.as_resource()
+  }
+}
+
+impl FromResource for UdpSocket {
+  fn from_resource(resource: Resource) -> Self {
+    Self(Socket::from_resource(resource))
+  }
+}
+
+/// The first of `addr`'s addresses, and the domain of a socket for it.
+fn resolve(addr: impl ToSocketAddrs) -> io::Result<(SocketAddr, i32)> {
+  let addr = addr.to_socket_addrs()?.next().ok_or_else(|| {
+    io::Error::new(io::ErrorKind::InvalidInput, "no address to bind to")
+  })?;
+  let domain = match addr {
+    SocketAddr::V4(_) => libc::AF_INET,
+    SocketAddr::V6(_) => libc::AF_INET6,
+  };
+  Ok((addr, domain))
+}
+
+impl UdpSocket {
+  /// Creates a UDP socket bound to `addr`, asynchronously.
+  ///
+  /// Binding to port 0 has the OS pick one, see
+  /// [`local_addr`](Self::local_addr). Of the addresses `addr` resolves to,
+  /// the first one is used.
+  ///
+  /// # Examples
+  ///
+  /// ```rust,no_run
+  /// use lio::net::UdpSocket;
+  ///
+  /// async fn example() -> std::io::Result<()> {
+  ///     let socket = UdpSocket::bind_async("[::1]:0").await?;
+  ///     println!("Bound to {}", socket.local_addr()?);
+  ///     Ok(())
+  /// }
+  /// ```
+  pub async fn bind_async(addr: impl ToSocketAddrs) -> io::Result<Self> {
+    let (addr, domain) = resolve(addr)?;
+    let socket = Socket::new(domain, libc::SOCK_DGRAM, 0).await?;
+    socket.bind(addr).await?;
+    Ok(Self(socket))
+  }
+
+  /// Creates a UDP socket bound to `addr`, blocking until it is.
+  ///
+  /// This is the blocking version of [`bind_async`](Self::bind_async).
+  #[allow(deprecated)]
+  pub fn bind_sync(addr: impl ToSocketAddrs) -> io::Result<Self> {
+    let (addr, domain) = resolve(addr)?;
+    let socket = Socket::new(domain, libc::SOCK_DGRAM, 0).wait()?;
+    socket.bind(addr).wait()?;
+    Ok(Self(socket))
+  }
+
+  /// Sets the peer [`send`](Self::send) sends to, and the only one
+  /// [`recv`](Self::recv) and the other receives take datagrams from.
+  pub fn connect(&self, addr: SocketAddr) -> Io<Connect> {
+    self.0.connect(addr)
+  }
+
+  /// Sends the bytes of `buf` as one datagram to `addr`.
+  ///
+  /// Resolves to the bytes sent, which is all of them, or an error like
+  /// `EMSGSIZE` for a datagram too big to go out.
+  ///
+  /// # Examples
+  ///
+  /// ```rust,no_run
+  /// use lio::net::UdpSocket;
+  ///
+  /// async fn example(socket: &UdpSocket) -> std::io::Result<()> {
+  ///     let (result, _) = socket.send_to(b"ping".to_vec(), "127.0.0.1:4433".parse().unwrap()).await;
+  ///     result?;
+  ///     Ok(())
+  /// }
+  /// ```
+  pub fn send_to<B>(&self, buf: B, addr: SocketAddr) -> Io<UdpSendTo<B>>
+  where
+    B: BufLike + Send + Sync,
+  {
+    Io::from_op(UdpSendTo::new(self.as_resource().clone(), buf, addr))
+  }
+
+  /// Sends the bytes of `buf` to `addr` as datagrams of `segment_size`
+  /// bytes, the last one possibly shorter.
+  ///
+  /// The kernel does the splitting (UDP generic segmentation offload, Linux
+  /// 4.18+), so a whole batch of datagrams to one peer costs a single send.
+  /// Fails with `EINVAL` if `buf` holds more segments than the kernel takes
+  /// at once (64 on most) or it doesn't support the offload, and with `EIO`
+  /// if the device can't checksum them.
+  ///
+  /// # Examples
+  ///
+  /// ```rust,no_run
+  /// use lio::net::UdpSocket;
+  ///
+  /// async fn example(socket: &UdpSocket) -> std::io::Result<()> {
+  ///     // Ten 1200 byte datagrams.
+  ///     let packets = vec![0u8; 12_000];
+  ///     let peer = "127.0.0.1:4433".parse().unwrap();
+  ///     let (result, _) = socket.send_segments_to(packets, peer, 1200).await;
+  ///     result?;
+  ///     Ok(())
+  /// }
+  /// ```
+  #[cfg(linux)]
+  pub fn send_segments_to<B>(
+    &self,
+    buf: B,
+    addr: SocketAddr,
+    segment_size: u16,
+  ) -> Io<UdpSendTo<B>>
+  where
+    B: BufLike + Send + Sync,
+  {
+    let send = UdpSendTo::new(self.as_resource().clone(), buf, addr);
+    Io::from_op(send.segment_size(segment_size))
+  }
+
+  /// Sends each buffer of `datagrams` as a datagram to its address, all
+  /// submitted before waiting on any.
+  ///
+  /// Resolves to one result per datagram, in order, once all are done. See
+  /// the [type docs](Self) for how backends batch them.
+  ///
+  /// # Examples
+  ///
+  /// ```rust,no_run
+  /// use lio::net::UdpSocket;
+  /// use std::net::SocketAddr;
+  ///
+  /// async fn example(socket: &UdpSocket, peers: &[SocketAddr]) {
+  ///     let datagrams = peers.iter().map(|&peer| (b"ping".to_vec(), peer)).collect();
+  ///     for (result, _) in socket.send_batch(datagrams).await {
+  ///         if let Err(err) = result {
+  ///             eprintln!("send failed: {err}");
+  ///         }
+  ///     }
+  /// }
+  /// ```
+  pub fn send_batch<B>(&self, datagrams: Vec<(B, SocketAddr)>) -> SendBatch<B>
+  where
+    B: BufLike + Send + Sync + Unpin + 'static,
+  {
+    SendBatch { socket: self.as_resource().clone(), datagrams, lio: None }
+  }
+
+  /// Receives a datagram into `buf`, with its sender's address.
+  ///
+  /// A datagram longer than `buf` is cut off. With [GRO](Self::set_gro) on,
+  /// several may come in coalesced without a way to tell them apart, so use
+  /// [`recv_from_multi`](Self::recv_from_multi) then.
+  ///
+  /// # Examples
+  ///
+  /// ```rust,no_run
+  /// use lio::net::UdpSocket;
+  ///
+  /// async fn example(socket: &UdpSocket) -> std::io::Result<()> {
+  ///     let (result, buf) = socket.recv_from(Vec::with_capacity(1500)).await;
+  ///     let (len, peer) = result?;
+  ///     println!("{len} bytes from {peer}: {:?}", buf);
+  ///     Ok(())
+  /// }
+  /// ```
+  pub fn recv_from<B>(&self, buf: B) -> Io<UdpRecvFrom<B>>
+  where
+    B: BufLike + Send + Sync,
+  {
+    Io::from_op(UdpRecvFrom::new(self.as_resource().clone(), buf))
+  }
+
+  /// Receives datagrams as they arrive, into buffers of a shared
+  /// [`BufRing`], with their senders' addresses.
+  ///
+  /// Every buffer starts with room for the address and control data, about
+  /// 200 bytes, so `ring` must have buffers that much bigger than the
+  /// largest datagram expected; longer ones are cut off, see
+  /// [`Datagram::is_truncated`](ops::Datagram::is_truncated). See
+  /// [`api::recvmsg_multi`].
+  ///
+  /// # Panics
+  ///
+  /// Panics if `ring`'s buffers have no room for a payload.
+  ///
+  /// # Examples
+  ///
+  /// ```rust,no_run
+  /// use lio::{Lio, net::UdpSocket};
+  ///
+  /// async fn example(lio: &Lio, socket: &UdpSocket) -> std::io::Result<()> {
+  ///     let ring = lio.register_buf_ring(1024, 2048)?;
+  ///
+  ///     let mut datagrams = socket.recv_from_multi(&ring).with_lio(lio).stream();
+  ///     while let Some(datagram) = datagrams.next().await {
+  ///         let datagram = datagram?;
+  ///         println!("{:?} from {:?}", &datagram[..], datagram.peer());
+  ///     }
+  ///     Ok(())
+  /// }
+  /// ```
+  pub fn recv_from_multi(&self, ring: &BufRing) -> Io<ops::RecvMsgMulti> {
+    api::recvmsg_multi(self, ring, None)
+  }
+
+  /// Sends `buf` as one datagram to the [connected](Self::connect) peer.
+  pub fn send<B>(&self, buf: B) -> Io<ops::Send<B>>
+  where
+    B: BufLike + Send + Sync,
+  {
+    api::send(self, buf, None)
+  }
+
+  /// Receives a datagram from the [connected](Self::connect) peer.
+  pub fn recv<B>(&self, buf: B) -> Io<ops::Recv<B>>
+  where
+    B: BufLike + Send + Sync,
+  {
+    api::recv(self, buf, None)
+  }
+
+  /// Has the kernel coalesce datagrams arriving from the same sender into
+  /// one receive (UDP generic receive offload, Linux 5.0+).
+  ///
+  /// Each [`Datagram`](ops::Datagram) of
+  /// [`recv_from_multi`](Self::recv_from_multi) then reports the size of the
+  /// datagrams it holds, see
+  /// [`Datagram::segments`](ops::Datagram::segments).
+  #[cfg(linux)]
+  pub fn set_gro(&self, enabled: bool) -> io::Result<()> {
+    use std::os::fd::AsRawFd;
+
+    let value = enabled as libc::c_int;
+    syscall!(setsockopt(
+      self.as_resource().as_raw_fd(),
+      libc::SOL_UDP,
+      libc::UDP_GRO,
+      (&raw const value).cast(),
+      std::mem::size_of::<libc::c_int>() as libc::socklen_t,
+    ))?;
+    Ok(())
+  }
+
+  /// Busy-polls the device queue on receives, see
+  /// [`Socket::set_busy_poll`].
+  #[cfg(linux)]
+  pub fn set_busy_poll(
+    &self,
+    budget: std::time::Duration,
+    prefer: bool,
+  ) -> io::Result<()> {
+    self.0.set_busy_poll(budget, prefer)
+  }
+
+  /// Returns the local address this socket is bound to.
+  pub fn local_addr(&self) -> io::Result<SocketAddr> {
+    self.0.local_addr()
+  }
+}
+
+/// Datagrams sent together, started by awaiting it.
+///
+/// Created by [`UdpSocket::send_batch`].
+#[must_use = "nothing is sent until awaited"]
+pub struct SendBatch<B> {
+  socket: Resource,
+  datagrams: Vec<(B, SocketAddr)>,
+  lio: Option<Lio>,
+}
+
+impl<B> SendBatch<B>
+where
+  B: BufLike + Send + Sync + Unpin + 'static,
+{
+  /// Runs the sends on `lio` instead of the global one, like
+  /// [`Io::with_lio`].
+  pub fn with_lio(mut self, lio: &Lio) -> Self {
+    self.lio = Some(lio.clone());
+    self
+  }
+
+  async fn run(self) -> Vec<BufResult<i32, B>> {
+    let mut sends: Vec<_> = self
+      .datagrams
+      .into_iter()
+      .map(|(buf, to)| {
+        let send = Io::from_op(UdpSendTo::new(self.socket.clone(), buf, to));
+        match &self.lio {
+          Some(lio) => send.with_lio(lio),
+          None => send,
+        }
+        .into_future()
+      })
+      .collect();
+    // Every send is submitted before waiting on any, the first poll only
+    // submits.
+    poll_fn(|cx| {
+      for send in &mut sends {
+        assert!(Pin::new(send).poll(cx).is_pending());
+      }
+      Poll::Ready(())
+    })
+    .await;
+
+    let mut results = Vec::with_capacity(sends.len());
+    for send in sends {
+      results.push(send.await);
+    }
+    results
+  }
+}
+
+impl<B> IntoFuture for SendBatch<B>
+where
+  B: BufLike + Send + Sync + Unpin + 'static,
+{
+  type Output = Vec<BufResult<i32, B>>;
+  type IntoFuture = Pin<Box<dyn Future<Output = Self::Output>>>;
+
+  fn into_future(self) -> Self::IntoFuture {
+    Box::pin(self.run())
+  }
+}
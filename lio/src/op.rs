@@ -11,6 +11,7 @@ use std::time::Duration;
 use std::os::fd::RawFd;
 
 use crate::api::resource::Resource;
+use crate::buf::BufRing;
 
 // ═══════════════════════════════════════════════════════════════════════════════
 // ErasedBuffer - Type-erased buffer storage
@@ -72,6 +73,22 @@ impl OpBuf {
     unsafe { *ptr }
   }
 
+  /// Mutable access to the contained value, for changing it in place.
+  ///
+  /// # Safety
+  /// Caller must ensure T matches the original type.
+  pub(crate) unsafe fn peek_mut<T>(&mut self) -> &mut T {
+    let ptr = self
+      .ptr
+      .as_mut()
+      .expect("ErasedBuffer already taken")
+      .as_ptr()
+      .cast::<T>();
+    // SAFETY: Caller guarantees the type matches, and `&mut self` makes this
+    // the only access.
+    unsafe { &mut *ptr }
+  }
+
   /// Takes the buffer out, consuming self.
   ///
   /// # Safety
@@ -130,11 +147,88 @@ pub enum Op {
     flags: i32,
     buffer: OpBuf,
   },
+  /// Send straight out of the buffer, without copying it into the socket.
+  ///
+  /// Usually completes twice: with the bytes sent, then once the kernel is
+  /// done reading the buffer.
+  SendZc {
+    fd: Resource,
+    flags: i32,
+    buffer: OpBuf,
+  },
   Recv {
     fd: Resource,
     flags: i32,
     buffer: OpBuf,
   },
+  /// Multishot receive: completes once per chunk of data, each landing in a
+  /// buffer picked from `ring`, until EOF or an error.
+  RecvMulti {
+    fd: Resource,
+    flags: i32,
+    ring: BufRing,
+  },
+  /// Read into a buffer of a registered [`BufStore`](crate::buf::BufStore).
+  ///
+  /// `offset == -1` reads from the current file position (or a socket).
+  ReadFixed {
+    fd: Resource,
+    offset: i64,
+    buf_index: u16,
+    buffer: OpBuf,
+  },
+  /// Write from a buffer of a registered [`BufStore`](crate::buf::BufStore).
+  ///
+  /// `offset == -1` writes at the current file position (or a socket).
+  WriteFixed {
+    fd: Resource,
+    offset: i64,
+    buf_index: u16,
+    buffer: OpBuf,
+  },
+  /// Vectored read at the current file position into the `iovcnt` buffers
+  /// `iov` points at, all owned by the typed op.
+  #[cfg(unix)]
+  Readv {
+    fd: Resource,
+    iov: *const libc::iovec,
+    iovcnt: u32,
+  },
+  /// Vectored write at the current file position, see [`Op::Readv`].
+  #[cfg(unix)]
+  Writev {
+    fd: Resource,
+    iov: *const libc::iovec,
+    iovcnt: u32,
+  },
+  /// `msg`, and the buffers and address it points at, are owned by the typed
+  /// op.
+  #[cfg(unix)]
+  SendMsg {
+    fd: Resource,
+    msg: *const libc::msghdr,
+    flags: i32,
+  },
+  /// Receive into the buffers of `msg`, which also takes in the sender's
+  /// address. Owned by the typed op like [`Op::SendMsg`].
+  #[cfg(unix)]
+  RecvMsg {
+    fd: Resource,
+    msg: *mut libc::msghdr,
+    flags: i32,
+  },
+  /// Multishot receive: completes once per message, each landing in a buffer
+  /// picked from `ring` as a
+  /// [`RecvMsgOut`](crate::api::ops::iovec::RecvMsgOut) header followed by
+  /// the sender's address, control data and payload. Only the name and
+  /// control lengths of `msg`, owned by the typed op, are used.
+  #[cfg(unix)]
+  RecvMsgMulti {
+    fd: Resource,
+    msg: *const libc::msghdr,
+    flags: i32,
+    ring: BufRing,
+  },
 
   // ═══════════════════════════════════════════════════════════════════════════════
   // Socket operations
@@ -144,6 +238,11 @@ pub enum Op {
     addr: *mut libc::sockaddr_storage,
     len: *mut libc::socklen_t,
   },
+  /// Multishot accept: completes once per incoming connection, with the new
+  /// fd as result, until an error.
+  AcceptMulti {
+    fd: Resource,
+  },
   Connect {
     fd: Resource,
     addr: *const libc::sockaddr_storage,
@@ -177,6 +276,8 @@ pub enum Op {
     dir_fd: Resource,
     path: *const c_char,
     flags: i32,
+    /// Permissions of a file `O_CREAT` creates, before the umask.
+    mode: u32,
   },
   Close {
     /// Raw file descriptor - we do not hold a Resource here to avoid
@@ -221,10 +322,29 @@ pub enum Op {
     fd_out: Resource,
     size: u32,
   },
+  /// Moves up to `size` bytes from `fd_in` to `fd_out` through the kernel,
+  /// one of them being a pipe. Reads `fd_in` from `off_in`, or from its file
+  /// position if that's -1, which it must be for pipes and sockets.
+  #[cfg(target_os = "linux")]
+  Splice {
+    fd_in: Resource,
+    off_in: i64,
+    fd_out: Resource,
+    size: u32,
+  },
+  /// Completes once `duration` passed. [`Lio`](crate::Lio) keeps these on
+  /// its timer wheel and never pushes them to the backend.
   Timeout {
     duration: Duration,
     #[cfg(target_os = "linux")]
-    timer_fd: Resource,
+    timespec: *const libc::timespec,
+  },
+  /// Cancels the op before it in a chain unless that one completes within
+  /// `duration`, see [`IoBackend::push_chain`]. Only valid in a chain.
+  ///
+  /// [`IoBackend::push_chain`]: crate::backends::IoBackend::push_chain
+  LinkTimeout {
+    duration: Duration,
     #[cfg(target_os = "linux")]
     timespec: *const libc::timespec,
   },
@@ -1,4 +1,7 @@
-use std::task::Waker;
+use std::{
+  mem::{ManuallyDrop, MaybeUninit},
+  task::Waker,
+};
 
 use crate::typed_op::TypedOp;
 
@@ -41,37 +44,51 @@ impl Notifier {
   }
 }
 
+/// Callbacks up to this size are stored in the [`OpCallback`] itself, which
+/// covers the closures lio builds (a channel sender, an `Arc`, a C function
+/// pointer and fd). Bigger ones, or more aligned ones, get boxed.
+const INLINE_WORDS: usize = 4;
+
+/// Holds a callback of type `F` inline, or a `Box<F>` if it doesn't fit.
+type CallbackSlot = MaybeUninit<[usize; INLINE_WORDS]>;
+
+/// Whether `F` is stored inline, decided at compile time.
+const fn fits_inline<F>() -> bool {
+  size_of::<F>() <= size_of::<CallbackSlot>()
+    && align_of::<F>() <= align_of::<CallbackSlot>()
+}
+
 pub(crate) struct OpCallback {
-  callback: *const (),
+  callback: CallbackSlot,
+  /// The boxed typed op. It stays boxed, the `Op` built from it points into
+  /// it and outlives moves of the registration.
   typed_op: *const (),
-  call_callback_fn:
-    for<'a> fn(*const (), *const (), isize, &'a mut Registration),
+  vtable: &'static CallbackVtable,
+}
+
+/// How to call or drop what an [`OpCallback`] holds, one per `T` and `F`.
+struct CallbackVtable {
+  call: unsafe fn(&mut CallbackSlot, *const (), isize),
+  drop: unsafe fn(&mut CallbackSlot, *const ()),
 }
 
 impl Drop for OpCallback {
   fn drop(&mut self) {
-    // If the callback wasn't called, we need to clean up the stored pointers
-    if !self.callback.is_null() {
-      // SAFETY: We need to drop the boxed callback to prevent memory leaks
-      // This is only called when OpCallback is dropped without `call` being invoked
-      // unsafe { drop(Box::from_raw(self.callback as *mut ())); }
-    }
-    if !self.typed_op.is_null() {
-      // SAFETY: We need to drop the boxed typed_op to prevent memory leaks
-      // unsafe { drop(Box::from_raw(self.typed_op as *mut ())); }
-    }
+    // Only reached if the op never completed, `call` doesn't drop `self`.
+    // SAFETY: The vtable matches the types `callback` and `typed_op` hold.
+    unsafe { (self.vtable.drop)(&mut self.callback, self.typed_op) }
   }
 }
 
 // SAFETY: OpCallback is Send because:
-// - The callback pointer points to a `F: FnOnce(T::Result) + Send` type (boxed in `new`)
+// - The callback slot holds a `F: FnOnce(T::Result) + Send` (inline or boxed)
 // - The typed_op pointer points to a `T: TypedOp + Send` type (boxed in `new`)
 // - We maintain exclusive ownership and only call them once via `call`
-// - The function pointer is a static function, which is Send
+// - The vtable only holds static function pointers, which are Send
 unsafe impl Send for OpCallback {}
 // SAFETY: OpCallback is Sync because:
 // - The callback and typed_op are only called once and consumed via `call` (takes self, not &self)
-// - The function pointer is a static function pointer, which is Sync
+// - The vtable only holds static function pointers, which are Sync
 // - While the callback itself may not be Sync, we never access it through a shared reference
 unsafe impl Sync for OpCallback {}
 
@@ -81,11 +98,7 @@ impl OpCallback {
     T: TypedOp,
     F: FnOnce(T::Result) + Send,
   {
-    OpCallback {
-      callback: Box::into_raw(Box::new(callback)) as *const (),
-      typed_op: Box::into_raw(Box::new(typed_op)) as *const (),
-      call_callback_fn: Self::call_callback::<T, F>,
-    }
+    Self::new_boxed::<T, F>(callback, Box::new(typed_op))
   }
 
   /// Create an OpCallback from an already-boxed TypedOp.
@@ -97,10 +110,28 @@ impl OpCallback {
     T: TypedOp,
     F: FnOnce(T::Result) + Send,
   {
+    let mut slot = CallbackSlot::uninit();
+    // SAFETY: The slot is big and aligned enough for `F` if it fits, and
+    // for the box pointer otherwise.
+    unsafe {
+      if const { fits_inline::<F>() } {
+        slot.as_mut_ptr().cast::<F>().write(callback);
+      } else {
+        slot
+          .as_mut_ptr()
+          .cast::<*mut F>()
+          .write(Box::into_raw(Box::new(callback)));
+      }
+    }
     OpCallback {
-      callback: Box::into_raw(Box::new(callback)) as *const (),
+      callback: slot,
       typed_op: Box::into_raw(typed_op) as *const (),
-      call_callback_fn: Self::call_callback::<T, F>,
+      vtable: const {
+        &CallbackVtable {
+          call: Self::call_callback::<T, F>,
+          drop: Self::drop_callback::<T, F>,
+        }
+      },
     }
   }
 
@@ -108,14 +139,35 @@ impl OpCallback {
     let res = reg
       .try_take_result()
       .expect("Result should be available when callback is called");
-    (self.call_callback_fn)(self.callback, self.typed_op, res, reg);
+    // The callback and typed op move out in `call_callback`.
+    let mut this = ManuallyDrop::new(self);
+    let OpCallback { callback, typed_op, vtable } = &mut *this;
+    // SAFETY: The vtable matches the stored types, and `this` is never used
+    // or dropped after.
+    unsafe { (vtable.call)(callback, *typed_op, res) }
+  }
+
+  /// Moves the callback of type `F` out of `slot`.
+  ///
+  /// # Safety
+  /// `slot` must hold an `F`, written by [`new_boxed`](Self::new_boxed), and
+  /// not be read again after.
+  unsafe fn take_callback<F>(slot: &mut CallbackSlot) -> F {
+    // SAFETY: The caller guarantees the slot holds an `F`, stored the same
+    // way `new_boxed` decides with the same check.
+    unsafe {
+      if const { fits_inline::<F>() } {
+        slot.as_ptr().cast::<F>().read()
+      } else {
+        *Box::from_raw(slot.as_ptr().cast::<*mut F>().read())
+      }
+    }
   }
 
-  fn call_callback<T, F>(
-    callback_ptr: *const (),
+  unsafe fn call_callback<T, F>(
+    slot: &mut CallbackSlot,
     typed_op_ptr: *const (),
     res: isize,
-    _reg: &mut Registration,
   ) where
     T: TypedOp,
     F: FnOnce(T::Result),
@@ -123,13 +175,115 @@ impl OpCallback {
     // SAFETY: We created this pointer with Box::into_raw from a Box<TypedOp>
     let typed_op = unsafe { Box::from_raw(typed_op_ptr as *mut T) };
     let result = typed_op.extract_result(res);
-    // SAFETY: We created this pointer with Box::into_raw from a Box<dyn FnOnce(T::Result) + Send>
-    let callback = unsafe { Box::from_raw(callback_ptr as *mut F) };
+    // SAFETY: The caller guarantees the slot holds an `F`.
+    let callback = unsafe { Self::take_callback::<F>(slot) };
     callback(result)
   }
+
+  unsafe fn drop_callback<T, F>(
+    slot: &mut CallbackSlot,
+    typed_op_ptr: *const (),
+  ) where
+    T: TypedOp,
+  {
+    // SAFETY: Same as in `call_callback`.
+    unsafe {
+      drop(Self::take_callback::<F>(slot));
+      drop(Box::from_raw(typed_op_ptr as *mut T));
+    }
+  }
 }
 
 #[test]
 fn test_op_reg_size() {
-  assert_eq!(std::mem::size_of::<Notifier>(), 24);
+  assert_eq!(std::mem::size_of::<Notifier>(), 48);
+}
+
+#[cfg(test)]
+mod tests {
+  use super::*;
+  use crate::api::ops::Nop;
+  use std::{
+    io,
+    sync::{
+      Arc,
+      atomic::{AtomicUsize, Ordering},
+    },
+  };
+
+  /// Counts its drops in `drops`.
+  struct Tracked {
+    drops: Arc<AtomicUsize>,
+  }
+
+  impl Drop for Tracked {
+    fn drop(&mut self) {
+      self.drops.fetch_add(1, Ordering::Relaxed);
+    }
+  }
+
+  fn complete(callback: OpCallback, res: isize) {
+    let mut reg = Registration::Done(Some(res));
+    callback.call(&mut reg);
+  }
+
+  #[test]
+  fn test_inline_callback() {
+    let calls = Arc::new(AtomicUsize::new(0));
+    let counter = calls.clone();
+    let callback = move |res: io::Result<()>| {
+      assert!(res.is_ok());
+      counter.fetch_add(1, Ordering::Relaxed);
+    };
+    assert!(fits_inline_val(&callback));
+
+    complete(OpCallback::new::<Nop, _>(callback, Nop), 0);
+    assert_eq!(calls.load(Ordering::Relaxed), 1);
+    assert_eq!(Arc::strong_count(&calls), 1, "callback wasn't dropped");
+  }
+
+  #[test]
+  fn test_boxed_callback() {
+    let calls = Arc::new(AtomicUsize::new(0));
+    let counter = calls.clone();
+    let big = [7u64; 16];
+    let callback = move |res: io::Result<()>| {
+      assert_eq!(res.unwrap_err().raw_os_error(), Some(libc::EBADF));
+      assert_eq!(big, [7; 16]);
+      counter.fetch_add(1, Ordering::Relaxed);
+    };
+    assert!(!fits_inline_val(&callback));
+
+    complete(OpCallback::new::<Nop, _>(callback, Nop), -libc::EBADF as isize);
+    assert_eq!(calls.load(Ordering::Relaxed), 1);
+    assert_eq!(Arc::strong_count(&calls), 1, "callback wasn't dropped");
+  }
+
+  #[test]
+  fn test_drop_uncalled() {
+    let drops = Arc::new(AtomicUsize::new(0));
+    let inline = Tracked { drops: drops.clone() };
+    drop(OpCallback::new::<Nop, _>(
+      move |_| {
+        let _ = &inline;
+        panic!("dropped callback was called");
+      },
+      Nop,
+    ));
+    assert_eq!(drops.load(Ordering::Relaxed), 1);
+
+    let boxed = (Tracked { drops: drops.clone() }, [0u64; 16]);
+    drop(OpCallback::new::<Nop, _>(
+      move |_| {
+        let _ = &boxed;
+        panic!("dropped callback was called");
+      },
+      Nop,
+    ));
+    assert_eq!(drops.load(Ordering::Relaxed), 2);
+  }
+
+  fn fits_inline_val<F>(_: &F) -> bool {
+    fits_inline::<F>()
+  }
 }
@@ -1,4 +1,4 @@
-use std::mem;
+use std::{cell::RefCell, collections::VecDeque, mem, rc::Rc};
 
 pub mod notifier;
 // mod stored;
@@ -13,17 +13,50 @@ use crate::{
 /// Opaque wrapper that hides the `pub(crate)` `Notifier` from the public `Registration` enum.
 pub struct RegistrationInner {
   pub(crate) notifier: Notifier,
+  /// Result of a completion with more to come, see
+  /// [`set_more`](Registration::set_more).
+  pub(crate) result: Option<isize>,
+}
+
+/// Receives every completion of a multishot op.
+pub(crate) trait StreamSink {
+  /// `more` is false for the op's final completion.
+  fn push(&self, res: isize, buf_id: Option<u16>, more: bool);
+}
+
+/// Opaque wrapper that hides the `pub(crate)` `StreamSink` from the public `Registration` enum.
+pub struct RegistrationStream {
+  pub(crate) sink: Rc<dyn StreamSink>,
+}
+
+/// `(user_data, result)` of each completed op registered with
+/// [`Registration::new_reap`], oldest first.
+pub(crate) type ReapQueue = RefCell<VecDeque<(u64, isize)>>;
+
+/// Opaque wrapper that hides the `pub(crate)` [`ReapQueue`] from the public `Registration` enum.
+pub struct RegistrationReap {
+  pub(crate) queue: Rc<ReapQueue>,
+  pub(crate) user_data: u64,
 }
 
 // NOTE: OpRegistration should **NEVER** impl Sync.
 pub enum Registration {
   Pending(RegistrationInner),
   Done(Option<isize>),
+  /// Multishot op, completions are forwarded as they arrive and the entry
+  /// lives until the final one.
+  Stream(RegistrationStream),
+  /// Completes into a queue instead of waking anyone, to be collected in
+  /// bulk.
+  Reap(RegistrationReap),
 }
 
 impl Registration {
   pub fn new_waker(waker: Waker) -> Self {
-    Self::Pending(RegistrationInner { notifier: Notifier::Waker(Some(waker)) })
+    Self::Pending(RegistrationInner {
+      notifier: Notifier::Waker(Some(waker)),
+      result: None,
+    })
   }
 
   pub fn new_callback<T, F>(callback: F, typed_op: T) -> Self
@@ -33,6 +66,7 @@ impl Registration {
   {
     Self::Pending(RegistrationInner {
       notifier: Notifier::Callback(OpCallback::new::<T, F>(callback, typed_op)),
+      result: None,
     })
   }
 
@@ -50,9 +84,30 @@ impl Registration {
       notifier: Notifier::Callback(OpCallback::new_boxed::<T, F>(
         callback, typed_op,
       )),
+      result: None,
     })
   }
 
+  /// Drops `typed_op` on completion instead of waking a waker, for a future
+  /// dropped while its op is in flight.
+  pub(crate) fn detach<T: TypedOp>(&mut self, typed_op: Box<T>) {
+    if let Self::Pending(inner) = self {
+      inner.notifier = Notifier::Callback(OpCallback::new_boxed::<T, _>(
+        |_: T::Result| {},
+        typed_op,
+      ));
+    }
+  }
+
+  pub(crate) fn new_stream(sink: Rc<dyn StreamSink>) -> Self {
+    Self::Stream(RegistrationStream { sink })
+  }
+
+  #[cfg(feature = "unstable_ffi")]
+  pub(crate) fn new_reap(queue: Rc<ReapQueue>, user_data: u64) -> Self {
+    Self::Reap(RegistrationReap { queue, user_data })
+  }
+
   /// Sets the waker, replacing any existing waker
   pub fn set_waker(&mut self, waker: Waker) {
     match self {
@@ -63,25 +118,54 @@ impl Registration {
       Self::Pending(RegistrationInner { notifier, .. }) => {
         notifier.set_waker(waker);
       }
+      // Streams keep their own waker, and reaped ops have none.
+      Self::Stream(_) | Self::Reap(_) => {}
     };
   }
 
+  /// Records the result of a completion that another one follows, without
+  /// completing the op.
+  ///
+  /// Zero-copy sends complete twice: first with the bytes sent, then once the
+  /// kernel lets go of the buffer. The op only completes on that last one,
+  /// with the result recorded here.
+  pub fn set_more(&mut self, res: isize) {
+    match self {
+      Self::Pending(inner) => inner.result = Some(res),
+      Self::Done(_) => panic!("op completed before its final completion"),
+      Self::Stream(_) => {
+        panic!("stream registrations complete through their sink");
+      }
+      Self::Reap(_) => panic!("reaped ops complete once"),
+    }
+  }
+
   // TODO: Way to remove
   pub fn set_done(&mut self, res: isize) {
     match mem::replace(self, Self::Done(Some(res))) {
-      Self::Pending(RegistrationInner { notifier }) => {
+      Self::Pending(RegistrationInner { notifier, result }) => {
+        if let Some(result) = result {
+          *self = Self::Done(Some(result));
+        }
         notifier.call(self);
       }
       Self::Done { .. } => {
         panic!("what");
       }
+      Self::Stream(_) => {
+        panic!("stream registrations complete through their sink");
+      }
+      Self::Reap(RegistrationReap { queue, user_data }) => {
+        queue.borrow_mut().push_back((user_data, res));
+        *self = Self::Done(None);
+      }
     }
   }
 
   pub fn try_take_result(&mut self) -> Option<isize> {
     match self {
       Self::Done(t) => Some(t.take().expect("Already taken")),
-      Self::Pending(_) => None,
+      Self::Pending(_) | Self::Stream(_) | Self::Reap(_) => None,
     }
   }
 
@@ -0,0 +1,131 @@
+//! Submitting to a [`Lio`] from other threads, see [`Lio::remote`].
+
+use std::{
+  io,
+  sync::{
+    Arc,
+    atomic::{AtomicBool, Ordering},
+  },
+};
+
+use crossbeam_channel::{Receiver, Sender};
+
+use crate::{Lio, backends::Wake};
+
+/// Work for the owning thread, see [`LioRemote::submit`].
+type Job = Box<dyn FnOnce(&Lio) + Send>;
+
+/// A `Send + Sync` handle that hands work to a [`Lio`] on its owning thread,
+/// made with [`Lio::remote`].
+///
+/// [`submit`](Self::submit) queues a closure, which the owning thread runs
+/// with its `Lio` at the start of its next [`run`](Lio::run). Ops submitted
+/// there complete on the owning thread like any other, so results travel
+/// back the way the closure arranges, e.g over a channel. A run blocked on
+/// the backend returns early for it.
+///
+/// Clone it to give every thread its own. Once the `Lio` is dropped,
+/// submitting fails.
+///
+/// # Example
+///
+/// ```no_run
+/// use std::sync::mpsc;
+/// use lio::{Lio, api};
+///
+/// let lio = Lio::new(64).unwrap();
+/// let remote = lio.remote().unwrap();
+///
+/// let (tx, rx) = mpsc::channel();
+/// std::thread::spawn(move || {
+///   remote
+///     .submit(move |lio| {
+///       let fd = api::resource::Resource::stdout();
+///       api::write(&fd, b"hello\n".to_vec()).with_lio(lio).send_with(tx);
+///     })
+///     .unwrap();
+/// });
+///
+/// while rx.try_recv().is_err() {
+///   lio.run().unwrap();
+/// }
+/// ```
+#[derive(Clone)]
+pub struct LioRemote {
+  jobs: Sender<Job>,
+  shared: Arc<Shared>,
+}
+
+/// What remotes and the owning thread share besides the queue.
+struct Shared {
+  waker: Option<Box<dyn Wake>>,
+  /// Set from the first wake until the owning thread takes the jobs, so a
+  /// burst of submissions wakes it once.
+  notified: AtomicBool,
+}
+
+impl LioRemote {
+  /// Queues `f` to run with the `Lio` on its owning thread, and wakes it.
+  ///
+  /// # Errors
+  ///
+  /// Fails with [`BrokenPipe`](io::ErrorKind::BrokenPipe) if the `Lio` was
+  /// dropped.
+  pub fn submit<F>(&self, f: F) -> io::Result<()>
+  where
+    F: FnOnce(&Lio) + Send + 'static,
+  {
+    self.jobs.send(Box::new(f)).map_err(|_| {
+      io::Error::new(io::ErrorKind::BrokenPipe, "the Lio was dropped")
+    })?;
+    self.wake();
+    Ok(())
+  }
+
+  /// Returns how many submitted jobs the owning thread hasn't taken yet, a
+  /// rough measure of how far behind it is.
+  pub fn queued(&self) -> usize {
+    self.jobs.len()
+  }
+
+  /// Makes the owning thread's current or next run return early.
+  pub fn wake(&self) {
+    if !self.shared.notified.swap(true, Ordering::AcqRel)
+      && let Some(waker) = &self.shared.waker
+    {
+      waker.wake();
+    }
+  }
+}
+
+/// The owning thread's end of its [`LioRemote`]s.
+pub(crate) struct Inbox {
+  jobs: Receiver<Job>,
+  /// Kept to make more remotes from.
+  sender: Sender<Job>,
+  shared: Arc<Shared>,
+}
+
+impl Inbox {
+  pub(crate) fn new(waker: Option<Box<dyn Wake>>) -> Self {
+    let (sender, jobs) = crossbeam_channel::unbounded();
+    let shared = Arc::new(Shared { waker, notified: AtomicBool::new(false) });
+    Self { jobs, sender, shared }
+  }
+
+  pub(crate) fn remote(&self) -> LioRemote {
+    LioRemote { jobs: self.sender.clone(), shared: self.shared.clone() }
+  }
+
+  /// Takes the queued jobs, letting the next submission wake the loop again.
+  ///
+  /// Only takes the ones queued so far, so remotes submitting faster than
+  /// they run can't keep the loop from getting to its I/O.
+  pub(crate) fn take(&self) -> impl Iterator<Item = Job> + '_ {
+    // A read-modify-write, so the queue is read after it: with a plain store
+    // that read could go first and miss a job whose remote then saw
+    // `notified` still set, and skipped the wake.
+    self.shared.notified.swap(false, Ordering::AcqRel);
+    (0..self.jobs.len()).map_while(|_| self.jobs.try_recv().ok())
+  }
+}
@@ -0,0 +1,495 @@
+//! Thread-per-core runtime.
+//!
+//! [`Builder::spawn`] starts one thread per core, each owning a [`Lio`] it
+//! installs with [`install_global`](crate::install_global), and calls the
+//! same setup function on all of them. Nothing is shared between the threads
+//! except the [`LioRemote`]s in [`Worker::peers`], through which a thread
+//! that's falling behind can [`shed`](Worker::shed) work to the others.
+//!
+//! Servers give every thread its own listener on the same address with
+//! [`Worker::listen`], and let the kernel spread the connections over them.
+//!
+//! # Example
+//!
+//! ```no_run
+//! use lio::rt;
+//!
+//! let runtime = rt::Builder::new()
+//!   .spawn(|worker| {
+//!     let listener = worker.listen("0.0.0.0:8080".parse().unwrap())?;
+//!     listener.accept().when_done(|res| {
+//!       // Handle the connection...
+//!     });
+//!     Ok(())
+//!   })
+//!   .unwrap();
+//!
+//! runtime.join().unwrap();
+//! ```
+
+use std::{
+  io,
+  sync::{
+    Arc, OnceLock,
+    atomic::{AtomicBool, Ordering},
+    mpsc,
+  },
+  thread::{self, JoinHandle},
+};
+
+#[cfg(unix)]
+use std::net::SocketAddr;
+
+#[cfg(unix)]
+use crate::net::TcpListener;
+use crate::{Lio, LioRemote, install_global, uninstall_global};
+
+/// Capacity of the drivers made without [`Builder::lio`].
+const DEFAULT_CAP: usize = 1024;
+
+/// Backlog of the listeners made by [`Worker::listen`].
+#[cfg(unix)]
+const LISTEN_BACKLOG: libc::c_int = 1024;
+
+type MakeLio = dyn Fn(usize) -> io::Result<Lio> + Send + Sync;
+type Setup = dyn Fn(&Worker) -> io::Result<()> + Send + Sync;
+
+/// Configures and starts a [`Runtime`].
+pub struct Builder {
+  threads: Option<usize>,
+  pin: bool,
+  make_lio: Arc<MakeLio>,
+}
+
+impl Default for Builder {
+  fn default() -> Self {
+    Self::new()
+  }
+}
+
+impl Builder {
+  /// A runtime of one pinned thread per CPU this process may run on, each
+  /// with a `Lio` of capacity 1024.
+  pub fn new() -> Self {
+    Self {
+      threads: None,
+      pin: true,
+      make_lio: Arc::new(|_| Lio::new(DEFAULT_CAP)),
+    }
+  }
+
+  /// Runs `threads` threads instead of one per CPU.
+  ///
+  /// # Panics
+  ///
+  /// Panics if `threads` is 0.
+  pub fn threads(mut self, threads: usize) -> Self {
+    assert!(threads > 0, "a runtime needs at least one thread");
+    self.threads = Some(threads);
+    self
+  }
+
+  /// Whether to pin each thread to its own CPU, on by default. Only Linux
+  /// pins; elsewhere threads are left to the scheduler.
+  ///
+  /// With more threads than CPUs, they share CPUs round-robin.
+  pub fn pin(mut self, pin: bool) -> Self {
+    self.pin = pin;
+    self
+  }
+
+  /// Makes each thread's driver with `make_lio`, called on that thread with
+  /// its index, e.g to tune the ring through [`Lio::builder`].
+  pub fn lio<F>(mut self, make_lio: F) -> Self
+  where
+    F: Fn(usize) -> io::Result<Lio> + Send + Sync + 'static,
+  {
+    self.make_lio = Arc::new(make_lio);
+    self
+  }
+
+  /// Starts the threads, calls `setup` on each, then runs its `Lio` until
+  /// [`Runtime::shutdown`].
+  ///
+  /// An error from `setup` or from running stops that thread and shuts the
+  /// runtime down, and is returned by [`Runtime::join`].
+  ///
+  /// # Errors
+  ///
+  /// Fails if a thread can't be started or can't make its `Lio`, after
+  /// stopping the ones that were.
+  pub fn spawn<F>(self, setup: F) -> io::Result<Runtime>
+  where
+    F: Fn(&Worker) -> io::Result<()> + Send + Sync + 'static,
+  {
+    let cpus = cpus()?;
+    let threads = self.threads.unwrap_or(cpus.len());
+    let setup: Arc<Setup> = Arc::new(setup);
+    let shared = Arc::new(Shared {
+      stop: AtomicBool::new(false),
+      peers: Default::default(),
+    });
+
+    let mut runtime = Runtime { shared: shared.clone(), handles: Vec::new() };
+    let (ready_tx, ready_rx) = mpsc::channel();
+    let mut starts = Vec::with_capacity(threads);
+    for index in 0..threads {
+      let cpu = self.pin.then(|| cpus[index % cpus.len()]);
+      let (start_tx, start_rx) = mpsc::channel();
+      let thread = WorkerThread {
+        index,
+        cpu,
+        make_lio: self.make_lio.clone(),
+        setup: setup.clone(),
+        shared: shared.clone(),
+        ready: ready_tx.clone(),
+        start: start_rx,
+      };
+      let handle = thread::Builder::new()
+        .name(format!("lio-rt-{index}"))
+        .spawn(move || thread.run());
+      match handle {
+        Ok(handle) => runtime.handles.push(handle),
+        // Dropping the start channels stops the ones already started.
+        Err(err) => return Err(err),
+      }
+      starts.push(start_tx);
+    }
+    drop(ready_tx);
+
+    // Every thread needs every other's remote before running `setup`.
+    let mut peers: Vec<Option<LioRemote>> = vec![None; threads];
+    for _ in 0..threads {
+      let Ok((index, remote)) = ready_rx.recv() else {
+        break;
+      };
+      match remote {
+        Ok(remote) => peers[index] = Some(remote),
+        Err(err) => return Err(err),
+      }
+    }
+    let Some(peers) = peers.into_iter().collect::<Option<Arc<[_]>>>() else {
+      return Err(io::Error::other("a runtime thread panicked on start"));
+    };
+    let _ = shared.peers.set(peers);
+    for start in starts {
+      let _ = start.send(());
+    }
+    Ok(runtime)
+  }
+}
+
+/// Running threads started by [`Builder::spawn`].
+///
+/// Dropping it shuts them down and waits for them.
+pub struct Runtime {
+  shared: Arc<Shared>,
+  handles: Vec<JoinHandle<io::Result<()>>>,
+}
+
+/// State every thread of a runtime shares.
+struct Shared {
+  stop: AtomicBool,
+  /// Every thread's remote, by index. Set before any runs `setup`.
+  peers: OnceLock<Arc<[LioRemote]>>,
+}
+
+impl Shared {
+  fn shutdown(&self) {
+    self.stop.store(true, Ordering::Release);
+    for peer in self.peers.get().into_iter().flat_map(|peers| peers.iter()) {
+      peer.wake();
+    }
+  }
+}
+
+impl Runtime {
+  /// Returns a remote for every thread, by index, to hand them work from
+  /// outside the runtime.
+  pub fn remotes(&self) -> &[LioRemote] {
+    self.shared.peers.get().map_or(&[], |peers| peers)
+  }
+
+  /// Tells every thread to stop after its current run. Ops still in flight
+  /// are dropped with their `Lio`.
+  pub fn shutdown(&self) {
+    self.shared.shutdown();
+  }
+
+  /// Waits for every thread to stop, see [`shutdown`](Self::shutdown).
+  ///
+  /// # Errors
+  ///
+  /// Returns the first thread's error, if any thread failed.
+  ///
+  /// # Panics
+  ///
+  /// Resumes the panic of a thread that panicked.
+  pub fn join(mut self) -> io::Result<()> {
+    self.join_all()
+  }
+
+  fn join_all(&mut self) -> io::Result<()> {
+    let mut result = Ok(());
+    for handle in self.handles.drain(..) {
+      let res = handle.join().unwrap_or_else(|p| std::panic::resume_unwind(p));
+      if result.is_ok() {
+        result = res;
+      }
+    }
+    result
+  }
+}
+
+impl Drop for Runtime {
+  fn drop(&mut self) {
+    if self.handles.is_empty() {
+      return;
+    }
+    self.shutdown();
+    if !thread::panicking() {
+      let _ = self.join_all();
+    }
+  }
+}
+
+/// What a thread is started with, moved onto it.
+struct WorkerThread {
+  index: usize,
+  cpu: Option<usize>,
+  make_lio: Arc<MakeLio>,
+  setup: Arc<Setup>,
+  shared: Arc<Shared>,
+  ready: mpsc::Sender<(usize, io::Result<LioRemote>)>,
+  start: mpsc::Receiver<()>,
+}
+
+impl WorkerThread {
+  fn run(self) -> io::Result<()> {
+    let lio = self.cpu.map_or(Ok(()), pin_to).and_then(|()| {
+      let lio = (self.make_lio)(self.index)?;
+      let remote = lio.remote()?;
+      Ok((lio, remote))
+    });
+    let lio = match lio {
+      Ok((lio, remote)) => {
+        let _ = self.ready.send((self.index, Ok(remote)));
+        lio
+      }
+      Err(err) => {
+        let _ = self.ready.send((self.index, Err(err)));
+        return Ok(());
+      }
+    };
+    drop(self.ready);
+    // Another thread failed to start.
+    if self.start.recv().is_err() {
+      return Ok(());
+    }
+
+    let worker = Worker {
+      index: self.index,
+      cpu: self.cpu,
+      lio: lio.clone(),
+      shared: self.shared,
+    };
+    install_global(lio);
+    let result = worker.run(&*self.setup);
+    if result.is_err() {
+      worker.shutdown();
+    }
+    drop(worker);
+    uninstall_global();
+    result
+  }
+}
+
+/// One thread of a [`Runtime`], passed to its setup function.
+pub struct Worker {
+  index: usize,
+  cpu: Option<usize>,
+  lio: Lio,
+  shared: Arc<Shared>,
+}
+
+impl Worker {
+  fn run(&self, setup: &Setup) -> io::Result<()> {
+    setup(self)?;
+    while !self.shared.stop.load(Ordering::Acquire) {
+      self.lio.run()?;
+    }
+    Ok(())
+  }
+
+  /// Returns this thread's index, from 0 to the number of threads.
+  pub fn index(&self) -> usize {
+    self.index
+  }
+
+  /// Returns the CPU this thread is pinned to, if it is.
+  pub fn cpu(&self) -> Option<usize> {
+    self.cpu
+  }
+
+  /// Returns this thread's `Lio`, which is also installed as its global.
+  pub fn lio(&self) -> &Lio {
+    &self.lio
+  }
+
+  /// Returns every thread's remote, by index, including this one's.
+  pub fn peers(&self) -> &[LioRemote] {
+    self.shared.peers.get().expect("peers are set before setup")
+  }
+
+  /// Hands `f` to the thread with the fewest queued remote jobs other than
+  /// this one, or to this one if it runs alone.
+  ///
+  /// # Errors
+  ///
+  /// Fails if the chosen thread already stopped.
+  pub fn shed<F>(&self, f: F) -> io::Result<()>
+  where
+    F: FnOnce(&Lio) + Send + 'static,
+  {
+    let peers = self.peers();
+    let target = peers
+      .iter()
+      .enumerate()
+      .filter(|(index, _)| *index != self.index)
+      .min_by_key(|(_, peer)| peer.queued())
+      .map_or(&peers[self.index], |(_, peer)| peer);
+    target.submit(f)
+  }
+
+  /// Shuts down the whole runtime, see [`Runtime::shutdown`].
+  pub fn shutdown(&self) {
+    self.shared.shutdown();
+  }
+
+  /// Binds a TCP listener on `addr` that shares the address with the other
+  /// threads' through `SO_REUSEPORT`, so the kernel spreads connections over
+  /// them.
+  ///
+  /// On Linux a pinned thread also sets `SO_INCOMING_CPU`, so the kernel
+  /// prefers the listener on the CPU that handled the connection's packets,
+  /// keeping it on one cache from the NIC queue to the handler.
+  ///
+  /// # Errors
+  ///
+  /// Fails like `bind(2)` and `listen(2)`.
+  #[cfg(unix)]
+  pub fn listen(&self, addr: SocketAddr) -> io::Result<TcpListener> {
+    reuse_port_listener(addr, self.cpu)
+  }
+}
+
+#[cfg(unix)]
+fn reuse_port_listener(
+  addr: SocketAddr,
+  cpu: Option<usize>,
+) -> io::Result<TcpListener> {
+  use crate::api::resource::{FromResource, Resource};
+  use std::os::fd::{FromRawFd, IntoRawFd, OwnedFd};
+  use std::{mem, ptr};
+
+  let (domain, len) = match addr {
+    SocketAddr::V4(_) => (libc::AF_INET, mem::size_of::<libc::sockaddr_in>()),
+    SocketAddr::V6(_) => (libc::AF_INET6, mem::size_of::<libc::sockaddr_in6>()),
+  };
+  #[cfg(linux)]
+  let ty = libc::SOCK_STREAM | libc::SOCK_CLOEXEC;
+  #[cfg(not(linux))]
+  let ty = libc::SOCK_STREAM;
+
+  // SAFETY: socket(2) takes no pointers.
+  let fd = unsafe { libc::socket(domain, ty, 0) };
+  if fd < 0 {
+    return Err(io::Error::last_os_error());
+  }
+  // SAFETY: `fd` was just opened and isn't owned by anything else.
+  let fd = unsafe { OwnedFd::from_raw_fd(fd) };
+  let raw = std::os::fd::AsRawFd::as_raw_fd(&fd);
+
+  let set = |opt: libc::c_int, value: libc::c_int| {
+    // SAFETY: `value` lives for the call and is the size passed.
+    let ret = unsafe {
+      libc::setsockopt(
+        raw,
+        libc::SOL_SOCKET,
+        opt,
+        ptr::from_ref(&value).cast(),
+        mem::size_of::<libc::c_int>() as libc::socklen_t,
+      )
+    };
+    if ret < 0 { Err(io::Error::last_os_error()) } else { Ok(()) }
+  };
+  set(libc::SO_REUSEADDR, 1)?;
+  set(libc::SO_REUSEPORT, 1)?;
+  #[cfg(linux)]
+  if let Some(cpu) = cpu {
+    set(libc::SO_INCOMING_CPU, cpu as libc::c_int)?;
+  }
+  #[cfg(not(linux))]
+  let _ = cpu;
+
+  let storage = crate::net_utils::std_socketaddr_into_libc(addr);
+  // SAFETY: `storage` holds an address of `domain`, which is `len` long.
+  let ret = unsafe {
+    libc::bind(raw, ptr::from_ref(&storage).cast(), len as libc::socklen_t)
+  };
+  if ret < 0 {
+    return Err(io::Error::last_os_error());
+  }
+  // SAFETY: listen(2) takes no pointers.
+  if unsafe { libc::listen(raw, LISTEN_BACKLOG) } < 0 {
+    return Err(io::Error::last_os_error());
+  }
+
+  // SAFETY: the fd is released from `fd`, so the resource is its only owner.
+  let resource = unsafe { Resource::from_raw_fd(fd.into_raw_fd()) };
+  Ok(TcpListener::from_resource(resource))
+}
+
+/// Lists the CPUs this process may run on, for pinning threads to.
+#[cfg(linux)]
+fn cpus() -> io::Result<Vec<usize>> {
+  // SAFETY: cpu_set_t is a plain bitmask, empty when zeroed.
+  let mut set: libc::cpu_set_t = unsafe { std::mem::zeroed() };
+  // SAFETY: `set` is a valid cpu_set_t of the size passed.
+  let ret = unsafe {
+    libc::sched_getaffinity(0, std::mem::size_of::<libc::cpu_set_t>(), &mut set)
+  };
+  if ret < 0 {
+    return Err(io::Error::last_os_error());
+  }
+  let cpus: Vec<_> = (0..libc::CPU_SETSIZE as usize)
+    // SAFETY: `cpu` is below CPU_SETSIZE.
+    .filter(|&cpu| unsafe { libc::CPU_ISSET(cpu, &set) })
+    .collect();
+  if cpus.is_empty() { Ok(vec![0]) } else { Ok(cpus) }
+}
+
+#[cfg(not(linux))]
+fn cpus() -> io::Result<Vec<usize>> {
+  let count =
+    thread::available_parallelism().map_or(1, std::num::NonZeroUsize::get);
+  Ok((0..count).collect())
+}
+
+#[cfg(linux)]
+fn pin_to(cpu: usize) -> io::Result<()> {
+  // SAFETY: cpu_set_t is a plain bitmask, empty when zeroed.
+  let mut set: libc::cpu_set_t = unsafe { std::mem::zeroed() };
+  // SAFETY: `cpu` comes from `cpus`, so is below CPU_SETSIZE.
+  unsafe { libc::CPU_SET(cpu, &mut set) };
+  // SAFETY: `set` is a valid cpu_set_t of the size passed.
+  let ret = unsafe {
+    libc::sched_setaffinity(0, std::mem::size_of::<libc::cpu_set_t>(), &set)
+  };
+  if ret < 0 { Err(io::Error::last_os_error()) } else { Ok(()) }
+}
+
+#[cfg(not(linux))]
+fn pin_to(_cpu: usize) -> io::Result<()> {
+  Ok(())
+}
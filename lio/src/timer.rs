@@ -0,0 +1,349 @@
+//! Hierarchical timer wheel behind [`api::timeout`](crate::api::timeout).
+//!
+//! Timeouts stay in [`Lio`](crate::Lio) instead of each taking a kernel
+//! timer, and the backend only ever waits for the nearest deadline. Six
+//! levels of 64 slots hold deadlines at millisecond resolution, level `n`
+//! slots spanning `64^n` ms, up to about two years out. Inserting and
+//! removing a timer are O(1), finding the nearest deadline checks one
+//! bitmask per level.
+//!
+//! Timers live in a slab indexed by [`OpStore::slot_of`] their op id, linked
+//! into the list of their slot.
+
+use std::time::{Duration, Instant};
+
+use crate::backends::OpStore;
+
+const LEVELS: usize = 6;
+const SLOT_BITS: u32 = 6;
+const SLOTS: usize = 1 << SLOT_BITS;
+/// Ticks the wheel spans, further deadlines wait in the furthest slot.
+const SPAN: u64 = 1 << (SLOT_BITS * LEVELS as u32);
+/// End of a slot's list.
+const NIL: u32 = u32::MAX;
+
+struct Timer {
+  id: u64,
+  /// Tick it expires at, which can be past the wheel's span.
+  deadline: u64,
+  level: u8,
+  slot: u8,
+  prev: u32,
+  next: u32,
+}
+
+pub(crate) struct TimerWheel {
+  /// Tick 0, ticks are milliseconds since.
+  start: Instant,
+  /// Tick the wheel has advanced to. Every timer is at or past it.
+  elapsed: u64,
+  timers: Vec<Option<Timer>>,
+  /// First timer of every slot.
+  heads: [[u32; SLOTS]; LEVELS],
+  /// Bit per slot that has timers.
+  occupied: [u64; LEVELS],
+  len: usize,
+}
+
+impl TimerWheel {
+  /// A wheel with room for the timers of a store of `cap` ops.
+  pub(crate) fn with_capacity(cap: usize) -> Self {
+    Self {
+      start: Instant::now(),
+      elapsed: 0,
+      timers: (0..cap).map(|_| None).collect(),
+      heads: [[NIL; SLOTS]; LEVELS],
+      occupied: [0; LEVELS],
+      len: 0,
+    }
+  }
+
+  pub(crate) fn is_empty(&self) -> bool {
+    self.len == 0
+  }
+
+  /// Arms a timer for op `id`, expiring at `deadline`.
+  ///
+  /// Rounds up to the next millisecond, so it never expires early.
+  pub(crate) fn insert(&mut self, id: u64, deadline: Instant) {
+    let since = deadline.saturating_duration_since(self.start);
+    let mut tick = since.as_millis() as u64;
+    if !since.subsec_nanos().is_multiple_of(1_000_000) {
+      tick += 1;
+    }
+
+    let index = OpStore::slot_of(id);
+    if index >= self.timers.len() {
+      // Only with ids from a store bigger than the wheel's capacity.
+      self.timers.resize_with(index + 1, || None);
+    }
+    debug_assert!(self.timers[index].is_none(), "timer {index} is armed");
+    self.timers[index] = Some(Timer {
+      id,
+      deadline: tick.max(self.elapsed),
+      level: 0,
+      slot: 0,
+      prev: NIL,
+      next: NIL,
+    });
+    self.link(index as u32);
+    self.len += 1;
+  }
+
+  /// Disarms the timer of op `id`. Returns false if it has none.
+  pub(crate) fn remove(&mut self, id: u64) -> bool {
+    let index = OpStore::slot_of(id);
+    if !matches!(self.timers.get(index), Some(Some(timer)) if timer.id == id) {
+      return false;
+    }
+    self.unlink(index as u32);
+    self.timers[index] = None;
+    self.len -= 1;
+    true
+  }
+
+  /// When the nearest timer expires.
+  ///
+  /// That may be up to a slot early for timers on the upper levels, which
+  /// then move down a level instead of expiring.
+  pub(crate) fn next_deadline(&self) -> Option<Instant> {
+    let (_, _, tick) = self.next_slot()?;
+    Some(self.start + Duration::from_millis(tick))
+  }
+
+  /// Advances the wheel to `now`, appending the ops whose timer expired to
+  /// `expired`.
+  pub(crate) fn expire(&mut self, now: Instant, expired: &mut Vec<u64>) {
+    let now = now.saturating_duration_since(self.start).as_millis() as u64;
+    while let Some((level, slot, tick)) = self.next_slot() {
+      if tick > now {
+        break;
+      }
+      self.elapsed = tick;
+
+      let mut index = self.heads[level][slot];
+      self.heads[level][slot] = NIL;
+      self.occupied[level] &= !(1 << slot);
+      while index != NIL {
+        let timer = self.timers[index as usize].as_mut().unwrap();
+        let next = timer.next;
+        if timer.deadline <= tick {
+          expired.push(timer.id);
+          self.timers[index as usize] = None;
+          self.len -= 1;
+        } else {
+          // Moves down a level, now that the wheel got closer.
+          self.link(index);
+        }
+        index = next;
+      }
+    }
+    self.elapsed = self.elapsed.max(now);
+  }
+
+  /// The nearest slot with timers, and the tick it starts at.
+  ///
+  /// Timers on a lower level expire before any on the levels above, which
+  /// only hold ones past the lower level's current rotation. The last level
+  /// wraps around, its slots before the current one being in the next
+  /// rotation.
+  fn next_slot(&self) -> Option<(usize, usize, u64)> {
+    for level in 0..LEVELS {
+      let occupied = self.occupied[level];
+      if occupied == 0 {
+        continue;
+      }
+      let shift = SLOT_BITS * level as u32;
+      let current = (self.elapsed >> shift) as u32 % SLOTS as u32;
+      let ahead = occupied.rotate_right(current).trailing_zeros();
+      let slot = ((ahead + current) as usize) % SLOTS;
+
+      let rotation = 1 << (shift + SLOT_BITS);
+      let mut tick =
+        (self.elapsed & !(rotation - 1)) + ((slot as u64) << shift);
+      if tick < self.elapsed {
+        tick += rotation;
+      }
+      return Some((level, slot, tick));
+    }
+    None
+  }
+
+  /// Links timer `index` into the slot its deadline falls in.
+  fn link(&mut self, index: u32) {
+    let timer = self.timers[index as usize].as_mut().unwrap();
+    // Past the span, it waits in the furthest slot.
+    let deadline = timer.deadline.min(self.elapsed + SPAN - 1);
+    // The highest bits it differs from `elapsed` in pick the level.
+    let differs =
+      ((deadline ^ self.elapsed) | (SLOTS as u64 - 1)).min(SPAN - 1);
+    let level = (63 - differs.leading_zeros()) / SLOT_BITS;
+    let slot = (deadline >> (SLOT_BITS * level)) as usize % SLOTS;
+
+    let head = self.heads[level as usize][slot];
+    timer.level = level as u8;
+    timer.slot = slot as u8;
+    timer.prev = NIL;
+    timer.next = head;
+    if head != NIL {
+      self.timers[head as usize].as_mut().unwrap().prev = index;
+    }
+    self.heads[level as usize][slot] = index;
+    self.occupied[level as usize] |= 1 << slot;
+  }
+
+  /// Takes timer `index` out of its slot's list.
+  fn unlink(&mut self, index: u32) {
+    let timer = self.timers[index as usize].as_ref().unwrap();
+    let (level, slot) = (timer.level as usize, timer.slot as usize);
+    let (prev, next) = (timer.prev, timer.next);
+    match prev {
+      NIL => self.heads[level][slot] = next,
+      prev => self.timers[prev as usize].as_mut().unwrap().next = next,
+    }
+    if next != NIL {
+      self.timers[next as usize].as_mut().unwrap().prev = prev;
+    }
+    if self.heads[level][slot] == NIL {
+      self.occupied[level] &= !(1 << slot);
+    }
+  }
+}
+
+#[cfg(test)]
+mod tests {
+  use super::*;
+
+  fn id(slot: u64) -> u64 {
+    // Generation 1, so ids don't look like plain slots.
+    (1 << 32) | slot
+  }
+
+  fn ms(ms: u64) -> Duration {
+    Duration::from_millis(ms)
+  }
+
+  /// Advances `wheel` tick by tick up to `until`, returning what expired
+  /// when.
+  fn run_to(wheel: &mut TimerWheel, until: u64) -> Vec<(u64, u64)> {
+    let mut fired = Vec::new();
+    let mut expired = Vec::new();
+    for tick in wheel.elapsed..=until {
+      wheel.expire(wheel.start + ms(tick), &mut expired);
+      fired.extend(expired.drain(..).map(|id| (id, tick)));
+    }
+    fired
+  }
+
+  #[test]
+  fn test_expires_on_deadline() {
+    let mut wheel = TimerWheel::with_capacity(8);
+    let start = wheel.start;
+    wheel.insert(id(0), start + ms(5));
+    wheel.insert(id(1), start + ms(70));
+    wheel.insert(id(2), start + ms(5000));
+    assert_eq!(
+      run_to(&mut wheel, 6000),
+      vec![(id(0), 5), (id(1), 70), (id(2), 5000)]
+    );
+    assert!(wheel.is_empty());
+  }
+
+  #[test]
+  fn test_rounds_up() {
+    let mut wheel = TimerWheel::with_capacity(8);
+    wheel.insert(id(0), wheel.start + Duration::from_micros(1500));
+    assert_eq!(run_to(&mut wheel, 3), vec![(id(0), 2)]);
+  }
+
+  #[test]
+  fn test_past_deadline_expires_right_away() {
+    let mut wheel = TimerWheel::with_capacity(8);
+    run_to(&mut wheel, 100);
+    wheel.insert(id(3), wheel.start);
+    assert!(wheel.next_deadline().unwrap() <= wheel.start + ms(100));
+    let mut expired = Vec::new();
+    wheel.expire(wheel.start + ms(100), &mut expired);
+    assert_eq!(expired, vec![id(3)]);
+  }
+
+  #[test]
+  fn test_remove() {
+    let mut wheel = TimerWheel::with_capacity(8);
+    let start = wheel.start;
+    for slot in 0..4 {
+      wheel.insert(id(slot), start + ms(10));
+    }
+    assert!(wheel.remove(id(1)));
+    assert!(wheel.remove(id(3)));
+    assert!(!wheel.remove(id(3)), "already removed");
+    assert!(!wheel.remove(id(0) + (1 << 32)), "other generation");
+
+    assert_eq!(run_to(&mut wheel, 20), vec![(id(2), 10), (id(0), 10)]);
+    assert!(wheel.is_empty());
+    assert!(wheel.next_deadline().is_none());
+  }
+
+  #[test]
+  fn test_jumps_ahead() {
+    let mut wheel = TimerWheel::with_capacity(8);
+    let start = wheel.start;
+    wheel.insert(id(0), start + ms(300));
+    wheel.insert(id(1), start + ms(100_000));
+
+    let mut expired = Vec::new();
+    wheel.expire(start + ms(99_999), &mut expired);
+    assert_eq!(expired, vec![id(0)]);
+    assert!(wheel.next_deadline().unwrap() <= start + ms(100_000));
+    wheel.expire(start + ms(100_000), &mut expired);
+    assert_eq!(expired, vec![id(0), id(1)]);
+  }
+
+  #[test]
+  fn test_next_deadline_never_late() {
+    let mut wheel = TimerWheel::with_capacity(64);
+    let start = wheel.start;
+    let deadlines = [1, 63, 64, 65, 4095, 4096, 4097, 262_143, 262_145, 9_999];
+    for (slot, deadline) in deadlines.iter().enumerate() {
+      wheel.insert(id(slot as u64), start + ms(*deadline));
+    }
+    let mut expired = Vec::new();
+    let mut fired = Vec::new();
+    while let Some(next) = wheel.next_deadline() {
+      wheel.expire(next, &mut expired);
+      let tick = (next - start).as_millis() as u64;
+      for id in expired.drain(..) {
+        let deadline = deadlines[(id & 0xffff_ffff) as usize];
+        assert_eq!(tick, deadline, "fired late or early");
+        fired.push(deadline);
+      }
+    }
+    let mut sorted = deadlines.to_vec();
+    sorted.sort();
+    assert_eq!(fired, sorted);
+  }
+
+  #[test]
+  fn test_beyond_span() {
+    let mut wheel = TimerWheel::with_capacity(8);
+    let far = SPAN + 10;
+    wheel.insert(id(0), wheel.start + ms(far));
+    let mut expired = Vec::new();
+    wheel.expire(wheel.start + ms(SPAN - 1), &mut expired);
+    assert!(expired.is_empty());
+    wheel.expire(wheel.start + ms(far - 1), &mut expired);
+    assert!(expired.is_empty());
+    wheel.expire(wheel.start + ms(far), &mut expired);
+    assert_eq!(expired, vec![id(0)]);
+  }
+
+  #[test]
+  fn test_across_rotations() {
+    let mut wheel = TimerWheel::with_capacity(8);
+    let mut expired = Vec::new();
+    wheel.expire(wheel.start + ms(SPAN - 5), &mut expired);
+    wheel.insert(id(0), wheel.start + ms(SPAN + 3));
+    assert_eq!(wheel.next_deadline(), Some(wheel.start + ms(SPAN)));
+    assert_eq!(run_to(&mut wheel, SPAN + 5), vec![(id(0), SPAN + 3)]);
+  }
+}
@@ -59,4 +59,35 @@ pub trait TypedOp: Send + Sync + 'static {
   fn extract_result(self, op_result: isize) -> Self::Result;
 }
 
+/// An operation that completes more than once, like a multishot receive.
+///
+/// Consumed through [`IoStream`](crate::api::io::IoStream), which yields one
+/// item per completion. The op stays submitted until the backend reports a
+/// completion without the "more" flag.
+#[allow(clippy::wrong_self_convention)]
+pub trait MultishotOp: Send + Sync + 'static {
+  /// The typed value produced by each completion.
+  type Item: Send + Sync;
+
+  /// Convert this operation into the type-erased Op enum.
+  ///
+  /// Called again with the same `self` when the stream re-arms the op.
+  fn into_op(&mut self) -> Op;
+
+  /// Extract one item from a raw completion.
+  ///
+  /// `buf_id` is the [`BufRing`](crate::buf::BufRing) buffer the completion
+  /// filled, if any. Returning `None` produces no item, e.g for EOF.
+  fn extract_item(&self, res: isize, buf_id: Option<u16>)
+  -> Option<Self::Item>;
+
+  /// Whether the final completion `res` only stopped the op early.
+  ///
+  /// The stream then re-submits the op on the next poll instead of ending.
+  fn resumable(&self, res: isize) -> bool {
+    let _ = res;
+    false
+  }
+}
+
 pub struct ResultNotMatching;
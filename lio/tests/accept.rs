@@ -293,3 +293,34 @@ fn test_accept_ipv6() {
 
   assert!(accepted_fd.as_fd().as_raw_fd() >= 0);
 }
+
+#[test]
+fn test_accept_peer_addr_and_without() {
+  use std::os::fd::{FromRawFd, IntoRawFd};
+
+  let mut lio = Lio::new(64).unwrap();
+  let listener = std::net::TcpListener::bind("127.0.0.1:0").unwrap();
+  let addr = listener.local_addr().unwrap();
+  // SAFETY: The fd comes from into_raw_fd, so the resource owns it.
+  let server_sock = unsafe {
+    lio::api::resource::Resource::from_raw_fd(listener.into_raw_fd())
+  };
+
+  let client_a = std::net::TcpStream::connect(addr).unwrap();
+  let client_b = std::net::TcpStream::connect(addr).unwrap();
+
+  // The peer address lands in storage inline in the op.
+  let (sender_a, receiver_a) = mpsc::channel();
+  api::accept(&server_sock).with_lio(&mut lio).send_with(sender_a);
+  let (_, peer) =
+    poll_until_recv(&mut lio, &receiver_a).expect("Failed to accept");
+  assert_eq!(peer, client_a.local_addr().unwrap());
+
+  // Works on TCP too, without asking for the address.
+  let (sender_b, receiver_b) = mpsc::channel();
+  api::accept_unix(&server_sock).with_lio(&mut lio).send_with(sender_b);
+  let accepted =
+    poll_until_recv(&mut lio, &receiver_b).expect("Failed to accept");
+  assert!(accepted.as_fd().as_raw_fd() >= 0);
+  drop(client_b);
+}
@@ -2,8 +2,13 @@ use std::{
   ffi::CString, mem::MaybeUninit, net::SocketAddr, sync::mpsc, time::Duration,
 };
 
-use lio::{Lio, api, api::io::Receiver, api::resource::Resource};
-use std::os::fd::{AsFd, AsRawFd};
+use lio::{
+  Lio, api,
+  api::io::{IoStream, Receiver},
+  api::resource::Resource,
+  typed_op::MultishotOp,
+};
+use std::os::fd::{AsFd, AsRawFd, FromRawFd};
 
 /// Utility function to create a unique temporary file path for proptest tests.
 /// Returns a CString path that includes the process ID and a unique value to avoid conflicts.
@@ -117,6 +122,25 @@ impl Drop for TempFile {
   }
 }
 
+/// Opens `temp` with `flags`, creating it if needed.
+#[allow(dead_code)]
+pub fn open(temp: &TempFile, flags: libc::c_int) -> Resource {
+  // SAFETY: The path is NUL-terminated, and `open` hands back a fresh fd.
+  unsafe {
+    Resource::from_raw_fd(libc::open(
+      temp.path.as_ptr(),
+      libc::O_CREAT | flags,
+      0o644,
+    ))
+  }
+}
+
+/// Opens `temp` for reading and writing, empty.
+#[allow(dead_code)]
+pub fn open_rw(temp: &TempFile) -> Resource {
+  open(temp, libc::O_RDWR | libc::O_TRUNC)
+}
+
 /// Poll the lio event loop until a result is received on the channel.
 /// Blocks in kqueue/epoll for up to 5ms per iteration — no busy-spin, no attempt cap.
 pub fn poll_until_recv<T>(lio: &mut Lio, receiver: &mpsc::Receiver<T>) -> T {
@@ -165,3 +189,44 @@ pub fn poll_recv<T>(lio: &mut Lio, receiver: &mut Receiver<T>) -> T {
     lio.run_timeout(Duration::from_millis(5)).unwrap();
   }
 }
+
+/// Poll the lio event loop until `stream` yields its next item.
+///
+/// Returns `None` once the stream has finished.
+///
+/// # Panics
+///
+/// Panics if nothing happens within 5 seconds.
+#[allow(dead_code)]
+pub fn poll_stream<T: MultishotOp>(
+  lio: &mut Lio,
+  stream: &mut IoStream<T>,
+) -> Option<T::Item> {
+  let start = std::time::Instant::now();
+  let timeout = Duration::from_secs(5);
+
+  loop {
+    if let Some(item) = stream.try_next() {
+      return Some(item);
+    }
+    if stream.is_finished() {
+      return None;
+    }
+    if start.elapsed() > timeout {
+      panic!("poll_stream timed out after {:?} waiting for an item", timeout);
+    }
+    lio.run_timeout(Duration::from_millis(5)).unwrap();
+  }
+}
+
+/// Sends all of `data` on `sock`, polling the lio event loop until it's out.
+///
+/// # Panics
+///
+/// Panics if the send fails or comes up short.
+#[allow(dead_code)]
+pub fn send_all(lio: &mut Lio, sock: &Resource, data: &[u8]) {
+  let mut send = api::send(sock, data.to_vec(), None).with_lio(lio).send();
+  let (sent, _) = poll_recv(lio, &mut send);
+  assert_eq!(sent.expect("Failed to send") as usize, data.len());
+}
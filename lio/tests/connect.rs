@@ -490,3 +490,32 @@ fn test_connect_with_bind() {
 
   poll_until_recv(&mut lio, &receiver_c).expect("Failed to connect");
 }
+
+#[cfg(target_os = "linux")]
+#[test]
+fn test_connect_nonblocking_poller() {
+  use lio::api::resource::Resource;
+  use lio::backends::pollingv2::Poller;
+  use std::os::fd::FromRawFd;
+
+  let mut lio = Lio::new_with_backend(Poller::new(), 64).unwrap();
+  let listener = std::net::TcpListener::bind("127.0.0.1:0").unwrap();
+  let addr = listener.local_addr().unwrap();
+
+  // A non-blocking socket starts with EINPROGRESS, so the poller has to
+  // wait for writability and finish the connect from there.
+  // SAFETY: Plain socket() call, the fd is owned by the Resource.
+  let client = unsafe {
+    let fd =
+      libc::socket(libc::AF_INET, libc::SOCK_STREAM | libc::SOCK_NONBLOCK, 0);
+    assert!(fd >= 0, "socket failed");
+    Resource::from_raw_fd(fd)
+  };
+
+  let (sender, receiver) = mpsc::channel();
+  connect(&client, addr).with_lio(&mut lio).send_with(sender);
+  poll_until_recv(&mut lio, &receiver).expect("Failed to connect");
+
+  let (_server, peer) = listener.accept().unwrap();
+  assert_eq!(peer.ip(), addr.ip());
+}
@@ -201,3 +201,5 @@ ffi_test!(test_file_ops);
 ffi_test!(test_socket_ops);
 ffi_test!(test_send_recv);
 ffi_test!(test_error_handling);
+ffi_test!(test_batch);
+ffi_test!(test_buffers);
@@ -0,0 +1,149 @@
+/* test_batch.c - Tests for lio_submit_batch and lio_reap */
+#include "test_utils.h"
+
+#define BATCH 64
+
+/* Tick and reap until `want` completions landed in `cqes` */
+static int reap_until(lio_handle_t *lio, lio_cqe_t *cqes, int want, int max_iterations) {
+    int got = 0;
+    for (int i = 0; i < max_iterations && got < want; i++) {
+        lio_tick(lio);
+        got += lio_reap(lio, cqes + got, (unsigned int)(want - got));
+        if (got < want) usleep(1000);
+    }
+    return got;
+}
+
+/* ─── Tests ──────────────────────────────────────────────────────────────── */
+
+static void test_batch_nops(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    lio_sqe_t sqes[BATCH];
+    memset(sqes, 0, sizeof(sqes));
+    int seen[BATCH] = {0};
+    for (int i = 0; i < BATCH; i++) {
+        sqes[i].opcode = LIO_SQE_NOP;
+        sqes[i].user_data = &seen[i];
+    }
+
+    ASSERT_EQ(lio_submit_batch(lio, sqes, BATCH), BATCH, "every nop should be submitted");
+
+    lio_cqe_t cqes[BATCH];
+    ASSERT_EQ(reap_until(lio, cqes, BATCH, 1000), BATCH, "every nop should complete");
+    for (int i = 0; i < BATCH; i++) {
+        ASSERT_EQ(cqes[i].res, 0, "nop should return 0");
+        (*(int *)cqes[i].user_data)++;
+    }
+    for (int i = 0; i < BATCH; i++) {
+        ASSERT_EQ(seen[i], 1, "each user_data should come back once");
+    }
+    ASSERT_EQ(lio_reap(lio, cqes, BATCH), 0, "nothing should be left to reap");
+
+    lio_destroy(lio);
+    TEST_PASS("test_batch_nops");
+}
+
+static void test_batch_write_read(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    char path[256];
+    int fd = create_temp_file(path, sizeof(path));
+    ASSERT_GE(fd, 0, "temp file creation should succeed");
+
+    char data[] = "batched";
+    lio_sqe_t wr;
+    memset(&wr, 0, sizeof(wr));
+    wr.opcode = LIO_SQE_WRITE;
+    wr.fd = fd;
+    wr.buf = data;
+    wr.len = strlen(data);
+    wr.offset = 0;
+    wr.user_data = data;
+    ASSERT_EQ(lio_submit_batch(lio, &wr, 1), 1, "write should be submitted");
+
+    lio_cqe_t cqe;
+    ASSERT_EQ(reap_until(lio, &cqe, 1, 1000), 1, "write should complete");
+    ASSERT_EQ(cqe.res, (int)strlen(data), "write should return bytes written");
+    ASSERT(cqe.user_data == data, "write should hand back its user_data");
+
+    char buf[16] = {0};
+    lio_sqe_t rd;
+    memset(&rd, 0, sizeof(rd));
+    rd.opcode = LIO_SQE_READ;
+    rd.fd = fd;
+    rd.buf = buf;
+    rd.len = sizeof(buf);
+    rd.offset = 0;
+    rd.user_data = buf;
+    ASSERT_EQ(lio_submit_batch(lio, &rd, 1), 1, "read should be submitted");
+
+    ASSERT_EQ(reap_until(lio, &cqe, 1, 1000), 1, "read should complete");
+    ASSERT_EQ(cqe.res, (int)strlen(data), "read should return bytes read");
+    ASSERT(cqe.user_data == buf, "read should hand back its user_data");
+    ASSERT(memcmp(buf, data, strlen(data)) == 0, "data should match");
+
+    close(fd);
+    unlink(path);
+    lio_destroy(lio);
+    TEST_PASS("test_batch_write_read");
+}
+
+static void test_batch_invalid_opcode(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    lio_sqe_t sqes[3];
+    memset(sqes, 0, sizeof(sqes));
+    sqes[0].opcode = LIO_SQE_NOP;
+    sqes[1].opcode = 0xffff;
+    sqes[2].opcode = LIO_SQE_NOP;
+
+    ASSERT_EQ(lio_submit_batch(lio, sqes, 3), 1, "submitting should stop at the bad entry");
+    ASSERT_EQ(lio_submit_batch(lio, sqes + 1, 2), -EINVAL, "a bad first entry should fail");
+
+    lio_cqe_t cqes[3];
+    ASSERT_EQ(reap_until(lio, cqes, 1, 1000), 1, "the first nop should complete");
+
+    lio_destroy(lio);
+    TEST_PASS("test_batch_invalid_opcode");
+}
+
+static void test_batch_fd_stays_open(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    char path[256];
+    int fd = create_temp_file(path, sizeof(path));
+    ASSERT_GE(fd, 0, "temp file creation should succeed");
+
+    lio_sqe_t sq;
+    memset(&sq, 0, sizeof(sq));
+    sq.opcode = LIO_SQE_FSYNC;
+    sq.fd = fd;
+    ASSERT_EQ(lio_submit_batch(lio, &sq, 1), 1, "fsync should be submitted");
+
+    lio_cqe_t cqe;
+    ASSERT_EQ(reap_until(lio, &cqe, 1, 1000), 1, "fsync should complete");
+    ASSERT_EQ(cqe.res, 0, "fsync should return 0");
+    ASSERT_GE(fcntl(fd, F_GETFD), 0, "the caller's fd should stay open");
+
+    close(fd);
+    unlink(path);
+    lio_destroy(lio);
+    TEST_PASS("test_batch_fd_stays_open");
+}
+
+int main(void) {
+    printf("=== Batch Tests ===\n");
+
+    test_batch_nops();
+    test_batch_write_read();
+    test_batch_invalid_opcode();
+    test_batch_fd_stays_open();
+
+    printf(GREEN "All batch tests passed\n" RESET);
+    return 0;
+}
@@ -0,0 +1,218 @@
+/* test_buffers.c - Tests for the _borrowed operations and the buffer pool */
+#include "test_utils.h"
+
+/* ─── Callback state ─────────────────────────────────────────────────────── */
+
+static volatile int g_rw_called = 0;
+static int g_rw_result = -999;
+static uint8_t *g_rw_buf = NULL;
+static size_t g_rw_len = 0;
+
+static volatile int g_fixed_called = 0;
+static int g_fixed_result = -999;
+static uint32_t g_fixed_index = UINT32_MAX;
+
+static void rw_callback(int result, uint8_t *buf, size_t len) {
+    g_rw_result = result;
+    g_rw_buf = buf;
+    g_rw_len = len;
+    g_rw_called = 1;
+}
+
+static void fixed_callback(int result, uint32_t index) {
+    g_fixed_result = result;
+    g_fixed_index = index;
+    g_fixed_called = 1;
+}
+
+static void reset_state(void) {
+    g_rw_called = 0;
+    g_rw_result = -999;
+    g_rw_buf = NULL;
+    g_rw_len = 0;
+    g_fixed_called = 0;
+    g_fixed_result = -999;
+    g_fixed_index = UINT32_MAX;
+}
+
+static lio_handle_t *create_with_pool(unsigned int buf_count, unsigned int buf_len) {
+    lio_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.capacity = TEST_CAPACITY;
+    config.buf_count = buf_count;
+    config.buf_len = buf_len;
+    return lio_create_ex(&config);
+}
+
+/* ─── Borrowed Tests ─────────────────────────────────────────────────────── */
+
+static void test_borrowed_write_read(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    char path[256];
+    int fd = create_temp_file(path, sizeof(path));
+    ASSERT_GE(fd, 0, "temp file creation should succeed");
+
+    /* Stack buffers, nothing is malloc'd */
+    uint8_t data[64];
+    memset(data, 0xAB, sizeof(data));
+
+    reset_state();
+    lio_write_at_borrowed(lio, fd, data, sizeof(data), 0, rw_callback);
+    tick_until_flag(lio, &g_rw_called, 1000);
+    ASSERT(g_rw_called, "write callback should be called");
+    ASSERT_EQ(g_rw_result, (int)sizeof(data), "should write all bytes");
+    ASSERT(g_rw_buf == data, "callback should hand back the caller's buffer");
+
+    uint8_t out[64];
+    memset(out, 0, sizeof(out));
+
+    reset_state();
+    lio_read_at_borrowed(lio, fd, out, sizeof(out), 0, rw_callback);
+    tick_until_flag(lio, &g_rw_called, 1000);
+    ASSERT(g_rw_called, "read callback should be called");
+    ASSERT_EQ(g_rw_result, (int)sizeof(out), "should read all bytes");
+    ASSERT(g_rw_buf == out, "callback should hand back the caller's buffer");
+    ASSERT_EQ(g_rw_len, sizeof(out), "len should be the bytes read");
+    ASSERT(verify_buffer_pattern(out, sizeof(out), 0xAB), "data should match");
+
+    close(fd);
+    unlink(path);
+    lio_destroy(lio);
+    TEST_PASS("test_borrowed_write_read");
+}
+
+static void test_borrowed_send_recv(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    int sv[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0, "socketpair should succeed");
+
+    char msg[] = "borrowed";
+    reset_state();
+    lio_send_borrowed(lio, sv[0], (uint8_t *)msg, strlen(msg), 0, rw_callback);
+    tick_until_flag(lio, &g_rw_called, 1000);
+    ASSERT_EQ(g_rw_result, (int)strlen(msg), "should send all bytes");
+
+    char buf[32] = {0};
+    reset_state();
+    lio_recv_borrowed(lio, sv[1], (uint8_t *)buf, sizeof(buf), 0, rw_callback);
+    tick_until_flag(lio, &g_rw_called, 1000);
+    ASSERT_EQ(g_rw_result, (int)strlen(msg), "should receive all bytes");
+    ASSERT(g_rw_buf == (uint8_t *)buf, "callback should hand back the caller's buffer");
+    ASSERT(memcmp(buf, msg, strlen(msg)) == 0, "data should match");
+
+    close(sv[0]);
+    close(sv[1]);
+    lio_destroy(lio);
+    TEST_PASS("test_borrowed_send_recv");
+}
+
+static void test_borrowed_null_buf(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    reset_state();
+    uint64_t id = lio_read_at_borrowed(lio, 0, NULL, 16, 0, rw_callback);
+    ASSERT(id == LIO_NO_OP, "a null buffer should not be submitted");
+    ASSERT(g_rw_called, "callback should be called right away");
+    ASSERT_EQ(g_rw_result, -EINVAL, "a null buffer should get EINVAL");
+
+    lio_destroy(lio);
+    TEST_PASS("test_borrowed_null_buf");
+}
+
+/* ─── Pool Tests ─────────────────────────────────────────────────────────── */
+
+static void test_buf_get_put(void) {
+    lio_handle_t *lio = create_with_pool(2, 0);
+    ASSERT_NOT_NULL(lio, "lio_create_ex should succeed");
+
+    lio_buf_t a, b, c;
+    ASSERT_EQ(lio_buf_get(lio, 100, &a), 0, "first buffer should be lent");
+    ASSERT_EQ(lio_buf_get(lio, 100, &b), 0, "second buffer should be lent");
+    ASSERT_NOT_NULL(a.data, "buffer should have data");
+    ASSERT_EQ(a.cap, 4096, "buffers should default to 4096 bytes");
+    ASSERT(a.index != b.index, "buffers should be distinct");
+    ASSERT_EQ(lio_buf_get(lio, 100, &c), -ENOBUFS, "pool should be empty");
+    ASSERT_EQ(lio_buf_get(lio, 8192, &c), -ENOBUFS, "no buffer should fit");
+
+    memset(a.data, 0xCD, a.cap);
+    ASSERT_EQ(lio_buf_put(lio, a.index), 0, "put should succeed");
+    ASSERT_EQ(lio_buf_put(lio, a.index), -EINVAL, "put twice should fail");
+    ASSERT_EQ(lio_buf_get(lio, 100, &c), 0, "returned buffer should be lent again");
+    ASSERT_EQ(c.index, a.index, "the returned buffer should be reused");
+
+    lio_destroy(lio);
+
+    lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+    ASSERT_EQ(lio_buf_get(lio, 100, &c), -ENOTSUP, "lio_create has no pool");
+    ASSERT_EQ(lio_buf_put(lio, 0), -EINVAL, "lio_create has no pool");
+    lio_destroy(lio);
+
+    TEST_PASS("test_buf_get_put");
+}
+
+static void test_fixed_write_read(void) {
+    lio_handle_t *lio = create_with_pool(2, 512);
+    ASSERT_NOT_NULL(lio, "lio_create_ex should succeed");
+
+    char path[256];
+    int fd = create_temp_file(path, sizeof(path));
+    ASSERT_GE(fd, 0, "temp file creation should succeed");
+
+    lio_buf_t wr, rd;
+    ASSERT_EQ(lio_buf_get(lio, 512, &wr), 0, "write buffer should be lent");
+    ASSERT_EQ(wr.cap, 512, "buffer should be 512 bytes");
+    memcpy(wr.data, "fixed", 5);
+
+    reset_state();
+    lio_write_fixed(lio, fd, wr.index, 5, 0, fixed_callback);
+    tick_until_flag(lio, &g_fixed_called, 1000);
+    ASSERT(g_fixed_called, "write callback should be called");
+    ASSERT_EQ(g_fixed_result, 5, "should write 5 bytes");
+    ASSERT_EQ(g_fixed_index, wr.index, "callback should name the buffer");
+
+    ASSERT_EQ(lio_buf_get(lio, 0, &rd), 0, "read buffer should be lent");
+    reset_state();
+    lio_read_fixed(lio, fd, rd.index, 0, fixed_callback);
+    tick_until_flag(lio, &g_fixed_called, 1000);
+    ASSERT(g_fixed_called, "read callback should be called");
+    ASSERT_EQ(g_fixed_result, 5, "should read 5 bytes");
+    ASSERT_EQ(g_fixed_index, rd.index, "callback should name the buffer");
+    ASSERT(memcmp(rd.data, "fixed", 5) == 0, "data should match");
+
+    reset_state();
+    uint64_t id = lio_write_fixed(lio, fd, wr.index, 513, 0, fixed_callback);
+    ASSERT(id == LIO_NO_OP, "an oversized write should not be submitted");
+    ASSERT_EQ(g_fixed_result, -EINVAL, "an oversized write should get EINVAL");
+
+    ASSERT_EQ(lio_buf_put(lio, wr.index), 0, "write buffer should be put back");
+    ASSERT_EQ(lio_buf_put(lio, rd.index), 0, "read buffer should be put back");
+
+    reset_state();
+    id = lio_read_fixed(lio, fd, rd.index, 0, fixed_callback);
+    ASSERT(id == LIO_NO_OP, "a buffer that isn't lent should not be submitted");
+    ASSERT_EQ(g_fixed_result, -EINVAL, "a buffer that isn't lent should get EINVAL");
+
+    close(fd);
+    unlink(path);
+    lio_destroy(lio);
+    TEST_PASS("test_fixed_write_read");
+}
+
+int main(void) {
+    printf("=== Buffer Tests ===\n");
+
+    test_borrowed_write_read();
+    test_borrowed_send_recv();
+    test_borrowed_null_buf();
+    test_buf_get_put();
+    test_fixed_write_read();
+
+    printf(GREEN "All buffer tests passed\n" RESET);
+    return 0;
+}
@@ -20,6 +20,52 @@ static void test_create_zero_capacity(void) {
     TEST_PASS("test_create_zero_capacity");
 }
 
+static void test_create_ex_defaults(void) {
+    lio_config_t config = {0};
+    config.capacity = TEST_CAPACITY;
+
+    lio_handle_t *lio = lio_create_ex(&config);
+    ASSERT_NOT_NULL(lio, "lio_create_ex with a zeroed config should succeed");
+
+    int result = lio_tick(lio);
+    ASSERT_GE(result, 0, "tick on empty queue should return >= 0");
+
+    lio_destroy(lio);
+    TEST_PASS("test_create_ex_defaults");
+}
+
+static void test_create_ex_cq_entries(void) {
+    lio_config_t config = {0};
+    config.capacity = TEST_CAPACITY;
+    config.cq_entries = TEST_CAPACITY * 8;
+
+    lio_handle_t *lio = lio_create_ex(&config);
+    ASSERT_NOT_NULL(lio, "lio_create_ex with cq_entries should succeed");
+
+    lio_destroy(lio);
+    TEST_PASS("test_create_ex_cq_entries");
+}
+
+static void test_create_ex_sqpoll(void) {
+    /* SQPOLL needs privileges on older kernels, so failing is allowed */
+    lio_config_t config = {0};
+    config.capacity = TEST_CAPACITY;
+    config.flags = LIO_CONFIG_SQPOLL;
+    config.sqpoll_idle_ms = 10;
+
+    lio_handle_t *lio = lio_create_ex(&config);
+    if (lio) {
+        lio_destroy(lio);
+    }
+    TEST_PASS("test_create_ex_sqpoll");
+}
+
+static void test_create_ex_null(void) {
+    lio_handle_t *lio = lio_create_ex(NULL);
+    ASSERT_NULL(lio, "lio_create_ex(NULL) should fail");
+    TEST_PASS("test_create_ex_null");
+}
+
 static void test_destroy_null(void) {
     /* Should not crash */
     lio_destroy(NULL);
@@ -45,6 +91,10 @@ int main(void) {
 
     test_create_destroy();
     test_create_zero_capacity();
+    test_create_ex_defaults();
+    test_create_ex_cq_entries();
+    test_create_ex_sqpoll();
+    test_create_ex_null();
     test_destroy_null();
     test_tick_empty();
 
@@ -27,6 +27,20 @@ static void recv_callback(int result, uint8_t *buf, size_t len) {
     g_recv_called = 1;
 }
 
+static volatile int g_vec_called = 0;
+static int g_vec_result = -999;
+static int g_vec_count = -1;
+static void *g_vec_bases[4];
+
+static void vec_callback(int result, const struct iovec *iov, int iovcnt) {
+    g_vec_result = result;
+    g_vec_count = iovcnt;
+    for (int i = 0; i < iovcnt && i < 4; i++) {
+        g_vec_bases[i] = iov[i].iov_base;
+    }
+    g_vec_called = 1;
+}
+
 /* ─── Helper: Create connected socket pair ──────────────────────────────── */
 
 static int create_socket_pair(int *server_fd, int *client_fd, int *accepted_fd) {
@@ -252,6 +266,100 @@ static void test_send_recv_buffer_roundtrip(void) {
     TEST_PASS("test_send_recv_buffer_roundtrip");
 }
 
+/* ─── Vectored Tests ─────────────────────────────────────────────────────── */
+
+static void test_sendmsg_two_buffers(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    int server_fd, client_fd, accepted_fd;
+    int ret = create_socket_pair(&server_fd, &client_fd, &accepted_fd);
+    ASSERT_EQ(ret, 0, "socket pair creation should succeed");
+
+    struct iovec iov[2];
+    iov[0].iov_base = malloc(6);
+    iov[0].iov_len = 6;
+    memcpy(iov[0].iov_base, "HEADER", 6);
+    iov[1].iov_base = malloc(4);
+    iov[1].iov_len = 4;
+    memcpy(iov[1].iov_base, "BODY", 4);
+
+    g_vec_called = 0;
+    lio_sendmsg(lio, client_fd, iov, 2, NULL, 0, 0, vec_callback);
+    tick_until_flag(lio, &g_vec_called, 1000);
+
+    ASSERT(g_vec_called, "sendmsg callback should be called");
+    ASSERT_EQ(g_vec_result, 10, "sendmsg should send both buffers");
+    ASSERT_EQ(g_vec_count, 2, "both buffers should be returned");
+
+    char received[16] = {0};
+    ssize_t n = recv(accepted_fd, received, sizeof(received), 0);
+    ASSERT_EQ(n, 10, "peer should receive both buffers");
+    ASSERT(memcmp(received, "HEADERBODY", 10) == 0, "data should arrive in order");
+    free(g_vec_bases[0]);
+    free(g_vec_bases[1]);
+
+    close(accepted_fd);
+    close(client_fd);
+    close(server_fd);
+    lio_destroy(lio);
+    TEST_PASS("test_sendmsg_two_buffers");
+}
+
+static void test_writev_socket(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    int server_fd, client_fd, accepted_fd;
+    int ret = create_socket_pair(&server_fd, &client_fd, &accepted_fd);
+    ASSERT_EQ(ret, 0, "socket pair creation should succeed");
+
+    struct iovec iov[3];
+    const char *parts[3] = {"a", "bc", "def"};
+    for (int i = 0; i < 3; i++) {
+        iov[i].iov_len = strlen(parts[i]);
+        iov[i].iov_base = malloc(iov[i].iov_len);
+        memcpy(iov[i].iov_base, parts[i], iov[i].iov_len);
+    }
+
+    g_vec_called = 0;
+    lio_writev(lio, client_fd, iov, 3, vec_callback);
+    tick_until_flag(lio, &g_vec_called, 1000);
+
+    ASSERT(g_vec_called, "writev callback should be called");
+    ASSERT_EQ(g_vec_result, 6, "writev should write every buffer");
+    ASSERT_EQ(g_vec_count, 3, "every buffer should be returned");
+
+    char received[8] = {0};
+    ssize_t n = recv(accepted_fd, received, sizeof(received), 0);
+    ASSERT_EQ(n, 6, "peer should receive every buffer");
+    ASSERT(memcmp(received, "abcdef", 6) == 0, "data should arrive in order");
+    for (int i = 0; i < 3; i++) {
+        free(g_vec_bases[i]);
+    }
+
+    close(accepted_fd);
+    close(client_fd);
+    close(server_fd);
+    lio_destroy(lio);
+    TEST_PASS("test_writev_socket");
+}
+
+static void test_writev_invalid(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    g_vec_called = 0;
+    lio_writev(lio, 1, NULL, 2, vec_callback);
+
+    ASSERT(g_vec_called, "invalid list should call back right away");
+    ASSERT_EQ(g_vec_result, -EINVAL, "invalid list should fail with EINVAL");
+    ASSERT_EQ(g_vec_count, 0, "no buffers should be returned");
+
+    lio_destroy(lio);
+    TEST_PASS("test_writev_invalid");
+}
+
 /* ─── Main ───────────────────────────────────────────────────────────────── */
 
 int main(void) {
@@ -262,6 +370,9 @@ int main(void) {
     test_recv_basic();
     test_recv_invalid_fd();
     test_send_recv_buffer_roundtrip();
+    test_sendmsg_two_buffers();
+    test_writev_socket();
+    test_writev_invalid();
 
     printf(GREEN "All send/recv tests passed\n" RESET);
     return 0;
@@ -40,6 +40,21 @@ static void accept_callback(intptr_t result, const struct sockaddr_storage *addr
     g_accept_called = 1;
 }
 
+/* The address is only valid during the callback, so copy it out */
+static struct sockaddr_storage g_accept_peer;
+
+static void accept_addr_callback(intptr_t result, const struct sockaddr_storage *addr) {
+    g_accept_result = result;
+    g_accept_addr = addr;
+    if (addr) g_accept_peer = *addr;
+    g_accept_called = 1;
+}
+
+static void accept_fd_callback(intptr_t result) {
+    g_accept_result = result;
+    g_accept_called = 1;
+}
+
 static void shutdown_callback(int result) {
     g_shutdown_result = result;
     g_shutdown_called = 1;
@@ -300,6 +315,66 @@ static void test_full_server_flow(void) {
     TEST_PASS("test_full_server_flow");
 }
 
+/* Listening loopback socket; its address goes to `addr` */
+static int listen_loopback(struct sockaddr_in *addr) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    *addr = make_loopback_addr(0);
+    socklen_t addr_len = sizeof(*addr);
+    if (bind(fd, (struct sockaddr*)addr, sizeof(*addr)) != 0 ||
+        listen(fd, 2) != 0 ||
+        getsockname(fd, (struct sockaddr*)addr, &addr_len) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void test_accept_without_alloc(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    struct sockaddr_in addr;
+    int server_fd = listen_loopback(&addr);
+    ASSERT_GE(server_fd, 0, "listening socket should be set up");
+
+    int client_a = socket(AF_INET, SOCK_STREAM, 0);
+    int client_b = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(connect(client_a, (struct sockaddr*)&addr, sizeof(addr)), 0, "connect should succeed");
+    ASSERT_EQ(connect(client_b, (struct sockaddr*)&addr, sizeof(addr)), 0, "connect should succeed");
+
+    /* Peer address lent for the callback, nothing to free */
+    g_accept_called = 0;
+    memset(&g_accept_peer, 0, sizeof(g_accept_peer));
+    lio_accept_addr(lio, server_fd, accept_addr_callback);
+    tick_until_flag(lio, &g_accept_called, 2000);
+    ASSERT(g_accept_called, "accept callback should be called");
+    ASSERT_GE(g_accept_result, 0, "accept should return valid fd");
+    ASSERT_NOT_NULL(g_accept_addr, "accept should pass the peer address");
+    ASSERT_EQ(g_accept_peer.ss_family, AF_INET, "peer should be IPv4");
+    close((int)g_accept_result);
+
+    /* No peer address at all */
+    g_accept_called = 0;
+    g_accept_result = -999;
+    lio_accept_fd(lio, server_fd, accept_fd_callback);
+    tick_until_flag(lio, &g_accept_called, 2000);
+    ASSERT(g_accept_called, "accept callback should be called");
+    ASSERT_GE(g_accept_result, 0, "accept should return valid fd");
+    close((int)g_accept_result);
+
+    g_accept_called = 0;
+    lio_accept_fd(lio, 999999, accept_fd_callback);
+    tick_until_flag(lio, &g_accept_called, 1000);
+    ASSERT_LT(g_accept_result, 0, "accept on invalid fd should fail");
+
+    close(client_a);
+    close(client_b);
+    close(server_fd);
+    lio_destroy(lio);
+    TEST_PASS("test_accept_without_alloc");
+}
+
 /* ─── Main ───────────────────────────────────────────────────────────────── */
 
 int main(void) {
@@ -324,6 +399,7 @@ int main(void) {
 
     /* Integration */
     test_full_server_flow();
+    test_accept_without_alloc();
 
     printf(GREEN "All socket operation tests passed\n" RESET);
     return 0;
@@ -1,4 +1,4 @@
-/* test_timeout.c - Tests for lio_timeout */
+/* test_timeout.c - Tests for lio_timeout and the blocking lio_run variants */
 #include "test_utils.h"
 #include <sys/time.h>
 
@@ -104,6 +104,96 @@ static void test_timeout_timing(void) {
     TEST_PASS("test_timeout_timing");
 }
 
+static void test_timeout_cancel(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    g_timeout_called = 0;
+    g_timeout_result = -999;
+
+    uint64_t id = lio_timeout(lio, 10000, timeout_callback);
+    ASSERT(id != LIO_NO_OP, "timeout should be submitted");
+    ASSERT_EQ(lio_cancel(lio, id), 0, "lio_cancel should succeed");
+    tick_until_flag(lio, &g_timeout_called, 1000);
+
+    ASSERT(g_timeout_called, "cancelled timeout callback should be called");
+    ASSERT_EQ(g_timeout_result, -ECANCELED,
+              "cancelled timeout should return -ECANCELED");
+
+    /* Cancelling an op that completed does nothing. */
+    ASSERT_EQ(lio_cancel(lio, id), 0, "lio_cancel after completion is a no-op");
+
+    lio_destroy(lio);
+    TEST_PASS("test_timeout_cancel");
+}
+
+static long elapsed_ms_since(const struct timeval *start) {
+    struct timeval end;
+    gettimeofday(&end, NULL);
+    return (end.tv_sec - start->tv_sec) * 1000 +
+           (end.tv_usec - start->tv_usec) / 1000;
+}
+
+static void test_run_blocks(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    g_timeout_called = 0;
+
+    struct timeval start;
+    gettimeofday(&start, NULL);
+
+    lio_timeout(lio, 20, timeout_callback);
+    while (!g_timeout_called) {
+        ASSERT_GE(lio_run(lio), 0, "lio_run should succeed");
+    }
+
+    ASSERT_GE(elapsed_ms_since(&start), 10, "lio_run should wait for the timeout");
+
+    lio_destroy(lio);
+    TEST_PASS("test_run_blocks");
+}
+
+static void test_run_timeout_expires(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    struct timeval start;
+    gettimeofday(&start, NULL);
+
+    ASSERT_EQ(lio_run_timeout(lio, 20 * 1000000ull), 0,
+              "lio_run_timeout without operations should return 0");
+    long elapsed_ms = elapsed_ms_since(&start);
+    ASSERT_GE(elapsed_ms, 10, "lio_run_timeout should wait");
+    ASSERT_LT(elapsed_ms, 200, "lio_run_timeout should give up");
+
+    lio_destroy(lio);
+    TEST_PASS("test_run_timeout_expires");
+}
+
+static void test_run_min_complete(void) {
+    lio_handle_t *lio = lio_create(TEST_CAPACITY);
+    ASSERT_NOT_NULL(lio, "lio_create should succeed");
+
+    g_timeout_count = 0;
+
+    lio_timeout(lio, 5, timeout_count_callback);
+    lio_timeout(lio, 10, timeout_count_callback);
+    lio_timeout(lio, 15, timeout_count_callback);
+
+    ASSERT_GE(lio_run_min_complete(lio, 3, 1000 * 1000000ull), 3,
+              "lio_run_min_complete should wait for all three");
+    ASSERT_EQ(g_timeout_count, 3, "all three timeouts should complete");
+
+    /* Gives up once the timeout passes. */
+    lio_timeout(lio, 10000, timeout_count_callback);
+    ASSERT_EQ(lio_run_min_complete(lio, 1, 20 * 1000000ull), 0,
+              "lio_run_min_complete should time out");
+
+    lio_destroy(lio);
+    TEST_PASS("test_run_min_complete");
+}
+
 /* ─── Main ───────────────────────────────────────────────────────────────── */
 
 int main(void) {
@@ -113,6 +203,10 @@ int main(void) {
     test_timeout_zero();
     test_timeout_multiple();
     test_timeout_timing();
+    test_timeout_cancel();
+    test_run_blocks();
+    test_run_timeout_expires();
+    test_run_min_complete();
 
     printf(GREEN "All timeout tests passed\n" RESET);
     return 0;
@@ -0,0 +1,98 @@
+//! Tests for multishot accept through `TcpListener::incoming`.
+
+mod common;
+
+use common::poll_stream;
+use lio::Lio;
+use lio::api::resource::{AsResource, FromResource, Resource};
+use lio::net::TcpListener;
+use std::io::{Read, Write};
+use std::os::fd::{AsFd, AsRawFd, FromRawFd, IntoRawFd};
+
+fn std_listener() -> (TcpListener, std::net::SocketAddr) {
+  let listener = std::net::TcpListener::bind("127.0.0.1:0").unwrap();
+  let addr = listener.local_addr().unwrap();
+  // SAFETY: The fd is owned by `listener`, which gives it up here.
+  let res = unsafe { Resource::from_raw_fd(listener.into_raw_fd()) };
+  (TcpListener::from_resource(res), addr)
+}
+
+fn incoming_yields_each_connection(mut lio: Lio) {
+  let (listener, addr) = std_listener();
+  let mut incoming = listener.incoming().with_lio(&lio).stream();
+
+  for i in 0..4u8 {
+    let mut client = std::net::TcpStream::connect(addr).unwrap();
+    let socket = poll_stream(&mut lio, &mut incoming)
+      .expect("stream ended early")
+      .expect("accept failed");
+
+    // The accepted fd is the peer of `client`.
+    let fd = socket.as_resource().as_fd().as_raw_fd();
+    // SAFETY: fd stays open for the lifetime of `socket`, and the written
+    // bytes come from a live slice.
+    let sent = unsafe { libc::send(fd, [i].as_ptr().cast(), 1, 0) };
+    assert_eq!(sent, 1);
+    let mut byte = [0u8; 1];
+    client.read_exact(&mut byte).unwrap();
+    assert_eq!(byte[0], i);
+  }
+  assert!(!incoming.is_finished());
+}
+
+fn incoming_drains_backlog(mut lio: Lio) {
+  let (listener, addr) = std_listener();
+  let mut incoming = listener.incoming().with_lio(&lio).stream();
+
+  // Queued before anything is accepted, so they land in one readiness event.
+  let mut clients: Vec<_> =
+    (0..100).map(|_| std::net::TcpStream::connect(addr).unwrap()).collect();
+
+  let mut accepted = Vec::new();
+  while accepted.len() < clients.len() {
+    let socket = poll_stream(&mut lio, &mut incoming)
+      .expect("stream ended early")
+      .expect("accept failed");
+    accepted.push(socket);
+  }
+
+  for client in &mut clients {
+    client.write_all(b"x").unwrap();
+  }
+  assert_eq!(accepted.len(), 100);
+}
+
+#[test]
+fn test_incoming_yields_each_connection() {
+  incoming_yields_each_connection(Lio::new(64).unwrap());
+}
+
+#[test]
+fn test_incoming_drains_backlog() {
+  incoming_drains_backlog(Lio::new(256).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_incoming_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  incoming_yields_each_connection(
+    Lio::new_with_backend(Poller::new(), 64).unwrap(),
+  );
+  incoming_drains_backlog(Lio::new_with_backend(Poller::new(), 256).unwrap());
+}
+
+#[test]
+fn test_accept_multi_bad_fd() {
+  let mut lio = Lio::new(64).unwrap();
+  // SAFETY: -1 is never a valid fd, the op only reports the error.
+  let res = unsafe { Resource::from_raw_fd(-1) };
+  let mut conns = lio::api::accept_multi(&res).with_lio(&lio).stream();
+
+  let err = poll_stream(&mut lio, &mut conns)
+    .expect("stream ended without an error")
+    .expect_err("accept on a bad fd succeeded");
+  assert_eq!(err.raw_os_error(), Some(libc::EBADF));
+  assert!(poll_stream(&mut lio, &mut conns).is_none());
+}
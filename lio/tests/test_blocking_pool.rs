@@ -0,0 +1,83 @@
+//! Tests for the poller's blocking-I/O worker pool.
+#![cfg(target_os = "linux")]
+
+mod common;
+
+use common::{TempFile, open_rw, poll_recv, poll_until_recv};
+use lio::backends::pollingv2::Poller;
+use lio::{Lio, api};
+use std::sync::mpsc;
+use std::time::{Duration, Instant};
+
+#[test]
+fn test_blocking_pool_file_roundtrip() {
+  let mut lio =
+    Lio::new_with_backend(Poller::new().with_blocking_pool(2, 16), 64).unwrap();
+  let temp = TempFile::new("blocking_pool_roundtrip");
+  let fd = open_rw(&temp);
+
+  let mut recv =
+    api::write_at(&fd, b"hello pool".to_vec(), 0).with_lio(&lio).send();
+  let (res, _) = poll_recv(&mut lio, &mut recv);
+  assert_eq!(res.expect("write_at failed"), 10);
+
+  let mut recv = api::fsync(&fd).with_lio(&lio).send();
+  poll_recv(&mut lio, &mut recv).expect("fsync failed");
+
+  let mut recv = api::truncate(&fd, 5).with_lio(&lio).send();
+  poll_recv(&mut lio, &mut recv).expect("truncate failed");
+
+  let mut recv =
+    api::read_at(&fd, Vec::with_capacity(16), 0).with_lio(&lio).send();
+  let (res, buf) = poll_recv(&mut lio, &mut recv);
+  assert_eq!(res.expect("read_at failed"), 5);
+  assert_eq!(&buf[..], b"hello");
+}
+
+#[test]
+fn test_blocking_pool_full_queue_runs_inline() {
+  // One queue slot for 64 ops: most of them run on the loop thread.
+  let mut lio =
+    Lio::new_with_backend(Poller::new().with_blocking_pool(1, 1), 128).unwrap();
+  let temp = TempFile::new("blocking_pool_full_queue");
+  let fd = open_rw(&temp);
+
+  let (sender, receiver) = mpsc::channel();
+  for i in 0..64u8 {
+    api::write_at(&fd, vec![i; 8], i as i64 * 8)
+      .with_lio(&lio)
+      .send_with(sender.clone());
+  }
+  for _ in 0..64 {
+    let (res, _) = poll_until_recv(&mut lio, &receiver);
+    assert_eq!(res.expect("write_at failed"), 8);
+  }
+
+  let mut recv =
+    api::read_at(&fd, Vec::with_capacity(512), 0).with_lio(&lio).send();
+  let (res, buf) = poll_recv(&mut lio, &mut recv);
+  assert_eq!(res.expect("read_at failed"), 512);
+  for (i, chunk) in buf.chunks(8).enumerate() {
+    assert!(chunk.iter().all(|b| *b == i as u8), "block {i} is wrong");
+  }
+}
+
+#[test]
+fn test_blocking_pool_wakes_loop() {
+  let lio =
+    Lio::new_with_backend(Poller::new().with_blocking_pool(1, 4), 64).unwrap();
+  let temp = TempFile::new("blocking_pool_wakes_loop");
+  let fd = open_rw(&temp);
+
+  let mut recv = api::fsync(&fd).with_lio(&lio).send();
+  // Nothing else is registered, so only the worker's wakeup ends this early.
+  let start = Instant::now();
+  while recv.try_recv().is_none() {
+    lio.run_timeout(Duration::from_secs(10)).unwrap();
+  }
+  assert!(
+    start.elapsed() < Duration::from_secs(5),
+    "loop only noticed the fsync on timeout: {:?}",
+    start.elapsed()
+  );
+}
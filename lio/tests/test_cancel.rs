@@ -0,0 +1,157 @@
+//! Tests for `Lio::cancel` and cancelling dropped futures.
+
+mod common;
+
+use common::{poll_recv, setup_tcp_pair};
+use lio::{Lio, api};
+use std::future::{Future, IntoFuture};
+use std::os::fd::AsRawFd;
+use std::pin::pin;
+use std::task::{Context, Waker};
+use std::time::{Duration, Instant};
+
+/// Sends `data` from `sock` outside of lio.
+fn send_raw(sock: &impl AsRawFd, data: &[u8]) {
+  let sent = unsafe {
+    libc::send(sock.as_raw_fd(), data.as_ptr().cast(), data.len(), 0)
+  };
+  assert_eq!(sent, data.len() as isize);
+}
+
+/// Checks that nothing still waits on `accepted_fd`, which would take the
+/// data meant for a new recv.
+fn recv_after_cancel(lio: &mut Lio, pair: &common::TcpPair) {
+  send_raw(&pair.client_sock, b"ping");
+  let mut recv =
+    api::recv(&pair.accepted_fd, vec![0; 16], None).with_lio(lio).send();
+  let (received, buf) = poll_recv(lio, &mut recv);
+  assert_eq!(received.expect("Failed to recv") as usize, 4);
+  assert_eq!(&buf[..4], b"ping");
+}
+
+fn cancel_recv(mut lio: Lio) {
+  let pair = setup_tcp_pair(&mut lio);
+
+  let mut recv =
+    api::recv(&pair.accepted_fd, vec![0; 16], None).with_lio(&lio).send();
+  lio.try_run().unwrap();
+  lio.cancel(recv.id()).unwrap();
+  let (received, buf) = poll_recv(&mut lio, &mut recv);
+  assert_eq!(received.unwrap_err().raw_os_error(), Some(libc::ECANCELED));
+  assert_eq!(buf.len(), 16);
+
+  recv_after_cancel(&mut lio, &pair);
+}
+
+#[test]
+fn test_cancel_recv() {
+  cancel_recv(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_cancel_recv_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  cancel_recv(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+fn cancel_timeout(mut lio: Lio) {
+  let start = Instant::now();
+  let mut timeout = api::timeout(Duration::from_secs(10)).with_lio(&lio).send();
+  lio.cancel(timeout.id()).unwrap();
+  let res = poll_recv(&mut lio, &mut timeout);
+  assert_eq!(res.unwrap_err().raw_os_error(), Some(libc::ECANCELED));
+  assert!(start.elapsed() < Duration::from_secs(5));
+}
+
+#[test]
+fn test_cancel_timeout() {
+  cancel_timeout(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_cancel_timeout_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  cancel_timeout(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+fn cancel_completed(mut lio: Lio) {
+  let mut nop = api::nop().with_lio(&lio).send();
+  poll_recv(&mut lio, &mut nop).expect("Failed to nop");
+
+  // The id doesn't carry over to the next op in the same slot.
+  let mut next = api::nop().with_lio(&lio).send();
+  lio.cancel(nop.id()).unwrap();
+  poll_recv(&mut lio, &mut next).expect("Cancelled the wrong op");
+}
+
+#[test]
+fn test_cancel_completed() {
+  cancel_completed(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_cancel_completed_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  cancel_completed(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+fn drop_inflight_future(mut lio: Lio) {
+  let pair = setup_tcp_pair(&mut lio);
+
+  {
+    let mut future = pin!(
+      api::recv(&pair.accepted_fd, vec![0; 16], None)
+        .with_lio(&lio)
+        .into_future()
+    );
+    let mut cx = Context::from_waker(Waker::noop());
+    assert!(future.as_mut().poll(&mut cx).is_pending());
+    lio.try_run().unwrap();
+  }
+  // Let the cancelled recv complete, dropping its buffer.
+  for _ in 0..10 {
+    lio.run_timeout(Duration::from_millis(5)).unwrap();
+  }
+
+  recv_after_cancel(&mut lio, &pair);
+}
+
+#[test]
+fn test_drop_inflight_future() {
+  drop_inflight_future(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_drop_inflight_future_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  drop_inflight_future(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_cancel_chain_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  let mut lio = Lio::new_with_backend(Poller::new(), 64).unwrap();
+  let pair = setup_tcp_pair(&mut lio);
+
+  let mut chain = api::recv(&pair.accepted_fd, vec![0; 16], None)
+    .with_lio(&lio)
+    .link(api::send(&pair.accepted_fd, b"pong".to_vec(), None))
+    .send();
+  lio.try_run().unwrap();
+  lio.cancel(chain.id()).unwrap();
+  let ((received, _), (sent, _)) = poll_recv(&mut lio, &mut chain);
+  assert_eq!(received.unwrap_err().raw_os_error(), Some(libc::ECANCELED));
+  assert_eq!(sent.unwrap_err().raw_os_error(), Some(libc::ECANCELED));
+
+  recv_after_cancel(&mut lio, &pair);
+}
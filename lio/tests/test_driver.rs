@@ -1,5 +1,5 @@
-use lio::Lio;
 use lio::api::resource::Resource;
+use lio::{BusyPoll, Lio};
 
 #[test]
 fn test_worker_start_stop() {
@@ -23,3 +23,130 @@ fn test_worker_start_stop() {
     std::thread::sleep(std::time::Duration::from_micros(100));
   }
 }
+
+#[test]
+fn test_builder_cq_entries() {
+  let mut lio = Lio::builder(64).cq_entries(1024).build().unwrap();
+
+  let (sender, receiver) = std::sync::mpsc::channel();
+  lio::api::nop().with_lio(&mut lio).send_with(sender);
+
+  loop {
+    lio.try_run().unwrap();
+    if let Ok(res) = receiver.try_recv() {
+      res.unwrap();
+      break;
+    }
+    std::thread::sleep(std::time::Duration::from_micros(100));
+  }
+}
+
+#[test]
+fn test_busy_poll_run() {
+  let max = std::time::Duration::from_micros(50);
+  let lio =
+    Lio::builder(64).busy_poll(BusyPoll::Adaptive { max }).build().unwrap();
+
+  for _ in 0..32 {
+    let mut nop = lio::api::nop().with_lio(&lio).send();
+    while nop.try_recv().is_none() {
+      lio.run().unwrap();
+    }
+  }
+
+  // Spinning gives up in the end, a timeout still applies.
+  lio.set_busy_poll(BusyPoll::Fixed(std::time::Duration::from_secs(10)));
+  let start = std::time::Instant::now();
+  let timeout = std::time::Duration::from_millis(20);
+  assert_eq!(lio.run_timeout(timeout).unwrap(), 0);
+  assert!(start.elapsed() < std::time::Duration::from_secs(5));
+}
+
+#[cfg(unix)]
+fn run_min_complete_recvs(lio: Lio) {
+  use std::io::Write;
+  use std::os::fd::{FromRawFd, IntoRawFd};
+  use std::os::unix::net::UnixStream;
+
+  let (tx, rx) = std::sync::mpsc::channel();
+  let mut writers = Vec::new();
+  for _ in 0..4 {
+    let (read, write) = UnixStream::pair().unwrap();
+    read.set_nonblocking(true).unwrap();
+    // SAFETY: `read` gives up its fd.
+    let read = unsafe { Resource::from_raw_fd(read.into_raw_fd()) };
+    lio::api::recv(&read, vec![0; 8], None)
+      .with_lio(&lio)
+      .send_with(tx.clone());
+    writers.push((read, write));
+  }
+
+  // The recvs complete one by one, reaching the backend's wait for all.
+  let (socks, writers): (Vec<_>, Vec<_>) = writers.into_iter().unzip();
+  let writer = std::thread::spawn(move || {
+    for mut write in writers {
+      std::thread::sleep(std::time::Duration::from_millis(5));
+      write.write_all(b"x").unwrap();
+    }
+  });
+  let timeout = std::time::Duration::from_secs(5);
+  let done = lio.run_min_complete(4, Some(timeout)).unwrap();
+  assert!(done >= 4, "Returned after {done} completions");
+  for _ in 0..4 {
+    let (res, buf) = rx.try_recv().expect("Recv didn't complete");
+    assert_eq!(res.expect("Failed to recv"), 1);
+    assert_eq!(buf, b"x");
+  }
+  writer.join().unwrap();
+  drop(socks);
+}
+
+#[test]
+#[cfg(unix)]
+fn test_run_min_complete_recvs() {
+  run_min_complete_recvs(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_run_min_complete_recvs_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  run_min_complete_recvs(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+#[cfg(unix)]
+fn drop_with_pending_recv(lio: Lio) {
+  use std::io::Write;
+  use std::os::fd::{FromRawFd, IntoRawFd};
+  use std::os::unix::net::UnixStream;
+
+  let (read, mut write) = UnixStream::pair().unwrap();
+  read.set_nonblocking(true).unwrap();
+  // SAFETY: `read` gives up its fd.
+  let read = unsafe { Resource::from_raw_fd(read.into_raw_fd()) };
+  let (tx, rx) = std::sync::mpsc::channel();
+  lio::api::recv(&read, vec![0; 64], None).with_lio(&lio).send_with(tx);
+  lio.try_run().unwrap();
+
+  // The recv is cancelled before its buffer and callback are freed, so
+  // data arriving later lands nowhere.
+  drop(lio);
+  assert!(rx.recv().is_err(), "Cancelled recv reported a result");
+  write.write_all(b"late").unwrap();
+  drop(read);
+}
+
+#[test]
+#[cfg(unix)]
+fn test_drop_with_pending_recv() {
+  drop_with_pending_recv(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_drop_with_pending_recv_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  drop_with_pending_recv(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
@@ -0,0 +1,85 @@
+//! Tests for read_fixed/write_fixed on pooled (and registered) buffers.
+
+mod common;
+
+use common::{TempFile, open_rw, poll_recv, setup_tcp_pair};
+use lio::buf::BufStore;
+use lio::{Lio, api};
+
+fn leaked_store(cap: usize) -> &'static BufStore {
+  Box::leak(Box::new(BufStore::with_capacity(cap)))
+}
+
+fn send_recv_roundtrip(mut lio: Lio, store: &'static BufStore) {
+  let common::TcpPair { server_sock: _, client_sock, accepted_fd } =
+    setup_tcp_pair(&mut lio);
+
+  let mut out = store.try_get().unwrap();
+  out.extend_from_slice(b"Hello, fixed!");
+
+  let mut send = api::write_fixed(&client_sock, out).with_lio(&lio).send();
+  let (sent, out) = poll_recv(&mut lio, &mut send);
+  assert_eq!(sent.expect("Failed to send") as usize, 13);
+  // Everything was written, so nothing is left in the buffer.
+  assert!(out.as_ref().is_empty());
+
+  let mut recv = api::read_fixed(&accepted_fd, store.try_get().unwrap())
+    .with_lio(&lio)
+    .send();
+  let (received, buf) = poll_recv(&mut lio, &mut recv);
+  assert_eq!(received.expect("Failed to receive") as usize, 13);
+  assert_eq!(buf.as_ref(), b"Hello, fixed!");
+}
+
+#[test]
+fn test_fixed_send_recv_registered() {
+  let store = leaked_store(8);
+  let lio = Lio::new_with_buf_store(64, store).unwrap();
+  send_recv_roundtrip(lio, store);
+}
+
+#[test]
+fn test_fixed_send_recv_unregistered() {
+  // Buffers from a store that isn't registered fall back to plain read/write.
+  let store = leaked_store(8);
+  let lio = Lio::new(64).unwrap();
+  send_recv_roundtrip(lio, store);
+}
+
+#[test]
+fn test_fixed_buffer_from_other_store() {
+  let registered = leaked_store(2);
+  let other = leaked_store(2);
+  let lio = Lio::new_with_buf_store(64, registered).unwrap();
+  send_recv_roundtrip(lio, other);
+}
+
+#[test]
+fn test_fixed_write_at_read_at() {
+  let store = leaked_store(4);
+  let mut lio = Lio::new_with_buf_store(64, store).unwrap();
+  let temp = TempFile::new("fixed_write_at_read_at");
+  let fd = open_rw(&temp);
+
+  let mut out = store.try_get().unwrap();
+  out.extend_from_slice(b"registered buffers");
+  let mut write = api::write_at_fixed(&fd, out, 4).with_lio(&lio).send();
+  let (written, _out) = poll_recv(&mut lio, &mut write);
+  assert_eq!(written.expect("Failed to write") as usize, 18);
+
+  let mut read =
+    api::read_at_fixed(&fd, store.try_get().unwrap(), 4).with_lio(&lio).send();
+  let (read_bytes, buf) = poll_recv(&mut lio, &mut read);
+  assert_eq!(read_bytes.expect("Failed to read") as usize, 18);
+  assert_eq!(buf.as_ref(), b"registered buffers");
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_fixed_send_recv_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  let store = leaked_store(8);
+  let lio = Lio::new_with_backend(Poller::new(), 64).unwrap();
+  send_recv_roundtrip(lio, store);
+}
@@ -0,0 +1,115 @@
+//! Tests for ops on resources registered with `Lio::register_file`.
+
+mod common;
+
+use common::{TempFile, open_rw, poll_recv, setup_tcp_pair};
+use lio::{Lio, api};
+use std::os::fd::AsRawFd;
+
+fn write_read_roundtrip(mut lio: Lio) {
+  let temp = TempFile::new("fixed_files_roundtrip");
+  let fd = open_rw(&temp);
+  lio.register_file(&fd).unwrap();
+
+  let mut write =
+    api::write_at(&fd, b"registered file".to_vec(), 2).with_lio(&lio).send();
+  let (written, _) = poll_recv(&mut lio, &mut write);
+  assert_eq!(written.expect("Failed to write") as usize, 15);
+
+  let mut read = api::read_at(&fd, vec![0; 15], 2).with_lio(&lio).send();
+  let (read_bytes, buf) = poll_recv(&mut lio, &mut read);
+  assert_eq!(read_bytes.expect("Failed to read") as usize, 15);
+  assert_eq!(buf, b"registered file");
+
+  lio.unregister_file(&fd).unwrap();
+  let mut read = api::read_at(&fd, vec![0; 10], 2).with_lio(&lio).send();
+  let (read_bytes, buf) = poll_recv(&mut lio, &mut read);
+  assert_eq!(read_bytes.expect("Failed to read") as usize, 10);
+  assert_eq!(buf, b"registered");
+}
+
+#[test]
+fn test_fixed_file_write_read() {
+  write_read_roundtrip(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_fixed_file_write_read_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  write_read_roundtrip(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+#[test]
+fn test_fixed_file_fd_reused_after_drop() {
+  let mut lio = Lio::new(64).unwrap();
+  let old_temp = TempFile::new("fixed_files_old");
+  let new_temp = TempFile::new("fixed_files_new");
+
+  let old = open_rw(&old_temp);
+  let old_fd = old.as_raw_fd();
+  lio.register_file(&old).unwrap();
+  // Dropped without unregistering, so its fd number is free again.
+  drop(old);
+
+  let new = open_rw(&new_temp);
+  assert_eq!(new.as_raw_fd(), old_fd, "expected the fd number to be reused");
+
+  let mut write =
+    api::write_at(&new, b"new file".to_vec(), 0).with_lio(&lio).send();
+  let (written, _) = poll_recv(&mut lio, &mut write);
+  assert_eq!(written.expect("Failed to write") as usize, 8);
+
+  let path = new_temp.path.to_str().unwrap();
+  assert_eq!(std::fs::read(path).unwrap(), b"new file");
+  let path = old_temp.path.to_str().unwrap();
+  assert!(std::fs::read(path).unwrap().is_empty());
+}
+
+#[test]
+fn test_fixed_file_sockets() {
+  let mut lio = Lio::new(64).unwrap();
+  let common::TcpPair { server_sock: _, client_sock, accepted_fd } =
+    setup_tcp_pair(&mut lio);
+  lio.register_file(&client_sock).unwrap();
+  lio.register_file(&accepted_fd).unwrap();
+
+  let mut send = api::send(&client_sock, b"Hello, fixed!".to_vec(), None)
+    .with_lio(&lio)
+    .send();
+  let (sent, _) = poll_recv(&mut lio, &mut send);
+  assert_eq!(sent.expect("Failed to send") as usize, 13);
+
+  let mut recv =
+    api::recv(&accepted_fd, vec![0; 13], None).with_lio(&lio).send();
+  let (received, buf) = poll_recv(&mut lio, &mut recv);
+  assert_eq!(received.expect("Failed to receive") as usize, 13);
+  assert_eq!(buf, b"Hello, fixed!");
+}
+
+fn dropped_socket_closes(mut lio: Lio) {
+  let common::TcpPair { server_sock: _, client_sock, accepted_fd } =
+    setup_tcp_pair(&mut lio);
+  lio.register_file(&client_sock).unwrap();
+  // Never unregistered, the table lets go of it on the next run.
+  drop(client_sock);
+
+  let mut recv =
+    api::recv(&accepted_fd, vec![0; 16], None).with_lio(&lio).send();
+  let (received, _) = poll_recv(&mut lio, &mut recv);
+  assert_eq!(received.expect("Failed to receive"), 0, "peer saw no EOF");
+}
+
+#[test]
+fn test_fixed_file_dropped_socket_closes() {
+  dropped_socket_closes(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_fixed_file_dropped_socket_closes_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  dropped_socket_closes(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
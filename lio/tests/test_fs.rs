@@ -0,0 +1,258 @@
+//! Tests for `lio::fs`: opening files and direct I/O.
+
+mod common;
+
+use common::{TempFile, poll_recv};
+use lio::{
+  Lio,
+  api::resource::Resource,
+  buf::{AlignedBuf, BufStore, SizeClass},
+  fs::{self, File, OpenOptions, SequentialReader},
+};
+use std::future::IntoFuture;
+use std::io::Read;
+use std::os::fd::{FromRawFd, IntoRawFd};
+use std::os::unix::{fs::PermissionsExt, net::UnixStream};
+use std::pin::pin;
+use std::task::{Context, Poll, Waker};
+use std::time::Duration;
+
+fn path(temp: &TempFile) -> &str {
+  temp.path.to_str().unwrap()
+}
+
+#[test]
+fn test_file_write_read_at() {
+  let mut lio = Lio::new(64).unwrap();
+  let temp = TempFile::new("fs_write_read_at");
+
+  let mut open = OpenOptions::new()
+    .read(true)
+    .write(true)
+    .create(true)
+    .mode(0o600)
+    .open(path(&temp))
+    .with_lio(&lio)
+    .send();
+  let file = poll_recv(&mut lio, &mut open).expect("Failed to open");
+  assert_eq!(file.alignment(), None);
+
+  let mut write = file.write_at(b"hello".to_vec(), 3).with_lio(&lio).send();
+  let (result, _) = poll_recv(&mut lio, &mut write);
+  assert_eq!(result.expect("Failed to write"), 5);
+
+  let mut read = file.read_at(Vec::with_capacity(16), 0).with_lio(&lio).send();
+  let (result, buf) = poll_recv(&mut lio, &mut read);
+  assert_eq!(result.expect("Failed to read"), 8);
+  assert_eq!(buf, b"\0\0\0hello");
+
+  let mode = std::fs::metadata(path(&temp)).unwrap().permissions().mode();
+  assert_eq!(mode & 0o777, 0o600);
+}
+
+#[test]
+fn test_file_open_invalid_options() {
+  let mut lio = Lio::new(64).unwrap();
+
+  let mut open = OpenOptions::new().open("/tmp").with_lio(&lio).send();
+  let err =
+    poll_recv(&mut lio, &mut open).err().expect("Opened without access");
+  assert_eq!(err.kind(), std::io::ErrorKind::InvalidInput);
+
+  let mut open =
+    OpenOptions::new().read(true).open("/tmp/a\0b").with_lio(&lio).send();
+  let err = poll_recv(&mut lio, &mut open).err().expect("Opened nul path");
+  assert_eq!(err.kind(), std::io::ErrorKind::InvalidInput);
+}
+
+#[test]
+fn test_file_direct_checks_alignment() {
+  let mut lio = Lio::new(64).unwrap();
+  let temp = TempFile::new("fs_direct");
+
+  let mut open = OpenOptions::new()
+    .read(true)
+    .write(true)
+    .create(true)
+    .direct(true)
+    .direct_alignment(4096)
+    .open(path(&temp))
+    .with_lio(&lio)
+    .send();
+  let file = match poll_recv(&mut lio, &mut open) {
+    Ok(file) => file,
+    // The filesystem under /tmp doesn't do O_DIRECT.
+    Err(err) if err.raw_os_error() == Some(libc::EINVAL) => return,
+    Err(err) => panic!("Failed to open: {err}"),
+  };
+  assert_eq!(file.alignment(), Some(4096));
+
+  // Misaligned lengths and offsets fail before submitting.
+  let mut write = file.write_at(vec![1u8; 100], 0).with_lio(&lio).send();
+  let (result, buf) = poll_recv(&mut lio, &mut write);
+  assert_eq!(result.unwrap_err().raw_os_error(), Some(libc::EINVAL));
+  assert_eq!(buf, vec![1u8; 100]);
+
+  let mut write =
+    file.write_at(AlignedBuf::new(4096, 4096), 512).with_lio(&lio).send();
+  let (result, _) = poll_recv(&mut lio, &mut write);
+  assert_eq!(result.unwrap_err().raw_os_error(), Some(libc::EINVAL));
+
+  let mut buf = AlignedBuf::new(4096, 4096);
+  buf.as_mut_slice().fill(7);
+  let mut write = file.write_at(buf, 0).with_lio(&lio).send();
+  let (result, _) = poll_recv(&mut lio, &mut write);
+  assert_eq!(result.expect("Failed to write aligned"), 4096);
+
+  let mut read =
+    file.read_at(AlignedBuf::new(4096, 4096), 0).with_lio(&lio).send();
+  let (result, buf) = poll_recv(&mut lio, &mut read);
+  assert_eq!(result.expect("Failed to read aligned"), 4096);
+  assert!(buf.as_ref().iter().all(|&b| b == 7));
+}
+
+/// Runs `lio` until `fut` resolves.
+fn block_on<F: IntoFuture>(lio: &Lio, fut: F) -> F::Output {
+  let mut fut = pin!(fut.into_future());
+  let mut cx = Context::from_waker(Waker::noop());
+  loop {
+    if let Poll::Ready(out) = fut.as_mut().poll(&mut cx) {
+      return out;
+    }
+    lio.run_timeout(Duration::from_millis(5)).unwrap();
+  }
+}
+
+/// Copies `range` of a file holding `len` patterned bytes to a socket,
+/// returning what was sent and what the peer got. A `slow` peer reads a
+/// little at a time, so the socket fills up.
+fn copy_range(
+  lio: Lio,
+  name: &str,
+  len: usize,
+  range: std::ops::Range<u64>,
+  slow: bool,
+) -> (u64, Vec<u8>, Vec<u8>) {
+  let temp = TempFile::new(name);
+  let data: Vec<u8> = (0..len).map(|i| (i % 251) as u8).collect();
+  std::fs::write(path(&temp), &data).unwrap();
+
+  let file = block_on(&lio, File::open(path(&temp)).with_lio(&lio))
+    .expect("Failed to open");
+  let (ours, theirs) = UnixStream::pair().unwrap();
+  ours.set_nonblocking(true).unwrap();
+  let reader = std::thread::spawn(move || {
+    let mut got = Vec::new();
+    if !slow {
+      (&theirs).read_to_end(&mut got).unwrap();
+      return got;
+    }
+    let mut buf = [0; 4096];
+    loop {
+      std::thread::sleep(Duration::from_millis(1));
+      match (&theirs).read(&mut buf).unwrap() {
+        0 => return got,
+        n => got.extend_from_slice(&buf[..n]),
+      }
+    }
+  });
+  // SAFETY: `ours` gives up its fd.
+  let socket = unsafe { Resource::from_raw_fd(ours.into_raw_fd()) };
+
+  let copy = fs::copy_to_socket(&file, &socket, range)
+    .chunks(3)
+    .chunk_size(16 * 1024)
+    .with_lio(&lio);
+  let sent = block_on(&lio, copy).expect("Failed to copy");
+  drop(socket);
+  (sent, reader.join().unwrap(), data)
+}
+
+#[test]
+fn test_copy_to_socket() {
+  let lio = Lio::new(64).unwrap();
+  let (sent, got, data) =
+    copy_range(lio, "fs_copy", 300_000, 100..290_000, false);
+  assert_eq!(sent, 289_900);
+  assert!(got == data[100..290_000], "peer got the wrong bytes");
+}
+
+#[test]
+fn test_copy_to_socket_past_eof() {
+  let lio = Lio::new(64).unwrap();
+  let (sent, got, data) =
+    copy_range(lio.clone(), "fs_copy_eof", 50_000, 1000..80_000, false);
+  assert_eq!(sent, 49_000);
+  assert!(got == data[1000..], "peer got the wrong bytes");
+
+  let (sent, got, _) = copy_range(lio, "fs_copy_empty", 10, 5..5, false);
+  assert_eq!((sent, got.len()), (0, 0));
+}
+
+#[test]
+fn test_copy_to_socket_backpressure() {
+  let lio = Lio::new(64).unwrap();
+  let (sent, got, data) =
+    copy_range(lio, "fs_copy_slow", 1_000_000, 0..1_000_000, true);
+  assert_eq!(sent, 1_000_000);
+  assert!(got == data, "peer got the wrong bytes");
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_copy_to_socket_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  let lio = Lio::new_with_backend(Poller::new(), 64).unwrap();
+  let (sent, got, data) =
+    copy_range(lio, "fs_copy_poller", 1_000_000, 0..1_000_000, true);
+  assert_eq!(sent, 1_000_000);
+  assert!(got == data, "peer got the wrong bytes");
+}
+
+fn store(buf_len: usize, count: usize) -> &'static BufStore {
+  Box::leak(Box::new(BufStore::with_classes(&[SizeClass::new(buf_len, count)])))
+}
+
+#[test]
+fn test_sequential_reader_in_order() {
+  let lio = Lio::new(64).unwrap();
+  let temp = TempFile::new("fs_sequential");
+  let data: Vec<u8> = (0..1_000_000).map(|i| (i % 251) as u8).collect();
+  std::fs::write(path(&temp), &data).unwrap();
+  let file = block_on(&lio, File::open(path(&temp)).with_lio(&lio))
+    .expect("Failed to open");
+
+  let mut reader = SequentialReader::new(&file, store(16 * 1024, 8))
+    .offset(10)
+    .window(2)
+    .max_window(6)
+    .with_lio(&lio);
+  let mut got = Vec::new();
+  while let Some(chunk) = block_on(&lio, reader.next()) {
+    got.extend_from_slice(chunk.expect("Failed to read").as_ref());
+  }
+  assert!(got == data[10..], "chunks came out wrong");
+  assert!((2..=6).contains(&reader.current_window()));
+  assert!(block_on(&lio, reader.next()).is_none());
+}
+
+#[test]
+fn test_sequential_reader_out_of_buffers() {
+  let lio = Lio::new(64).unwrap();
+  let temp = TempFile::new("fs_sequential_nobufs");
+  std::fs::write(path(&temp), vec![1u8; 8192]).unwrap();
+  let file = block_on(&lio, File::open(path(&temp)).with_lio(&lio))
+    .expect("Failed to open");
+
+  let mut reader =
+    SequentialReader::new(&file, store(1024, 2)).window(2).with_lio(&lio);
+  let first = block_on(&lio, reader.next()).unwrap().unwrap();
+  let second = block_on(&lio, reader.next()).unwrap().unwrap();
+  let err = block_on(&lio, reader.next()).unwrap().err().expect("Got a chunk");
+  assert_eq!(err.raw_os_error(), Some(libc::ENOBUFS));
+
+  drop((first, second));
+  let third = block_on(&lio, reader.next()).unwrap().unwrap();
+  assert_eq!(third.as_ref(), [1u8; 1024]);
+}
@@ -0,0 +1,177 @@
+//! Tests for op chains built with `Io::link` and `Io::link_timeout`.
+
+mod common;
+
+use common::{TempFile, open, open_rw, poll_recv, setup_tcp_pair};
+use lio::{Lio, api};
+use std::os::fd::AsRawFd;
+use std::time::{Duration, Instant};
+
+fn write_then_fsync(mut lio: Lio) {
+  let temp = TempFile::new("linked_write_fsync");
+  let fd = open_rw(&temp);
+
+  let mut chain = api::write_at(&fd, b"wal record".to_vec(), 0)
+    .with_lio(&lio)
+    .link(api::fsync(&fd))
+    .send();
+  let ((written, buf), synced) = poll_recv(&mut lio, &mut chain);
+  assert_eq!(written.expect("Failed to write") as usize, 10);
+  assert_eq!(buf, b"wal record");
+  synced.expect("Failed to fsync");
+
+  let path = temp.path.to_str().unwrap();
+  assert_eq!(std::fs::read(path).unwrap(), b"wal record");
+}
+
+#[test]
+fn test_link_write_fsync() {
+  write_then_fsync(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_link_write_fsync_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  write_then_fsync(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+fn failed_op_cancels_rest(mut lio: Lio) {
+  let temp = TempFile::new("linked_failed_write");
+  let fd = open(&temp, libc::O_RDONLY);
+
+  let mut chain = api::write_at(&fd, b"nope".to_vec(), 0)
+    .with_lio(&lio)
+    .link(api::fsync(&fd))
+    .link(api::write_at(&fd, b"nope".to_vec(), 4))
+    .send();
+  let (((written, _), synced), (rest, _)) = poll_recv(&mut lio, &mut chain);
+  assert_eq!(written.unwrap_err().raw_os_error(), Some(libc::EBADF));
+  assert_eq!(synced.unwrap_err().raw_os_error(), Some(libc::ECANCELED));
+  assert_eq!(rest.unwrap_err().raw_os_error(), Some(libc::ECANCELED));
+}
+
+#[test]
+fn test_link_failed_op_cancels_rest() {
+  failed_op_cancels_rest(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_link_failed_op_cancels_rest_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  failed_op_cancels_rest(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+fn recv_times_out(mut lio: Lio) {
+  let common::TcpPair { server_sock: _, client_sock: _client, accepted_fd } =
+    setup_tcp_pair(&mut lio);
+
+  let start = Instant::now();
+  let mut recv = api::recv(&accepted_fd, vec![0; 16], None)
+    .with_lio(&lio)
+    .link_timeout(Duration::from_millis(50))
+    .send();
+  let (received, _) = poll_recv(&mut lio, &mut recv);
+  assert_eq!(received.unwrap_err().raw_os_error(), Some(libc::ECANCELED));
+  assert!(start.elapsed() >= Duration::from_millis(50));
+
+  // The cancelled recv left no registration behind on the socket.
+  let mut drain = api::recv(&accepted_fd, vec![0; 16], None)
+    .with_lio(&lio)
+    .link_timeout(Duration::from_millis(10))
+    .send();
+  let (received, _) = poll_recv(&mut lio, &mut drain);
+  assert_eq!(received.unwrap_err().raw_os_error(), Some(libc::ECANCELED));
+}
+
+#[test]
+fn test_link_timeout_recv_times_out() {
+  recv_times_out(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_link_timeout_recv_times_out_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  recv_times_out(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_link_timeout_recv_times_out_poller_edge() {
+  use lio::backends::pollingv2::Poller;
+
+  let lio = Lio::new_with_backend(Poller::new().edge_triggered(), 64).unwrap();
+  recv_times_out(lio);
+}
+
+fn recv_in_time(mut lio: Lio) {
+  let common::TcpPair { server_sock: _, client_sock, accepted_fd } =
+    setup_tcp_pair(&mut lio);
+
+  let mut recv = api::recv(&accepted_fd, vec![0; 16], None)
+    .with_lio(&lio)
+    .link_timeout(Duration::from_secs(5))
+    .link(api::send(&accepted_fd, b"pong".to_vec(), None))
+    .send();
+  let sent = unsafe {
+    libc::send(client_sock.as_raw_fd(), b"ping".as_ptr().cast(), 4, 0)
+  };
+  assert_eq!(sent, 4);
+
+  let start = Instant::now();
+  let ((received, buf), (sent, _)) = poll_recv(&mut lio, &mut recv);
+  assert!(start.elapsed() < Duration::from_secs(5));
+  assert_eq!(received.expect("Failed to recv") as usize, 4);
+  assert_eq!(&buf[..4], b"ping");
+  assert_eq!(sent.expect("Failed to send") as usize, 4);
+
+  let mut pong =
+    api::recv(&client_sock, vec![0; 16], None).with_lio(&lio).send();
+  let (received, buf) = poll_recv(&mut lio, &mut pong);
+  assert_eq!(received.expect("Failed to recv") as usize, 4);
+  assert_eq!(&buf[..4], b"pong");
+}
+
+#[test]
+fn test_link_timeout_recv_in_time() {
+  recv_in_time(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_link_timeout_recv_in_time_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  recv_in_time(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_link_future_poller() {
+  use lio::backends::pollingv2::Poller;
+  use std::future::{Future, IntoFuture};
+  use std::pin::pin;
+  use std::task::{Context, Poll, Waker};
+
+  let lio = Lio::new_with_backend(Poller::new(), 64).unwrap();
+  let mut future =
+    pin!(api::nop().with_lio(&lio).link(api::nop()).into_future());
+  let mut cx = Context::from_waker(Waker::noop());
+
+  assert!(future.as_mut().poll(&mut cx).is_pending());
+  let start = Instant::now();
+  loop {
+    lio.run_timeout(Duration::from_millis(5)).unwrap();
+    if let Poll::Ready((first, second)) = future.as_mut().poll(&mut cx) {
+      first.expect("Failed to nop");
+      second.expect("Failed to nop");
+      break;
+    }
+    assert!(start.elapsed() < Duration::from_secs(5), "chain never finished");
+  }
+}
@@ -0,0 +1,56 @@
+//! Tests for `Lio::stats` with the `metrics` feature.
+#![cfg(feature = "metrics")]
+
+mod common;
+
+use common::poll_recv;
+use lio::{Lio, api, backends::pollingv2::Poller, metrics::OpKind};
+use std::time::Duration;
+
+fn lio() -> Lio {
+  Lio::new_with_backend(Poller::new(), 64).unwrap()
+}
+
+#[test]
+fn test_metrics_counts_ops() {
+  let mut lio = lio();
+
+  let mut nops: Vec<_> =
+    (0..3).map(|_| api::nop().with_lio(&lio).send()).collect();
+  let mut timeout =
+    api::timeout(Duration::from_millis(1)).with_lio(&lio).send();
+  assert_eq!(lio.stats().in_flight, 4);
+
+  for nop in &mut nops {
+    poll_recv(&mut lio, nop).expect("Failed to nop");
+  }
+  poll_recv(&mut lio, &mut timeout).expect("Failed to time out");
+
+  let stats = lio.stats();
+  assert_eq!(stats.capacity, 64);
+  assert_eq!(stats.in_flight, 0);
+  assert_eq!((stats.submitted, stats.completed), (4, 4));
+  assert!(stats.ticks > 0);
+  assert_eq!(stats.completions.sum(), 4);
+
+  let nop = stats.op(OpKind::Nop);
+  assert_eq!((nop.submitted, nop.completed, nop.failed), (3, 3, 0));
+  assert_eq!(nop.latency.count(), 3);
+  let timeout = stats.op(OpKind::Timeout);
+  assert!(timeout.latency.max() >= 1_000_000, "timed out early");
+
+  let kinds: Vec<_> = stats.ops().map(|(kind, _)| kind).collect();
+  assert_eq!(kinds, [OpKind::Timeout, OpKind::Nop]);
+}
+
+#[test]
+fn test_metrics_counts_failures() {
+  let mut lio = lio();
+
+  let mut close = api::close(-1).with_lio(&lio).send();
+  assert!(poll_recv(&mut lio, &mut close).is_err());
+
+  let stats = lio.stats();
+  let close = stats.op(OpKind::Close);
+  assert_eq!((close.completed, close.failed), (1, 1));
+}
@@ -0,0 +1,119 @@
+//! Tests for multishot recv into a shared BufRing.
+
+mod common;
+
+use common::{poll_stream, send_all, setup_tcp_pair};
+use lio::api::resource::Resource;
+use lio::{Lio, api};
+
+fn recv_until_eof(mut lio: Lio) {
+  let common::TcpPair { server_sock: _, client_sock, accepted_fd } =
+    setup_tcp_pair(&mut lio);
+  let ring = lio.register_buf_ring(8, 64).unwrap();
+
+  let mut chunks =
+    api::recv_multi(&accepted_fd, &ring, None).with_lio(&lio).stream();
+
+  let mut received = Vec::new();
+  for msg in [&b"first "[..], &b"second "[..], &b"third"[..]] {
+    send_all(&mut lio, &client_sock, msg);
+    let chunk = poll_stream(&mut lio, &mut chunks)
+      .expect("stream ended early")
+      .expect("recv failed");
+    received.extend_from_slice(&chunk);
+  }
+  assert_eq!(received, b"first second third");
+
+  drop(client_sock);
+  assert!(poll_stream(&mut lio, &mut chunks).is_none());
+  assert!(chunks.is_finished());
+}
+
+fn recv_resumes_after_enobufs(mut lio: Lio) {
+  let common::TcpPair { server_sock: _, client_sock, accepted_fd } =
+    setup_tcp_pair(&mut lio);
+  let ring = lio.register_buf_ring(2, 8).unwrap();
+
+  let mut chunks =
+    api::recv_multi(&accepted_fd, &ring, None).with_lio(&lio).stream();
+  send_all(&mut lio, &client_sock, &[7u8; 32]);
+
+  // Both buffers end up held here, so the ring runs dry.
+  let mut held = Vec::new();
+  let mut received = 0;
+  let err = loop {
+    match poll_stream(&mut lio, &mut chunks).expect("stream ended early") {
+      Ok(chunk) => {
+        received += chunk.len();
+        held.push(chunk);
+      }
+      Err(err) => break err,
+    }
+  };
+  assert_eq!(err.raw_os_error(), Some(libc::ENOBUFS));
+  assert_eq!(held.len(), 2);
+
+  drop(held);
+  while received < 32 {
+    let chunk = poll_stream(&mut lio, &mut chunks)
+      .expect("stream ended early")
+      .expect("recv failed after buffers were returned");
+    assert!(chunk.iter().all(|b| *b == 7));
+    received += chunk.len();
+  }
+  assert_eq!(received, 32);
+}
+
+#[test]
+fn test_recv_multi_until_eof() {
+  recv_until_eof(Lio::new(64).unwrap());
+}
+
+#[test]
+fn test_recv_multi_resumes_after_enobufs() {
+  recv_resumes_after_enobufs(Lio::new(64).unwrap());
+}
+
+#[test]
+fn test_tcp_socket_recv_multi_shares_ring() {
+  use lio::api::resource::FromResource;
+  use lio::net::TcpSocket;
+  use std::io::Write;
+  use std::net::TcpListener;
+  use std::os::fd::{FromRawFd, IntoRawFd};
+
+  let lio = Lio::new(64).unwrap();
+  let listener = TcpListener::bind("127.0.0.1:0").unwrap();
+  let addr = listener.local_addr().unwrap();
+  let ring = lio.register_buf_ring(4, 128).unwrap();
+
+  let mut clients = Vec::new();
+  let mut streams = Vec::new();
+  for _ in 0..16 {
+    clients.push(std::net::TcpStream::connect(addr).unwrap());
+    let (accepted, _) = listener.accept().unwrap();
+    // SAFETY: The fd is owned by `accepted`, which gives it up here.
+    let res = unsafe { Resource::from_raw_fd(accepted.into_raw_fd()) };
+    let socket = TcpSocket::from_resource(res);
+    streams.push(socket.recv_multi(&ring).with_lio(&lio).stream());
+  }
+
+  // 16 connections, 4 buffers: idle sockets hold none of them.
+  let mut lio = lio;
+  for (i, client) in clients.iter_mut().enumerate() {
+    client.write_all(format!("conn {i}").as_bytes()).unwrap();
+    let chunk = poll_stream(&mut lio, &mut streams[i])
+      .expect("stream ended early")
+      .expect("recv failed");
+    assert_eq!(&chunk[..], format!("conn {i}").as_bytes());
+  }
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_recv_multi_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  recv_until_eof(Lio::new_with_backend(Poller::new(), 64).unwrap());
+  recv_resumes_after_enobufs(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
@@ -0,0 +1,196 @@
+//! Tests for `LioRemote`, submitting to a Lio from other threads.
+
+use lio::{Lio, api};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, mpsc};
+use std::thread;
+use std::time::{Duration, Instant};
+
+/// Runs `lio` until `rx` got `n` results, failing after 5 seconds.
+fn run_until<T>(lio: &Lio, rx: &mpsc::Receiver<T>, n: usize) -> Vec<T> {
+  let start = Instant::now();
+  let mut got = Vec::new();
+  while got.len() < n {
+    assert!(start.elapsed() < Duration::from_secs(5), "remote work never ran");
+    lio.run_timeout(Duration::from_secs(1)).unwrap();
+    got.extend(rx.try_iter());
+  }
+  got
+}
+
+fn wakes_blocked_run(lio: Lio) {
+  let remote = lio.remote().unwrap();
+  let (tx, rx) = mpsc::channel();
+
+  let submitter = thread::spawn(move || {
+    thread::sleep(Duration::from_millis(50));
+    remote
+      .submit(move |lio| {
+        api::nop().with_lio(lio).send_with(tx);
+      })
+      .unwrap();
+  });
+
+  // Blocks with nothing in flight until the remote wakes it.
+  let start = Instant::now();
+  let results = run_until(&lio, &rx, 1);
+  assert!(start.elapsed() < Duration::from_secs(1), "run wasn't woken up");
+  results[0].as_ref().expect("Failed to nop");
+  submitter.join().unwrap();
+}
+
+#[test]
+fn test_remote_wakes_blocked_run() {
+  wakes_blocked_run(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_remote_wakes_blocked_run_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  wakes_blocked_run(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+fn many_threads(lio: Lio) {
+  const THREADS: usize = 4;
+  const PER_THREAD: usize = 50;
+
+  let (tx, rx) = mpsc::channel();
+  let submitters: Vec<_> = (0..THREADS)
+    .map(|_| {
+      let remote = lio.remote().unwrap();
+      let tx = tx.clone();
+      thread::spawn(move || {
+        for _ in 0..PER_THREAD {
+          let tx = tx.clone();
+          let owner = thread::current().id();
+          remote
+            .submit(move |lio| {
+              api::nop().with_lio(lio).when_done(move |res| {
+                // Completions come back on the owning thread.
+                let _ = tx.send((res, thread::current().id() != owner));
+              });
+            })
+            .unwrap();
+        }
+      })
+    })
+    .collect();
+  drop(tx);
+
+  let results = run_until(&lio, &rx, THREADS * PER_THREAD);
+  for (res, on_owner) in results {
+    res.expect("Failed to nop");
+    assert!(on_owner, "completion ran on the submitting thread");
+  }
+  for submitter in submitters {
+    submitter.join().unwrap();
+  }
+}
+
+#[test]
+fn test_remote_many_threads() {
+  many_threads(Lio::new(256).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_remote_many_threads_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  many_threads(Lio::new_with_backend(Poller::new(), 256).unwrap());
+}
+
+fn ping_pong(lio: Lio) {
+  const ROUNDS: usize = 20_000;
+
+  let remote = lio.remote().unwrap();
+  let done = Arc::new(AtomicBool::new(false));
+  let finished = done.clone();
+  let submitter = thread::spawn(move || {
+    let (tx, rx) = mpsc::channel();
+    for round in 0..ROUNDS {
+      let tx = tx.clone();
+      remote
+        .submit(move |lio| {
+          api::nop().with_lio(lio).send_with(tx);
+        })
+        .unwrap();
+      // Each submission lands while the driver blocks with nothing else to
+      // do. A lost wake leaves it queued until the run times out.
+      let res = rx.recv_timeout(Duration::from_secs(5));
+      let res = res.unwrap_or_else(|_| panic!("wake lost in round {round}"));
+      res.expect("Failed to nop");
+    }
+    finished.store(true, Ordering::Release);
+    remote.wake();
+  });
+
+  while !done.load(Ordering::Acquire) && !submitter.is_finished() {
+    lio.run_timeout(Duration::from_secs(10)).unwrap();
+  }
+  submitter.join().unwrap();
+}
+
+#[test]
+fn test_remote_ping_pong() {
+  ping_pong(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_remote_ping_pong_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  ping_pong(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+fn run_min_complete_runs_jobs(lio: Lio) {
+  const JOBS: usize = 4;
+
+  let remote = lio.remote().unwrap();
+  let submitter = thread::spawn(move || {
+    for _ in 0..JOBS {
+      thread::sleep(Duration::from_millis(5));
+      remote
+        .submit(|lio| {
+          api::nop().with_lio(lio).when_done(|res| res.unwrap());
+        })
+        .unwrap();
+    }
+  });
+
+  // All the completions come from ops the jobs submit.
+  let start = Instant::now();
+  let done = lio.run_min_complete(JOBS, Some(Duration::from_secs(5))).unwrap();
+  assert_eq!(done, JOBS);
+  assert!(start.elapsed() < Duration::from_secs(5), "jobs didn't get to run");
+  submitter.join().unwrap();
+}
+
+#[test]
+fn test_remote_run_min_complete() {
+  run_min_complete_runs_jobs(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_remote_run_min_complete_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  run_min_complete_runs_jobs(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_remote_after_drop() {
+  use lio::backends::pollingv2::Poller;
+
+  let lio = Lio::new_with_backend(Poller::new(), 64).unwrap();
+  let remote = lio.remote().unwrap();
+  drop(lio);
+
+  let err = remote.submit(|_| panic!("ran after the Lio was dropped"));
+  assert_eq!(err.unwrap_err().kind(), std::io::ErrorKind::BrokenPipe);
+}
@@ -0,0 +1,126 @@
+//! Tests for the thread-per-core runtime in `lio::rt`.
+#![cfg(target_os = "linux")]
+
+use lio::{Lio, api, backends::pollingv2::Poller, rt};
+use std::collections::HashSet;
+use std::net::{SocketAddr, TcpStream};
+use std::sync::{Arc, Barrier, mpsc};
+use std::time::Duration;
+
+fn builder() -> rt::Builder {
+  rt::Builder::new()
+    .threads(2)
+    .lio(|_| Lio::new_with_backend(Poller::new(), 64))
+}
+
+/// Finds a port that's free right now.
+fn free_addr() -> SocketAddr {
+  let listener = std::net::TcpListener::bind("127.0.0.1:0").unwrap();
+  listener.local_addr().unwrap()
+}
+
+#[test]
+fn test_rt_runs_every_worker() {
+  let (tx, rx) = mpsc::channel();
+  let tx = std::sync::Mutex::new(tx);
+  let runtime = builder()
+    .spawn(move |worker| {
+      let tx = tx.lock().unwrap().clone();
+      let index = worker.index();
+      // Runs on the global installed for this thread.
+      api::nop().when_done(move |res| {
+        let _ = tx.send((index, res.is_ok(), std::thread::current().id()));
+      });
+      Ok(())
+    })
+    .unwrap();
+
+  let results: Vec<_> =
+    (0..2).map(|_| rx.recv_timeout(Duration::from_secs(5)).unwrap()).collect();
+  let indexes: HashSet<_> = results.iter().map(|(index, ..)| *index).collect();
+  let threads: HashSet<_> =
+    results.iter().map(|(.., thread)| *thread).collect();
+  assert_eq!(indexes, HashSet::from([0, 1]));
+  assert_eq!(threads.len(), 2, "workers share a thread");
+  assert!(results.iter().all(|(_, ok, _)| *ok), "Failed to nop");
+
+  runtime.shutdown();
+  runtime.join().unwrap();
+}
+
+#[test]
+fn test_rt_reuse_port() {
+  let addr = free_addr();
+  let (tx, rx) = mpsc::channel();
+  let tx = std::sync::Mutex::new(tx);
+  let listening = Arc::new(Barrier::new(3));
+  let workers_listening = listening.clone();
+  let runtime = builder()
+    .spawn(move |worker| {
+      let tx = tx.lock().unwrap().clone();
+      let index = worker.index();
+      let listener = worker.listen(addr)?;
+      workers_listening.wait();
+      listener.accept().when_done(move |res| {
+        let _ = tx.send((index, res.is_ok()));
+      });
+      Ok(())
+    })
+    .unwrap();
+  listening.wait();
+
+  // Each worker takes one connection; keep connecting until both did.
+  let mut clients = Vec::new();
+  let mut accepted = HashSet::new();
+  while accepted.len() < 2 {
+    assert!(clients.len() < 256, "one worker never accepted");
+    clients.push(TcpStream::connect(addr).unwrap());
+    while let Ok((index, ok)) = rx.recv_timeout(Duration::from_millis(20)) {
+      assert!(ok, "Failed to accept");
+      accepted.insert(index);
+    }
+  }
+
+  drop(runtime);
+}
+
+#[test]
+fn test_rt_shed() {
+  let (tx, rx) = mpsc::channel();
+  let tx = std::sync::Mutex::new(tx);
+  let runtime = builder()
+    .spawn(move |worker| {
+      if worker.index() == 0 {
+        let tx = tx.lock().unwrap().clone();
+        worker.shed(move |lio| {
+          api::nop().with_lio(lio).when_done(move |_| {
+            let name = std::thread::current().name().map(str::to_owned);
+            let _ = tx.send(name);
+          });
+        })?;
+      }
+      Ok(())
+    })
+    .unwrap();
+
+  let name = rx.recv_timeout(Duration::from_secs(5)).unwrap();
+  assert_eq!(name.as_deref(), Some("lio-rt-1"));
+  runtime.shutdown();
+  runtime.join().unwrap();
+}
+
+#[test]
+fn test_rt_setup_error() {
+  let runtime = builder()
+    .spawn(|worker| {
+      if worker.index() == 1 {
+        return Err(std::io::Error::other("setup failed"));
+      }
+      Ok(())
+    })
+    .unwrap();
+
+  // The failing worker shuts the others down.
+  let err = runtime.join().unwrap_err();
+  assert_eq!(err.to_string(), "setup failed");
+}
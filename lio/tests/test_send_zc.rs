@@ -0,0 +1,124 @@
+//! Tests for `api::send_zc`, which completes only once the kernel is done
+//! with the buffer.
+
+mod common;
+
+use common::{poll_recv, setup_tcp_pair};
+use lio::api::resource::Resource;
+use lio::{Lio, api};
+use std::os::fd::FromRawFd;
+
+fn pattern(len: usize) -> Vec<u8> {
+  (0..len).map(|i| (i % 251) as u8).collect()
+}
+
+fn recv_exact(lio: &mut Lio, sock: &Resource, len: usize) -> Vec<u8> {
+  let mut data = Vec::with_capacity(len);
+  while data.len() < len {
+    let mut recv = api::recv(sock, Vec::with_capacity(len - data.len()), None)
+      .with_lio(lio)
+      .send();
+    let (res, buf) = poll_recv(lio, &mut recv);
+    assert!(res.expect("Failed to recv") > 0, "peer closed early");
+    data.extend_from_slice(&buf);
+  }
+  data
+}
+
+fn send_zc_roundtrip(mut lio: Lio) {
+  let common::TcpPair { server_sock: _, client_sock, accepted_fd } =
+    setup_tcp_pair(&mut lio);
+
+  let data = pattern(64 * 1024);
+  let mut send =
+    api::send_zc(&client_sock, data.clone(), None).with_lio(&lio).send();
+  let (sent, buf) = poll_recv(&mut lio, &mut send);
+  let sent = sent.expect("Failed to send_zc") as usize;
+  assert!(sent > 0);
+  assert_eq!(buf.len(), data.len(), "buffer comes back whole");
+
+  assert_eq!(recv_exact(&mut lio, &accepted_fd, sent), data[..sent]);
+}
+
+#[test]
+fn test_send_zc() {
+  send_zc_roundtrip(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_send_zc_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  send_zc_roundtrip(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_send_zc_poller_edge() {
+  use lio::backends::pollingv2::Poller;
+
+  let lio = Lio::new_with_backend(Poller::new().edge_triggered(), 64).unwrap();
+  send_zc_roundtrip(lio);
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_send_zc_pipelined_edge() {
+  use lio::backends::pollingv2::Poller;
+
+  let mut lio =
+    Lio::new_with_backend(Poller::new().edge_triggered(), 64).unwrap();
+  let common::TcpPair { server_sock: _, client_sock, accepted_fd } =
+    setup_tcp_pair(&mut lio);
+
+  // In flight together, so their notifications may come as one range.
+  let mut sends: Vec<_> = (0..8u8)
+    .map(|i| {
+      api::send_zc(&client_sock, vec![i; 1024], None).with_lio(&lio).send()
+    })
+    .collect();
+  let mut total = 0;
+  for send in &mut sends {
+    let (sent, _) = poll_recv(&mut lio, send);
+    total += sent.expect("Failed to send_zc") as usize;
+  }
+  assert_eq!(total, 8 * 1024);
+
+  let data = recv_exact(&mut lio, &accepted_fd, total);
+  for (i, chunk) in data.chunks(1024).enumerate() {
+    assert!(chunk.iter().all(|&b| b == i as u8), "chunk {i} out of order");
+  }
+}
+
+#[cfg(target_os = "linux")]
+fn unix_socket_falls_back(mut lio: Lio) {
+  let mut fds = [0; 2];
+  let ret = unsafe {
+    libc::socketpair(libc::AF_UNIX, libc::SOCK_STREAM, 0, fds.as_mut_ptr())
+  };
+  assert_eq!(ret, 0);
+  let (a, b) =
+    unsafe { (Resource::from_raw_fd(fds[0]), Resource::from_raw_fd(fds[1])) };
+
+  // Unix sockets refuse SO_ZEROCOPY, so this is a plain send.
+  let mut send =
+    api::send_zc(&a, b"no zero-copy".to_vec(), None).with_lio(&lio).send();
+  let (sent, _) = poll_recv(&mut lio, &mut send);
+  assert_eq!(sent.expect("Failed to send_zc") as usize, 12);
+  assert_eq!(recv_exact(&mut lio, &b, 12), b"no zero-copy");
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_send_zc_unix_socket_falls_back() {
+  unix_socket_falls_back(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_send_zc_unix_socket_falls_back_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  unix_socket_falls_back(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
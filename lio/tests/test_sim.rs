@@ -0,0 +1,121 @@
+//! Tests for the fault-injecting `SimBackend` under a real driver.
+
+mod common;
+
+use common::{TempFile, poll_recv};
+use lio::{
+  Lio, api,
+  backends::{
+    pollingv2::Poller,
+    sim::{Rule, SimBackend},
+  },
+  fs::OpenOptions,
+  op::Op,
+};
+use std::time::{Duration, Instant};
+
+fn sim_lio(sim: SimBackend<Poller>) -> Lio {
+  Lio::new_with_backend(sim, 64).unwrap()
+}
+
+#[test]
+fn test_sim_short_writes() {
+  let short = Rule::short().when(|op| matches!(op, Op::WriteAt { .. }));
+  let mut lio = sim_lio(SimBackend::new(Poller::new(), 11).rule(short));
+  let temp = TempFile::new("sim_short");
+
+  let mut open = OpenOptions::new()
+    .write(true)
+    .create(true)
+    .open(temp.path.to_str().unwrap())
+    .with_lio(&lio)
+    .send();
+  let file = poll_recv(&mut lio, &mut open).expect("Failed to open");
+
+  // Retrying after short writes still gets it all out, in pieces.
+  let data: Vec<u8> = (0..4096).map(|i| (i % 251) as u8).collect();
+  let (mut written, mut writes) = (0, 0);
+  while written < data.len() {
+    let buf = data[written..].to_vec();
+    let mut write = file.write_at(buf, written as i64).with_lio(&lio).send();
+    let (result, _) = poll_recv(&mut lio, &mut write);
+    let n = result.expect("Failed to write") as usize;
+    assert!(n > 0 && n <= data.len() - written);
+    written += n;
+    writes += 1;
+  }
+  assert!(writes > 1, "no write came up short");
+  assert_eq!(std::fs::read(temp.path.to_str().unwrap()).unwrap(), data);
+}
+
+#[test]
+fn test_sim_eagain_storm() {
+  let storm = Rule::fail(libc::EAGAIN).rate(0.2).burst(4);
+  let mut lio = sim_lio(SimBackend::new(Poller::new(), 3).rule(storm));
+
+  let mut failures = Vec::new();
+  for _ in 0..64 {
+    let mut nop = api::nop().with_lio(&lio).send();
+    failures.push(poll_recv(&mut lio, &mut nop).is_err());
+  }
+  // Failures come in runs of at least four.
+  let mut run = 0;
+  for (i, &failed) in failures.iter().enumerate() {
+    run = if failed { run + 1 } else { 0 };
+    let next = failures.get(i + 1).copied().unwrap_or(false);
+    if failed && !next && i + 1 < failures.len() {
+      assert!(run >= 4, "run of {run} at {i}");
+    }
+  }
+  assert!(failures.contains(&true));
+}
+
+#[test]
+fn test_sim_delays_and_reorders() {
+  let delay = Rule::delay(Duration::from_millis(1)..Duration::from_millis(20));
+  let lio =
+    sim_lio(SimBackend::new(Poller::new(), 5).rule(delay).reorder(true));
+
+  let order = std::sync::Arc::new(std::sync::Mutex::new(Vec::new()));
+  let start = Instant::now();
+  for i in 0..16 {
+    let order = order.clone();
+    api::nop().with_lio(&lio).when_done(move |_| order.lock().unwrap().push(i));
+  }
+  while order.lock().unwrap().len() < 16 {
+    lio.run_timeout(Duration::from_secs(1)).unwrap();
+  }
+  assert!(start.elapsed() >= Duration::from_millis(1));
+  let order = order.lock().unwrap();
+  assert!(order.windows(2).any(|w| w[0] > w[1]), "came out in order");
+}
+
+#[test]
+fn test_sim_reorder_keeps_multishot_order() {
+  use lio::api::resource::Resource;
+  use std::io::Write;
+  use std::os::fd::{FromRawFd, IntoRawFd};
+  use std::os::unix::net::UnixStream;
+
+  let data: Vec<u8> = (0..=255).collect();
+  for seed in 0..8 {
+    let mut lio = sim_lio(SimBackend::new(Poller::new(), seed).reorder(true));
+    let ring = lio.register_buf_ring(32, 16).unwrap();
+    let (ours, mut theirs) = UnixStream::pair().unwrap();
+    ours.set_nonblocking(true).unwrap();
+    // SAFETY: `ours` gives up its fd.
+    let ours = unsafe { Resource::from_raw_fd(ours.into_raw_fd()) };
+
+    // Queued up with the EOF behind it, so the chunks and the end of the
+    // stream come back from one wait.
+    theirs.write_all(&data).unwrap();
+    drop(theirs);
+    let mut chunks =
+      api::recv_multi(&ours, &ring, None).with_lio(&lio).stream();
+    let mut got = Vec::new();
+    while let Some(chunk) = common::poll_stream(&mut lio, &mut chunks) {
+      got.extend_from_slice(&chunk.expect("recv failed"));
+    }
+    assert!(got == data, "chunks came out of order with seed {seed}");
+  }
+}
@@ -330,3 +330,60 @@ fn test_timeout_many_concurrent() {
     elapsed
   );
 }
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_timeout_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  let mut lio = Lio::new_with_backend(Poller::new(), 64).unwrap();
+
+  for timeout_duration in
+    [Duration::ZERO, Duration::from_micros(10), Duration::from_millis(20)]
+  {
+    let start = Instant::now();
+    let mut recv = api::timeout(timeout_duration).with_lio(&mut lio).send();
+    let result = poll_recv_timeout(&mut lio, &mut recv, Duration::from_secs(1))
+      .expect("Timeout on the poller backend never fired");
+
+    assert!(result.is_ok(), "Timeout should complete successfully");
+    assert!(
+      start.elapsed() >= timeout_duration,
+      "Should wait at least {:?}, waited {:?}",
+      timeout_duration,
+      start.elapsed()
+    );
+  }
+}
+
+fn run_min_complete(lio: Lio) {
+  let recvs: Vec<_> = [5, 10, 15]
+    .map(|ms| api::timeout(Duration::from_millis(ms)).with_lio(&lio).send())
+    .into();
+
+  let done = lio.run_min_complete(3, Some(Duration::from_secs(1))).unwrap();
+  assert!(done >= 3, "Returned after {done} completions");
+  for mut recv in recvs {
+    assert!(recv.try_recv().expect("Timeout didn't complete").is_ok());
+  }
+
+  // Gives up once the timeout passes.
+  let _pending = api::timeout(Duration::from_secs(10)).with_lio(&lio).send();
+  let start = Instant::now();
+  let done = lio.run_min_complete(1, Some(Duration::from_millis(20))).unwrap();
+  assert_eq!(done, 0);
+  assert!(start.elapsed() >= Duration::from_millis(20));
+}
+
+#[test]
+fn test_run_min_complete() {
+  run_min_complete(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_run_min_complete_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  run_min_complete(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
@@ -0,0 +1,290 @@
+//! Tests for `lio::net::UdpSocket`: datagrams, batches and offloads.
+
+mod common;
+
+use common::{poll_recv, poll_stream};
+use lio::{
+  Lio,
+  api::resource::{FromResource, Resource},
+  net::UdpSocket,
+};
+use std::future::IntoFuture;
+use std::os::fd::{FromRawFd, IntoRawFd};
+use std::pin::pin;
+use std::task::{Context, Poll, Waker};
+use std::time::Duration;
+
+/// A socket bound to a free loopback port.
+fn bind() -> UdpSocket {
+  let socket = std::net::UdpSocket::bind("127.0.0.1:0").unwrap();
+  socket.set_nonblocking(true).unwrap();
+  // SAFETY: `socket` gives up its fd.
+  let resource = unsafe { Resource::from_raw_fd(socket.into_raw_fd()) };
+  UdpSocket::from_resource(resource)
+}
+
+/// Runs `lio` until `fut` resolves.
+fn block_on<F: IntoFuture>(lio: &Lio, fut: F) -> F::Output {
+  let mut fut = pin!(fut.into_future());
+  let mut cx = Context::from_waker(Waker::noop());
+  loop {
+    if let Poll::Ready(out) = fut.as_mut().poll(&mut cx) {
+      return out;
+    }
+    lio.run_timeout(Duration::from_millis(5)).unwrap();
+  }
+}
+
+#[test]
+fn test_udp_send_to_recv_from() {
+  let mut lio = Lio::new(64).unwrap();
+  let (a, b) = (bind(), bind());
+  let (a_addr, b_addr) = (a.local_addr().unwrap(), b.local_addr().unwrap());
+
+  let mut recv = b.recv_from(Vec::with_capacity(64)).with_lio(&lio).send();
+  let mut send = a.send_to(b"hello".to_vec(), b_addr).with_lio(&lio).send();
+  let (result, _) = poll_recv(&mut lio, &mut send);
+  assert_eq!(result.expect("Failed to send"), 5);
+
+  let (result, buf) = poll_recv(&mut lio, &mut recv);
+  let (len, peer) = result.expect("Failed to recv");
+  assert_eq!((len, peer), (5, a_addr));
+  assert_eq!(buf, b"hello");
+}
+
+/// Sends 8 datagrams in batches of `per_batch`, receiving them with one
+/// multishot recv.
+fn send_batch_recv_multi(mut lio: Lio, per_batch: usize) {
+  let (a, b) = (bind(), bind());
+  let (a_addr, b_addr) = (a.local_addr().unwrap(), b.local_addr().unwrap());
+  let ring = lio.register_buf_ring(16, 256).unwrap();
+
+  let mut datagrams = b.recv_from_multi(&ring).with_lio(&lio).stream();
+  let sends: Vec<_> =
+    (0..8u8).map(|i| (vec![i; 10 + i as usize], b_addr)).collect();
+  let mut results = Vec::new();
+  for batch in sends.chunks(per_batch) {
+    let batch = a.send_batch(batch.to_vec()).with_lio(&lio);
+    results.extend(block_on(&lio, batch));
+  }
+  assert_eq!(results.len(), 8);
+  for (i, (result, _)) in results.into_iter().enumerate() {
+    assert_eq!(result.expect("Failed to send") as usize, 10 + i);
+  }
+
+  for i in 0..8u8 {
+    let datagram = poll_stream(&mut lio, &mut datagrams)
+      .expect("stream ended early")
+      .expect("recv failed");
+    assert_eq!(datagram.peer(), Some(a_addr));
+    assert!(!datagram.is_truncated());
+    assert_eq!(&datagram[..], vec![i; 10 + i as usize]);
+  }
+}
+
+#[test]
+fn test_udp_send_batch_recv_multi() {
+  send_batch_recv_multi(Lio::new(64).unwrap(), 8);
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_udp_send_batch_recv_multi_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  // One-shot registrations take one op per fd at a time.
+  let lio = Lio::new_with_backend(Poller::new(), 64).unwrap();
+  send_batch_recv_multi(lio, 1);
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_udp_send_batch_recv_multi_edge_triggered() {
+  use lio::backends::pollingv2::Poller;
+
+  let lio = Lio::new_with_backend(Poller::new().edge_triggered(), 64).unwrap();
+  send_batch_recv_multi(lio, 8);
+}
+
+/// Floods one socket and sends a single datagram to another: the second's
+/// datagram comes in before the first is drained.
+#[cfg(target_os = "linux")]
+fn recv_multi_fairness(mut lio: Lio) {
+  use lio::api::resource::AsResource;
+  use std::os::fd::AsRawFd;
+
+  const FLOOD: usize = 200;
+
+  let (a, b) = (bind(), bind());
+  let (a_addr, b_addr) = (a.local_addr().unwrap(), b.local_addr().unwrap());
+  let big: libc::c_int = 1 << 20;
+  // SAFETY: The fd is open and `big` outlives the call.
+  let res = unsafe {
+    libc::setsockopt(
+      a.as_resource().as_raw_fd(),
+      libc::SOL_SOCKET,
+      libc::SO_RCVBUF,
+      (&raw const big).cast(),
+      std::mem::size_of::<libc::c_int>() as libc::socklen_t,
+    )
+  };
+  assert_eq!(res, 0);
+  let (ring_a, ring_b) = (
+    lio.register_buf_ring(256, 256).unwrap(),
+    lio.register_buf_ring(16, 256).unwrap(),
+  );
+  let mut flooded = a.recv_from_multi(&ring_a).with_lio(&lio).stream();
+  let mut single = b.recv_from_multi(&ring_b).with_lio(&lio).stream();
+  // Both waiting before anything arrives.
+  assert!(flooded.try_next().is_none() && single.try_next().is_none());
+  lio.run_timeout(Duration::ZERO).unwrap();
+
+  let sender = std::net::UdpSocket::bind("127.0.0.1:0").unwrap();
+  for _ in 0..FLOOD {
+    sender.send_to(b"a", a_addr).unwrap();
+  }
+  sender.send_to(b"b", b_addr).unwrap();
+
+  let mut held = Vec::new();
+  let start = std::time::Instant::now();
+  let during = loop {
+    assert!(start.elapsed() < Duration::from_secs(5), "no datagram for b");
+    lio.run_timeout(Duration::from_millis(5)).unwrap();
+    while let Some(datagram) = flooded.try_next() {
+      held.push(datagram.expect("recv failed"));
+    }
+    if let Some(datagram) = single.try_next() {
+      assert_eq!(&datagram.expect("recv failed")[..], b"b");
+      break held.len();
+    }
+  };
+  assert!(during < FLOOD, "a was drained before b got a turn");
+
+  while held.len() < FLOOD {
+    let datagram = poll_stream(&mut lio, &mut flooded)
+      .expect("stream ended early")
+      .expect("recv failed");
+    held.push(datagram);
+  }
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_udp_recv_multi_fairness_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  recv_multi_fairness(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_udp_recv_multi_fairness_edge_triggered() {
+  use lio::backends::pollingv2::Poller;
+
+  let lio = Lio::new_with_backend(Poller::new().edge_triggered(), 64).unwrap();
+  recv_multi_fairness(lio);
+}
+
+#[cfg(target_os = "linux")]
+fn send_segments_gro(mut lio: Lio) {
+  let (a, b) = (bind(), bind());
+  let b_addr = b.local_addr().unwrap();
+  let gro = b.set_gro(true).is_ok();
+  let ring = lio.register_buf_ring(16, 8192).unwrap();
+
+  let mut datagrams = b.recv_from_multi(&ring).with_lio(&lio).stream();
+  let data: Vec<u8> = (0..4000).map(|i| (i % 251) as u8).collect();
+  let mut send =
+    a.send_segments_to(data.clone(), b_addr, 1000).with_lio(&lio).send();
+  match poll_recv(&mut lio, &mut send).0 {
+    Ok(sent) => assert_eq!(sent, 4000),
+    // No UDP segmentation offload in this kernel.
+    Err(err)
+      if matches!(
+        err.raw_os_error(),
+        Some(libc::EINVAL | libc::EIO | libc::ENOPROTOOPT)
+      ) =>
+    {
+      return;
+    }
+    Err(err) => panic!("Failed to send: {err}"),
+  }
+
+  // Four datagrams, coalesced back into fewer if GRO is on.
+  let mut got = Vec::new();
+  while got.len() < data.len() {
+    let datagram = poll_stream(&mut lio, &mut datagrams)
+      .expect("stream ended early")
+      .expect("recv failed");
+    if !gro {
+      assert_eq!(datagram.segment_size(), None);
+    }
+    for segment in datagram.segments() {
+      assert!(segment.len() <= 1000);
+      got.extend_from_slice(segment);
+    }
+  }
+  assert!(got == data, "segments came out wrong");
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_udp_send_segments_gro() {
+  send_segments_gro(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_udp_send_segments_gro_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  send_segments_gro(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_udp_send_segments_gro_edge_triggered() {
+  use lio::backends::pollingv2::Poller;
+
+  let lio = Lio::new_with_backend(Poller::new().edge_triggered(), 64).unwrap();
+  send_segments_gro(lio);
+}
+
+/// `SO_PREFER_BUSY_POLL` of `fd`, or `None` before Linux 5.11.
+#[cfg(target_os = "linux")]
+fn prefer_busy_poll(fd: std::os::fd::RawFd) -> Option<libc::c_int> {
+  let mut value: libc::c_int = 0;
+  let mut len = std::mem::size_of::<libc::c_int>() as libc::socklen_t;
+  let opt = libc::SO_PREFER_BUSY_POLL;
+  // SAFETY: `fd` is open and `value`/`len` outlive the call.
+  let res = unsafe {
+    libc::getsockopt(
+      fd,
+      libc::SOL_SOCKET,
+      opt,
+      (&raw mut value).cast(),
+      &mut len,
+    )
+  };
+  (res == 0).then_some(value)
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_udp_busy_poll_prefer() {
+  use lio::api::resource::AsResource;
+  use std::os::fd::AsRawFd;
+
+  let socket = bind();
+  let fd = socket.as_resource().as_raw_fd();
+  if prefer_busy_poll(fd).is_none() {
+    return;
+  }
+
+  socket.set_busy_poll(Duration::ZERO, false).unwrap();
+  assert_eq!(prefer_busy_poll(fd), Some(0));
+  socket.set_busy_poll(Duration::ZERO, true).unwrap();
+  assert_eq!(prefer_busy_poll(fd), Some(1));
+  socket.set_busy_poll(Duration::ZERO, false).unwrap();
+  assert_eq!(prefer_busy_poll(fd), Some(0), "prefer was left on");
+}
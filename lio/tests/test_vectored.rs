@@ -0,0 +1,117 @@
+//! Tests for the vectored ops: `readv`, `writev`, `sendmsg` and `recvmsg`.
+
+mod common;
+
+use common::{TempFile, open_rw, poll_recv, setup_tcp_pair};
+use lio::api::resource::Resource;
+use lio::{Lio, api};
+use std::net::SocketAddr;
+use std::os::fd::{AsRawFd, FromRawFd, IntoRawFd};
+
+fn writev_readv_roundtrip(mut lio: Lio) {
+  let temp = TempFile::new("vectored_roundtrip");
+  let fd = open_rw(&temp);
+
+  let bufs =
+    vec![b"Hello, ".to_vec(), b"vectored ".to_vec(), b"world".to_vec()];
+  let mut write = api::writev(&fd, bufs).with_lio(&lio).send();
+  let (written, bufs) = poll_recv(&mut lio, &mut write);
+  assert_eq!(written.expect("Failed to writev") as usize, 21);
+  assert_eq!(bufs.len(), 3);
+
+  let path = temp.path.to_str().unwrap();
+  assert_eq!(std::fs::read(path).unwrap(), b"Hello, vectored world");
+
+  // Readv continues from the file position, so rewind first.
+  unsafe { libc::lseek(fd.as_raw_fd(), 0, libc::SEEK_SET) };
+  let bufs = vec![Vec::with_capacity(7), Vec::with_capacity(20)];
+  let mut read = api::readv(&fd, bufs).with_lio(&lio).send();
+  let (read_bytes, bufs) = poll_recv(&mut lio, &mut read);
+  assert_eq!(read_bytes.expect("Failed to readv") as usize, 21);
+  assert_eq!(bufs[0], b"Hello, ");
+  assert_eq!(bufs[1], b"vectored world");
+}
+
+#[test]
+fn test_writev_readv() {
+  writev_readv_roundtrip(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_writev_readv_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  writev_readv_roundtrip(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+fn sendmsg_recvmsg_tcp(mut lio: Lio) {
+  let common::TcpPair { server_sock: _, client_sock, accepted_fd } =
+    setup_tcp_pair(&mut lio);
+
+  let bufs = vec![b"header".to_vec(), b"body".to_vec()];
+  let mut send =
+    api::sendmsg(&client_sock, bufs, None, None).with_lio(&lio).send();
+  let (sent, _) = poll_recv(&mut lio, &mut send);
+  assert_eq!(sent.expect("Failed to sendmsg") as usize, 10);
+
+  let bufs = vec![Vec::with_capacity(6), Vec::with_capacity(16)];
+  let mut recv = api::recvmsg(&accepted_fd, bufs, None).with_lio(&lio).send();
+  let (received, bufs) = poll_recv(&mut lio, &mut recv);
+  let (n, peer) = received.expect("Failed to recvmsg");
+  assert_eq!(n, 10);
+  assert!(peer.is_none(), "connected sockets report no peer address");
+  assert_eq!(bufs[0], b"header");
+  assert_eq!(bufs[1], b"body");
+}
+
+#[test]
+fn test_sendmsg_recvmsg_tcp() {
+  sendmsg_recvmsg_tcp(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_sendmsg_recvmsg_tcp_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  sendmsg_recvmsg_tcp(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}
+
+fn sendmsg_recvmsg_udp(mut lio: Lio) {
+  let receiver = std::net::UdpSocket::bind("127.0.0.1:0").unwrap();
+  let sender = std::net::UdpSocket::bind("127.0.0.1:0").unwrap();
+  let receiver_addr = receiver.local_addr().unwrap();
+  let sender_addr: SocketAddr = sender.local_addr().unwrap();
+  let receiver = unsafe { Resource::from_raw_fd(receiver.into_raw_fd()) };
+  let sender = unsafe { Resource::from_raw_fd(sender.into_raw_fd()) };
+
+  let bufs = vec![b"ping".to_vec(), b"!".to_vec()];
+  let mut send = api::sendmsg(&sender, bufs, Some(receiver_addr), None)
+    .with_lio(&lio)
+    .send();
+  let (sent, _) = poll_recv(&mut lio, &mut send);
+  assert_eq!(sent.expect("Failed to sendmsg") as usize, 5);
+
+  let mut recv = api::recvmsg(&receiver, vec![Vec::with_capacity(16)], None)
+    .with_lio(&lio)
+    .send();
+  let (received, bufs) = poll_recv(&mut lio, &mut recv);
+  let (n, peer) = received.expect("Failed to recvmsg");
+  assert_eq!(n, 5);
+  assert_eq!(peer, Some(sender_addr));
+  assert_eq!(bufs[0], b"ping!");
+}
+
+#[test]
+fn test_sendmsg_recvmsg_udp_addr() {
+  sendmsg_recvmsg_udp(Lio::new(64).unwrap());
+}
+
+#[test]
+#[cfg(target_os = "linux")]
+fn test_sendmsg_recvmsg_udp_addr_poller() {
+  use lio::backends::pollingv2::Poller;
+
+  sendmsg_recvmsg_udp(Lio::new_with_backend(Poller::new(), 64).unwrap());
+}